@@ -0,0 +1,179 @@
+#include "epoch.h"
+
+namespace zstl {
+
+constexpr int EpochManager::LIMBO_NUM;
+constexpr int EpochManager::RETIRE_THRESHOLD;
+
+// return the record to manager when the thread exits
+struct EpochThreadRecord {
+    EpochManager::Record* rec = nullptr;
+
+    ~EpochThreadRecord() {
+        if (rec != nullptr) {
+            EpochManager::instance().releaseRecord(rec);
+        }
+    }
+};
+
+EpochManager&
+EpochManager::instance() {
+    static EpochManager manager;
+    return manager;
+}
+
+EpochManager::~EpochManager() {
+    // all threads have exited
+    auto rec = records_.load(std::memory_order_acquire);
+    while (rec != nullptr) {
+        auto next = rec->next;
+        for (auto& limbo : rec->limbo) {
+            freeLimbo(limbo);
+        }
+        delete rec;
+        rec = next;
+    }
+}
+
+auto
+EpochManager::record()
+-> Record* {
+    static thread_local EpochThreadRecord local;
+
+    if (local.rec == nullptr) {
+        local.rec = acquireRecord();
+    }
+
+    return local.rec;
+}
+
+auto
+EpochManager::acquireRecord()
+-> Record* {
+    // reuse the record returned by exited thread
+    for (auto rec = records_.load(std::memory_order_acquire);
+         rec != nullptr;
+         rec = rec->next) {
+        bool expected = false;
+        if (!rec->used.load(std::memory_order_relaxed) &&
+            rec->used.compare_exchange_strong(expected, true,
+                                              std::memory_order_acquire)) {
+            return rec;
+        }
+    }
+
+    auto rec = new Record;
+    auto head = records_.load(std::memory_order_relaxed);
+    do {
+        rec->next = head;
+    } while (!records_.compare_exchange_weak(head, rec,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+
+    return rec;
+}
+
+void
+EpochManager::releaseRecord(Record* rec) ZSTL_NOEXCEPT {
+    rec->depth = 0;
+    rec->local.store(0, std::memory_order_release);
+
+    // the left objects are released by next owner or destructor
+    tryAdvance();
+    reclaim(rec, epoch());
+
+    rec->used.store(false, std::memory_order_release);
+}
+
+void
+EpochManager::enter() ZSTL_NOEXCEPT {
+    auto rec = record();
+
+    if (rec->depth++ == 0) {
+        rec->local.store(epoch_.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+        // the local epoch must be visible before reading shared structure
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+void
+EpochManager::leave() ZSTL_NOEXCEPT {
+    auto rec = record();
+
+    if (--rec->depth == 0) {
+        rec->local.store(0, std::memory_order_release);
+    }
+}
+
+void
+EpochManager::retire(void* p, Deleter deleter) {
+    auto rec = record();
+    const auto e = epoch_.load(std::memory_order_acquire);
+
+    reclaim(rec, e);
+    rec->limbo[e % LIMBO_NUM].push_back(Retired{ p, deleter });
+
+    if (++rec->retireCount >= RETIRE_THRESHOLD) {
+        rec->retireCount = 0;
+        if (tryAdvance()) {
+            reclaim(rec, epoch());
+        }
+    }
+}
+
+void
+EpochManager::collect() {
+    auto rec = record();
+
+    for (int i = 0; i != LIMBO_NUM - 1; ++i) {
+        tryAdvance();
+    }
+
+    reclaim(rec, epoch());
+}
+
+bool
+EpochManager::tryAdvance() ZSTL_NOEXCEPT {
+    auto e = epoch_.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // every thread in critical section must have observed current epoch
+    for (auto rec = records_.load(std::memory_order_acquire);
+         rec != nullptr;
+         rec = rec->next) {
+        const auto local = rec->local.load(std::memory_order_acquire);
+        if (local != 0 && local != e) {
+            return false;
+        }
+    }
+
+    // failure means other thread has advanced it
+    epoch_.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+void
+EpochManager::reclaim(Record* rec, uint64_t e) {
+    // the objects retired in epoch e can be released
+    // once global epoch reach e + 2
+    for (int i = 0; i != LIMBO_NUM; ++i) {
+        if (rec->limboEpoch[i] + 2 <= e) {
+            freeLimbo(rec->limbo[i]);
+        }
+    }
+
+    rec->limboEpoch[e % LIMBO_NUM] = e;
+}
+
+void
+EpochManager::freeLimbo(Vector<Retired>& limbo) {
+    for (auto& r : limbo) {
+        r.deleter(r.ptr);
+    }
+
+    limbo.clear();
+}
+
+} // namespace zstl
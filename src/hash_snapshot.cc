@@ -0,0 +1,170 @@
+#include "hash_snapshot.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace zstl {
+
+constexpr uint32_t HashSnapshotHeader::BYTE_ORDER_MARK;
+constexpr size_t HashSnapshotHeader::SECTION_ALIGN;
+
+static constexpr char SNAPSHOT_MAGIC[8] = { 'Z', 'S', 'T', 'L', 'H', 'S', 'N', '1' };
+
+static inline uint64_t alignSection(uint64_t offset) noexcept {
+    const auto align = HashSnapshotHeader::SECTION_ALIGN;
+    return (offset + align - 1) / align * align;
+}
+
+namespace detail {
+
+namespace {
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::string const& path)
+        : path_(path)
+        , fp_(::fopen(path.c_str(), "wb"))
+    {
+        if (fp_ == nullptr) {
+            throw std::runtime_error("Failed to create snapshot " + path_);
+        }
+    }
+
+    ~SnapshotWriter() {
+        if (fp_ != nullptr) {
+            ::fclose(fp_);
+            ::remove(path_.c_str());
+        }
+    }
+
+    // write @p len bytes at @p offset, the gap is filled with 0
+    void write(uint64_t offset, void const* data, uint64_t len) {
+        static char const zeros[HashSnapshotHeader::SECTION_ALIGN] = { 0 };
+        assert(offset >= written_ && offset - written_ <= sizeof zeros);
+
+        put(zeros, offset - written_);
+        put(data, len);
+    }
+
+    // the file is kept only if it is closed successfully
+    void close() {
+        const bool ok = ::fflush(fp_) == 0 && ::ferror(fp_) == 0;
+        const bool closed = ::fclose(fp_) == 0;
+        fp_ = nullptr;
+
+        if (!ok || !closed) {
+            ::remove(path_.c_str());
+            throw std::runtime_error("Failed to write snapshot " + path_);
+        }
+    }
+
+private:
+    void put(void const* data, uint64_t len) {
+        if (len != 0 && ::fwrite(data, 1, len, fp_) != len) {
+            throw std::runtime_error("Failed to write snapshot " + path_);
+        }
+        written_ += len;
+    }
+
+    std::string path_;
+    FILE* fp_;
+    uint64_t written_ = 0;
+};
+
+} // namespace
+
+void writeHashSnapshot(
+    char const* path,
+    uint32_t entrySize,
+    uint64_t bucketCount,
+    uint64_t elementCount,
+    void const* buckets,
+    void const* entries,
+    void const* blob,
+    uint64_t blobSize) {
+    HashSnapshotHeader header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+    header.byteOrder = HashSnapshotHeader::BYTE_ORDER_MARK;
+    header.entrySize = entrySize;
+    header.bucketCount = bucketCount;
+    header.elementCount = elementCount;
+    header.bucketsOffset = alignSection(sizeof header);
+    header.entriesOffset = alignSection(
+        header.bucketsOffset + (bucketCount + 1) * sizeof(uint64_t));
+    header.blobOffset = alignSection(
+        header.entriesOffset + elementCount * entrySize);
+    header.blobSize = blobSize;
+
+    const std::string tmpPath = std::string(path) + ".tmp";
+    SnapshotWriter writer(tmpPath);
+
+    writer.write(0, &header, sizeof header);
+    writer.write(header.bucketsOffset, buckets,
+                 (bucketCount + 1) * sizeof(uint64_t));
+    writer.write(header.entriesOffset, entries, elementCount * entrySize);
+    writer.write(header.blobOffset, blob, blobSize);
+    writer.close();
+
+    if (::rename(tmpPath.c_str(), path) != 0) {
+        ::remove(tmpPath.c_str());
+        throw std::runtime_error(std::string("Failed to rename snapshot to ") + path);
+    }
+}
+
+HashSnapshotHeader const&
+checkHashSnapshot(MappedFile const& file, char const* path, uint32_t entrySize) {
+    auto invalid = [path](char const* what) {
+        return std::runtime_error(
+            std::string("Invalid snapshot ") + path + ": " + what);
+    };
+
+    if (file.size() < sizeof(HashSnapshotHeader)) {
+        throw invalid("truncated header");
+    }
+
+    auto const& header = *reinterpret_cast<HashSnapshotHeader const*>(file.data());
+
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof header.magic) != 0) {
+        throw invalid("bad magic");
+    }
+
+    if (header.byteOrder != HashSnapshotHeader::BYTE_ORDER_MARK) {
+        throw invalid("byte order mismatch");
+    }
+
+    if (header.entrySize != entrySize) {
+        throw invalid("entry type mismatch");
+    }
+
+    // compare by division to avoid overflow of crafted count
+    const uint64_t size = file.size();
+    const auto fits = [size](uint64_t offset, uint64_t count, uint64_t unit) {
+        return offset % HashSnapshotHeader::SECTION_ALIGN == 0 &&
+               offset <= size &&
+               (unit == 0 || count <= (size - offset) / unit);
+    };
+
+    if (header.bucketCount == 0 || header.bucketCount >= size ||
+        !fits(header.bucketsOffset, header.bucketCount + 1, sizeof(uint64_t)) ||
+        !fits(header.entriesOffset, header.elementCount, entrySize) ||
+        !fits(header.blobOffset, header.blobSize, 1)) {
+        throw invalid("section out of file");
+    }
+
+    auto const buckets = reinterpret_cast<uint64_t const*>(
+        file.data() + header.bucketsOffset);
+    if (buckets[header.bucketCount] != header.elementCount) {
+        throw invalid("bucket table mismatch");
+    }
+
+    return header;
+}
+
+} // namespace detail
+
+} // namespace zstl
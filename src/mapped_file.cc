@@ -0,0 +1,83 @@
+#include "mapped_file.h"
+#include "stl_move.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace zstl {
+
+static void throwSystemError(char const* what, char const* path) {
+    throw std::runtime_error(
+        std::string(what) + " " + path + ": " + strerror(errno));
+}
+
+MappedFile::MappedFile(char const* path) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throwSystemError("open", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        ::close(fd);
+        throwSystemError("fstat", path);
+    }
+
+    // mmap() rejects zero length
+    if (st.st_size > 0) {
+        auto addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throwSystemError("mmap", path);
+        }
+
+        data_ = static_cast<char const*>(addr);
+        size_ = st.st_size;
+    }
+
+    // the mapping is valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) ZSTL_NOEXCEPT
+    : data_{ rhs.data_ }
+    , size_{ rhs.size_ }
+{
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+}
+
+MappedFile&
+MappedFile::operator=(MappedFile&& rhs) ZSTL_NOEXCEPT {
+    MappedFile tmp(STL_MOVE(rhs));
+    swap(tmp);
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+void
+MappedFile::willNeed() const ZSTL_NOEXCEPT {
+    if (data_ != nullptr) {
+        ::madvise(const_cast<char*>(data_), size_, MADV_WILLNEED);
+    }
+}
+
+void
+MappedFile::swap(MappedFile& rhs) ZSTL_NOEXCEPT {
+    STL_SWAP(data_, rhs.data_);
+    STL_SWAP(size_, rhs.size_);
+}
+
+} // namespace zstl
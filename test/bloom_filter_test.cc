@@ -0,0 +1,83 @@
+#include "bloom_filter.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace zstl;
+
+#define N 100000
+
+TEST(BloomFilterTest, noFalseNegative) {
+	BlockedBloomFilter<int> filter(N);
+
+	for (int i = 0; i != N; ++i) {
+		filter.insert(i * 3);
+	}
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_TRUE(filter.contains(i * 3));
+	}
+
+	EXPECT_EQ(filter.size(), N);
+	EXPECT_EQ(filter.numProbes(), 7);
+	EXPECT_NEAR(filter.bitsPerKey(), 10, 0.1);
+}
+
+TEST(BloomFilterTest, falsePositiveRate) {
+	for (double bitsPerKey : { 8.0, 10.0, 16.0 }) {
+		BlockedBloomFilter<int> filter(N, bitsPerKey);
+		for (int i = 0; i != N; ++i) {
+			filter.insert(i);
+		}
+
+		int positive = 0;
+		for (int i = N; i != 11 * N; ++i) {
+			positive += filter.contains(i);
+		}
+
+		// the estimation is close to the measured rate
+		const double measured = positive / (10.0 * N);
+		const double estimated = filter.falsePositiveRate();
+		EXPECT_NEAR(measured, estimated, estimated * 0.2 + 1e-4);
+		EXPECT_LT(measured, bitsPerKey == 8 ? 0.035 : (bitsPerKey == 10 ? 0.015 : 0.002));
+	}
+}
+
+TEST(BloomFilterTest, batch) {
+	BlockedBloomFilter<std::string, string_hash> filter(N);
+
+	std::vector<std::string> keys;
+	for (int i = 0; i != 2 * N; ++i) {
+		keys.push_back("key" + std::to_string(i));
+	}
+
+	// insert first half by batch
+	filter.insert_batch(keys.data(), N);
+	EXPECT_EQ(filter.size(), N);
+
+	std::unique_ptr<bool[]> out(new bool[keys.size()]);
+	filter.contains_batch(keys.data(), keys.size(), out.get());
+
+	int positive = 0;
+	for (size_t i = 0; i != keys.size(); ++i) {
+		EXPECT_EQ(out[i], filter.contains(keys[i]));
+		if (i < N) {
+			EXPECT_TRUE(out[i]);
+		} else {
+			positive += out[i];
+		}
+	}
+	EXPECT_LT(positive, N * 0.015);
+
+	filter.clear();
+	EXPECT_EQ(filter.size(), 0);
+	EXPECT_EQ(filter.falsePositiveRate(), 0);
+	EXPECT_FALSE(filter.contains(keys[0]));
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,155 @@
+#include "btree_set.h"
+#include "set.h"
+
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace zstl;
+
+#define N 1000000
+
+static std::vector<int> const& randomKeys(int n) {
+	static std::vector<int> keys;
+	if ((int)keys.size() != n) {
+		std::mt19937 gen(n);
+		keys.resize(n);
+		for (auto& key : keys) {
+			key = gen();
+		}
+	}
+	return keys;
+}
+
+// bytes allocated from malloc, including the overhead of malloc
+static size_t allocatedBytes() {
+	return mallinfo2().uordblks;
+}
+
+template<typename S>
+static void fill(S& s, int n) {
+	for (auto key : randomKeys(n)) {
+		s.insert(key);
+	}
+}
+
+template<typename S>
+static void insert_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	randomKeys(n);
+	size_t bytes = 0;
+
+	for (auto _ : state) {
+		const auto before = allocatedBytes();
+		S s;
+		fill(s, n);
+		bytes = allocatedBytes() - before;
+
+		state.PauseTiming();
+		{ S tmp(std::move(s)); }
+		state.ResumeTiming();
+	}
+
+	state.counters["bytes/elem"] = static_cast<double>(bytes) / n;
+}
+
+template<typename S>
+static void find_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	S s;
+	fill(s, n);
+	auto const& keys = randomKeys(n);
+
+	for (auto _ : state) {
+		size_t found = 0;
+		for (auto key : keys) {
+			found += s.find(key) != s.end();
+		}
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+template<typename S>
+static void scan_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	S s;
+	fill(s, n);
+
+	for (auto _ : state) {
+		long long sum = 0;
+		for (auto key : s) {
+			sum += key;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+}
+
+template<typename S>
+static void erase_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	auto const& keys = randomKeys(n);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		S s;
+		fill(s, n);
+		state.ResumeTiming();
+
+		for (auto key : keys) {
+			s.erase(key);
+		}
+	}
+}
+
+static void BTreeSetInsert(benchmark::State& state)
+{ insert_benchmark<BTreeSet<int>>(state); }
+
+static void MySetInsert(benchmark::State& state)
+{ insert_benchmark<Set<int>>(state); }
+
+static void STLSetInsert(benchmark::State& state)
+{ insert_benchmark<std::set<int>>(state); }
+
+static void BTreeSetFind(benchmark::State& state)
+{ find_benchmark<BTreeSet<int>>(state); }
+
+static void MySetFind(benchmark::State& state)
+{ find_benchmark<Set<int>>(state); }
+
+static void STLSetFind(benchmark::State& state)
+{ find_benchmark<std::set<int>>(state); }
+
+static void BTreeSetScan(benchmark::State& state)
+{ scan_benchmark<BTreeSet<int>>(state); }
+
+static void MySetScan(benchmark::State& state)
+{ scan_benchmark<Set<int>>(state); }
+
+static void STLSetScan(benchmark::State& state)
+{ scan_benchmark<std::set<int>>(state); }
+
+static void BTreeSetErase(benchmark::State& state)
+{ erase_benchmark<BTreeSet<int>>(state); }
+
+static void MySetErase(benchmark::State& state)
+{ erase_benchmark<Set<int>>(state); }
+
+static void STLSetErase(benchmark::State& state)
+{ erase_benchmark<std::set<int>>(state); }
+
+BENCHMARK(BTreeSetInsert)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetInsert)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(STLSetInsert)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(BTreeSetFind)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetFind)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(STLSetFind)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(BTreeSetScan)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetScan)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(STLSetScan)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(BTreeSetErase)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetErase)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(STLSetErase)->RangeMultiplier(100)->Range(100, N);
+
+BENCHMARK_MAIN();
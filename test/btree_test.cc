@@ -0,0 +1,277 @@
+#define BTREE_DEBUG
+#include "btree_set.h"
+#include "btree_map.h"
+#include "stl_numeric.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <string>
+
+#define N 20000
+
+using namespace zstl;
+
+// small nodes make deep tree to cover split and merge of inner nodes
+using SmallSet = BTreeSet<int, zstl::less<int>, zstl::allocator<int>, 32>;
+
+template<typename S>
+void expectSame(S const& s, std::set<int> const& stl) {
+	ASSERT_TRUE(s.rep().verify());
+	ASSERT_EQ(s.size(), stl.size());
+
+	auto iter = s.begin();
+	for (auto x : stl) {
+		ASSERT_EQ(*iter, x);
+		++iter;
+	}
+	EXPECT_EQ(iter, s.end());
+}
+
+TEST(BTreeSet, sequential) {
+	SmallSet s;
+	std::set<int> stl;
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_TRUE(s.insert(i).second);
+		EXPECT_FALSE(s.insert(i).second);
+		stl.insert(i);
+	}
+	expectSame(s, stl);
+
+	for (int i = -1; i != -N; --i) {
+		EXPECT_TRUE(s.insert(i).second);
+		stl.insert(i);
+	}
+	expectSame(s, stl);
+
+	// backward
+	int expect = N - 1;
+	for (auto iter = s.rbegin(); iter != s.rend(); ++iter) {
+		EXPECT_EQ(*iter, expect--);
+	}
+
+	for (int i = 0; i != N; i += 2) {
+		EXPECT_EQ(s.erase(i), 1);
+		EXPECT_EQ(s.erase(i), 0);
+		stl.erase(i);
+	}
+	expectSame(s, stl);
+}
+
+TEST(BTreeSet, random) {
+	SmallSet s;
+	std::set<int> stl;
+	std::mt19937 gen(N);
+
+	for (int i = 0; i != 10 * N; ++i) {
+		const int key = gen() % N;
+		if (gen() % 3 != 0) {
+			EXPECT_EQ(s.insert(key).second, stl.insert(key).second);
+		} else {
+			EXPECT_EQ(s.erase(key), stl.erase(key));
+		}
+
+		if (i % 1000 == 0) {
+			ASSERT_TRUE(s.rep().verify());
+		}
+	}
+	expectSame(s, stl);
+
+	for (int key = -1; key <= N; ++key) {
+		auto lb = s.lower_bound(key);
+		auto stl_lb = stl.lower_bound(key);
+		ASSERT_EQ(lb == s.end(), stl_lb == stl.end());
+		if (lb != s.end()) {
+			EXPECT_EQ(*lb, *stl_lb);
+		}
+
+		auto ub = s.upper_bound(key);
+		auto stl_ub = stl.upper_bound(key);
+		ASSERT_EQ(ub == s.end(), stl_ub == stl.end());
+		if (ub != s.end()) {
+			EXPECT_EQ(*ub, *stl_ub);
+		}
+
+		EXPECT_EQ(s.count(key), stl.count(key));
+	}
+
+	// erase all
+	for (int key = 0; key != N; ++key) {
+		EXPECT_EQ(s.erase(key), stl.erase(key));
+	}
+	EXPECT_TRUE(s.empty());
+	EXPECT_EQ(s.begin(), s.end());
+	EXPECT_TRUE(s.rep().verify());
+}
+
+TEST(BTreeSet, eraseIterator) {
+	SmallSet s;
+	std::set<int> stl;
+	for (int i = 0; i != N; ++i) {
+		s.insert(i);
+		stl.insert(i);
+	}
+
+	// erase() returns the next element even if the leaves are merged
+	auto iter = s.begin();
+	auto stl_iter = stl.begin();
+	while (iter != s.end()) {
+		if (*iter % 3 != 0) {
+			iter = s.erase(iter);
+			stl_iter = stl.erase(stl_iter);
+		} else {
+			++iter;
+			++stl_iter;
+		}
+		if (iter != s.end()) {
+			ASSERT_EQ(*iter, *stl_iter);
+		}
+	}
+	expectSame(s, stl);
+
+	auto first = s.lower_bound(N / 4);
+	auto last = s.lower_bound(N / 2);
+	auto next = s.erase(first, last);
+	stl.erase(stl.lower_bound(N / 4), stl.lower_bound(N / 2));
+	EXPECT_EQ(*next, *stl.lower_bound(N / 2));
+	expectSame(s, stl);
+
+	next = s.erase(s.begin(), s.end());
+	EXPECT_EQ(next, s.end());
+	EXPECT_TRUE(s.empty());
+}
+
+TEST(BTreeSet, copyAndMove) {
+	SmallSet s;
+	std::set<int> stl;
+	for (int i = 0; i != N; ++i) {
+		s.insert(i * 7 % N);
+		stl.insert(i * 7 % N);
+	}
+
+	SmallSet copy(s);
+	expectSame(copy, stl);
+
+	SmallSet moved(std::move(s));
+	EXPECT_TRUE(s.empty());
+	EXPECT_TRUE(s.rep().verify());
+	expectSame(moved, stl);
+
+	SmallSet small;
+	small.insert(-1);
+	small = copy;
+	expectSame(small, stl);
+
+	swap(small, s);
+	EXPECT_TRUE(small.empty());
+	expectSame(s, stl);
+
+	// algorithms work with the iterator
+	EXPECT_EQ(zstl::accumulate(s.begin(), s.end(), 0LL), (long long)N * (N - 1) / 2);
+}
+
+TEST(BTreeSet, string) {
+	BTreeSet<std::string> s;
+	std::set<std::string> stl;
+	std::mt19937 gen(N);
+
+	for (int i = 0; i != N; ++i) {
+		auto key = std::to_string(gen() % N);
+		EXPECT_EQ(s.insert(key).second, stl.insert(key).second);
+		if (i % 4 == 0) {
+			key = std::to_string(gen() % N);
+			EXPECT_EQ(s.erase(key), stl.erase(key));
+		}
+	}
+
+	ASSERT_TRUE(s.rep().verify());
+	ASSERT_EQ(s.size(), stl.size());
+	auto iter = s.begin();
+	for (auto const& x : stl) {
+		EXPECT_EQ(*iter++, x);
+	}
+}
+
+TEST(BTreeMap, access) {
+	BTreeMap<int, std::string, zstl::less<int>,
+		zstl::allocator<zstl::pair<int const, std::string>>, 64> m;
+
+	for (int i = 0; i != N; ++i) {
+		m[i] = std::to_string(i);
+	}
+	EXPECT_EQ(m.size(), N);
+	EXPECT_EQ(m.at(N / 2), std::to_string(N / 2));
+	EXPECT_THROW(m.at(N), std::range_error);
+
+	auto res = m.try_emplace(1, "x");
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->second, "1");
+
+	res = m.insert_or_assign(1, "x");
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(m[1], "x");
+
+	res = m.insert_or_assign(-1, "y");
+	EXPECT_TRUE(res.second);
+	EXPECT_EQ(m.begin()->second, "y");
+
+	for (int i = 0; i < N; i += 3) {
+		EXPECT_EQ(m.erase(i), 1);
+	}
+	EXPECT_TRUE(m.rep().verify());
+	for (int i = 0; i != N; ++i) {
+		EXPECT_EQ(m.contains(i), i % 3 != 0);
+	}
+
+	auto copy = m;
+	EXPECT_EQ(copy.size(), m.size());
+	EXPECT_EQ(copy[2], "2");
+}
+
+struct CountCopy {
+	static int copies;
+
+	CountCopy(int v)
+		: val(v)
+	{ }
+
+	CountCopy(CountCopy const& rhs)
+		: val(rhs.val)
+	{ ++copies; }
+
+	CountCopy(CountCopy&& rhs) noexcept
+		: val(rhs.val)
+	{ }
+
+	CountCopy& operator=(CountCopy const&) = default;
+
+	bool operator<(CountCopy const& rhs) const
+	{ return val < rhs.val; }
+
+	int val;
+};
+
+int CountCopy::copies = 0;
+
+TEST(BTreeMap, relocate) {
+	BTreeMap<CountCopy, int> m;
+	const int n = (int)decltype(m)::Rep::LEAF_SLOTS;
+
+	// the const key is moved when the values are shifted in the leaf
+	CountCopy::copies = 0;
+	for (int i = n; i > 0; --i) {
+		m.try_emplace(CountCopy(i), i);
+	}
+	for (int i = 1; i < n; i += 2) {
+		EXPECT_EQ(m.erase(CountCopy(i)), 1);
+	}
+	EXPECT_EQ(CountCopy::copies, 0);
+	EXPECT_EQ(m.rep().height(), 1);
+	EXPECT_EQ(m.begin()->first.val, 2);
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
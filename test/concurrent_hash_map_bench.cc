@@ -0,0 +1,117 @@
+#include "concurrent_hash_map.h"
+#include "hash_table.h"
+#include "functional.h"
+
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <random>
+
+using namespace zstl;
+
+#define N (1 << 20)
+
+// the baseline: HashTable guarded by one mutex
+class LockedHashMap {
+	using Rep = HashTable<zstl::pair<int const, int>, int, zstl::hash<int>,
+		get_first<int const, int>, zstl::equal_to<int>>;
+public:
+	bool find(int key, int& out) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto iter = rep_.find(key);
+		if (iter != rep_.end()) {
+			out = iter->second;
+			return true;
+		}
+		return false;
+	}
+
+	bool insert_or_assign(int key, int val) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto res = rep_.tryEmplaceUnique(key, key, val);
+		if (!res.second) {
+			res.first->second = val;
+		}
+		return res.second;
+	}
+
+	size_t erase(int key) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return rep_.erase(key);
+	}
+private:
+	mutable std::mutex mutex_;
+	Rep rep_;
+};
+
+// shared by benchmark threads, half of keys in [0, 2N) are in it
+template<typename M>
+M& sharedMap() {
+	static M* map = []() {
+		auto m = new M;
+		for (int i = 0; i < 2 * N; i += 2) {
+			m->insert_or_assign(i, i);
+		}
+		return m;
+	}();
+
+	return *map;
+}
+
+/**
+ * Each thread performs operations on random keys,
+ * @p writePercent of them are insert_or_assign() or erase(),
+ * so the size of map is roughly stable.
+ */
+template<typename M>
+void
+mixed_benchmark(benchmark::State& state, int writePercent) {
+	auto& map = sharedMap<M>();
+	std::mt19937 gen(state.thread_index());
+	std::uniform_int_distribution<int> keyDist(0, 2 * N - 1);
+	std::uniform_int_distribution<int> opDist(0, 99);
+
+	for (auto _ : state) {
+		const int key = keyDist(gen);
+		const int op = opDist(gen);
+
+		if (op < writePercent) {
+			if (op % 2 == 0) {
+				benchmark::DoNotOptimize(map.insert_or_assign(key, key));
+			} else {
+				benchmark::DoNotOptimize(map.erase(key));
+			}
+		} else {
+			int val;
+			benchmark::DoNotOptimize(map.find(key, val));
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static inline void
+ConcurrentMapReadHeavy(benchmark::State& state) {
+	mixed_benchmark<ConcurrentHashMap<int, int>>(state, 5);
+}
+
+static inline void
+LockedMapReadHeavy(benchmark::State& state) {
+	mixed_benchmark<LockedHashMap>(state, 5);
+}
+
+static inline void
+ConcurrentMapMixed(benchmark::State& state) {
+	mixed_benchmark<ConcurrentHashMap<int, int>>(state, 50);
+}
+
+static inline void
+LockedMapMixed(benchmark::State& state) {
+	mixed_benchmark<LockedHashMap>(state, 50);
+}
+
+BENCHMARK(ConcurrentMapReadHeavy)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(LockedMapReadHeavy)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(ConcurrentMapMixed)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(LockedMapMixed)->ThreadRange(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,168 @@
+#include "concurrent_hash_map.h"
+#include "tool.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace zstl;
+
+#define N 20000
+#define THREADS 8
+
+TEST(ConcurrentHashMap, basic) {
+	ConcurrentHashMap<std::string, int> m;
+	int val;
+
+	EXPECT_TRUE(m.empty());
+	EXPECT_FALSE(m.find("0", val));
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_TRUE(m.try_emplace(std::to_string(i), i));
+		EXPECT_FALSE(m.try_emplace(std::to_string(i), -i));
+	}
+
+	EXPECT_EQ(m.size(), N);
+	EXPECT_GE(m.bucket_count(), N / 2);
+
+	for (int i = 0; i != N; ++i) {
+		ASSERT_TRUE(m.find(std::to_string(i), val));
+		EXPECT_EQ(val, i);
+	}
+
+	EXPECT_FALSE(m.insert_or_assign("0", 100));
+	EXPECT_TRUE(m.find("0", val));
+	EXPECT_EQ(val, 100);
+	EXPECT_TRUE(m.insert_or_assign("-1", -1));
+	EXPECT_EQ(m.size(), N + 1);
+
+	for (int i = 0; i != N; i += 2) {
+		EXPECT_EQ(m.erase(std::to_string(i)), 1);
+		EXPECT_EQ(m.erase(std::to_string(i)), 0);
+	}
+
+	EXPECT_EQ(m.size(), N / 2 + 1);
+	for (int i = 0; i != N; ++i) {
+		EXPECT_EQ(m.contains(std::to_string(i)), i % 2 == 1);
+	}
+
+	m.clear();
+	EXPECT_TRUE(m.empty());
+	EXPECT_FALSE(m.contains("1"));
+}
+
+TEST(ConcurrentHashMap, reclaim) {
+	{
+		ConcurrentHashMap<int, Tracked> m;
+		for (int i = 0; i != N; ++i) {
+			m.try_emplace(i, i);
+		}
+		for (int i = 0; i != N; ++i) {
+			m.insert_or_assign(i, Tracked(i + 1));
+		}
+		for (int i = 0; i != N; i += 2) {
+			m.erase(i);
+		}
+		m.clear();
+	}
+
+	// no other thread is in critical section
+	EpochManager::instance().collect();
+	EXPECT_EQ(Tracked::alive().load(), 0);
+}
+
+// writers insert disjoint keys, and the table grows meanwhile
+TEST(ConcurrentHashMap, concurrentInsert) {
+	ConcurrentHashMap<int, int> m;
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t != THREADS; ++t) {
+		threads.emplace_back([&m, t]() {
+			for (int i = t; i < N * THREADS; i += THREADS) {
+				EXPECT_TRUE(m.try_emplace(i, i));
+				// the key inserted by itself is always visible
+				EXPECT_TRUE(m.contains(i));
+			}
+		});
+	}
+
+	for (auto& th : threads) {
+		th.join();
+	}
+
+	EXPECT_EQ(m.size(), N * THREADS);
+	for (int i = 0; i != N * THREADS; ++i) {
+		int val = -1;
+		ASSERT_TRUE(m.find(i, val));
+		EXPECT_EQ(val, i);
+	}
+}
+
+// readers must see either no value or a complete value
+// while writers replace and erase them
+TEST(ConcurrentHashMap, readWhileWrite) {
+	ConcurrentHashMap<int, std::string> m;
+	std::atomic<bool> stop{ false };
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i != N; ++i) {
+		m.try_emplace(i, std::to_string(i));
+	}
+
+	for (int t = 0; t != THREADS / 2; ++t) {
+		threads.emplace_back([&m, &stop, t]() {
+			std::string val;
+			while (!stop.load(std::memory_order_relaxed)) {
+				for (int i = t; i < 2 * N; i += THREADS / 2) {
+					if (m.find(i % N, val)) {
+						EXPECT_EQ(val.substr(0, val.find('#')), std::to_string(i % N));
+					}
+				}
+			}
+		});
+	}
+
+	std::vector<std::thread> writers;
+	for (int t = 0; t != THREADS / 2; ++t) {
+		writers.emplace_back([&m, t]() {
+			for (int round = 0; round != 4; ++round) {
+				for (int i = t; i < N; i += THREADS / 2) {
+					switch (round) {
+					case 0:
+						m.insert_or_assign(i, std::to_string(i) + "#" + std::string(32, 'x'));
+						break;
+					case 1:
+						m.erase(i);
+						break;
+					case 2:
+						// grow the table again
+						m.try_emplace(i, std::to_string(i));
+						m.try_emplace(i + N, std::to_string(i + N));
+						break;
+					case 3:
+						m.erase(i + N);
+						break;
+					}
+				}
+			}
+		});
+	}
+
+	for (auto& th : writers) {
+		th.join();
+	}
+
+	stop = true;
+	for (auto& th : threads) {
+		th.join();
+	}
+
+	EXPECT_EQ(m.size(), N);
+}
+
+int main(int argc, char* argv[]) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
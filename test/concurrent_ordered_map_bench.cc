@@ -0,0 +1,144 @@
+#include "concurrent_ordered_map.h"
+#include "map.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <shared_mutex>
+
+using namespace zstl;
+
+#define N (1 << 18)
+
+// the baseline: Map guarded by a readers-writer lock
+// (shared_timed_mutex since shared_mutex is C++17)
+class LockedOrderedMap {
+public:
+	bool find(int key, int& out) const {
+		std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+		auto iter = rep_.find(key);
+		if (iter != rep_.end()) {
+			out = iter->second;
+			return true;
+		}
+		return false;
+	}
+
+	template<typename F>
+	void scan(int first, int last, F f) const {
+		std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+		for (auto iter = rep_.lower_bound(first);
+			iter != rep_.end() && iter->first < last; ++iter) {
+			f(*iter);
+		}
+	}
+
+	bool insert_or_assign(int key, int val) {
+		std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+		auto iter = rep_.find(key);
+		if (iter != rep_.end()) {
+			iter->second = val;
+			return false;
+		}
+		rep_[key] = val;
+		return true;
+	}
+
+	size_t erase(int key) {
+		std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+		return rep_.erase(key);
+	}
+private:
+	mutable std::shared_timed_mutex mutex_;
+	Map<int, int> rep_;
+};
+
+// shared by benchmark threads, half of keys in [0, 2N) are in it
+template<typename M>
+M& sharedMap() {
+	static M* map = []() {
+		auto m = new M;
+		for (int i = 0; i < 2 * N; i += 2) {
+			m->insert_or_assign(i, i);
+		}
+		return m;
+	}();
+
+	return *map;
+}
+
+/**
+ * Each thread performs operations on random keys,
+ * @p writePercent of them are insert_or_assign() or erase(),
+ * @p scanPercent of them scan 100 keys, the others are find().
+ */
+template<typename M>
+void
+mixed_benchmark(benchmark::State& state, int writePercent, int scanPercent) {
+	auto& map = sharedMap<M>();
+	std::mt19937 gen(state.thread_index());
+	std::uniform_int_distribution<int> keyDist(0, 2 * N - 1);
+	std::uniform_int_distribution<int> opDist(0, 99);
+
+	for (auto _ : state) {
+		const int key = keyDist(gen);
+		const int op = opDist(gen);
+
+		if (op < writePercent) {
+			if (op % 2 == 0) {
+				benchmark::DoNotOptimize(map.insert_or_assign(key, key));
+			} else {
+				benchmark::DoNotOptimize(map.erase(key));
+			}
+		} else if (op < writePercent + scanPercent) {
+			long long sum = 0;
+			map.scan(key, key + 100, [&sum](zstl::pair<int const, int> const& x) {
+				sum += x.second;
+			});
+			benchmark::DoNotOptimize(sum);
+		} else {
+			int val;
+			benchmark::DoNotOptimize(map.find(key, val));
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static inline void
+ConcurrentOrderedMapRead(benchmark::State& state) {
+	mixed_benchmark<ConcurrentOrderedMap<int, int>>(state, 0, 0);
+}
+
+static inline void
+LockedOrderedMapRead(benchmark::State& state) {
+	mixed_benchmark<LockedOrderedMap>(state, 0, 0);
+}
+
+static inline void
+ConcurrentOrderedMapReadHeavy(benchmark::State& state) {
+	mixed_benchmark<ConcurrentOrderedMap<int, int>>(state, 2, 8);
+}
+
+static inline void
+LockedOrderedMapReadHeavy(benchmark::State& state) {
+	mixed_benchmark<LockedOrderedMap>(state, 2, 8);
+}
+
+static inline void
+ConcurrentOrderedMapMixed(benchmark::State& state) {
+	mixed_benchmark<ConcurrentOrderedMap<int, int>>(state, 20, 10);
+}
+
+static inline void
+LockedOrderedMapMixed(benchmark::State& state) {
+	mixed_benchmark<LockedOrderedMap>(state, 20, 10);
+}
+
+BENCHMARK(ConcurrentOrderedMapRead)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(LockedOrderedMapRead)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(ConcurrentOrderedMapReadHeavy)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(LockedOrderedMapReadHeavy)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(ConcurrentOrderedMapMixed)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(LockedOrderedMapMixed)->ThreadRange(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
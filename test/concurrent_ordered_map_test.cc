@@ -0,0 +1,149 @@
+#include "concurrent_ordered_map.h"
+#include "tool.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace zstl;
+
+#define N 20000
+#define THREADS 8
+
+TEST(ConcurrentOrderedMap, basic) {
+	ConcurrentOrderedMap<int, std::string> m;
+	std::string val;
+
+	EXPECT_TRUE(m.empty());
+	EXPECT_FALSE(m.find(0, val));
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_TRUE(m.try_emplace(i, std::to_string(i)));
+		EXPECT_FALSE(m.try_emplace(i, "dup"));
+	}
+	EXPECT_EQ(m.size(), N);
+
+	ASSERT_TRUE(m.find(42, val));
+	EXPECT_EQ(val, "42");
+	EXPECT_FALSE(m.insert_or_assign(42, std::string("x")));
+	EXPECT_TRUE(m.visit(42, [](std::string const& v) { EXPECT_EQ(v, "x"); }));
+
+	for (int i = 0; i < N; i += 2) {
+		EXPECT_EQ(m.erase(i), 1);
+		EXPECT_EQ(m.erase(i), 0);
+	}
+	EXPECT_EQ(m.size(), N / 2);
+
+	// [100, 200) in order
+	int expect = 101;
+	m.scan(100, 200, [&expect](zstl::pair<int const, std::string> const& x) {
+		EXPECT_EQ(x.first, expect);
+		expect += 2;
+	});
+	EXPECT_EQ(expect, 201);
+
+	auto snap = m.snapshot();
+	m.clear();
+	EXPECT_TRUE(m.empty());
+	EXPECT_EQ(snap.size(), N / 2);
+	EXPECT_EQ(snap.begin()->first, 1);
+}
+
+TEST(ConcurrentOrderedMap, reclaim) {
+	{
+		ConcurrentOrderedMap<int, Tracked> m;
+		for (int i = 0; i != N; ++i) {
+			m.try_emplace(i, i);
+		}
+		for (int i = 0; i != N; ++i) {
+			m.insert_or_assign(i, Tracked(i + 1));
+		}
+		m.update([](PersistentMap<int, Tracked>& map) {
+			for (int i = 0; i != N; i += 2) {
+				map.erase(i);
+			}
+		});
+
+		// the partial modifications of a throwing update() are dropped
+		EXPECT_THROW(m.update([](PersistentMap<int, Tracked>& map) {
+			map.erase(1);
+			throw std::runtime_error("update");
+		}), std::runtime_error);
+		EXPECT_TRUE(m.contains(1));
+		m.erase(3);
+		EXPECT_TRUE(m.contains(1));
+		EXPECT_EQ(m.size(), N / 2 - 1);
+		m.clear();
+	}
+
+	// no other thread is in critical section
+	EpochManager::instance().collect();
+	EpochManager::instance().collect();
+	EXPECT_EQ(Tracked::alive().load(), 0);
+}
+
+// the writers move amounts between keys in one update(),
+// so every scan of readers sees the same total
+TEST(ConcurrentOrderedMap, consistentScan) {
+	ConcurrentOrderedMap<int, int> m;
+	std::atomic<bool> stop{ false };
+	std::vector<std::thread> readers;
+
+	for (int i = 0; i != 1000; ++i) {
+		m.try_emplace(i, 100);
+	}
+
+	for (int t = 0; t != THREADS / 2; ++t) {
+		readers.emplace_back([&m, &stop]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				long long sum = 0;
+				int last = -1;
+				m.forEach([&sum, &last](zstl::pair<int const, int> const& x) {
+					EXPECT_LT(last, x.first);
+					last = x.first;
+					sum += x.second;
+				});
+				EXPECT_EQ(sum, 100000);
+			}
+		});
+	}
+
+	std::vector<std::thread> writers;
+	for (int t = 0; t != THREADS / 2; ++t) {
+		writers.emplace_back([&m, t]() {
+			for (int i = 0; i != 2000; ++i) {
+				const int from = (i * 7 + t) % 1000;
+				const int to = 1000 + i * THREADS + t;
+				m.update([from, to](PersistentMap<int, int>& map) {
+					int amount = 0;
+					map.find(from, amount);
+					map.erase(from);
+					map.try_emplace(from + 1000000, amount / 2);
+					map.try_emplace(to, amount - amount / 2);
+				});
+			}
+		});
+	}
+
+	for (auto& th : writers) {
+		th.join();
+	}
+	stop = true;
+	for (auto& th : readers) {
+		th.join();
+	}
+
+	long long sum = 0;
+	for (auto const& x : m.snapshot()) {
+		sum += x.second;
+	}
+	EXPECT_EQ(sum, 100000);
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
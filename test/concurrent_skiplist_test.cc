@@ -0,0 +1,162 @@
+#include "concurrent_skiplist.h"
+#include "tool.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace zstl;
+
+#define N 20000
+#define THREADS 8
+
+TEST(ConcurrentSkipList, basic) {
+	ConcurrentSkipList<int, std::string> m;
+	std::string val;
+
+	EXPECT_TRUE(m.empty());
+	EXPECT_FALSE(m.find(0, val));
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_TRUE(m.try_emplace(i, std::to_string(i)));
+		EXPECT_FALSE(m.try_emplace(i, "dup"));
+	}
+	EXPECT_EQ(m.size(), N);
+	EXPECT_FALSE(m.insert(decltype(m)::value_type(0, "dup")));
+
+	ASSERT_TRUE(m.find(42, val));
+	EXPECT_EQ(val, "42");
+	EXPECT_TRUE(m.visit(42, [](std::string const& v) { EXPECT_EQ(v, "42"); }));
+
+	for (int i = 0; i < N; i += 2) {
+		EXPECT_EQ(m.erase(i), 1);
+		EXPECT_EQ(m.erase(i), 0);
+		EXPECT_FALSE(m.contains(i));
+	}
+	EXPECT_EQ(m.size(), N / 2);
+	EXPECT_EQ(m.count(1), 1);
+
+	// [100, 200) in order
+	int expect = 101;
+	m.scan(100, 200, [&expect](zstl::pair<int const, std::string> const& x) {
+		EXPECT_EQ(x.first, expect);
+		expect += 2;
+	});
+	EXPECT_EQ(expect, 201);
+
+	int total = 0;
+	m.forEach([&total](zstl::pair<int const, std::string> const&) {
+		++total;
+	});
+	EXPECT_EQ(total, N / 2);
+}
+
+TEST(ConcurrentSkipList, reclaim) {
+	{
+		ConcurrentSkipList<int, Tracked> m;
+		for (int i = 0; i != N; ++i) {
+			m.try_emplace(i, i);
+		}
+		for (int i = 0; i != N; i += 2) {
+			m.erase(i);
+		}
+	}
+
+	// no other thread is in critical section
+	EpochManager::instance().collect();
+	EpochManager::instance().collect();
+	EXPECT_EQ(Tracked::alive().load(), 0);
+}
+
+// each writer owns the keys equal to its id modulo THREADS,
+// and erases them after inserting, while the readers check the order
+TEST(ConcurrentSkipList, concurrentWriters) {
+	ConcurrentSkipList<int, int> m;
+	std::atomic<bool> stop{ false };
+	std::vector<std::thread> readers;
+
+	for (int t = 0; t != THREADS / 2; ++t) {
+		readers.emplace_back([&m, &stop]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				int last = -1;
+				m.forEach([&last](zstl::pair<int const, int> const& x) {
+					EXPECT_LT(last, x.first);
+					EXPECT_EQ(x.first, x.second);
+					last = x.first;
+				});
+			}
+		});
+	}
+
+	std::vector<std::thread> writers;
+	for (int t = 0; t != THREADS; ++t) {
+		writers.emplace_back([&m, t]() {
+			for (int i = t; i < N; i += THREADS) {
+				EXPECT_TRUE(m.try_emplace(i, i));
+			}
+			// the odd keys are kept
+			for (int i = t; i < N; i += THREADS) {
+				if (i % 2 == 0) {
+					EXPECT_EQ(m.erase(i), 1);
+				}
+			}
+		});
+	}
+
+	for (auto& th : writers) {
+		th.join();
+	}
+	stop = true;
+	for (auto& th : readers) {
+		th.join();
+	}
+
+	EXPECT_EQ(m.size(), N / 2);
+	int expect = 1;
+	m.forEach([&expect](zstl::pair<int const, int> const& x) {
+		EXPECT_EQ(x.first, expect);
+		expect += 2;
+	});
+	EXPECT_EQ(expect, N + 1);
+}
+
+// the writers race on the same keys, only one of them succeeds for each operation
+TEST(ConcurrentSkipList, contention) {
+	ConcurrentSkipList<int, int> m;
+	std::atomic<int> inserted{ 0 };
+	std::atomic<int> erased{ 0 };
+	std::vector<std::thread> writers;
+
+	for (int t = 0; t != THREADS; ++t) {
+		writers.emplace_back([&m, &inserted, &erased, t]() {
+			for (int round = 0; round != 4; ++round) {
+				for (int i = 0; i != N / 10; ++i) {
+					if (m.try_emplace(i, t))
+						++inserted;
+				}
+				for (int i = 0; i != N / 10; ++i) {
+					erased += m.erase(i);
+				}
+			}
+		});
+	}
+
+	for (auto& th : writers) {
+		th.join();
+	}
+
+	EXPECT_EQ(inserted.load() - erased.load(), static_cast<int>(m.size()));
+	int size = 0;
+	m.forEach([&size](zstl::pair<int const, int> const&) {
+		++size;
+	});
+	EXPECT_EQ(size, static_cast<int>(m.size()));
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
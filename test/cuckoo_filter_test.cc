@@ -0,0 +1,109 @@
+#include "cuckoo_filter.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace zstl;
+
+#define N 100000
+
+TEST(CuckooFilterTest, insertErase) {
+	CuckooFilter<int> filter(N);
+
+	for (int i = 0; i != N; ++i) {
+		ASSERT_TRUE(filter.insert(i));
+	}
+	EXPECT_EQ(filter.size(), N);
+	EXPECT_FALSE(filter.full());
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_TRUE(filter.contains(i));
+	}
+
+	for (int i = 0; i != N; i += 2) {
+		EXPECT_TRUE(filter.erase(i));
+	}
+	EXPECT_EQ(filter.size(), N / 2);
+
+	int positive = 0;
+	for (int i = 0; i != N; ++i) {
+		if (i % 2) {
+			EXPECT_TRUE(filter.contains(i));
+		} else {
+			positive += filter.contains(i);
+		}
+	}
+	EXPECT_LT(positive, 10);
+}
+
+TEST(CuckooFilterTest, falsePositiveRate) {
+	CuckooFilter<int, hash<int>, uint8_t> filter(N);
+	for (int i = 0; i != N; ++i) {
+		ASSERT_TRUE(filter.insert(i));
+	}
+
+	int positive = 0;
+	for (int i = N; i != 11 * N; ++i) {
+		positive += filter.contains(i);
+	}
+
+	const double measured = positive / (10.0 * N);
+	const double estimated = filter.falsePositiveRate();
+	EXPECT_NEAR(measured, estimated, estimated * 0.2);
+}
+
+TEST(CuckooFilterTest, full) {
+	CuckooFilter<int> filter(1000);
+
+	// no inserted key is lost even when the filter is full
+	int inserted = 0;
+	while (filter.insert(inserted)) {
+		++inserted;
+	}
+	EXPECT_TRUE(filter.full());
+	EXPECT_GT(filter.loadFactor(), 0.9);
+	EXPECT_EQ(filter.size(), inserted);
+
+	for (int i = 0; i != inserted; ++i) {
+		ASSERT_TRUE(filter.contains(i));
+	}
+
+	// erase makes room for the victim
+	EXPECT_TRUE(filter.erase(0));
+	EXPECT_EQ(filter.size(), inserted - 1);
+	for (int i = 1; i != inserted; ++i) {
+		ASSERT_TRUE(filter.contains(i));
+	}
+}
+
+TEST(CuckooFilterTest, batch) {
+	CuckooFilter<std::string, string_hash> filter(N);
+
+	std::vector<std::string> keys;
+	for (int i = 0; i != 2 * N; ++i) {
+		keys.push_back("key" + std::to_string(i));
+	}
+
+	EXPECT_EQ(filter.insert_batch(keys.data(), N), N);
+
+	std::unique_ptr<bool[]> out(new bool[keys.size()]);
+	filter.contains_batch(keys.data(), keys.size(), out.get());
+
+	for (size_t i = 0; i != keys.size(); ++i) {
+		EXPECT_EQ(out[i], filter.contains(keys[i]));
+		if (i < N) {
+			EXPECT_TRUE(out[i]);
+		}
+	}
+
+	filter.clear();
+	EXPECT_EQ(filter.size(), 0);
+	EXPECT_FALSE(filter.contains(keys[0]));
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+#include "bloom_filter.h"
+#include "cuckoo_filter.h"
+#include "hash_table.h"
+#include "functional.h"
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace zstl;
+
+using HashSet = HashTable<int, int, zstl::hash<int>, identity<int>, equal_to<int>>;
+
+// half of queried keys are inserted
+static std::vector<int> queryKeys(int length) {
+	std::mt19937 gen(length);
+	std::uniform_int_distribution<int> dist(0, 2 * length - 1);
+	std::vector<int> keys(1 << 20);
+	for (auto& key : keys) {
+		key = dist(gen);
+	}
+	return keys;
+}
+
+/**
+ * Query throughput, the memory per key and false positive rate
+ * are reported as counters
+ */
+template<typename Filter, typename F>
+void
+filter_benchmark(benchmark::State& state, Filter& filter, F query) {
+	const int length = state.range(0);
+	for (int i = 0; i != length; ++i) {
+		filter.insert(i);
+	}
+
+	const auto keys = queryKeys(length);
+	std::unique_ptr<bool[]> out(new bool[keys.size()]);
+
+	for (auto _ : state) {
+		query(filter, keys.data(), keys.size(), out.get());
+		benchmark::DoNotOptimize(out[0]);
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+	state.counters["bits/key"] = filter.bitsPerKey();
+	state.counters["fpr"] = filter.falsePositiveRate();
+}
+
+template<typename Filter>
+void
+query_loop(Filter const& filter, int const* keys, size_t n, bool* out) {
+	for (size_t i = 0; i != n; ++i) {
+		out[i] = filter.contains(keys[i]);
+	}
+}
+
+template<typename Filter>
+void
+query_batch(Filter const& filter, int const* keys, size_t n, bool* out) {
+	filter.contains_batch(keys, n, out);
+}
+
+static inline void
+BloomQueryLoop(benchmark::State& state) {
+	BlockedBloomFilter<int> filter(state.range(0));
+	filter_benchmark(state, filter, query_loop<BlockedBloomFilter<int>>);
+}
+
+static inline void
+BloomQueryBatch(benchmark::State& state) {
+	BlockedBloomFilter<int> filter(state.range(0));
+	filter_benchmark(state, filter, query_batch<BlockedBloomFilter<int>>);
+}
+
+static inline void
+CuckooQueryLoop(benchmark::State& state) {
+	CuckooFilter<int> filter(state.range(0));
+	filter_benchmark(state, filter, query_loop<CuckooFilter<int>>);
+}
+
+static inline void
+CuckooQueryBatch(benchmark::State& state) {
+	CuckooFilter<int> filter(state.range(0));
+	filter_benchmark(state, filter, query_batch<CuckooFilter<int>>);
+}
+
+// the exact lookup which the filter fronts
+static inline void
+HashTableQuery(benchmark::State& state) {
+	const int length = state.range(0);
+	HashSet set(length);
+	for (int i = 0; i != length; ++i) {
+		set.insertUnique(i);
+	}
+
+	const auto keys = queryKeys(length);
+	std::unique_ptr<bool[]> out(new bool[keys.size()]);
+
+	for (auto _ : state) {
+		for (size_t i = 0; i != keys.size(); ++i) {
+			out[i] = set.contains(keys[i]);
+		}
+		benchmark::DoNotOptimize(out[0]);
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK(BloomQueryLoop)->RangeMultiplier(64)->Range(1 << 14, 1 << 26);
+BENCHMARK(BloomQueryBatch)->RangeMultiplier(64)->Range(1 << 14, 1 << 26);
+BENCHMARK(CuckooQueryLoop)->RangeMultiplier(64)->Range(1 << 14, 1 << 26);
+BENCHMARK(CuckooQueryBatch)->RangeMultiplier(64)->Range(1 << 14, 1 << 26);
+BENCHMARK(HashTableQuery)->RangeMultiplier(64)->Range(1 << 14, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+#include "flat_set.h"
+#include "flat_map.h"
+#include "map.h"
+#include "set.h"
+
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+#include <random>
+#include <vector>
+
+using namespace zstl;
+
+// lookups in one iteration, so the time of large sets is comparable
+#define LOOKUPS (1 << 16)
+
+static std::vector<int> const& randomKeys(int n) {
+	static std::vector<int> keys;
+	if ((int)keys.size() != n) {
+		std::mt19937 gen(n);
+		keys.resize(n);
+		for (auto& key : keys) {
+			key = gen();
+		}
+	}
+	return keys;
+}
+
+// bytes allocated from malloc, including the overhead of malloc
+// and the large arrays which are mapped by mmap()
+static size_t allocatedBytes() {
+	auto info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+template<typename T>
+static void fill(Set<T>& s, std::vector<int> const& keys) {
+	for (auto key : keys) {
+		s.insert(key);
+	}
+}
+
+template<typename T>
+static void fill(FlatSet<T>& s, std::vector<int> const& keys) {
+	s.insert(keys.begin(), keys.end());
+}
+
+template<typename K, typename V>
+static void fill(Map<K, V>& m, std::vector<int> const& keys) {
+	for (auto key : keys) {
+		m[key];
+	}
+}
+
+template<typename K, typename V, typename CP, bool S>
+static void fill(FlatMap<K, V, CP, S>& m, std::vector<int> const& keys) {
+	Vector<zstl::pair<K, V>> pairs;
+	for (auto key : keys) {
+		pairs.emplace_back(key, V{});
+	}
+	m.insert(pairs.begin(), pairs.end());
+}
+
+template<typename S>
+static void find_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	auto const& keys = randomKeys(n);
+
+	const auto before = allocatedBytes();
+	S s;
+	fill(s, keys);
+	const auto bytes = allocatedBytes() - before;
+
+	std::vector<int> lookups(LOOKUPS);
+	std::mt19937 gen(0);
+	for (auto& key : lookups) {
+		key = keys[gen() % n];
+	}
+
+	for (auto _ : state) {
+		size_t found = 0;
+		for (auto key : lookups) {
+			found += s.find(key) != s.end();
+		}
+		benchmark::DoNotOptimize(found);
+	}
+
+	state.SetItemsProcessed(state.iterations() * LOOKUPS);
+	state.counters["bytes/elem"] = static_cast<double>(bytes) / n;
+}
+
+template<typename S>
+static void build_benchmark(benchmark::State& state) {
+	auto const& keys = randomKeys(state.range(0));
+
+	for (auto _ : state) {
+		S s;
+		fill(s, keys);
+		benchmark::DoNotOptimize(s.size());
+
+		state.PauseTiming();
+		{ S tmp(std::move(s)); }
+		state.ResumeTiming();
+	}
+}
+
+// 64 bytes value, which makes the pair layout sparse
+struct Payload {
+	long data[8];
+};
+
+static void FlatSetFind(benchmark::State& state)
+{ find_benchmark<FlatSet<int>>(state); }
+
+static void SetFind(benchmark::State& state)
+{ find_benchmark<Set<int>>(state); }
+
+static void FlatMapFind(benchmark::State& state)
+{ find_benchmark<FlatMap<int, Payload>>(state); }
+
+static void SplitFlatMapFind(benchmark::State& state)
+{ find_benchmark<SplitFlatMap<int, Payload>>(state); }
+
+static void MapFind(benchmark::State& state)
+{ find_benchmark<Map<int, Payload>>(state); }
+
+static void FlatSetBuild(benchmark::State& state)
+{ build_benchmark<FlatSet<int>>(state); }
+
+static void SetBuild(benchmark::State& state)
+{ build_benchmark<Set<int>>(state); }
+
+BENCHMARK(FlatSetFind)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(SetFind)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(FlatMapFind)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(SplitFlatMapFind)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(MapFind)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(FlatSetBuild)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(SetBuild)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,288 @@
+#include "flat_set.h"
+#include "flat_map.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#define N 20000
+
+using namespace zstl;
+
+template<typename S>
+void expectSame(S const& s, std::set<int> const& stl) {
+	ASSERT_EQ(s.size(), stl.size());
+
+	auto iter = s.begin();
+	for (auto x : stl) {
+		ASSERT_EQ(*iter, x);
+		++iter;
+	}
+	EXPECT_EQ(iter, s.end());
+}
+
+template<typename M>
+void expectSame(M const& m, std::map<int, std::string> const& stl) {
+	ASSERT_EQ(m.size(), stl.size());
+
+	auto iter = m.begin();
+	for (auto const& x : stl) {
+		ASSERT_EQ(iter->first, x.first);
+		ASSERT_EQ(iter->second, x.second);
+		++iter;
+	}
+	EXPECT_EQ(iter, m.end());
+}
+
+TEST(FlatSet, single) {
+	FlatSet<int> s;
+	std::set<int> stl;
+	std::mt19937 gen(42);
+
+	for (int i = 0; i != N; ++i) {
+		int x = gen() % N;
+		EXPECT_EQ(s.insert(x).second, stl.insert(x).second);
+	}
+	expectSame(s, stl);
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_EQ(s.contains(i), stl.count(i) == 1);
+		EXPECT_EQ(s.lower_bound(i) == s.end(), stl.lower_bound(i) == stl.end());
+		if (s.upper_bound(i) != s.end()) {
+			EXPECT_EQ(*s.upper_bound(i), *stl.upper_bound(i));
+		}
+	}
+
+	for (int i = 0; i < N; i += 2) {
+		EXPECT_EQ(s.erase(i), stl.erase(i));
+	}
+	expectSame(s, stl);
+
+	auto iter = s.erase(s.begin());
+	EXPECT_EQ(iter, s.begin());
+	stl.erase(stl.begin());
+	expectSame(s, stl);
+}
+
+TEST(FlatSet, bulk) {
+	FlatSet<int> s;
+	std::set<int> stl;
+	std::mt19937 gen(42);
+
+	// unsorted batches with duplicates, both inside a batch and across batches
+	for (int round = 0; round != 10; ++round) {
+		Vector<int> batch;
+		for (int i = 0; i != N / 10; ++i) {
+			batch.push_back(gen() % N);
+		}
+		s.insert(batch.begin(), batch.end());
+		stl.insert(batch.begin(), batch.end());
+		expectSame(s, stl);
+	}
+
+	// all keys are greater than the old ones
+	Vector<int> tail;
+	for (int i = 2 * N; i != N; --i) {
+		tail.push_back(i);
+		tail.push_back(i);
+	}
+	s.insert(tail.begin(), tail.end());
+	stl.insert(tail.begin(), tail.end());
+	expectSame(s, stl);
+
+	s.insert(tail.begin(), tail.begin());
+	expectSame(s, stl);
+
+	FlatSet<int> t(tail.begin(), tail.end());
+	EXPECT_EQ(t.size(), N);
+	EXPECT_EQ(*t.begin(), N + 1);
+}
+
+TEST(FlatSet, string) {
+	FlatSet<std::string> s;
+	Vector<std::string> words{ "flat", "set", "based", "on", "sorted", "vector" };
+	s.insert(words.begin(), words.end());
+	s.insert(words.begin(), words.end());
+	EXPECT_EQ(s.size(), words.size());
+	EXPECT_EQ(*s.begin(), "based");
+	EXPECT_TRUE(s.emplace("zstl").second);
+	EXPECT_EQ(*s.rbegin(), "zstl");
+	EXPECT_EQ(s.count("set"), 1);
+
+	FlatSet<std::string> other;
+	swap(s, other);
+	EXPECT_TRUE(s.empty());
+	EXPECT_EQ(other.size(), words.size() + 1);
+}
+
+template<typename M>
+void testMap() {
+	M m;
+	std::map<int, std::string> stl;
+	std::mt19937 gen(42);
+
+	for (int i = 0; i != N / 4; ++i) {
+		int x = gen() % N;
+		auto res = m.try_emplace(x, std::to_string(x));
+		EXPECT_EQ(res.second, stl.emplace(x, std::to_string(x)).second);
+		EXPECT_EQ(res.first->first, x);
+	}
+	expectSame(m, stl);
+
+	// the existing values are kept
+	Vector<zstl::pair<int, std::string>> batch;
+	for (int i = 0; i != N; ++i) {
+		int x = gen() % (2 * N);
+		batch.emplace_back(x, std::string("bulk"));
+		stl.emplace(x, "bulk");
+	}
+	m.insert(batch.begin(), batch.end());
+	expectSame(m, stl);
+
+	for (auto const& x : stl) {
+		EXPECT_EQ(m.at(x.first), x.second);
+		EXPECT_EQ(m.find(x.first)->second, x.second);
+	}
+	EXPECT_EQ(m.find(-1), m.end());
+	EXPECT_THROW(m.at(-1), std::range_error);
+
+	m[-1] = "new";
+	stl[-1] = "new";
+	m[-1] += "er";
+	stl[-1] += "er";
+	EXPECT_EQ(m.insert_or_assign(0, std::string("zero")).second, stl.count(0) == 0);
+	stl[0] = "zero";
+	expectSame(m, stl);
+
+	for (int i = 0; i < 2 * N; i += 3) {
+		EXPECT_EQ(m.erase(i), stl.erase(i));
+	}
+	expectSame(m, stl);
+
+	auto iter = m.erase(m.begin(), m.lower_bound(N));
+	EXPECT_EQ(iter, m.begin());
+	stl.erase(stl.begin(), stl.lower_bound(N));
+	expectSame(m, stl);
+	EXPECT_EQ(m.upper_bound(2 * N), m.end());
+}
+
+TEST(FlatMap, pair) {
+	testMap<FlatMap<int, std::string>>();
+}
+
+TEST(FlatMap, split) {
+	testMap<SplitFlatMap<int, std::string>>();
+
+	SplitFlatMap<int, int> m;
+	for (int i = 0; i != 100; ++i) {
+		m[i] = i;
+	}
+	for (auto iter = m.begin(); iter != m.end(); ++iter) {
+		iter->second *= 2;
+	}
+
+	SplitFlatMap<int, int> const& cm = m;
+	int sum = 0;
+	for (auto x : cm) {
+		EXPECT_EQ(x.second, 2 * x.first);
+		sum += x.second;
+	}
+	EXPECT_EQ(sum, 9900);
+	EXPECT_EQ(cm.end() - cm.begin(), 100);
+	EXPECT_EQ(cm.begin()[10].second, 20);
+}
+
+struct ThrowOnCopy {
+	static int copies;
+
+	ThrowOnCopy(int v)
+		: val(v)
+	{ }
+
+	ThrowOnCopy(ThrowOnCopy const& rhs)
+		: val(rhs.val) {
+		if (--copies == 0) {
+			throw std::runtime_error("copy");
+		}
+	}
+
+	ThrowOnCopy& operator=(ThrowOnCopy const&) = default;
+
+	bool operator<(ThrowOnCopy const& rhs) const
+	{ return val < rhs.val; }
+
+	int val;
+};
+
+int ThrowOnCopy::copies = 0;
+
+TEST(FlatSet, insert_throw) {
+	FlatSet<ThrowOnCopy> s;
+	for (int i = 0; i < 100; i += 2) {
+		s.insert(ThrowOnCopy(i));
+	}
+
+	Vector<ThrowOnCopy> batch;
+	for (int i = 99; i > 0; i -= 2) {
+		batch.push_back(ThrowOnCopy(i));
+	}
+
+	// throw in the append and the merge, the set is still sorted and unchanged
+	for (int copies : { 10, 100, 140 }) {
+		ThrowOnCopy::copies = copies;
+		EXPECT_THROW(s.insert(batch.begin(), batch.end()), std::runtime_error);
+		ASSERT_EQ(s.size(), 50);
+		for (int i = 0; i < 50; ++i) {
+			EXPECT_EQ(s.begin()[i].val, 2 * i);
+		}
+	}
+
+	ThrowOnCopy::copies = 0;
+	s.insert(batch.begin(), batch.end());
+	EXPECT_EQ(s.size(), 100);
+	EXPECT_TRUE(s.contains(ThrowOnCopy(99)));
+}
+
+template<typename M>
+void testMapInsertThrow() {
+	M m;
+	for (int i = 0; i < 100; i += 2) {
+		m.try_emplace(i, i);
+	}
+
+	Vector<zstl::pair<int, ThrowOnCopy>> batch;
+	for (int i = 99; i > 0; i -= 2) {
+		batch.emplace_back(i, ThrowOnCopy(i));
+	}
+
+	// keys and values stay paired and sorted
+	for (int copies : { 10, 100, 140 }) {
+		ThrowOnCopy::copies = copies;
+		EXPECT_THROW(m.insert(batch.begin(), batch.end()), std::runtime_error);
+		ASSERT_EQ(m.size(), 50);
+		int i = 0;
+		for (auto iter = m.begin(); iter != m.end(); ++iter, i += 2) {
+			EXPECT_EQ((*iter).first, i);
+			EXPECT_EQ((*iter).second.val, i);
+		}
+	}
+
+	ThrowOnCopy::copies = 0;
+	m.insert(batch.begin(), batch.end());
+	EXPECT_EQ(m.size(), 100);
+	EXPECT_EQ(m.at(99).val, 99);
+}
+
+TEST(FlatMap, insert_throw) {
+	testMapInsertThrow<FlatMap<int, ThrowOnCopy>>();
+	testMapInsertThrow<SplitFlatMap<int, ThrowOnCopy>>();
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -9,6 +9,34 @@ TEST(hashAuxTest, hashString) {
     EXPECT_EQ(zstl::hash<std::string>{}("a"), (int)'a');
 }
 
+TEST(hashAuxTest, hashStringIdentical) {
+    std::string str = "hash of string";
+    char const* cstr = str.c_str();
+    zstl::string_view sv(str);
+
+    auto h = zstl::hash<std::string>{}(str);
+    EXPECT_EQ(zstl::hash<char const*>{}(cstr), h);
+    EXPECT_EQ(zstl::hash<zstl::string_view>{}(sv), h);
+    EXPECT_EQ(zstl::string_hash{}(str), h);
+    EXPECT_EQ(zstl::string_hash{}(cstr), h);
+    EXPECT_EQ(zstl::string_hash{}(sv), h);
+
+    // view is not null-terminated
+    zstl::string_view prefix(cstr, 4);
+    EXPECT_EQ(zstl::string_hash{}(prefix), zstl::hash<std::string>{}("hash"));
+}
+
+TEST(hashAuxTest, hashMix64) {
+    EXPECT_EQ(hashMix64(0), 0);
+
+    // flipping one input bit flips about half of output bits
+    long flipped = 0;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        flipped += __builtin_popcountll(hashMix64(i) ^ hashMix64(i ^ 1));
+    }
+    EXPECT_NEAR(flipped / 1000.0, 32, 2);
+}
+
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
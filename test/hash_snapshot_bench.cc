@@ -0,0 +1,135 @@
+#include "hash_snapshot.h"
+#include "unordered_map.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace zstl;
+
+using Map = UnorderedMap<std::string, std::string, string_hash, equal_to<>>;
+using Snapshot = HashSnapshot<std::string, std::string>;
+
+static std::string keyOf(int i) {
+	return "user:" + std::to_string(i);
+}
+
+static std::string snapshotPath(int length) {
+	return "/tmp/zstl_bench_" + std::to_string(length) + ".snap";
+}
+
+// the snapshot of length elements, written once
+static void prepareSnapshot(int length) {
+	static int prepared = -1;
+	if (prepared == length) {
+		return;
+	}
+
+	Map m;
+	for (int i = 0; i != length; ++i) {
+		m[keyOf(i)] = std::string(32, 'v') + std::to_string(i);
+	}
+	saveHashSnapshot(m, snapshotPath(length).c_str());
+	prepared = length;
+}
+
+/**
+ * Cold start: rebuild the table from source data
+ * vs. map the snapshot, then serve 1000 lookups
+ */
+static inline void
+MapRebuild(benchmark::State& state) {
+	const int length = state.range(0);
+	std::vector<std::pair<std::string, std::string>> source;
+	for (int i = 0; i != length; ++i) {
+		source.emplace_back(keyOf(i), std::string(32, 'v') + std::to_string(i));
+	}
+
+	for (auto _ : state) {
+		Map m;
+		for (auto const& kv : source) {
+			m[kv.first] = kv.second;
+		}
+		benchmark::DoNotOptimize(m.find(keyOf(length / 2)));
+	}
+}
+
+static inline void
+SnapshotOpen(benchmark::State& state) {
+	const int length = state.range(0);
+	prepareSnapshot(length);
+
+	std::mt19937 gen(length);
+	std::uniform_int_distribution<int> dist(0, length - 1);
+	std::vector<std::string> keys;
+	for (int i = 0; i != 1000; ++i) {
+		keys.push_back(keyOf(dist(gen)));
+	}
+
+	for (auto _ : state) {
+		Snapshot snap(snapshotPath(length).c_str());
+		string_view val;
+		for (auto const& key : keys) {
+			benchmark::DoNotOptimize(snap.find(key, val));
+		}
+	}
+}
+
+/**
+ * Steady state: search random keys(half are missing)
+ */
+template<typename F>
+void
+lookup_benchmark(benchmark::State& state, F find) {
+	const int length = state.range(0);
+	std::mt19937 gen(length);
+	std::uniform_int_distribution<int> dist(0, 2 * length - 1);
+	std::vector<std::string> keys;
+	for (int i = 0; i != (1 << 16); ++i) {
+		keys.push_back(keyOf(dist(gen)));
+	}
+
+	for (auto _ : state) {
+		size_t found = 0;
+		for (auto const& key : keys) {
+			found += find(string_view(key));
+		}
+		benchmark::DoNotOptimize(found);
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static inline void
+MapFind(benchmark::State& state) {
+	const int length = state.range(0);
+	Map m;
+	for (int i = 0; i != length; ++i) {
+		m[keyOf(i)] = std::string(32, 'v') + std::to_string(i);
+	}
+
+	lookup_benchmark(state, [&m](string_view key) {
+		return m.contains(key);
+	});
+}
+
+static inline void
+SnapshotFind(benchmark::State& state) {
+	const int length = state.range(0);
+	prepareSnapshot(length);
+	Snapshot snap(snapshotPath(length).c_str());
+
+	lookup_benchmark(state, [&snap](string_view key) {
+		return snap.contains(key);
+	});
+}
+
+BENCHMARK(MapRebuild)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK(SnapshotOpen)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK(MapFind)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(SnapshotFind)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+BENCHMARK_MAIN();
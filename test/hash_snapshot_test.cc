@@ -0,0 +1,134 @@
+#include "hash_snapshot.h"
+#include "unordered_map.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+
+using namespace zstl;
+
+#define N 10000
+
+static std::string snapshotPath(char const* name) {
+	return ::testing::TempDir() + name;
+}
+
+struct Point {
+	int x;
+	double y;
+};
+
+TEST(HashSnapshotTest, trivial) {
+	UnorderedMap<int, Point> m;
+	for (int i = 0; i != N; ++i) {
+		m[i * 7] = Point{ i, i / 2.0 };
+	}
+
+	const auto path = snapshotPath("trivial.snap");
+	saveHashSnapshot(m, path.c_str());
+
+	HashSnapshot<int, Point> snap(path.c_str());
+	EXPECT_EQ(snap.size(), N);
+	EXPECT_FALSE(snap.empty());
+
+	for (int i = 0; i != N; ++i) {
+		Point p{ -1, -1 };
+		ASSERT_TRUE(snap.find(i * 7, p));
+		EXPECT_EQ(p.x, i);
+		EXPECT_EQ(p.y, i / 2.0);
+	}
+
+	Point p{ -1, -1 };
+	EXPECT_FALSE(snap.find(1, p));
+	EXPECT_EQ(p.x, -1);
+	EXPECT_EQ(snap.count(-7), 0);
+	EXPECT_TRUE(snap.contains(0));
+
+	long sum = 0;
+	snap.forEach([&sum](int key, Point const& val) {
+		EXPECT_EQ(key, val.x * 7);
+		sum += val.x;
+	});
+	EXPECT_EQ(sum, (long)N * (N - 1) / 2);
+
+	remove(path.c_str());
+}
+
+TEST(HashSnapshotTest, string) {
+	UnorderedMap<std::string, std::string> m;
+	for (int i = 0; i != N; ++i) {
+		m[std::to_string(i)] = std::string(i % 50, 'a') + std::to_string(i);
+	}
+	m[""] = "empty";
+
+	const auto path = snapshotPath("string.snap");
+	saveHashSnapshot(m, path.c_str());
+
+	HashSnapshot<std::string, std::string> snap(path.c_str());
+	EXPECT_EQ(snap.size(), N + 1);
+
+	// the key is searched by string_view without std::string
+	std::string buf = "1234 99999";
+	string_view val;
+	ASSERT_TRUE(snap.find(string_view(buf.data(), 4), val));
+	EXPECT_EQ(std::string(val.data(), val.size()), m["1234"]);
+	EXPECT_FALSE(snap.contains(string_view(buf.data() + 5, 5)));
+
+	for (auto const& kv : m) {
+		ASSERT_TRUE(snap.find(kv.first, val));
+		EXPECT_EQ(std::string(val.data(), val.size()), kv.second);
+	}
+
+	remove(path.c_str());
+}
+
+TEST(HashSnapshotTest, empty) {
+	UnorderedMap<int, int> m;
+
+	const auto path = snapshotPath("empty.snap");
+	saveHashSnapshot(m, path.c_str());
+
+	HashSnapshot<int, int> snap(path.c_str());
+	EXPECT_TRUE(snap.empty());
+	EXPECT_FALSE(snap.contains(0));
+
+	remove(path.c_str());
+}
+
+TEST(HashSnapshotTest, invalid) {
+	UnorderedMap<int, int> m;
+	for (int i = 0; i != N; ++i) {
+		m[i] = i;
+	}
+
+	const auto path = snapshotPath("invalid.snap");
+	saveHashSnapshot(m, path.c_str());
+
+	// entry type mismatch
+	using Snapshot = HashSnapshot<int, long>;
+	EXPECT_THROW(Snapshot(path.c_str()), std::runtime_error);
+
+	// truncated
+	FILE* fp = fopen(path.c_str(), "r+");
+	ASSERT_NE(fp, nullptr);
+	ASSERT_EQ(ftruncate(fileno(fp), 1000), 0);
+	fclose(fp);
+
+	using IntSnapshot = HashSnapshot<int, int>;
+	EXPECT_THROW(IntSnapshot(path.c_str()), std::runtime_error);
+
+	// not a snapshot
+	fp = fopen(path.c_str(), "w");
+	fputs("not a snapshot, but long enough to hold the header of snapshot", fp);
+	fclose(fp);
+	EXPECT_THROW(IntSnapshot(path.c_str()), std::runtime_error);
+
+	remove(path.c_str());
+	EXPECT_THROW(IntSnapshot(path.c_str()), std::runtime_error);
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
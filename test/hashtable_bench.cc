@@ -0,0 +1,384 @@
+#include "hash_table.h"
+#include "unordered_map.h"
+#include "functional.h"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace zstl;
+
+template<typename K>
+using HashSet
+= zstl::HashTable<
+    K, K, zstl::hash<K>, zstl::identity<K>, zstl::equal_to<K>>;
+
+#define N 10000000
+
+/**
+ * Measure the latency of each insert into a growing table,
+ * report the percentiles since the mean hides the rehash stall.
+ */
+template<typename T, typename... Args>
+void
+insert_latency_benchmark(benchmark::State& state, Args... args) {
+	using Clock = std::chrono::steady_clock;
+
+	int length = state.range(0);
+	std::vector<int64_t> latencies(length);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		T set(args...);
+		state.ResumeTiming();
+
+		for (int i = 0; i != length; ++i) {
+			auto start = Clock::now();
+			benchmark::DoNotOptimize(set.insert(i));
+			latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					Clock::now() - start).count();
+		}
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	auto percentile = [&latencies](double p) {
+		return static_cast<double>(
+				latencies[static_cast<size_t>(p * (latencies.size() - 1))]);
+	};
+
+	state.counters["p50(ns)"] = percentile(0.5);
+	state.counters["p99(ns)"] = percentile(0.99);
+	state.counters["p999(ns)"] = percentile(0.999);
+	state.counters["max(ns)"] = static_cast<double>(latencies.back());
+}
+
+// adapt HashTable to the interface of std::unordered_set
+template<typename K>
+struct MyHashSet : HashSet<K> {
+	explicit MyHashSet(RehashPolicy policy)
+		: HashSet<K>(policy)
+	{ }
+
+	zstl::pair<typename HashSet<K>::iterator, bool> insert(K const& key)
+	{ return this->insertUnique(key); }
+};
+
+static inline void
+MyHashInsertOnce(benchmark::State& state) {
+	insert_latency_benchmark<MyHashSet<int>>(state, RehashPolicy::Once);
+}
+
+static inline void
+MyHashInsertIncremental(benchmark::State& state) {
+	insert_latency_benchmark<MyHashSet<int>>(state, RehashPolicy::Incremental);
+}
+
+static inline void
+STLHashInsert(benchmark::State& state) {
+	insert_latency_benchmark<std::unordered_set<int>>(state);
+}
+
+/**
+ * Insert keys which are mostly duplicate(only 1% distinct),
+ * compare searching key first and constructing node first
+ */
+template<typename F>
+void
+duplicate_insert_benchmark(benchmark::State& state, F insert) {
+	int length = state.range(0);
+
+	std::vector<std::string> keys;
+	keys.reserve(length);
+	for (int i = 0; i != length; ++i) {
+		keys.push_back(std::string(32, 'x') + std::to_string(i % (length / 100 + 1)));
+	}
+
+	for (auto _ : state) {
+		HashSet<std::string> set;
+		for (auto const& key : keys) {
+			benchmark::DoNotOptimize(insert(set, key));
+		}
+	}
+}
+
+static inline void
+MyHashDupInsert(benchmark::State& state) {
+	duplicate_insert_benchmark(state,
+		[](HashSet<std::string>& set, std::string const& key) {
+			return set.insertUnique(key).second;
+		});
+}
+
+// the previous behavior: construct node then drop it if key is duplicate
+static inline void
+MyHashDupEmplace(benchmark::State& state) {
+	duplicate_insert_benchmark(state,
+		[](HashSet<std::string>& set, std::string const& key) {
+			return set.emplaceUnique(key).second;
+		});
+}
+
+static inline void
+STLHashDupInsert(benchmark::State& state) {
+	int length = state.range(0);
+
+	std::vector<std::string> keys;
+	keys.reserve(length);
+	for (int i = 0; i != length; ++i) {
+		keys.push_back(std::string(32, 'x') + std::to_string(i % (length / 100 + 1)));
+	}
+
+	for (auto _ : state) {
+		std::unordered_set<std::string> set;
+		for (auto const& key : keys) {
+			benchmark::DoNotOptimize(set.insert(key).second);
+		}
+	}
+}
+
+// word count: most of keys are exist
+template<typename M>
+void
+map_count_benchmark(benchmark::State& state) {
+	int length = state.range(0);
+
+	std::vector<std::string> keys;
+	keys.reserve(length);
+	for (int i = 0; i != length; ++i) {
+		keys.push_back(std::string(32, 'x') + std::to_string(i % (length / 100 + 1)));
+	}
+
+	for (auto _ : state) {
+		M map;
+		for (auto const& key : keys) {
+			++map[key];
+		}
+		benchmark::DoNotOptimize(map.size());
+	}
+}
+
+static inline void
+MyMapDupSubscript(benchmark::State& state) {
+	map_count_benchmark<UnorderedMap<std::string, int>>(state);
+}
+
+static inline void
+STLMapDupSubscript(benchmark::State& state) {
+	map_count_benchmark<std::unordered_map<std::string, int>>(state);
+}
+
+/**
+ * Search keys(half of them are missing) by group of 64,
+ * compare looping over find() and find_batch().
+ * The table of 1 << 22 elements is much larger than LLC.
+ */
+template<typename F>
+void
+lookup_benchmark(benchmark::State& state, F lookup) {
+	int length = state.range(0);
+	constexpr int GROUP = 64;
+
+	HashSet<int> set(length);
+	for (int i = 0; i != length; ++i) {
+		set.insertUnique(i);
+	}
+
+	std::mt19937 gen(length);
+	std::uniform_int_distribution<int> dist(0, 2 * length - 1);
+	std::vector<int> keys(1 << 20);
+	for (auto& key : keys) {
+		key = dist(gen);
+	}
+
+	HashSet<int>::const_iterator out[GROUP];
+	for (auto _ : state) {
+		size_t found = 0;
+		for (size_t i = 0; i < keys.size(); i += GROUP) {
+			lookup(set, &keys[i], GROUP, out);
+			for (int j = 0; j != GROUP; ++j) {
+				found += out[j] != set.end();
+			}
+		}
+		benchmark::DoNotOptimize(found);
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static inline void
+MyHashFindLoop(benchmark::State& state) {
+	lookup_benchmark(state,
+		[](HashSet<int> const& set, int const* keys, int n,
+		   HashSet<int>::const_iterator* out) {
+			for (int i = 0; i != n; ++i) {
+				out[i] = set.find(keys[i]);
+			}
+		});
+}
+
+static inline void
+MyHashFindBatch(benchmark::State& state) {
+	lookup_benchmark(state,
+		[](HashSet<int> const& set, int const* keys, int n,
+		   HashSet<int>::const_iterator* out) {
+			set.find_batch(keys, n, out);
+		});
+}
+
+/**
+ * Iterate the whole table whose load factor is range(0) percent
+ * and the number of buckets is about range(1)
+ */
+static inline void
+MyHashScan(benchmark::State& state) {
+	const long buckets = state.range(1);
+	const int length = static_cast<int>((buckets - 1) * state.range(0) / 100);
+
+	HashSet<int> set(buckets);
+	for (int i = 0; i != length; ++i) {
+		// scatter the keys over buckets
+		set.insertUnique(static_cast<int>((i * 2654435761u) & 0x7fffffff));
+	}
+
+	for (auto _ : state) {
+		long sum = 0;
+		for (auto x : set) {
+			sum += x;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * length);
+}
+
+/**
+ * Move every element of a table into another one(e.g. rebalance shards),
+ * compare copying and erasing with relinking the nodes by merge
+ */
+template<typename F>
+void
+move_benchmark(benchmark::State& state, F move) {
+	const int length = state.range(0);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		HashSet<std::string> src(length), dst(length);
+		for (int i = 0; i != length; ++i) {
+			src.insertUnique(std::string(24, 'x') + std::to_string(i));
+		}
+		state.ResumeTiming();
+
+		move(src, dst);
+		benchmark::DoNotOptimize(dst.size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * length);
+}
+
+static inline void
+MyHashMoveByCopy(benchmark::State& state) {
+	move_benchmark(state,
+		[](HashSet<std::string>& src, HashSet<std::string>& dst) {
+			for (auto iter = src.begin(); iter != src.end(); ) {
+				dst.insertUnique(*iter);
+				iter = src.erase(iter);
+			}
+		});
+}
+
+static inline void
+MyHashMoveByMerge(benchmark::State& state) {
+	move_benchmark(state,
+		[](HashSet<std::string>& src, HashSet<std::string>& dst) {
+			dst.mergeUnique(src);
+		});
+}
+
+/**
+ * Multimap with skewed keys(e.g. inverted index):
+ * key i is drawn with probability ~ 1/(i+1), then every key is visited
+ * by equal_range and count
+ */
+template<typename M>
+void
+multi_benchmark(benchmark::State& state) {
+	const int length = state.range(0);
+	const int keys = length / 16;
+
+	std::mt19937 gen(length);
+	std::vector<double> weights;
+	for (int i = 0; i != keys; ++i) {
+		weights.push_back(1.0 / (i + 1));
+	}
+	std::discrete_distribution<int> dist(weights.begin(), weights.end());
+	std::vector<int> data;
+	for (int i = 0; i != length; ++i) {
+		data.push_back(dist(gen));
+	}
+
+	for (auto _ : state) {
+		M m;
+		for (int i = 0; i != length; ++i) {
+			m.insert(typename M::value_type(data[i], i));
+		}
+
+		size_t sum = 0;
+		for (int k = 0; k != keys; ++k) {
+			auto range = m.equal_range(k);
+			for (; range.first != range.second; ++range.first) {
+				sum += range.first->second;
+			}
+			sum += m.count(k);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * length);
+}
+
+static inline void
+MyMultiMapSkewed(benchmark::State& state) {
+	multi_benchmark<UnorderedMultiMap<int, int>>(state);
+}
+
+static inline void
+STLMultiMapSkewed(benchmark::State& state) {
+	multi_benchmark<std::unordered_multimap<int, int>>(state);
+}
+
+BENCHMARK(MyHashScan)->ArgsProduct({{1, 5, 25, 100}, {1 << 16, 1 << 22}})
+	->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(MyMultiMapSkewed)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+	->Unit(benchmark::kMicrosecond);
+BENCHMARK(STLMultiMapSkewed)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+	->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(MyHashMoveByCopy)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+	->Unit(benchmark::kMicrosecond);
+BENCHMARK(MyHashMoveByMerge)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+	->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(MyHashFindLoop)->RangeMultiplier(16)->Range(1 << 14, 1 << 22);
+BENCHMARK(MyHashFindBatch)->RangeMultiplier(16)->Range(1 << 14, 1 << 22);
+
+BENCHMARK(MyHashDupInsert)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(MyHashDupEmplace)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(STLHashDupInsert)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(MyMapDupSubscript)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(STLMapDupSubscript)->RangeMultiplier(10)->Range(1000, 1000000);
+
+BENCHMARK(MyHashInsertOnce)->RangeMultiplier(10)->Range(100000, N)
+	->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(MyHashInsertIncremental)->RangeMultiplier(10)->Range(100000, N)
+	->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(STLHashInsert)->RangeMultiplier(10)->Range(100000, N)
+	->Iterations(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -29,6 +29,271 @@ TEST(MyHashTest, insertUnique) {
     //EXPECT_EQ(hashSet.size(), N);
 }
 
+TEST(MyHashTest, find) {
+    HashSet<int> hashSet;
+    EXPECT_EQ(hashSet.find(0), hashSet.end());
+
+    for (int i = 0; i != N; ++i)
+        EXPECT_TRUE(hashSet.insertUnique(i).second);
+
+    EXPECT_EQ(hashSet.size(), N);
+    EXPECT_FALSE(hashSet.insertUnique(0).second);
+
+    for (int i = 0; i != N; ++i) {
+        auto iter = hashSet.find(i);
+        ASSERT_NE(iter, hashSet.end());
+        EXPECT_EQ(*iter, i);
+    }
+
+    EXPECT_EQ(hashSet.find(N), hashSet.end());
+}
+
+TEST(MyHashTest, incrementalRehash) {
+    HashSet<int> hashSet(zstl::RehashPolicy::Incremental);
+    bool rehashed = false;
+
+    for (int i = 0; i != N; ++i) {
+        EXPECT_TRUE(hashSet.insertUnique(i).second);
+        EXPECT_FALSE(hashSet.insertUnique(i).second);
+
+        if (hashSet.isRehashing()) {
+            rehashed = true;
+
+            // lookups must consult both old and new table
+            for (int j = 0; j <= i; ++j) {
+                auto iter = hashSet.find(j);
+                ASSERT_NE(iter, hashSet.end());
+                EXPECT_EQ(*iter, j);
+            }
+
+            // iteration must visit both old and new table
+            int cnt = 0;
+            for (auto& x : hashSet) {
+                (void)x;
+                ++cnt;
+            }
+            EXPECT_EQ(cnt, i + 1);
+        }
+    }
+
+    EXPECT_TRUE(rehashed);
+    EXPECT_EQ(hashSet.size(), N);
+
+    std::unordered_set<int> visited;
+    for (auto x : hashSet)
+        visited.insert(x);
+    EXPECT_EQ(visited.size(), N);
+
+    hashSet.clear();
+    EXPECT_TRUE(hashSet.empty());
+    EXPECT_FALSE(hashSet.isRehashing());
+    EXPECT_EQ(hashSet.begin(), hashSet.end());
+}
+
+TEST(MyHashTest, insertEqual) {
+    for (auto policy : { zstl::RehashPolicy::Once, zstl::RehashPolicy::Incremental }) {
+        HashSet<int> hashSet(policy);
+
+        // key i appears i % 7 times, inserted in interleaved order
+        for (int round = 0; round != 7; ++round) {
+            for (int i = 0; i != N; ++i) {
+                if (round < i % 7) {
+                    EXPECT_EQ(*hashSet.insertEqual(i), i);
+                }
+            }
+        }
+
+        // the elements with same key are adjacent when iterating
+        std::unordered_set<int> seen;
+        int prev = -1;
+        size_t total = 0;
+        for (auto x : hashSet) {
+            if (x != prev) {
+                EXPECT_TRUE(seen.insert(x).second) << x << " is not grouped";
+                prev = x;
+            }
+            ++total;
+        }
+        EXPECT_EQ(total, hashSet.size());
+
+        for (int i = 0; i != N; ++i) {
+            EXPECT_EQ(hashSet.count(i), i % 7);
+
+            auto range = hashSet.equal_range(i);
+            int len = 0;
+            for (; range.first != range.second; ++range.first, ++len) {
+                EXPECT_EQ(*range.first, i);
+            }
+            EXPECT_EQ(len, i % 7);
+        }
+
+        for (int i = 0; i < N; i += 2) {
+            EXPECT_EQ(hashSet.erase(i), i % 7);
+            EXPECT_EQ(hashSet.count(i), 0);
+        }
+
+        // copy keeps the groups
+        auto copy = hashSet;
+        for (int i = 1; i < N; i += 2) {
+            EXPECT_EQ(copy.count(i), i % 7);
+        }
+
+        // the key refers to an element to be erased
+        for (int i = 1; i < N; i += 2) {
+            if (i % 7 != 0) {
+                EXPECT_EQ(copy.erase(*copy.find(i)), i % 7);
+            }
+        }
+        EXPECT_TRUE(copy.empty());
+    }
+}
+
+TEST(MyHashTest, findBatch) {
+    HashSet<int> hashSet(zstl::RehashPolicy::Incremental);
+    HashSet<int>::iterator out[2 * N];
+    int keys[2 * N];
+
+    // empty table
+    keys[0] = 1;
+    hashSet.find_batch(keys, 1, out);
+    EXPECT_EQ(out[0], hashSet.end());
+
+    // hit and miss are interleaved,
+    // and the length is not multiple of BATCH_SIZE
+    for (int i = 0; i != 2 * N; ++i)
+        keys[i] = (i % 2 == 0) ? i / 2 : -i;
+
+    bool rehashing = false;
+    for (int i = 0; i != N; ++i) {
+        hashSet.insertUnique(i);
+        rehashing |= hashSet.isRehashing();
+
+        if (i % 97 == 0 || (hashSet.isRehashing() && i % 7 == 0)) {
+            const int n = 2 * N - 1;
+            hashSet.find_batch(keys, n, out);
+            for (int j = 0; j != n; ++j) {
+                EXPECT_EQ(out[j], hashSet.find(keys[j]));
+            }
+        }
+    }
+
+    EXPECT_TRUE(rehashing);
+
+    HashSet<int> const& cset = hashSet;
+    HashSet<int>::const_iterator couts[N];
+    cset.find_batch(keys, N, couts);
+    for (int j = 0; j != N; ++j) {
+        ASSERT_EQ(couts[j] != cset.end(), j % 2 == 0);
+        if (j % 2 == 0) {
+            EXPECT_EQ(*couts[j], j / 2);
+        }
+    }
+}
+
+TEST(MyHashTest, sparseIterate) {
+    // most of buckets are empty
+    HashSet<int> hashSet(100000);
+    EXPECT_EQ(hashSet.begin(), hashSet.end());
+
+    for (int i = 0; i != 200; ++i)
+        hashSet.insertUnique(i * 997);
+
+    auto countAll = [&hashSet]() {
+        int cnt = 0;
+        for (auto x : hashSet) {
+            EXPECT_EQ(x % 997, 0);
+            ++cnt;
+        }
+        return cnt;
+    };
+
+    EXPECT_EQ(countAll(), 200);
+
+    // the bucket becomes empty when its last node is erased
+    for (int i = 0; i != 200; i += 4)
+        EXPECT_EQ(hashSet.erase(i * 997), 1);
+    EXPECT_EQ(countAll(), 150);
+
+    int erased = 0;
+    for (auto iter = hashSet.begin(); iter != hashSet.end(); ) {
+        if ((*iter / 997) % 2 == 1) {
+            iter = hashSet.erase(iter);
+            ++erased;
+        } else {
+            ++iter;
+        }
+    }
+    EXPECT_EQ(erased, 100);
+    EXPECT_EQ(countAll(), 50);
+
+    hashSet.clear();
+    EXPECT_EQ(hashSet.begin(), hashSet.end());
+
+    hashSet.insertUnique(997);
+    EXPECT_EQ(countAll(), 1);
+    EXPECT_EQ(*hashSet.begin(), 997);
+}
+
+// all keys are in one chain
+struct BadHash {
+    size_t operator()(int) const { return 42; }
+};
+
+TEST(MyHashTest, stats) {
+    HashSet<int> hashSet(zstl::RehashPolicy::Incremental);
+    auto st = hashSet.stats();
+    EXPECT_EQ(st.elementCount, 0);
+    EXPECT_EQ(st.maxChain, 0);
+    EXPECT_EQ(st.counters.rehashCount, 0);
+
+    bool checked = false;
+    for (int i = 0; i != N; ++i) {
+        hashSet.insertUnique(i);
+
+        // the unmigrated buckets are counted
+        if (hashSet.isRehashing() && !checked) {
+            EXPECT_EQ(hashSet.stats().elementCount, hashSet.size());
+            checked = true;
+        }
+    }
+    EXPECT_TRUE(checked);
+
+    st = hashSet.stats();
+    size_t buckets = 0;
+    for (auto n : st.chainHistogram)
+        buckets += n;
+
+    EXPECT_EQ(st.elementCount, N);
+    EXPECT_EQ(buckets, st.bucketCount);
+    EXPECT_EQ(st.chainHistogram[0], st.emptyBuckets);
+    EXPECT_DOUBLE_EQ(st.avgUnsuccessfulProbe, st.loadFactor());
+    EXPECT_GE(st.avgSuccessfulProbe, 1.0);
+    EXPECT_GT(st.counters.rehashCount, 0);
+    EXPECT_GT(st.counters.bucketsMigrated, 0);
+    EXPECT_GT(st.counters.rehashNanos, 0);
+
+    while (hashSet.isRehashing())
+        hashSet.rehashStep();
+
+    size_t len = 0;
+    for (size_t i = 0; i != hashSet.tableSize(); ++i)
+        len += hashSet.table_count(i);
+    EXPECT_EQ(len, N);
+
+    hashSet.resetCounters();
+    EXPECT_EQ(hashSet.counters().rehashCount, 0);
+
+    zstl::HashTable<int, int, BadHash, zstl::identity<int>, zstl::equal_to<int>> bad;
+    for (int i = 0; i != 100; ++i)
+        bad.insertUnique(i);
+
+    st = bad.stats();
+    EXPECT_EQ(st.maxChain, 100);
+    EXPECT_EQ(st.chainHistogram[zstl::HashTableStats::HISTOGRAM_SIZE - 1], 1);
+    EXPECT_DOUBLE_EQ(st.avgSuccessfulProbe, 50.5);
+    EXPECT_EQ(bad.table_count(bad.table_num(0)), 100);
+}
+
 TEST(STLHashTest, insert) {
     std::unordered_set<std::string> hashSet;
     for (int i = 0; i != N; ++i)
@@ -0,0 +1,107 @@
+#include "interval_tree.h"
+#include "stl_algorithm.h"
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace zstl;
+
+// intervals in [0, 100 * n) whose length is in [0, 1000)
+static Vector<Interval<int>> randomIntervals(int n) {
+	std::mt19937 gen(n);
+	std::uniform_int_distribution<int> pos(0, 100 * n);
+	std::uniform_int_distribution<int> len(0, 999);
+	Vector<Interval<int>> res;
+	res.reserve(n);
+	for (int i = 0; i != n; ++i) {
+		const int lo = pos(gen);
+		res.push_back({ lo, lo + len(gen) });
+	}
+	return res;
+}
+
+// the baseline: sorted by lo, scan the ones whose lo <= hi and filter by their hi
+class SortedIntervals {
+public:
+	explicit SortedIntervals(Vector<Interval<int>> intervals)
+		: rep_(STL_MOVE(intervals))
+	{
+		zstl::sort(rep_.begin(), rep_.end(), [](Interval<int> const& x, Interval<int> const& y) {
+			return x.lo < y.lo;
+		});
+	}
+
+	template<typename F>
+	void find_overlapping(int lo, int hi, F f) const {
+		for (auto const& x : rep_) {
+			if (x.lo > hi)
+				break;
+			if (x.hi >= lo)
+				f(x);
+		}
+	}
+
+private:
+	Vector<Interval<int>> rep_;
+};
+
+// the queries are points(stabbing) if width is 0
+static Vector<Interval<int>> randomQueries(int n, int width) {
+	std::mt19937 gen(n + 1);
+	std::uniform_int_distribution<int> pos(0, 100 * n);
+	Vector<Interval<int>> res;
+	for (int i = 0; i != 1024; ++i) {
+		const int lo = pos(gen);
+		res.push_back({ lo, lo + width });
+	}
+	return res;
+}
+
+static void
+IntervalTreeQuery(benchmark::State& state) {
+	const int n = state.range(0);
+	IntervalTree<int, int> tree;
+	for (auto const& x : randomIntervals(n)) {
+		tree.emplace(x.lo, x.hi, 0);
+	}
+	const auto queries = randomQueries(n, state.range(1));
+
+	size_t i = 0;
+	for (auto _ : state) {
+		auto const& q = queries[i++ % queries.size()];
+		int found = 0;
+		for (auto const& x : tree.find_overlapping(q.lo, q.hi)) {
+			benchmark::DoNotOptimize(x);
+			++found;
+		}
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+static void
+SortedVectorQuery(benchmark::State& state) {
+	const int n = state.range(0);
+	SortedIntervals intervals(randomIntervals(n));
+	const auto queries = randomQueries(n, state.range(1));
+
+	size_t i = 0;
+	for (auto _ : state) {
+		auto const& q = queries[i++ % queries.size()];
+		int found = 0;
+		intervals.find_overlapping(q.lo, q.hi, [&found](Interval<int> const& x) {
+			benchmark::DoNotOptimize(x);
+			++found;
+		});
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+// stabbing and range queries
+#define QUERY_ARGS \
+	ArgsProduct({ { 1000, 100000, 1000000 }, { 0, 10000 } })
+
+BENCHMARK(IntervalTreeQuery)->QUERY_ARGS;
+BENCHMARK(SortedVectorQuery)->QUERY_ARGS;
+
+BENCHMARK_MAIN();
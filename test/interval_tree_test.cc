@@ -0,0 +1,127 @@
+#include "interval_tree.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+using namespace zstl;
+
+#define N 2000
+
+using Tree = IntervalTree<int, int>;
+
+// the values of intervals overlapping [lo, hi] by linear scan, in order of tree
+static Vector<int> bruteForce(Tree const& tree, int lo, int hi) {
+	Vector<int> res;
+	for (auto const& x : tree) {
+		if (x.first.lo <= hi && lo <= x.first.hi)
+			res.push_back(x.second);
+	}
+	return res;
+}
+
+static Vector<int> query(Tree const& tree, int lo, int hi) {
+	Vector<int> res;
+	for (auto const& x : tree.find_overlapping(lo, hi)) {
+		res.push_back(x.second);
+	}
+	return res;
+}
+
+TEST(IntervalTree, basic) {
+	IntervalTree<int, std::string> tree;
+	EXPECT_TRUE(tree.empty());
+	EXPECT_TRUE(tree.find_overlapping(0, 100).empty());
+	EXPECT_FALSE(tree.contains(0));
+
+	tree.emplace(10, 20, "a");
+	tree.emplace(15, 15, "b");
+	tree.emplace(30, 40, "c");
+	tree.emplace(10, 20, "d");
+	EXPECT_EQ(tree.size(), 4);
+	EXPECT_EQ(tree.count({ 10, 20 }), 2);
+
+	// stabbing
+	std::string res;
+	for (auto const& x : tree.find_overlapping(15)) {
+		res += x.second;
+	}
+	EXPECT_EQ(res, "adb");
+	EXPECT_TRUE(tree.find_overlapping(25).empty());
+	EXPECT_TRUE(tree.contains(40));
+	EXPECT_FALSE(tree.contains(41));
+
+	// endpoints are included
+	EXPECT_TRUE(tree.overlaps(20, 30));
+	EXPECT_FALSE(tree.overlaps(21, 29));
+
+	EXPECT_EQ(tree.erase({ 10, 20 }), 2);
+	EXPECT_EQ(tree.size(), 2);
+	EXPECT_TRUE(tree.find_overlapping(12).empty());
+	EXPECT_EQ(tree.find_overlapping(15).begin()->second, "b");
+}
+
+TEST(IntervalTree, random) {
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> pos(0, 10 * N);
+	std::uniform_int_distribution<int> len(0, 100);
+	Tree tree;
+
+	for (int i = 0; i != N; ++i) {
+		const int lo = pos(gen);
+		tree.emplace(lo, lo + len(gen), i);
+	}
+
+	// erase half of them to exercise the erase fixup
+	for (int i = 0; i != N / 2; ++i) {
+		const int lo = pos(gen);
+		auto range = tree.find_overlapping(lo);
+		if (!range.empty())
+			tree.erase(range.begin().base());
+	}
+
+	auto check = [&gen, &pos, &len](Tree const& t) {
+		for (int i = 0; i != N; ++i) {
+			const int lo = pos(gen);
+			const int hi = lo + len(gen) * (i % 3);
+			EXPECT_EQ(query(t, lo, hi), bruteForce(t, lo, hi));
+			EXPECT_EQ(t.overlaps(lo, hi), !bruteForce(t, lo, hi).empty());
+		}
+	};
+
+	check(tree);
+	// the augment of copy is rebuilt
+	Tree copy(tree);
+	ASSERT_EQ(copy.size(), tree.size());
+	auto iter = tree.begin();
+	for (auto const& x : copy) {
+		EXPECT_EQ(x.first, iter->first);
+		EXPECT_EQ(x.second, iter->second);
+		++iter;
+	}
+	check(copy);
+}
+
+TEST(IntervalTree, eraseDuringIteration) {
+	Tree tree;
+	for (int i = 0; i != N; ++i) {
+		tree.emplace(i, i + 10, i);
+	}
+
+	// erase the intervals containing 500
+	auto range = tree.find_overlapping(500);
+	for (auto iter = range.begin(); iter != range.end(); ) {
+		tree.erase((iter++).base());
+	}
+	EXPECT_EQ(tree.size(), N - 11);
+	EXPECT_FALSE(tree.contains(500));
+	EXPECT_TRUE(tree.contains(489));
+	EXPECT_TRUE(tree.contains(501));
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
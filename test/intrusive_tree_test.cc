@@ -0,0 +1,155 @@
+#include "intrusive_tree.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace zstl;
+
+struct Order {
+	int id;
+	int price;
+	RBTreeBaseNode by_id;
+	RBTreeBaseNode by_price;
+};
+
+struct OrderId {
+	int operator()(Order const& x) const noexcept
+	{ return x.id; }
+};
+
+struct OrderPrice {
+	int const& operator()(Order const& x) const noexcept
+	{ return x.price; }
+};
+
+using IdIndex = IntrusiveTree<Order, &Order::by_id, int, OrderId>;
+using PriceIndex = IntrusiveTree<Order, &Order::by_price, int, OrderPrice>;
+
+TEST(IntrusiveTreeTest, unique) {
+	std::vector<Order> orders(100);
+	for (int i = 0; i != 100; ++i) {
+		orders[i].id = (i * 37) % 100;
+	}
+
+	IdIndex index;
+	for (auto& x : orders) {
+		auto res = index.insert_unique(x);
+		EXPECT_TRUE(res.second);
+		EXPECT_EQ(&*res.first, &x);
+	}
+	EXPECT_EQ(index.size(), 100);
+
+	Order dup;
+	dup.id = 42;
+	auto res = index.insert_unique(dup);
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->id, 42);
+	EXPECT_NE(&*res.first, &dup);
+
+	int expect = 0;
+	for (auto& x : index) {
+		EXPECT_EQ(x.id, expect++);
+	}
+	EXPECT_EQ(index.rbegin()->id, 99);
+
+	EXPECT_TRUE(index.contains(10));
+	EXPECT_FALSE(index.contains(100));
+	EXPECT_EQ(index.find(7)->id, 7);
+	EXPECT_EQ(index.count(7), 1);
+	EXPECT_EQ(index.lower_bound(100), index.end());
+	EXPECT_EQ(index.upper_bound(98)->id, 99);
+}
+
+TEST(IntrusiveTreeTest, multiIndex) {
+	std::vector<Order> orders(1000);
+	IdIndex ids;
+	PriceIndex prices;
+	std::multiset<int> expect_prices;
+
+	srand(42);
+	for (int i = 0; i != 1000; ++i) {
+		orders[i].id = i;
+		orders[i].price = rand() % 100;
+		ids.insert_unique(orders[i]);
+		prices.insert_equal(orders[i]);
+		expect_prices.insert(orders[i].price);
+	}
+
+	// erase by the object itself, no search in the other index
+	for (int i = 0; i < 1000; i += 3) {
+		auto& x = *ids.find(i);
+		prices.erase(x);
+		ids.erase(x);
+		expect_prices.erase(expect_prices.find(x.price));
+	}
+
+	EXPECT_EQ(ids.size(), expect_prices.size());
+	EXPECT_EQ(prices.size(), expect_prices.size());
+	EXPECT_TRUE(std::equal(expect_prices.begin(), expect_prices.end(), prices.begin(),
+		[](int price, Order const& x) { return price == x.price; }));
+
+	// equal objects are in insertion order
+	for (auto it = prices.begin(); it != prices.end(); ) {
+		auto next = it;
+		++next;
+		if (next != prices.end() && next->price == it->price) {
+			EXPECT_LT(it->id, next->id);
+		}
+		it = next;
+	}
+
+	EXPECT_EQ(prices.count(50), expect_prices.count(50));
+	EXPECT_EQ(prices.erase(50), expect_prices.count(50));
+	EXPECT_FALSE(prices.contains(50));
+
+	// iterator_to and erase(iterator)
+	auto& x = orders[1];
+	auto it = prices.iterator_to(x);
+	EXPECT_EQ(&*it, &x);
+	auto next = prices.erase(it);
+	EXPECT_TRUE(next == prices.end() || next->price >= x.price);
+
+	// unlinked objects can be linked again
+	ids.clear();
+	EXPECT_TRUE(ids.empty());
+	for (auto& order : orders) {
+		ids.insert_unique(order);
+	}
+	EXPECT_EQ(ids.size(), 1000);
+}
+
+TEST(IntrusiveTreeTest, moveAndDispose) {
+	IdIndex index;
+	for (int i = 0; i != 100; ++i) {
+		auto x = new Order;
+		x->id = i;
+		index.insert_unique(*x);
+	}
+
+	IdIndex other(STL_MOVE(index));
+	EXPECT_TRUE(index.empty());
+	EXPECT_EQ(index.begin(), index.end());
+	EXPECT_EQ(other.size(), 100);
+	EXPECT_EQ(other.begin()->id, 0);
+
+	index.swap(other);
+	EXPECT_EQ(index.size(), 100);
+	EXPECT_EQ((--index.end())->id, 99);
+
+	int disposed = 0;
+	index.clear_and_dispose([&disposed](Order* x) {
+		++disposed;
+		delete x;
+	});
+	EXPECT_EQ(disposed, 100);
+	EXPECT_TRUE(index.empty());
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
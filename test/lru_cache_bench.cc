@@ -0,0 +1,170 @@
+#include "lru_cache.h"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <list>
+#include <math.h>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace zstl;
+
+#define UNIVERSE (1 << 20)
+#define TRACE_LENGTH (1 << 20)
+
+/**
+ * Zipfian trace: key of rank i is requested with probability ~ 1/(i+1)^0.99,
+ * the ranks are shuffled over the key space
+ */
+static std::vector<int> const& zipfTrace() {
+	static std::vector<int> trace;
+	if (!trace.empty()) {
+		return trace;
+	}
+
+	std::vector<double> cdf(UNIVERSE);
+	double sum = 0;
+	for (int i = 0; i != UNIVERSE; ++i) {
+		sum += 1.0 / pow(i + 1, 0.99);
+		cdf[i] = sum;
+	}
+
+	std::mt19937 gen(42);
+	std::vector<int> keys(UNIVERSE);
+	for (int i = 0; i != UNIVERSE; ++i) {
+		keys[i] = i;
+	}
+	std::shuffle(keys.begin(), keys.end(), gen);
+
+	std::uniform_real_distribution<double> dist(0, sum);
+	for (int i = 0; i != TRACE_LENGTH; ++i) {
+		const auto rank = std::lower_bound(cdf.begin(), cdf.end(), dist(gen)) - cdf.begin();
+		trace.push_back(keys[rank < UNIVERSE ? rank : UNIVERSE - 1]);
+	}
+	return trace;
+}
+
+/**
+ * Replay the trace, load the value on miss.
+ * The capacity is state.range(0) per mille of the key space.
+ */
+template<typename Cache>
+void
+cache_benchmark(benchmark::State& state) {
+	auto const& trace = zipfTrace();
+	const size_t capacity = (size_t)UNIVERSE * state.range(0) / 1000;
+
+	size_t hits = 0;
+	for (auto _ : state) {
+		Cache cache(capacity);
+		for (auto key : trace) {
+			long val;
+			if (cache.get(key, val)) {
+				++hits;
+			} else {
+				cache.put(key, (long)key);
+			}
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * trace.size());
+	state.counters["hit_rate"] = (double)hits / (state.iterations() * trace.size());
+}
+
+// the usual LRU: hash map to list iterator, two allocations per element
+class StdLruCache {
+public:
+	explicit StdLruCache(size_t capacity)
+		: capacity_{ capacity }
+	{ map_.reserve(capacity + 1); }
+
+	bool get(int key, long& out) {
+		auto iter = map_.find(key);
+		if (iter == map_.end()) {
+			return false;
+		}
+		list_.splice(list_.begin(), list_, iter->second);
+		out = iter->second->second;
+		return true;
+	}
+
+	void put(int key, long val) {
+		list_.emplace_front(key, val);
+		map_[key] = list_.begin();
+		if (map_.size() > capacity_) {
+			map_.erase(list_.back().first);
+			list_.pop_back();
+		}
+	}
+
+private:
+	size_t capacity_;
+	std::list<std::pair<int, long>> list_;
+	std::unordered_map<int, std::list<std::pair<int, long>>::iterator> map_;
+};
+
+static inline void
+MyLruCache(benchmark::State& state) {
+	cache_benchmark<LruCache<int, long>>(state);
+}
+
+static inline void
+MyClockCache(benchmark::State& state) {
+	cache_benchmark<ClockCache<int, long>>(state);
+}
+
+static inline void
+STLLruCache(benchmark::State& state) {
+	cache_benchmark<StdLruCache>(state);
+}
+
+/**
+ * The threads replay disjoint slices of the trace on a shared cache
+ */
+template<typename Cache>
+void
+sharded_benchmark(benchmark::State& state) {
+	static ShardedCache<Cache>* cache;
+	auto const& trace = zipfTrace();
+
+	if (state.thread_index() == 0) {
+		cache = new ShardedCache<Cache>(UNIVERSE / 10);
+	}
+
+	const size_t slice = trace.size() / state.threads();
+	const size_t first = slice * state.thread_index();
+	for (auto _ : state) {
+		for (size_t i = first; i != first + slice; ++i) {
+			long val;
+			if (!cache->get(trace[i], val)) {
+				cache->put(trace[i], (long)trace[i]);
+			}
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * slice);
+	if (state.thread_index() == 0) {
+		state.counters["hit_rate"] = cache->stats().hitRate();
+		delete cache;
+	}
+}
+
+static inline void
+ShardedLruCache(benchmark::State& state) {
+	sharded_benchmark<LruCache<int, long>>(state);
+}
+
+static inline void
+ShardedClockCache(benchmark::State& state) {
+	sharded_benchmark<ClockCache<int, long>>(state);
+}
+
+BENCHMARK(MyLruCache)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(MyClockCache)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(STLLruCache)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(ShardedLruCache)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(ShardedClockCache)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,167 @@
+#include "lru_cache.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace zstl;
+
+#define N 10000
+
+TEST(LruCacheTest, evict) {
+	std::vector<int> evicted;
+	LruCache<int, std::string> cache(3, [&evicted](int const& key, std::string& val) {
+		EXPECT_EQ(val, std::to_string(key));
+		evicted.push_back(key);
+	});
+
+	for (int i = 0; i != 3; ++i) {
+		EXPECT_TRUE(cache.put(i, std::to_string(i)));
+	}
+
+	// 0 becomes the most recently used, 1 is the victim
+	ASSERT_NE(cache.get(0), nullptr);
+	EXPECT_EQ(*cache.get(0), "0");
+	EXPECT_TRUE(cache.put(3, "3"));
+	EXPECT_EQ(evicted, std::vector<int>{ 1 });
+	EXPECT_FALSE(cache.contains(1));
+
+	// assignment also refreshes the key
+	EXPECT_FALSE(cache.put(2, "2"));
+	EXPECT_TRUE(cache.put(4, "4"));
+	EXPECT_EQ(evicted, (std::vector<int>{ 1, 0 }));
+
+	// peek doesn't refresh
+	EXPECT_NE(cache.peek(3), nullptr);
+	EXPECT_TRUE(cache.put(5, "5"));
+	EXPECT_EQ(evicted, (std::vector<int>{ 1, 0, 3 }));
+
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_EQ(cache.stats().evictions, 3);
+	EXPECT_EQ(cache.stats().hits, 2);
+
+	std::string val;
+	EXPECT_FALSE(cache.get(1, val));
+	EXPECT_TRUE(cache.get(5, val));
+	EXPECT_EQ(val, "5");
+	EXPECT_EQ(cache.stats().misses, 1);
+
+	// erase and clear don't call the callback
+	EXPECT_TRUE(cache.erase(5));
+	EXPECT_FALSE(cache.erase(5));
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+	EXPECT_EQ(evicted.size(), 3);
+
+	using Cache = LruCache<int, int>;
+	EXPECT_THROW(Cache(0), std::length_error);
+}
+
+TEST(LruCacheTest, setCapacity) {
+	LruCache<int, int> cache(N);
+	for (int i = 0; i != N; ++i) {
+		cache.put(i, i);
+	}
+	EXPECT_EQ(cache.size(), N);
+
+	// the most recently used ones are kept
+	cache.setCapacity(N / 10);
+	EXPECT_EQ(cache.size(), N / 10);
+	for (int i = 0; i != N; ++i) {
+		EXPECT_EQ(cache.contains(i), i >= N - N / 10) << i;
+	}
+
+	cache.setCapacity(N);
+	for (int i = 0; i != N; ++i) {
+		cache.put(i, i);
+	}
+	EXPECT_EQ(cache.size(), N);
+}
+
+TEST(LruCacheTest, throwingCallback) {
+	LruCache<int, int> cache(2, [](int const& key, int&) {
+		if (key == 0) {
+			throw std::runtime_error("evict");
+		}
+	});
+
+	cache.put(0, 0);
+	cache.put(1, 1);
+	EXPECT_THROW(cache.put(2, 2), std::runtime_error);
+
+	// the victim is removed even if the callback throws
+	EXPECT_FALSE(cache.contains(0));
+	EXPECT_EQ(cache.size(), 2);
+	EXPECT_TRUE(cache.erase(1));
+	EXPECT_TRUE(cache.put(3, 3));
+	EXPECT_TRUE(cache.put(4, 4));
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(ClockCacheTest, secondChance) {
+	std::vector<int> evicted;
+	ClockCache<int, int> cache(4, [&evicted](int const& key, int&) {
+		evicted.push_back(key);
+	});
+
+	for (int i = 0; i != 4; ++i) {
+		cache.put(i, i);
+	}
+
+	// all are referenced since inserted, the sweep clears them and evicts the first one
+	cache.put(4, 4);
+	EXPECT_EQ(evicted, std::vector<int>{ 0 });
+
+	// 1 gets a second chance
+	EXPECT_NE(cache.get(1), nullptr);
+	cache.put(5, 5);
+	EXPECT_EQ(evicted, (std::vector<int>{ 0, 2 }));
+
+	cache.put(6, 6);
+	EXPECT_EQ(evicted, (std::vector<int>{ 0, 2, 3 }));
+	EXPECT_TRUE(cache.contains(1));
+
+	// erase the key under hand
+	EXPECT_TRUE(cache.erase(1));
+	for (int i = 7; i != N; ++i) {
+		cache.put(i, i);
+		EXPECT_LE(cache.size(), 4);
+	}
+	for (int i = N - 4; i != N; ++i) {
+		EXPECT_TRUE(cache.contains(i)) << i;
+	}
+}
+
+TEST(ShardedCacheTest, concurrent) {
+	ShardedCache<LruCache<int, int>> cache(N);
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t != 4; ++t) {
+		threads.emplace_back([&cache, t] {
+			for (int i = 0; i != 4 * N; ++i) {
+				const int key = (i * 7 + t) % (2 * N);
+				int val = -1;
+				if (cache.get(key, val)) {
+					EXPECT_EQ(val, key * 2);
+				} else {
+					cache.put(key, key * 2);
+				}
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	EXPECT_LE(cache.size(), N);
+	auto stats = cache.stats();
+	EXPECT_EQ(stats.hits + stats.misses, 16 * N);
+	EXPECT_GT(stats.hits, 0);
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+#include "map.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+
+#define N 10000
+
+using namespace zstl;
+
+// count the constructions to verify allocation-free duplicate detection
+struct Counted {
+	static int constructed;
+
+	Counted(int v = 0)
+		: val(v)
+	{ ++constructed; }
+
+	Counted(Counted const& rhs)
+		: val(rhs.val)
+	{ ++constructed; }
+
+	Counted(Counted&& rhs) noexcept
+		: val(rhs.val)
+	{ }
+
+	Counted& operator=(Counted const&) = default;
+	Counted& operator=(Counted&&) = default;
+
+	int val;
+};
+
+int Counted::constructed = 0;
+
+TEST(MyMap, tryEmplace) {
+	Map<int, Counted> m;
+
+	auto res = m.try_emplace(1, 10);
+	EXPECT_TRUE(res.second);
+	EXPECT_EQ(res.first->second.val, 10);
+
+	Counted::constructed = 0;
+	res = m.try_emplace(1, 20);
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->second.val, 10);
+	EXPECT_EQ(Counted::constructed, 0);
+
+	// operator[] doesn't construct value for existing key
+	EXPECT_EQ(m[1].val, 10);
+	EXPECT_EQ(Counted::constructed, 0);
+	EXPECT_EQ(m[2].val, 0);
+	EXPECT_EQ(m.size(), 2);
+
+	res = m.insert_or_assign(2, Counted(30));
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(m.at(2).val, 30);
+
+	res = m.insert_or_assign(3, Counted(40));
+	EXPECT_TRUE(res.second);
+	EXPECT_EQ(m.at(3).val, 40);
+	EXPECT_THROW(m.at(4), std::range_error);
+
+	EXPECT_EQ(m.count(3), 1);
+	EXPECT_EQ(m.erase(3), 1);
+	EXPECT_EQ(m.erase(3), 0);
+	EXPECT_FALSE(m.contains(3));
+}
+
+TEST(MyMap, random) {
+	Map<int, int> m;
+	std::map<int, int> stl;
+	std::mt19937 gen(N);
+
+	for (int i = 0; i != 4 * N; ++i) {
+		const int key = gen() % N;
+		switch (gen() % 4) {
+		case 0:
+			m[key] += i;
+			stl[key] += i;
+			break;
+		case 1:
+			EXPECT_EQ(m.try_emplace(key, i).second, stl.emplace(key, i).second);
+			break;
+		case 2:
+			m.insert_or_assign(key, i);
+			stl[key] = i;
+			break;
+		case 3:
+			EXPECT_EQ(m.erase(key), stl.erase(key));
+			break;
+		}
+	}
+
+	ASSERT_EQ(m.size(), stl.size());
+	auto iter = m.begin();
+	for (auto const& kv : stl) {
+		EXPECT_EQ(iter->first, kv.first);
+		EXPECT_EQ(iter->second, kv.second);
+		++iter;
+	}
+	EXPECT_EQ(iter, m.end());
+
+	for (int key = -1; key <= N; ++key) {
+		auto lb = m.lower_bound(key);
+		auto stl_lb = stl.lower_bound(key);
+		ASSERT_EQ(lb == m.end(), stl_lb == stl.end());
+		if (lb != m.end()) {
+			EXPECT_EQ(lb->first, stl_lb->first);
+		}
+
+		auto ub = m.upper_bound(key);
+		auto stl_ub = stl.upper_bound(key);
+		ASSERT_EQ(ub == m.end(), stl_ub == stl.end());
+		if (ub != m.end()) {
+			EXPECT_EQ(ub->first, stl_ub->first);
+		}
+	}
+}
+
+TEST(MyMap, hint) {
+	Map<std::string, int> m;
+
+	// sorted input inserted at end() is amortized O(1)
+	for (int i = 0; i != N; ++i) {
+		char buf[16];
+		snprintf(buf, sizeof buf, "%08d", i);
+		EXPECT_TRUE(m.try_emplace(m.end(), buf, i).second);
+	}
+
+	// hint before the position
+	auto res = m.try_emplace(m.begin(), "00000000", -1);
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->second, 0);
+
+	res = m.insert_or_assign(m.find("00000100"), "00000100", -1);
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(m["00000100"], -1);
+
+	res = m.try_emplace(m.find("00000100"), "00000100x", 1);
+	EXPECT_TRUE(res.second);
+	EXPECT_EQ((++m.find("00000100"))->first, "00000100x");
+	EXPECT_EQ(m.size(), N + 1);
+
+	// the temporary key is moved into the node
+	std::string key(32, 'z');
+	res = m.insert_or_assign(m.end(), std::move(key), 1);
+	EXPECT_TRUE(res.second);
+	EXPECT_TRUE(key.empty());
+	EXPECT_EQ(m.rbegin()->first, std::string(32, 'z'));
+}
+
+TEST(MyMap, copyAndMove) {
+	Map<int, std::string> m;
+	for (int i = 0; i != N; ++i) {
+		m[i] = std::to_string(i);
+	}
+
+	Map<int, std::string> copy(m);
+	Map<int, std::string> moved(std::move(m));
+	EXPECT_TRUE(m.empty());
+	EXPECT_EQ(m.begin(), m.end());
+	EXPECT_EQ(moved.size(), N);
+	EXPECT_EQ(moved[N / 2], std::to_string(N / 2));
+
+	Map<int, std::string> small;
+	small[-1] = "x";
+	small = std::move(copy);
+	EXPECT_EQ(small.size(), N);
+	EXPECT_FALSE(small.contains(-1));
+
+	swap(small, m);
+	EXPECT_TRUE(small.empty());
+	EXPECT_EQ(m.size(), N);
+	int expect = 0;
+	for (auto const& kv : m) {
+		EXPECT_EQ(kv.first, expect++);
+	}
+
+	m = small;
+	EXPECT_TRUE(m.empty());
+}
+
+TEST(MyMultiMap, insert) {
+	MultiMap<int, int> m;
+	for (int i = 0; i != N; ++i) {
+		m.insert(zstl::pair<int const, int>(i % 100, i));
+	}
+
+	EXPECT_EQ(m.size(), N);
+	EXPECT_EQ(m.count(42), N / 100);
+
+	// equal keys keep the insertion order
+	int prev = -1;
+	auto range = m.equal_range(42);
+	for (; range.first != range.second; ++range.first) {
+		EXPECT_EQ(range.first->first, 42);
+		EXPECT_GT(range.first->second, prev);
+		prev = range.first->second;
+	}
+
+	m.emplace_hint(m.end(), 1000, 1);
+	EXPECT_EQ(m.rbegin()->first, 1000);
+	EXPECT_EQ(m.erase(42), N / 100);
+	EXPECT_EQ(m.size(), N - N / 100 + 1);
+}
+
+TEST(MyMultiMap, orderStatistics) {
+	MultiMap<int, int, zstl::less<int>,
+		zstl::allocator<zstl::pair<int const, int>>, RBTreeSizeAugment> m;
+	for (int i = 0; i != N; ++i) {
+		m.emplace(i % 100, i);
+	}
+
+	EXPECT_EQ(m.rank(42), 42 * (N / 100));
+	EXPECT_EQ(m.select(m.rank(42))->first, 42);
+	EXPECT_EQ(m.select(N), m.end());
+
+	auto range = m.equal_range(42);
+	EXPECT_EQ(m.distance(range.first, range.second), N / 100);
+	EXPECT_EQ(m.index(range.second), 43 * (N / 100));
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
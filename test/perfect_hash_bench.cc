@@ -0,0 +1,167 @@
+#include "perfect_hash.h"
+#include "unordered_map.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace zstl;
+using namespace zstl::literal;
+
+constexpr auto KEYWORDS = makePerfectHashMap<string_view, int>({
+	{ "alignas"_sv, 0 }, { "alignof"_sv, 1 }, { "auto"_sv, 2 }, { "bool"_sv, 3 },
+	{ "break"_sv, 4 }, { "case"_sv, 5 }, { "catch"_sv, 6 }, { "char"_sv, 7 },
+	{ "class"_sv, 8 }, { "const"_sv, 9 }, { "constexpr"_sv, 10 }, { "continue"_sv, 11 },
+	{ "decltype"_sv, 12 }, { "default"_sv, 13 }, { "delete"_sv, 14 }, { "do"_sv, 15 },
+	{ "double"_sv, 16 }, { "else"_sv, 17 }, { "enum"_sv, 18 }, { "explicit"_sv, 19 },
+	{ "extern"_sv, 20 }, { "false"_sv, 21 }, { "float"_sv, 22 }, { "for"_sv, 23 },
+	{ "friend"_sv, 24 }, { "goto"_sv, 25 }, { "if"_sv, 26 }, { "inline"_sv, 27 },
+	{ "int"_sv, 28 }, { "long"_sv, 29 }, { "mutable"_sv, 30 }, { "namespace"_sv, 31 },
+	{ "new"_sv, 32 }, { "noexcept"_sv, 33 }, { "nullptr"_sv, 34 }, { "operator"_sv, 35 },
+	{ "private"_sv, 36 }, { "protected"_sv, 37 }, { "public"_sv, 38 }, { "return"_sv, 39 },
+	{ "short"_sv, 40 }, { "signed"_sv, 41 }, { "sizeof"_sv, 42 }, { "static"_sv, 43 },
+	{ "struct"_sv, 44 }, { "switch"_sv, 45 }, { "template"_sv, 46 }, { "this"_sv, 47 },
+	{ "throw"_sv, 48 }, { "true"_sv, 49 }, { "try"_sv, 50 }, { "typedef"_sv, 51 },
+	{ "typename"_sv, 52 }, { "union"_sv, 53 }, { "unsigned"_sv, 54 }, { "using"_sv, 55 },
+	{ "virtual"_sv, 56 }, { "void"_sv, 57 }, { "volatile"_sv, 58 }, { "while"_sv, 59 },
+});
+
+static char const* const KEYWORD_NAMES[] = {
+	"alignas", "alignof", "auto", "bool", "break", "case", "catch", "char",
+	"class", "const", "constexpr", "continue", "decltype", "default", "delete", "do",
+	"double", "else", "enum", "explicit", "extern", "false", "float", "for",
+	"friend", "goto", "if", "inline", "int", "long", "mutable", "namespace",
+	"new", "noexcept", "nullptr", "operator", "private", "protected", "public", "return",
+	"short", "signed", "sizeof", "static", "struct", "switch", "template", "this",
+	"throw", "true", "try", "typedef", "typename", "union", "unsigned", "using",
+	"virtual", "void", "volatile", "while",
+};
+
+// sparse opcodes
+constexpr auto OPCODES = makePerfectHashSet(mpl::Valuelist<int,
+	0x01, 0x07, 0x13, 0x1f, 0x22, 0x2d, 0x3a, 0x41, 0x4c, 0x58, 0x63, 0x6e,
+	0x7b, 0x85, 0x90, 0x9c, 0xa7, 0xb1, 0xbe, 0xc9, 0xd4, 0xe0, 0xeb, 0xf6>{});
+
+static int opcodeSwitch(int op) {
+	switch (op) {
+	case 0x01: return 0; case 0x07: return 1; case 0x13: return 2; case 0x1f: return 3;
+	case 0x22: return 4; case 0x2d: return 5; case 0x3a: return 6; case 0x41: return 7;
+	case 0x4c: return 8; case 0x58: return 9; case 0x63: return 10; case 0x6e: return 11;
+	case 0x7b: return 12; case 0x85: return 13; case 0x90: return 14; case 0x9c: return 15;
+	case 0xa7: return 16; case 0xb1: return 17; case 0xbe: return 18; case 0xc9: return 19;
+	case 0xd4: return 20; case 0xe0: return 21; case 0xeb: return 22; case 0xf6: return 23;
+	default: return -1;
+	}
+}
+
+/**
+ * Classify tokens of source code, about half are keywords
+ */
+template<typename F>
+void
+keyword_benchmark(benchmark::State& state, F lookup) {
+	static char const* const identifiers[] = {
+		"i", "size", "value", "iter", "std", "first", "last", "node", "x", "result",
+		"alloc", "count", "ptr", "len", "key", "data", "begin", "end", "n", "self",
+	};
+
+	std::mt19937 gen(42);
+	std::vector<std::string> tokens;
+	for (int i = 0; i != 4096; ++i) {
+		if (gen() % 2) {
+			tokens.emplace_back(identifiers[gen() % 20]);
+		} else {
+			tokens.emplace_back(KEYWORD_NAMES[gen() % KEYWORDS.size()]);
+		}
+	}
+
+	for (auto _ : state) {
+		int sum = 0;
+		for (auto const& tok : tokens) {
+			sum += lookup(string_view(tok));
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * tokens.size());
+}
+
+static inline void
+PerfectHashKeyword(benchmark::State& state) {
+	keyword_benchmark(state, [](string_view tok) {
+		return KEYWORDS.get(tok, -1);
+	});
+}
+
+static inline void
+MyHashKeyword(benchmark::State& state) {
+	UnorderedMap<std::string, int, string_hash, equal_to<>> m;
+	for (auto kw : KEYWORD_NAMES) {
+		m[kw] = KEYWORDS.get(kw, -1);
+	}
+
+	keyword_benchmark(state, [&m](string_view tok) {
+		auto iter = m.find(tok);
+		return iter != m.end() ? iter->second : -1;
+	});
+}
+
+/**
+ * Decode random bytes, about 10% are valid opcodes
+ */
+template<typename F>
+void
+opcode_benchmark(benchmark::State& state, F decode) {
+	std::mt19937 gen(42);
+	std::vector<int> code;
+	for (int i = 0; i != 4096; ++i) {
+		code.push_back(gen() % 256);
+	}
+
+	for (auto _ : state) {
+		int sum = 0;
+		for (auto op : code) {
+			sum += decode(op);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * code.size());
+}
+
+static inline void
+PerfectHashOpcode(benchmark::State& state) {
+	opcode_benchmark(state, [](int op) {
+		return static_cast<int>(OPCODES.indexOf(op));
+	});
+}
+
+static inline void
+SwitchOpcode(benchmark::State& state) {
+	opcode_benchmark(state, opcodeSwitch);
+}
+
+static inline void
+MyHashOpcode(benchmark::State& state) {
+	UnorderedMap<int, int> m;
+	for (int op = 0; op != 256; ++op) {
+		if (opcodeSwitch(op) != -1) {
+			m[op] = opcodeSwitch(op);
+		}
+	}
+
+	opcode_benchmark(state, [&m](int op) {
+		auto iter = m.find(op);
+		return iter != m.end() ? iter->second : -1;
+	});
+}
+
+BENCHMARK(PerfectHashKeyword);
+BENCHMARK(MyHashKeyword);
+
+BENCHMARK(PerfectHashOpcode);
+BENCHMARK(SwitchOpcode);
+BENCHMARK(MyHashOpcode);
+
+BENCHMARK_MAIN();
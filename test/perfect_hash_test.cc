@@ -0,0 +1,99 @@
+#include "perfect_hash.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace zstl;
+using namespace zstl::literal;
+
+enum class Opcode { Nop, Load, Store, Add, Jump, Halt };
+
+// the tables are built at compile time
+constexpr auto KEYWORDS = makePerfectHashMap<string_view, int>({
+	{ "if"_sv, 1 }, { "else"_sv, 2 }, { "while"_sv, 3 }, { "for"_sv, 4 },
+	{ "return"_sv, 5 }, { "break"_sv, 6 }, { "continue"_sv, 7 }, { ""_sv, 8 },
+});
+
+constexpr auto OPCODES = makePerfectHashMap<int, Opcode>({
+	{ 0x00, Opcode::Nop }, { 0x10, Opcode::Load }, { 0x11, Opcode::Store },
+	{ 0x20, Opcode::Add }, { 0x7f, Opcode::Jump }, { -1, Opcode::Halt },
+});
+
+constexpr auto PRIMES = makePerfectHashSet(mpl::Valuelist<int, 2, 3, 5, 7, 11, 13, 17, 19>{});
+
+static_assert(KEYWORDS.get("while"_sv, 0) == 3, "");
+static_assert(KEYWORDS.get("whilst"_sv, 0) == 0, "");
+static_assert(OPCODES.get(-1, Opcode::Nop) == Opcode::Halt, "");
+static_assert(PRIMES.contains(13) && !PRIMES.contains(15), "");
+static_assert(PRIMES.indexOf(19) == 7, "");
+
+TEST(PerfectHashTest, string) {
+	EXPECT_EQ(KEYWORDS.size(), 8);
+
+	// runtime keys
+	for (std::string word : { "if", "else", "while", "for", "return", "break", "continue", "" }) {
+		auto val = KEYWORDS.find(word);
+		ASSERT_NE(val, nullptr) << word;
+		EXPECT_EQ(KEYWORDS.get(word, 0), *val);
+	}
+
+	for (std::string word : { "i", "iff", "Else", "whilE", "fo", "goto", "continu" }) {
+		EXPECT_EQ(KEYWORDS.find(word), nullptr) << word;
+		EXPECT_FALSE(KEYWORDS.contains(word));
+	}
+}
+
+TEST(PerfectHashTest, integer) {
+	EXPECT_EQ(*OPCODES.find(0x11), Opcode::Store);
+	EXPECT_EQ(OPCODES.count(0x12), 0);
+
+	for (int i = -100; i != 100; ++i) {
+		bool prime = i > 1 && i < 20;
+		for (int d = 2; d * d <= i; ++d) {
+			prime = prime && i % d != 0;
+		}
+		EXPECT_EQ(PRIMES.contains(i), prime) << i;
+	}
+}
+
+TEST(PerfectHashTest, large) {
+	// built at runtime, the same code as compile time
+	static int keys[1000];
+	for (int i = 0; i != 1000; ++i) {
+		keys[i] = i * 7919;
+	}
+
+	PerfectHashSet<int, 1000> set(keys);
+	EXPECT_LE(set.slot_count(), 2048);
+	for (int i = 0; i != 1000; ++i) {
+		EXPECT_EQ(set.indexOf(i * 7919), i);
+		EXPECT_EQ(set.indexOf(i * 7919 + 1), set.npos);
+	}
+}
+
+TEST(PerfectHashTest, shortString) {
+	// keys differing in one character
+	static char chars[128][2];
+	string_view keys[128];
+	for (int i = 0; i != 128; ++i) {
+		chars[i][0] = static_cast<char>(i);
+		keys[i] = string_view(chars[i], 1);
+	}
+
+	PerfectHashSet<string_view, 128> set(keys);
+	for (int i = 0; i != 128; ++i) {
+		EXPECT_EQ(set.indexOf(keys[i]), i);
+		EXPECT_FALSE(set.contains(string_view(chars[i], 2)));
+	}
+}
+
+TEST(PerfectHashTest, duplicate) {
+	int keys[] = { 1, 2, 3, 2 };
+	using Set = PerfectHashSet<int, 4>;
+	EXPECT_THROW(Set{ keys }, std::invalid_argument);
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
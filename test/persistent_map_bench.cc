@@ -0,0 +1,82 @@
+#include "persistent_map.h"
+#include "map.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace zstl;
+
+#define N 1000000
+
+static void fill(Map<int, int>& m, int n) {
+	for (int i = 0; i != n; ++i) {
+		m[i];
+	}
+}
+
+static void fill(PersistentMap<int, int>& m, int n) {
+	for (int i = 0; i != n; ++i) {
+		m.try_emplace(i, 0);
+	}
+}
+
+// update one entry of the master table, then publish the snapshot for readers
+static void publish(Map<int, int>& master, Map<int, int>& published, int key, int val) {
+	master[key] = val;
+	// copy the whole tree, the nodes of the old snapshot are reused
+	published = master;
+}
+
+static void publish(PersistentMap<int, int>& master, PersistentMap<int, int>& published, int key, int val) {
+	master.insert_or_assign(key, val);
+	published = master.snapshot();
+}
+
+template<typename M>
+static void publish_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	std::mt19937 gen(n);
+
+	M master;
+	fill(master, n);
+	M published = master;
+
+	int val = 0;
+	for (auto _ : state) {
+		publish(master, published, gen() % n, ++val);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<typename M>
+static void find_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	std::mt19937 gen(n);
+
+	M m;
+	fill(m, n);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m.contains(gen() % n));
+	}
+}
+
+static void PersistentMapPublish(benchmark::State& state)
+{ publish_benchmark<PersistentMap<int, int>>(state); }
+
+static void MapCopyPublish(benchmark::State& state)
+{ publish_benchmark<Map<int, int>>(state); }
+
+static void PersistentMapFind(benchmark::State& state)
+{ find_benchmark<PersistentMap<int, int>>(state); }
+
+static void MapFind(benchmark::State& state)
+{ find_benchmark<Map<int, int>>(state); }
+
+BENCHMARK(PersistentMapPublish)->RangeMultiplier(10)->Range(1000, N);
+BENCHMARK(MapCopyPublish)->RangeMultiplier(10)->Range(1000, N)->Unit(benchmark::kMicrosecond);
+BENCHMARK(PersistentMapFind)->RangeMultiplier(10)->Range(1000, N);
+BENCHMARK(MapFind)->RangeMultiplier(10)->Range(1000, N);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,169 @@
+#define PERSISTENT_MAP_DEBUG
+#include "persistent_map.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define N 20000
+
+using namespace zstl;
+
+using IntMap = PersistentMap<int, int>;
+
+template<typename M>
+void expectSame(M const& m, std::map<int, int> const& stl) {
+	ASSERT_TRUE(m.verify());
+	ASSERT_EQ(m.size(), stl.size());
+
+	auto iter = m.begin();
+	for (auto const& x : stl) {
+		ASSERT_EQ(iter->first, x.first);
+		ASSERT_EQ(iter->second, x.second);
+		++iter;
+	}
+	EXPECT_EQ(iter, m.end());
+}
+
+TEST(PersistentMap, basic) {
+	IntMap m;
+	std::map<int, int> stl;
+	std::mt19937 gen(42);
+
+	for (int i = 0; i != N; ++i) {
+		int x = gen() % N;
+		EXPECT_EQ(m.try_emplace(x, i), stl.emplace(x, i).second);
+	}
+	expectSame(m, stl);
+
+	for (int i = 0; i != N; ++i) {
+		int val = -1;
+		EXPECT_EQ(m.find(i, val), stl.count(i) == 1);
+		if (stl.count(i)) {
+			EXPECT_EQ(val, stl[i]);
+			EXPECT_EQ(m.at(i), stl[i]);
+		}
+	}
+	EXPECT_THROW(m.at(-1), std::range_error);
+
+	for (int i = 0; i < N; i += 2) {
+		EXPECT_EQ(m.insert_or_assign(i, -i), stl.count(i) == 0);
+		stl[i] = -i;
+	}
+	expectSame(m, stl);
+
+	for (int i = 0; i < N; i += 3) {
+		EXPECT_EQ(m.erase(i), stl.erase(i));
+	}
+	expectSame(m, stl);
+
+	auto iter = m.lower_bound(N / 2);
+	EXPECT_EQ(iter->first, stl.lower_bound(N / 2)->first);
+	EXPECT_EQ(m.lower_bound(N), m.end());
+
+	m.clear();
+	EXPECT_TRUE(m.empty());
+	EXPECT_EQ(m.begin(), m.end());
+}
+
+TEST(PersistentMap, snapshot) {
+	IntMap m;
+	std::map<int, int> stl;
+	std::vector<IntMap> versions;
+	std::vector<std::map<int, int>> expects;
+	std::mt19937 gen(42);
+
+	// every version is kept while the later ones are built
+	for (int round = 0; round != 50; ++round) {
+		for (int i = 0; i != 200; ++i) {
+			int x = gen() % 2000;
+			switch (gen() % 3) {
+			case 0:
+				m.erase(x);
+				stl.erase(x);
+				break;
+			case 1:
+				m.insert_or_assign(x, round);
+				stl[x] = round;
+				break;
+			default:
+				m.try_emplace(x, round);
+				stl.emplace(x, round);
+			}
+		}
+		versions.push_back(m.snapshot());
+		expects.push_back(stl);
+	}
+
+	for (size_t i = 0; i != versions.size(); ++i) {
+		expectSame(versions[i], expects[i]);
+	}
+
+	// release the versions out of order
+	for (size_t i = 0; i < versions.size(); i += 2) {
+		versions[i].clear();
+	}
+	for (size_t i = 1; i < versions.size(); i += 2) {
+		expectSame(versions[i], expects[i]);
+	}
+
+	IntMap moved(STL_MOVE(m));
+	EXPECT_TRUE(m.empty());
+	expectSame(moved, stl);
+}
+
+TEST(PersistentMap, string) {
+	PersistentMap<std::string, std::string> m;
+	m.try_emplace("route", "a");
+	auto old = m;
+	m.insert_or_assign("route", std::string("b"));
+	m.insert(zstl::pair<std::string const, std::string>("zstl", "c"));
+
+	EXPECT_EQ(old.at("route"), "a");
+	EXPECT_EQ(m.at("route"), "b");
+	EXPECT_FALSE(old.contains("zstl"));
+	EXPECT_TRUE(m.visit("zstl", [](std::string const& val) {
+		EXPECT_EQ(val, "c");
+	}));
+}
+
+TEST(PersistentMap, concurrent) {
+	IntMap m;
+	for (int i = 0; i != 1000; ++i) {
+		m.try_emplace(i, i);
+	}
+
+	// the readers own their snapshots, the writer keeps modifying the shared nodes
+	std::vector<std::thread> readers;
+	for (int t = 0; t != 4; ++t) {
+		readers.emplace_back([snap = m.snapshot()]() mutable {
+			for (int round = 0; round != 20; ++round) {
+				long long sum = 0;
+				for (auto const& x : snap) {
+					sum += x.second;
+				}
+				EXPECT_EQ(sum, 999 * 1000 / 2);
+				auto copy = snap;
+				copy.erase(round);
+			}
+		});
+	}
+
+	for (int i = 0; i != 1000; ++i) {
+		m.insert_or_assign(i, 0);
+		m.erase(i / 2);
+	}
+	for (auto& t : readers) {
+		t.join();
+	}
+	EXPECT_TRUE(m.verify());
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
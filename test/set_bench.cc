@@ -1,4 +1,7 @@
 #include "set.h"
+#include "map.h"
+#include "vector.h"
+#include "pool_allocator.h"
 #include "tool.h"
 
 #include <gtest/gtest.h>
@@ -100,11 +103,298 @@ MySetErase(benchmark::State& state) {
 	erase_benchmark<Set<int>>(state);
 }
 
+template<typename T>
+void
+map_insert_benchmark(benchmark::State& state) {
+	int length = state.range(0);
+	std::mt19937 gen(length);
+
+	for (auto _ : state) {
+		T map;
+		for (int i = 0; i != length; ++i) {
+			// about half of keys are duplicate
+			map[gen() % length] += i;
+		}
+		benchmark::DoNotOptimize(map.size());
+	}
+}
+
+static inline void
+MyMapInsert(benchmark::State& state) {
+	map_insert_benchmark<Map<int, int>>(state);
+}
+
+static inline void
+STLMapInsert(benchmark::State& state) {
+	map_insert_benchmark<std::map<int, int>>(state);
+}
+
+template<typename T>
+void
+map_find_benchmark(benchmark::State& state) {
+	int length = state.range(0);
+	T map;
+	for (int i = 0; i != length; ++i) {
+		map.emplace(i * 2, i);
+	}
+
+	for (auto _ : state) {
+		int found = 0;
+		for (int i = 0; i != length * 2; ++i) {
+			found += map.find(i) != map.end();
+		}
+		EXPECT_EQ(found, length);
+	}
+}
+
+static inline void
+MyMapFind(benchmark::State& state) {
+	map_find_benchmark<Map<int, int>>(state);
+}
+
+static inline void
+STLMapFind(benchmark::State& state) {
+	map_find_benchmark<std::map<int, int>>(state);
+}
+
+template<typename T>
+void
+map_erase_benchmark(benchmark::State& state) {
+	int length = state.range(0);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		T map;
+		for (int i = 0; i != length; ++i) {
+			map.emplace(i, i);
+		}
+		state.ResumeTiming();
+
+		for (int i = 0; i != length; ++i) {
+			map.erase((i * 7919) % length);
+		}
+	}
+}
+
+static inline void
+MyMapErase(benchmark::State& state) {
+	map_erase_benchmark<Map<int, int>>(state);
+}
+
+static inline void
+STLMapErase(benchmark::State& state) {
+	map_erase_benchmark<std::map<int, int>>(state);
+}
+
+template<typename T>
+void load_sorted_benchmark(benchmark::State& state, bool bulk) {
+	const int length = state.range(0);
+	Vector<int> sorted(length);
+	for (int i = 0; i != length; ++i) {
+		sorted[i] = i;
+	}
+
+	for (auto _ : state) {
+		if (bulk) {
+			T set(sorted.begin(), sorted.end());
+			benchmark::DoNotOptimize(set.size());
+			state.PauseTiming();
+		} else {
+			T set;
+			for (auto x : sorted) {
+				set.insert(x);
+			}
+			benchmark::DoNotOptimize(set.size());
+			state.PauseTiming();
+		}
+		// exclude the destruction
+		state.ResumeTiming();
+	}
+}
+
+static inline void
+MySetLoadSorted(benchmark::State& state) {
+	load_sorted_benchmark<Set<int>>(state, true);
+}
+
+static inline void
+MySetLoadSortedPerInsert(benchmark::State& state) {
+	load_sorted_benchmark<Set<int>>(state, false);
+}
+
+static inline void
+STLSetLoadSorted(benchmark::State& state) {
+	load_sorted_benchmark<std::set<int>>(state, true);
+}
+
+template<typename T>
+T random_int_set(int n, int range) {
+	T set;
+	while ((int)set.size() != n) {
+		set.insert(rand() % range);
+	}
+	return set;
+}
+
+// compute op(a, b) into res, a is the smaller one
+template<typename T, typename F>
+void set_algebra_benchmark(benchmark::State& state, F op) {
+	const int m = state.range(0);
+	const int n = state.range(1);
+	srand(1);
+	const auto small = random_int_set<T>(m, 4 * n);
+	const auto large = random_int_set<T>(n, 4 * n);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		{
+			T a(small);
+			T b(large);
+			T res;
+			state.ResumeTiming();
+
+			op(a, b, res);
+			benchmark::DoNotOptimize(res.size());
+			// exclude the destruction
+			state.PauseTiming();
+		}
+		state.ResumeTiming();
+	}
+}
+
+// the nodes of the smaller one are relinked into the larger one
+static inline void
+MySetUnionFinger(benchmark::State& state) {
+	set_algebra_benchmark<Set<int>>(state, [](Set<int>& a, Set<int>& b, Set<int>& res) {
+		res = zstl::set_union(STL_MOVE(a), STL_MOVE(b));
+	});
+}
+
+static inline void
+MySetUnionInsert(benchmark::State& state) {
+	set_algebra_benchmark<Set<int>>(state, [](Set<int>& a, Set<int>& b, Set<int>& res) {
+		for (auto x : a) {
+			b.insert(x);
+		}
+		res.swap(b);
+	});
+}
+
+static inline void
+STLSetUnionMerge(benchmark::State& state) {
+	set_algebra_benchmark<std::set<int>>(state, [](std::set<int>& a, std::set<int>& b, std::set<int>& res) {
+		std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::inserter(res, res.end()));
+	});
+}
+
+static inline void
+MySetIntersectFinger(benchmark::State& state) {
+	set_algebra_benchmark<Set<int>>(state, [](Set<int>& a, Set<int>& b, Set<int>& res) {
+		res = zstl::set_intersection(STL_MOVE(a), b);
+	});
+}
+
+static inline void
+MySetIntersectFind(benchmark::State& state) {
+	set_algebra_benchmark<Set<int>>(state, [](Set<int>& a, Set<int>& b, Set<int>& res) {
+		for (auto x : a) {
+			if (b.contains(x)) {
+				res.insert(res.end(), x);
+			}
+		}
+	});
+}
+
+static inline void
+STLSetIntersectMerge(benchmark::State& state) {
+	set_algebra_benchmark<std::set<int>>(state, [](std::set<int>& a, std::set<int>& b, std::set<int>& res) {
+		std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::inserter(res, res.end()));
+	});
+}
+
+// b - a, erased from b in place
+static inline void
+MySetDifferenceFinger(benchmark::State& state) {
+	set_algebra_benchmark<Set<int>>(state, [](Set<int>& a, Set<int>& b, Set<int>& res) {
+		res = zstl::set_difference(STL_MOVE(b), a);
+	});
+}
+
+static inline void
+MySetDifferenceErase(benchmark::State& state) {
+	set_algebra_benchmark<Set<int>>(state, [](Set<int>& a, Set<int>& b, Set<int>& res) {
+		for (auto x : a) {
+			b.erase(x);
+		}
+		res.swap(b);
+	});
+}
+
+// only clear() is timed, the pool drops the slabs without walking the tree
+template<typename T>
+void teardown_benchmark(benchmark::State& state) {
+	const int length = state.range(0);
+	std::mt19937 gen(length);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		T set;
+		for (int i = 0; i != length; ++i) {
+			set.insert(gen());
+		}
+		state.ResumeTiming();
+
+		set.clear();
+		benchmark::DoNotOptimize(set.size());
+	}
+}
+
+static inline void
+MySetTeardown(benchmark::State& state) {
+	teardown_benchmark<Set<int>>(state);
+}
+
+static inline void
+MySetTeardownPool(benchmark::State& state) {
+	teardown_benchmark<Set<int, zstl::less<int>, PoolAllocator<int>>>(state);
+}
+
+static inline void
+STLSetTeardown(benchmark::State& state) {
+	teardown_benchmark<std::set<int>>(state);
+}
+
 BENCHMARK(MySetErase)->RangeMultiplier(10)->Range(1, N);
 BENCHMARK(STLSetErase)->RangeMultiplier(10)->Range(1, N);
 BENCHMARK(MySetInsert)->RangeMultiplier(10)->Range(1, N);
 BENCHMARK(STLSetInsert)->RangeMultiplier(10)->Range(1, N);
 BENCHMARK(STLSetFind)->RangeMultiplier(10)->Range(1, N);
 BENCHMARK(MySetFind)->RangeMultiplier(10)->Range(1, N);
+BENCHMARK(MySetLoadSorted)->Arg(10 * N)->Unit(benchmark::kMillisecond);
+BENCHMARK(MySetLoadSortedPerInsert)->Arg(10 * N)->Unit(benchmark::kMillisecond);
+BENCHMARK(STLSetLoadSorted)->Arg(10 * N)->Unit(benchmark::kMillisecond);
+BENCHMARK(MyMapInsert)->RangeMultiplier(10)->Range(10, N);
+BENCHMARK(STLMapInsert)->RangeMultiplier(10)->Range(10, N);
+BENCHMARK(MyMapFind)->RangeMultiplier(10)->Range(10, N);
+BENCHMARK(STLMapFind)->RangeMultiplier(10)->Range(10, N);
+BENCHMARK(MyMapErase)->RangeMultiplier(10)->Range(10, N);
+BENCHMARK(STLMapErase)->RangeMultiplier(10)->Range(10, N);
+
+// small-into-large and equal size,
+// the iterations are limited since the sets are copied in each one
+#define SET_ALGEBRA_ARGS \
+	Args({ 1000, N })->Args({ N, N })->Iterations(10)->Unit(benchmark::kMillisecond)
+BENCHMARK(MySetUnionFinger)->SET_ALGEBRA_ARGS;
+BENCHMARK(MySetUnionInsert)->SET_ALGEBRA_ARGS;
+BENCHMARK(STLSetUnionMerge)->SET_ALGEBRA_ARGS;
+BENCHMARK(MySetIntersectFinger)->SET_ALGEBRA_ARGS;
+BENCHMARK(MySetIntersectFind)->SET_ALGEBRA_ARGS;
+BENCHMARK(STLSetIntersectMerge)->SET_ALGEBRA_ARGS;
+BENCHMARK(MySetDifferenceFinger)->SET_ALGEBRA_ARGS;
+BENCHMARK(MySetDifferenceErase)->SET_ALGEBRA_ARGS;
+
+BENCHMARK(MySetTeardown)->Arg(4 * N)->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK(MySetTeardownPool)->Arg(4 * N)->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK(STLSetTeardown)->Arg(4 * N)->Iterations(5)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
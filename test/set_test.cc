@@ -2,10 +2,16 @@
 
 #include "../include/set.h"
 #include "../include/vector.h"
+#include "../include/deferred_destroyer.h"
+#include "../include/pool_allocator.h"
 
 #include "tool.h"
 
 #include <algorithm>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #define N 1000000
@@ -107,6 +113,494 @@ TEST(MySet, copy) {
   EXPECT_TRUE(s2.empty()); 
 }
 
+TEST(MySet, bound) {
+  Set<int> s;
+  for (int i = 1; i < 10; i += 2) {
+    s.insert(i);
+  }
+
+  EXPECT_EQ(s.lower_bound(0), s.begin());
+  EXPECT_EQ(*s.lower_bound(3), 3);
+  EXPECT_EQ(*s.lower_bound(4), 5);
+  EXPECT_EQ(*s.upper_bound(3), 5);
+  EXPECT_EQ(*s.upper_bound(4), 5);
+  EXPECT_EQ(s.lower_bound(10), s.end());
+  EXPECT_EQ(s.upper_bound(9), s.end());
+}
+
+using IntTree = RBTree<int, int, zstl::identity<int>, zstl::less<int>, zstl::allocator<int>>;
+
+TEST(MySet, insert_equal) {
+  IntTree tree;
+  for (int i = 0; i < 100; ++i) {
+    tree.InsertEqual(i % 10);
+    tree.EmplaceEqual(i % 10);
+  }
+
+  EXPECT_EQ(tree.size(), 200);
+  EXPECT_TRUE(is_sorted(tree.begin(), tree.end()));
+  EXPECT_EQ(tree.count(3), 20);
+}
+
+TEST(MySet, reverse) {
+  Set<int> s;
+  for (int i = 0; i < 100; ++i) {
+    s.insert(i);
+  }
+
+  int expect = 99;
+  for (auto it = s.rbegin(); it != s.rend(); ++it) {
+    EXPECT_EQ(*it, expect--);
+  }
+  EXPECT_EQ(expect, -1);
+}
+
+// erase the maximum and a random key in turn, the root is erased many times
+TEST(MySet, erase_random) {
+  IntTree tree;
+  std::set<int> expect;
+  std::mt19937 gen(42);
+  for (int i = 0; i < 2000; ++i) {
+    int x = gen() % 4000;
+    tree.InsertUnique(x);
+    expect.insert(x);
+  }
+
+  while (!expect.empty()) {
+    int x = expect.size() % 2 ? *expect.rbegin()
+      : *std::next(expect.begin(), gen() % expect.size());
+    auto pos = tree.find(x);
+    ASSERT_NE(pos, tree.end());
+    tree.erase(pos);
+    expect.erase(x);
+
+    ASSERT_TRUE(tree.IsRequired().first);
+    ASSERT_EQ(tree.size(), expect.size());
+    if (!expect.empty()) {
+      ASSERT_EQ(*tree.begin(), *expect.begin());
+      ASSERT_EQ(*--tree.end(), *expect.rbegin());
+    }
+  }
+}
+
+TEST(MySet, move_swap) {
+  Set<int> a;
+  for (int i = 0; i < 100; ++i) {
+    a.insert(i);
+  }
+
+  Set<int> b(STL_MOVE(a));
+  EXPECT_EQ(a.size(), 0);
+  EXPECT_EQ(a.begin(), a.end());
+  EXPECT_EQ(b.size(), 100);
+  EXPECT_EQ(*--b.end(), 99);
+
+  // the moved-from set is still usable
+  a.insert(1000);
+  EXPECT_EQ(a.size(), 1);
+
+  a.swap(b);
+  EXPECT_EQ(a.size(), 100);
+  EXPECT_EQ(*--a.end(), 99);
+  EXPECT_EQ(b.size(), 1);
+  EXPECT_EQ(*b.begin(), 1000);
+  b.insert(999);
+  EXPECT_EQ(*b.begin(), 999);
+
+  b = STL_MOVE(a);
+  EXPECT_EQ(a.size(), 0);
+  EXPECT_EQ(b.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NE(b.find(i), b.end());
+  }
+}
+
+TEST(MySet, copy_empty) {
+  Set<int> s;
+  for (int i = 0; i < 100; ++i) {
+    s.insert(i);
+  }
+
+  // the nodes of s are released once
+  Set<int> empty;
+  s = empty;
+  EXPECT_EQ(s.size(), 0);
+  EXPECT_EQ(s.begin(), s.end());
+
+  s.insert(1);
+  EXPECT_EQ(s.size(), 1);
+}
+
+struct TrackedLess {
+  bool operator()(Tracked const& x, Tracked const& y) const
+  { return x.val < y.val; }
+};
+
+TEST(MySet, emplace_hint_duplicate) {
+  {
+    Set<Tracked, TrackedLess> s;
+    s.emplace_hint(s.end(), 1);
+    auto res = s.emplace_hint(s.end(), 1);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(res.first->val, 1);
+    EXPECT_EQ(Tracked::alive().load(), 1);
+  }
+  EXPECT_EQ(Tracked::alive().load(), 0);
+}
+
+TEST(MySet, contains) {
+  Set<int> s;
+  s.insert(1);
+
+  EXPECT_TRUE(s.contains(1));
+  EXPECT_FALSE(s.contains(2));
+}
+
+TEST(MySet, emplace) {
+  Set<std::string> s;
+  auto res = s.emplace(3, 'a');
+  EXPECT_TRUE(res.second);
+  EXPECT_EQ(*res.first, "aaa");
+
+  res = s.emplace("aaa");
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ(s.size(), 1);
+}
+
+TEST(MySet, assign_sorted) {
+  // all shapes of the last level
+  for (int n = 0; n < 300; ++n) {
+    Vector<int> sorted;
+    for (int i = 0; i < n; ++i) {
+      // duplicate keys are ignored
+      sorted.push_back(i / 2 * 2);
+    }
+
+    Set<int> s(sorted.begin(), sorted.end());
+    ASSERT_TRUE(s.rep().IsRequired().first) << n;
+    ASSERT_EQ(s.size(), (n + 1) / 2);
+
+    int expect = 0;
+    for (auto x : s) {
+      EXPECT_EQ(x, expect);
+      expect += 2;
+    }
+
+    // parent links are correct
+    for (int i = 0; i < n; i += 4) {
+      s.erase(i);
+      ASSERT_TRUE(s.rep().IsRequired().first) << n;
+    }
+    s.insert(-1);
+    ASSERT_TRUE(s.rep().IsRequired().first) << n;
+  }
+
+  Set<int> s;
+  s.insert(100);
+  int sorted[] = { 1, 2, 3 };
+  s.assign_sorted(sorted, sorted + 3);
+  EXPECT_EQ(s.size(), 3);
+  EXPECT_EQ(*s.begin(), 1);
+  EXPECT_EQ(*--s.end(), 3);
+
+  // unsorted range is inserted one by one
+  int unsorted[] = { 3, 1, 2, 1 };
+  Set<int> s2(unsorted, unsorted + 4);
+  EXPECT_TRUE(s2.rep().IsRequired().first);
+  EXPECT_EQ(s2.size(), 3);
+  EXPECT_TRUE(is_sorted(s2.begin(), s2.end()));
+}
+
+struct ThrowOnCopy {
+  static int copies;
+
+  ThrowOnCopy(int v)
+    : val(v)
+  { }
+
+  ThrowOnCopy(ThrowOnCopy const& rhs)
+    : val(rhs.val) {
+    if (--copies == 0) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  bool operator<(ThrowOnCopy const& rhs) const
+  { return val < rhs.val; }
+
+  int val;
+};
+
+int ThrowOnCopy::copies = 0;
+
+TEST(MySet, assign_sorted_throw) {
+  Vector<ThrowOnCopy> sorted;
+  for (int i = 0; i < 100; ++i) {
+    sorted.push_back(ThrowOnCopy(i));
+  }
+
+  Set<ThrowOnCopy> s;
+  s.insert(ThrowOnCopy(-1));
+
+  // the nodes created are freed, and the set is unchanged
+  ThrowOnCopy::copies = 50;
+  EXPECT_THROW(s.assign_sorted(sorted.begin(), sorted.end()), std::runtime_error);
+  EXPECT_EQ(s.size(), 1);
+  EXPECT_EQ(s.begin()->val, -1);
+
+  ThrowOnCopy::copies = 0;
+  s.assign_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(s.size(), 100);
+}
+
+static Set<int> RandomSet(int n, int range) {
+  Set<int> s;
+  while ((int)s.size() < n) {
+    s.insert(rand() % range);
+  }
+  return s;
+}
+
+// iterate both directions and erase all to check parent links
+static void CheckSet(Set<int>& s, std::set<int> const& expect) {
+  ASSERT_TRUE(s.rep().IsRequired().first);
+  ASSERT_EQ(s.size(), expect.size());
+  ASSERT_TRUE(std::equal(s.begin(), s.end(), expect.begin()));
+  ASSERT_TRUE(std::equal(s.rbegin(), s.rend(), expect.rbegin()));
+
+  Set<int> copy(s);
+  for (auto x : expect) {
+    ASSERT_EQ(copy.erase(x), 1);
+  }
+  ASSERT_TRUE(copy.empty());
+}
+
+TEST(MySet, join_split) {
+  srand(42);
+  for (int n = 0; n < 200; n += 7) {
+    auto s = RandomSet(n, 1000);
+    std::set<int> expect(s.begin(), s.end());
+
+    for (int key = -1; key <= 1000; key += 97) {
+      auto left = s;
+      auto right = left.split(key);
+      std::set<int> expect_left(expect.begin(), expect.lower_bound(key));
+      std::set<int> expect_right(expect.lower_bound(key), expect.end());
+      CheckSet(left, expect_left);
+      CheckSet(right, expect_right);
+
+      left.join(right);
+      EXPECT_TRUE(right.empty());
+      CheckSet(left, expect);
+    }
+  }
+
+  // trees of different black heights
+  for (int n = 0; n < 300; n += 13) {
+    Set<int> left, right;
+    for (int i = 0; i < n; ++i) {
+      left.insert(i);
+    }
+    for (int i = 1000; i < 1000 + 300 - n; ++i) {
+      right.insert(i);
+    }
+    std::set<int> expect(left.begin(), left.end());
+    expect.insert(right.begin(), right.end());
+
+    left.join(right);
+    CheckSet(left, expect);
+  }
+}
+
+TEST(MySet, set_algebra) {
+  srand(42);
+  int const sizes[] = { 0, 1, 5, 100, 1000 };
+
+  for (auto m : sizes) {
+    for (auto n : sizes) {
+      auto a = RandomSet(m, 3000);
+      auto b = RandomSet(n, 3000);
+      std::vector<int> expect;
+      Set<int> res;
+
+      std::set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expect));
+      res = zstl::set_union(a, b);
+      CheckSet(res, std::set<int>(expect.begin(), expect.end()));
+
+      expect.clear();
+      std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expect));
+      res = zstl::set_intersection(a, b);
+      CheckSet(res, std::set<int>(expect.begin(), expect.end()));
+
+      // the lvalues are not modified
+      std::set<int> expect_b(b.begin(), b.end());
+      CheckSet(b, expect_b);
+
+      expect.clear();
+      std::set_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expect));
+      res = zstl::set_difference(std::move(a), std::move(b));
+      CheckSet(res, std::set<int>(expect.begin(), expect.end()));
+      EXPECT_TRUE(a.empty());
+      // rhs is only read even if it is a rvalue
+      CheckSet(b, expect_b);
+    }
+  }
+}
+
+using RankedSet = Set<int, zstl::less<int>, zstl::allocator<int>, RBTreeSizeAugment>;
+
+// check the subtree sizes by order statistics of all elements
+static void CheckRanked(RankedSet const& s, std::set<int> const& expect) {
+  ASSERT_TRUE(const_cast<RankedSet&>(s).rep().IsRequired().first);
+  ASSERT_EQ(s.size(), expect.size());
+
+  size_t i = 0;
+  for (auto it = expect.begin(); it != expect.end(); ++it, ++i) {
+    ASSERT_EQ(*s.select(i), *it);
+    ASSERT_EQ(s.rank(*it), i);
+    ASSERT_EQ(s.rank(*it + 1), i + 1);
+    ASSERT_EQ(s.index(s.find(*it)), i);
+  }
+  ASSERT_TRUE(s.select(i) == s.end());
+  ASSERT_EQ(s.index(s.end()), s.size());
+}
+
+TEST(MySet, order_statistics) {
+  // no field for default augment
+  static_assert(sizeof(RBTreeNode<int>) < sizeof(RBTreeNode<int, RBTreeSizeAugment>), "");
+
+  srand(42);
+  RankedSet s;
+  std::set<int> expect;
+  for (int i = 0; i < 2000; ++i) {
+    auto x = rand() % 1000;
+    if (rand() % 3 == 0) {
+      EXPECT_EQ(s.erase(x), expect.erase(x));
+    } else {
+      s.insert(x);
+      expect.insert(x);
+    }
+
+    if (i % 100 == 0) {
+      CheckRanked(s, expect);
+    }
+  }
+  CheckRanked(s, expect);
+
+  RankedSet::difference_type dist = s.distance(s.begin(), s.end());
+  EXPECT_EQ(dist, (std::ptrdiff_t)s.size());
+  EXPECT_EQ(s.distance(s.end(), s.begin()), -(std::ptrdiff_t)s.size());
+  EXPECT_EQ(s.distance(s.select(10), s.select(100)), 90);
+
+  // the sizes are maintained by copy, bulk load, split, join and set algebra
+  RankedSet copy(s);
+  CheckRanked(copy, expect);
+
+  Vector<int> sorted;
+  for (int i = 0; i < 1000; ++i) {
+    sorted.push_back(i * 2);
+  }
+  RankedSet even(sorted.begin(), sorted.end());
+  std::set<int> expect_even(sorted.begin(), sorted.end());
+  CheckRanked(even, expect_even);
+
+  auto right = even.split(999);
+  CheckRanked(even, std::set<int>(expect_even.begin(), expect_even.lower_bound(999)));
+  CheckRanked(right, std::set<int>(expect_even.lower_bound(999), expect_even.end()));
+  even.join(right);
+  CheckRanked(even, expect_even);
+
+  std::set<int> expect_union(expect);
+  expect_union.insert(expect_even.begin(), expect_even.end());
+  auto u = zstl::set_union(STL_MOVE(copy), STL_MOVE(even));
+  CheckRanked(u, expect_union);
+
+  std::vector<int> expect_diff;
+  std::set_difference(expect_union.begin(), expect_union.end(),
+    expect.begin(), expect.end(), back_inserter(expect_diff));
+  auto d = zstl::set_difference(u, s);
+  CheckRanked(d, std::set<int>(expect_diff.begin(), expect_diff.end()));
+}
+
+TEST(MySet, teardown) {
+  // sorted insertion makes long left and right spines
+  Set<int> s;
+  for (int i = 0; i < 100000; ++i) {
+    s.insert(i);
+  }
+  s.clear();
+  EXPECT_TRUE(s.empty());
+  s.insert(1);
+  EXPECT_EQ(s.size(), 1);
+
+  // the pool frees all nodes at once
+  using PoolSet = Set<int, zstl::less<int>, PoolAllocator<int>>;
+  PoolSet pool;
+  std::set<int> expect;
+  srand(42);
+  for (int i = 0; i < 10000; ++i) {
+    auto x = rand() % 5000;
+    if (rand() % 3 == 0) {
+      EXPECT_EQ(pool.erase(x), expect.erase(x));
+    } else {
+      pool.insert(x);
+      expect.insert(x);
+    }
+  }
+  EXPECT_TRUE(pool.size() == expect.size() && std::equal(pool.begin(), pool.end(), expect.begin()));
+
+  // copy has its own pool, swap and move take the pool with the nodes
+  PoolSet copy(pool);
+  PoolSet other;
+  other.insert(-1);
+  other.swap(copy);
+  EXPECT_EQ(copy.size(), 1);
+  EXPECT_TRUE(other.size() == expect.size() && std::equal(other.begin(), other.end(), expect.begin()));
+  PoolSet moved(STL_MOVE(other));
+  pool.clear();
+  EXPECT_TRUE(moved.size() == expect.size() && std::equal(moved.begin(), moved.end(), expect.begin()));
+  pool.insert(42);
+  EXPECT_EQ(*pool.begin(), 42);
+
+  // the destructors are still called for non-trivial value
+  Set<std::string, zstl::less<std::string>, PoolAllocator<std::string>> strs;
+  for (int i = 0; i < 1000; ++i) {
+    strs.insert(std::string(64, 'a') + std::to_string(i));
+  }
+  strs.clear();
+  EXPECT_TRUE(strs.empty());
+}
+
+TEST(MySet, deferred_destroy) {
+  static int destroyed = 0;
+  struct Counted {
+    int x;
+    Counted(int i) : x(i) { }
+    Counted(Counted const& rhs) = default;
+    ~Counted() { ++destroyed; }
+    bool operator<(Counted const& rhs) const { return x < rhs.x; }
+  };
+
+  DeferredDestroyer destroyer;
+  Set<Counted> s;
+  for (int i = 0; i < 1000; ++i) {
+    s.insert(Counted(i));
+  }
+  destroyed = 0;
+
+  destroyer.retire(STL_MOVE(s));
+  EXPECT_TRUE(s.empty());
+  destroyer.drain();
+  EXPECT_EQ(destroyed, 1000);
+
+  // the pending objects are destroyed with destroyer
+  {
+    DeferredDestroyer scoped;
+    Vector<int> vec(100, 1);
+    scoped.retire(STL_MOVE(vec));
+  }
+}
+
 int main()
 {
 	::testing::InitGoogleTest();
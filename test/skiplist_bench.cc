@@ -0,0 +1,106 @@
+#include "skiplist.h"
+#include "set.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace zstl;
+
+#define N 1000000
+
+static std::vector<int> const& randomKeys(int n) {
+	static std::vector<int> keys;
+	if ((int)keys.size() != n) {
+		std::mt19937 gen(n);
+		keys.resize(n);
+		for (auto& key : keys) {
+			key = gen();
+		}
+	}
+	return keys;
+}
+
+template<typename S>
+static void fill(S& s, int n) {
+	for (auto key : randomKeys(n)) {
+		s.insert(key);
+	}
+}
+
+template<typename S>
+static void insert_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	randomKeys(n);
+
+	for (auto _ : state) {
+		S s;
+		fill(s, n);
+
+		state.PauseTiming();
+		{ S tmp(std::move(s)); }
+		state.ResumeTiming();
+	}
+}
+
+template<typename S>
+static void find_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	S s;
+	fill(s, n);
+	auto const& keys = randomKeys(n);
+
+	for (auto _ : state) {
+		size_t found = 0;
+		for (auto key : keys) {
+			found += s.find(key) != s.end();
+		}
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+// lower_bound() of random keys, then visit the next 100 elements
+template<typename S>
+static void range_scan_benchmark(benchmark::State& state) {
+	const int n = state.range(0);
+	S s;
+	fill(s, n);
+	auto const& keys = randomKeys(n);
+
+	size_t i = 0;
+	for (auto _ : state) {
+		long long sum = 0;
+		auto iter = s.lower_bound(keys[i++ % keys.size()]);
+		for (int j = 0; j != 100 && iter != s.end(); ++j, ++iter) {
+			sum += *iter;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+}
+
+static void SkipListInsert(benchmark::State& state)
+{ insert_benchmark<SkipList<int>>(state); }
+
+static void MySetInsert(benchmark::State& state)
+{ insert_benchmark<Set<int>>(state); }
+
+static void SkipListFind(benchmark::State& state)
+{ find_benchmark<SkipList<int>>(state); }
+
+static void MySetFind(benchmark::State& state)
+{ find_benchmark<Set<int>>(state); }
+
+static void SkipListRangeScan(benchmark::State& state)
+{ range_scan_benchmark<SkipList<int>>(state); }
+
+static void MySetRangeScan(benchmark::State& state)
+{ range_scan_benchmark<Set<int>>(state); }
+
+BENCHMARK(SkipListInsert)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetInsert)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(SkipListFind)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetFind)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(SkipListRangeScan)->RangeMultiplier(100)->Range(100, N);
+BENCHMARK(MySetRangeScan)->RangeMultiplier(100)->Range(100, N);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,139 @@
+#include "skiplist.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <string>
+
+#define N 20000
+
+using namespace zstl;
+
+template<typename S, typename T>
+void expectSame(S const& s, std::set<T> const& stl) {
+	ASSERT_EQ(s.size(), stl.size());
+
+	auto iter = s.begin();
+	for (auto const& x : stl) {
+		ASSERT_EQ(*iter, x);
+		++iter;
+	}
+	EXPECT_EQ(iter, s.end());
+
+	// backward
+	auto riter = s.rbegin();
+	for (auto it = stl.rbegin(); it != stl.rend(); ++it) {
+		ASSERT_EQ(*riter, *it);
+		++riter;
+	}
+	EXPECT_EQ(riter, s.rend());
+}
+
+TEST(SkipList, random) {
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> dist(0, N);
+	SkipList<int> s;
+	std::set<int> stl;
+
+	EXPECT_TRUE(s.empty());
+	EXPECT_EQ(s.begin(), s.end());
+
+	for (int i = 0; i != N; ++i) {
+		const int x = dist(gen);
+		EXPECT_EQ(s.insert(x).second, stl.insert(x).second);
+	}
+	expectSame(s, stl);
+
+	for (int i = 0; i != N; ++i) {
+		const int x = dist(gen);
+		EXPECT_EQ(s.contains(x), stl.count(x) == 1);
+		EXPECT_EQ(*s.lower_bound(x), *stl.lower_bound(x));
+		auto upper = s.upper_bound(x);
+		if (upper == s.end()) {
+			EXPECT_EQ(stl.upper_bound(x), stl.end());
+		} else {
+			EXPECT_EQ(*upper, *stl.upper_bound(x));
+		}
+	}
+
+	for (int i = 0; i != N; ++i) {
+		const int x = dist(gen);
+		EXPECT_EQ(s.erase(x), stl.erase(x));
+	}
+	expectSame(s, stl);
+
+	// erase by iterator
+	auto iter = s.find(*stl.begin());
+	while (iter != s.end()) {
+		stl.erase(*iter);
+		iter = s.erase(iter);
+		if (iter != s.end())
+			++iter;
+	}
+	expectSame(s, stl);
+}
+
+TEST(SkipList, emplace) {
+	SkipList<std::string> s;
+	EXPECT_TRUE(s.emplace(3, 'a').second);
+	EXPECT_FALSE(s.emplace("aaa").second);
+	EXPECT_TRUE(s.insert(s.end(), "b").second);
+	EXPECT_EQ(*s.begin(), "aaa");
+	EXPECT_EQ(*s.rbegin(), "b");
+
+	auto range = s.equal_range("aaa");
+	EXPECT_EQ(*range.first, "aaa");
+	EXPECT_EQ(*range.second, "b");
+	EXPECT_EQ(s.count("c"), 0);
+}
+
+TEST(SkipList, copyAndMove) {
+	Vector<std::string> sorted;
+	std::set<std::string> stl;
+	for (int i = 0; i != N; ++i) {
+		sorted.push_back(std::to_string(i));
+		stl.insert(sorted.back());
+	}
+	zstl::sort(sorted.begin(), sorted.end());
+	// duplicates are skipped
+	sorted.push_back(sorted.back());
+
+	SkipList<std::string> s;
+	s.assign_sorted(sorted.begin(), sorted.end());
+	expectSame(s, stl);
+
+	SkipList<std::string> copy(s);
+	expectSame(copy, stl);
+	EXPECT_TRUE(copy == s);
+	copy.erase("0");
+	EXPECT_TRUE(copy != s);
+	EXPECT_TRUE(s < copy);
+
+	SkipList<std::string> moved(STL_MOVE(s));
+	expectSame(moved, stl);
+	EXPECT_TRUE(s.empty());
+	EXPECT_EQ(s.begin(), s.end());
+
+	// the moved list is still usable
+	EXPECT_TRUE(moved.insert("z").second);
+	EXPECT_TRUE(moved.erase("z"));
+	expectSame(moved, stl);
+
+	s = copy;
+	moved.swap(s);
+	expectSame(s, stl);
+	EXPECT_EQ(moved, copy);
+
+	moved.erase(moved.begin(), moved.end());
+	EXPECT_TRUE(moved.empty());
+	s.clear();
+	EXPECT_TRUE(s.empty());
+	EXPECT_TRUE(s.insert("a").second);
+}
+
+int main()
+{
+	::testing::InitGoogleTest();
+	return RUN_ALL_TESTS();
+}
@@ -117,6 +117,44 @@ TEST(stl_algorithm, transform) {
 
 }
 
+TEST(stl_algorithm, sort) {
+  srand(42);
+  // short range, long range and many duplicates
+  for (int n : { 0, 1, 10, 1000, 100000 }) {
+    zstl::Vector<int> vec;
+    for (int i = 0; i != n; ++i)
+      vec.push_back(rand() % (n / 2 + 1));
+
+    zstl::sort(vec.begin(), vec.end());
+    for (int i = 1; i < n; ++i)
+      EXPECT_LE(vec[i-1], vec[i]);
+  }
+
+  // descending and presorted input
+  zstl::Vector<int> vec;
+  for (int i = 0; i != 1000; ++i)
+    vec.push_back(i);
+  zstl::sort(vec.begin(), vec.end(), [](int x, int y) { return x > y; });
+  for (int i = 0; i != 1000; ++i)
+    EXPECT_EQ(vec[i], 999 - i);
+  zstl::sort(vec.begin(), vec.end());
+  for (int i = 0; i != 1000; ++i)
+    EXPECT_EQ(vec[i], i);
+}
+
+TEST(stl_algorithm, bound) {
+  zstl::Vector<int> vec{ 1, 2, 2, 2, 5 };
+
+  EXPECT_EQ(zstl::lower_bound(vec.begin(), vec.end(), 2), vec.begin() + 1);
+  EXPECT_EQ(zstl::upper_bound(vec.begin(), vec.end(), 2), vec.begin() + 4);
+  EXPECT_EQ(zstl::upper_bound(vec.begin(), vec.end(), 5), vec.end());
+
+  auto greater = [](int x, int y) { return x > y; };
+  zstl::Vector<int> desc{ 5, 2, 2, 1 };
+  EXPECT_EQ(zstl::lower_bound(desc.begin(), desc.end(), 2, greater), desc.begin() + 1);
+  EXPECT_EQ(zstl::upper_bound(desc.begin(), desc.end(), 2, greater), desc.begin() + 3);
+}
+
 int main()
 {
   testing::InitGoogleTest();
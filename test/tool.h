@@ -1,6 +1,7 @@
 #ifndef ZSTL__TOOL_H
 #define ZSTL__TOOL_H
 
+#include <atomic>
 #include <iostream>
 #include <random>
 
@@ -28,7 +29,7 @@ T GetRandom(T f,T l){
     return u(e);
 }
 
-std::string getRandomString(uint64_t len) {
+inline std::string getRandomString(uint64_t len) {
     static char const alphabetAndNumber[] = 
         "abcdefghijklmnopqrstuvwxyz"
         "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -53,4 +54,28 @@ void emplace_backLoop(T& cont, unsigned n, V const& v) {
 		cont.emplace_back(v);
 }
 
+// count the alive objects to check the erased or retired elements are released
+struct Tracked {
+	// a function-local static, so that tool.h can be included by many tests
+	static std::atomic<int>& alive() {
+		static std::atomic<int> n{ 0 };
+		return n;
+	}
+
+	int val;
+
+	Tracked(int v = 0)
+		: val(v)
+	{ ++alive(); }
+
+	Tracked(Tracked const& rhs)
+		: val(rhs.val)
+	{ ++alive(); }
+
+	~Tracked()
+	{ --alive(); }
+
+	Tracked& operator=(Tracked const&) = default;
+};
+
 #endif //ZSTL__TOOL_H
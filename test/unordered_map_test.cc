@@ -0,0 +1,254 @@
+#include "unordered_map.h"
+#include "tool.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace zstl;
+
+#define N 10000
+
+// count the constructions to check no value is wasted
+struct Counted {
+	static int ctor_count;
+
+	int val;
+
+	Counted(int v = 0)
+		: val(v)
+	{ ++ctor_count; }
+
+	Counted(Counted const& rhs)
+		: val(rhs.val)
+	{ ++ctor_count; }
+
+	Counted(Counted&& rhs) noexcept
+		: val(rhs.val)
+	{ }
+
+	Counted& operator=(Counted const&) = default;
+};
+
+int Counted::ctor_count = 0;
+
+TEST(MyUnorderedMap, insert) {
+	using Map = UnorderedMap<std::string, int>;
+	Map m;
+
+	for (int i = 0; i != N; ++i) {
+		auto res = m.insert(Map::value_type(std::to_string(i), i));
+		EXPECT_TRUE(res.second);
+		EXPECT_EQ(res.first->second, i);
+	}
+
+	auto res = m.insert(Map::value_type("0", 1));
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->second, 0);
+	EXPECT_EQ(m.size(), N);
+
+	for (int i = 0; i != N; ++i) {
+		EXPECT_EQ(m.at(std::to_string(i)), i);
+	}
+
+	EXPECT_THROW(m.at("-1"), std::range_error);
+}
+
+TEST(MyUnorderedMap, try_emplace) {
+	UnorderedMap<int, Counted> m;
+
+	Counted::ctor_count = 0;
+	auto res = m.try_emplace(1, 10);
+	EXPECT_TRUE(res.second);
+	EXPECT_EQ(res.first->second.val, 10);
+	EXPECT_EQ(Counted::ctor_count, 1);
+
+	// duplicate key: nothing is constructed
+	res = m.try_emplace(1, 20);
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->second.val, 10);
+	EXPECT_EQ(Counted::ctor_count, 1);
+
+	std::string key = "key";
+	UnorderedMap<std::string, std::string> m2;
+	m2.try_emplace(STL_MOVE(key), 3, 'a');
+	EXPECT_EQ(m2.at("key"), "aaa");
+
+	// args are not moved from if key is exists
+	std::string val = "bbb";
+	m2.try_emplace("key", STL_MOVE(val));
+	EXPECT_EQ(val, "bbb");
+	EXPECT_EQ(m2.at("key"), "aaa");
+
+	// the mapped value is constructed in place
+	struct Pinned {
+		int a, b;
+		Pinned(int x, int y) : a(x), b(y) {}
+		Pinned(Pinned&&) = delete;
+	};
+	UnorderedMap<int, Pinned> m3;
+	EXPECT_TRUE(m3.try_emplace(1, 2, 3).second);
+	EXPECT_EQ(m3.find(1)->second.b, 3);
+}
+
+TEST(MyUnorderedMap, insert_or_assign) {
+	UnorderedMap<std::string, std::string> m;
+
+	auto res = m.insert_or_assign("a", "1");
+	EXPECT_TRUE(res.second);
+	EXPECT_EQ(res.first->second, "1");
+
+	res = m.insert_or_assign("a", "2");
+	EXPECT_FALSE(res.second);
+	EXPECT_EQ(res.first->second, "2");
+	EXPECT_EQ(m.size(), 1);
+}
+
+TEST(MyUnorderedMap, subscript) {
+	UnorderedMap<std::string, int> m;
+
+	for (int i = 0; i != N; ++i) {
+		++m[std::to_string(i % 100)];
+	}
+
+	EXPECT_EQ(m.size(), 100);
+	for (auto const& p : m) {
+		EXPECT_EQ(p.second, N / 100);
+	}
+}
+
+TEST(MyUnorderedMap, erase) {
+	UnorderedMap<int, int> m;
+
+	for (int i = 0; i != N; ++i) {
+		m[i] = i;
+	}
+
+	for (int i = 0; i != N; i += 2) {
+		EXPECT_EQ(m.erase(i), 1);
+	}
+
+	EXPECT_EQ(m.size(), N / 2);
+	EXPECT_EQ(m.count(0), 0);
+	EXPECT_EQ(m.count(1), 1);
+
+	auto range = m.equal_range(1);
+	EXPECT_EQ(range.first->second, 1);
+	EXPECT_EQ(++range.first, range.second);
+}
+
+TEST(MyUnorderedMap, heterogeneous) {
+	UnorderedMap<std::string, int, string_hash, equal_to<>> m;
+
+	for (int i = 0; i != N; ++i) {
+		m[std::to_string(i)] = i;
+	}
+
+	// tokens of a buffer, not null-terminated
+	std::string buf = "1234 99999 abc";
+	string_view token(buf.data(), 4);
+
+	auto iter = m.find(token);
+	ASSERT_NE(iter, m.end());
+	EXPECT_EQ(iter->second, 1234);
+
+	EXPECT_EQ(m.count(string_view(buf.data() + 5, 5)), 0);
+	EXPECT_FALSE(m.contains(string_view(buf.data() + 11, 3)));
+	EXPECT_TRUE(m.contains("9999"));
+	EXPECT_TRUE(m.contains(string_view("42")));
+
+	auto const& cm = m;
+	EXPECT_EQ(cm.find(string_view("7"))->second, 7);
+
+	// the batched lookup of non-const map returns mutable iterators,
+	// instead of converting out to const_iterator*
+	using HMap = decltype(m);
+	void (HMap::*batch)(string_view const*, HMap::size_type, HMap::iterator*) = &HMap::find_batch;
+	string_view keys[] = { token, string_view(buf.data() + 11, 3), "42" };
+	HMap::iterator out[3];
+	(m.*batch)(keys, 3, out);
+	ASSERT_NE(out[0], m.end());
+	EXPECT_EQ(out[1], m.end());
+	ASSERT_NE(out[2], m.end());
+	out[0]->second = -1;
+	EXPECT_EQ(m["1234"], -1);
+	EXPECT_EQ(out[2]->first, "42");
+}
+
+TEST(MyUnorderedMap, extract) {
+	UnorderedMap<int, Counted> src, dst;
+
+	for (int i = 0; i != N; ++i) {
+		src.try_emplace(i, i);
+	}
+
+	Counted::ctor_count = 0;
+	auto addr = &*src.find(1);
+	auto nh = src.extract(1);
+	ASSERT_FALSE(nh.empty());
+	EXPECT_EQ(src.size(), N - 1);
+	EXPECT_FALSE(src.contains(1));
+	EXPECT_EQ(nh.value().second.val, 1);
+
+	// the node is relinked, not copied
+	auto res = dst.insert(STL_MOVE(nh));
+	EXPECT_TRUE(res.inserted);
+	EXPECT_TRUE(res.node.empty());
+	EXPECT_TRUE(nh.empty());
+	EXPECT_EQ(&*res.position, addr);
+	EXPECT_EQ(dst.find(1)->second.val, 1);
+
+	// duplicate key, the node is given back
+	nh = src.extract(src.find(2));
+	nh.value().second.val = 3;
+	dst.try_emplace(2, 2);
+	res = dst.insert(STL_MOVE(nh));
+	EXPECT_FALSE(res.inserted);
+	ASSERT_FALSE(res.node.empty());
+	EXPECT_EQ(res.node.value().second.val, 3);
+	EXPECT_EQ(res.position->second.val, 2);
+	EXPECT_EQ(Counted::ctor_count, 1);
+
+	EXPECT_TRUE(src.extract(-1).empty());
+	res = dst.insert(src.extract(-1));
+	EXPECT_FALSE(res.inserted);
+	EXPECT_EQ(res.position, dst.end());
+}
+
+TEST(MyUnorderedMultiMap, insert) {
+	// inverted index: word -> document
+	UnorderedMultiMap<std::string, int> index;
+	for (int doc = 0; doc != N; ++doc) {
+		index.insert(UnorderedMultiMap<std::string, int>::value_type(
+			"w" + std::to_string(doc % 10), doc));
+		index.emplace("all", doc);
+	}
+
+	EXPECT_EQ(index.size(), 2 * N);
+	EXPECT_EQ(index.count("all"), N);
+	EXPECT_EQ(index.count("w3"), N / 10);
+	EXPECT_EQ(index.count("none"), 0);
+
+	int docs = 0;
+	auto range = index.equal_range("w3");
+	for (; range.first != range.second; ++range.first) {
+		EXPECT_EQ(range.first->second % 10, 3);
+		++docs;
+	}
+	EXPECT_EQ(docs, N / 10);
+
+	// node handle
+	auto nh = index.extract("w3");
+	EXPECT_EQ(nh.value().first, "w3");
+	EXPECT_EQ(index.count("w3"), N / 10 - 1);
+	index.insert(STL_MOVE(nh));
+	EXPECT_EQ(index.count("w3"), N / 10);
+
+	EXPECT_EQ(index.erase("all"), N);
+	EXPECT_FALSE(index.contains("all"));
+	EXPECT_EQ(index.size(), N);
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
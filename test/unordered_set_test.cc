@@ -0,0 +1,241 @@
+#include "unordered_set.h"
+#include "tool.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <unordered_set>
+
+using namespace zstl;
+
+#define N 10000
+
+TEST(MyUnorderedSet, insert) {
+	UnorderedSet<std::string> s;
+
+	for (int i = 0; i != N; ++i) {
+		auto res = s.insert(std::to_string(i));
+		EXPECT_TRUE(res.second);
+		EXPECT_EQ(*res.first, std::to_string(i));
+	}
+
+	for (int i = 0; i != N; ++i) {
+		auto res = s.insert(std::to_string(i));
+		EXPECT_FALSE(res.second);
+		EXPECT_EQ(*res.first, std::to_string(i));
+	}
+
+	EXPECT_EQ(s.size(), N);
+	EXPECT_LE(s.load_factor(), 1.0);
+}
+
+TEST(MyUnorderedSet, emplace) {
+	UnorderedSet<std::string> s;
+
+	EXPECT_TRUE(s.emplace(3, 'a').second);
+	EXPECT_FALSE(s.emplace("aaa").second);
+	EXPECT_TRUE(s.contains("aaa"));
+	EXPECT_EQ(s.size(), 1);
+}
+
+TEST(MyUnorderedSet, find) {
+	UnorderedSet<int> s;
+
+	s.insert(2);
+	s.insert(10);
+	s.insert(100);
+
+	auto f1 = s.find(10);
+	EXPECT_NE(f1, s.end());
+	EXPECT_EQ(*f1, 10);
+
+	EXPECT_EQ(s.find(9), s.end());
+	EXPECT_EQ(s.count(2), 1);
+	EXPECT_EQ(s.count(3), 0);
+
+	auto range = s.equal_range(100);
+	EXPECT_NE(range.first, range.second);
+	EXPECT_EQ(*range.first, 100);
+	EXPECT_EQ(++range.first, range.second);
+
+	range = s.equal_range(101);
+	EXPECT_EQ(range.first, s.end());
+	EXPECT_EQ(range.second, s.end());
+}
+
+TEST(MyUnorderedSet, heterogeneous) {
+	UnorderedSet<std::string, string_hash, equal_to<>> s;
+	for (int i = 0; i != N; ++i) {
+		s.insert(std::to_string(i));
+	}
+
+	EXPECT_TRUE(s.contains(string_view("42")));
+
+	using HSet = decltype(s);
+	void (HSet::*batch)(string_view const*, HSet::size_type, HSet::iterator*) = &HSet::find_batch;
+	string_view keys[] = { "1", "abc", "9999" };
+	HSet::iterator out[3];
+	(s.*batch)(keys, 3, out);
+	ASSERT_NE(out[0], s.end());
+	EXPECT_EQ(*out[0], "1");
+	EXPECT_EQ(out[1], s.end());
+	ASSERT_NE(out[2], s.end());
+	EXPECT_EQ(*out[2], "9999");
+}
+
+TEST(MyUnorderedSet, erase) {
+	UnorderedSet<int> s;
+
+	for (int i = 0; i < N; ++i) {
+		s.insert(i);
+	}
+
+	for (int i = 0; i < N; i += 2) {
+		EXPECT_EQ(s.erase(i), 1);
+	}
+
+	EXPECT_EQ(s.erase(0), 0);
+	EXPECT_EQ(s.size(), N / 2);
+
+	for (int i = 0; i < N; ++i) {
+		EXPECT_EQ(s.contains(i), i % 2 == 1);
+	}
+
+	for (auto iter = s.begin(); iter != s.end(); ) {
+		iter = s.erase(iter);
+	}
+
+	EXPECT_TRUE(s.empty());
+	EXPECT_EQ(s.begin(), s.end());
+}
+
+TEST(MyUnorderedSet, incrementalErase) {
+	UnorderedSet<int> s(RehashPolicy::Incremental);
+
+	for (int i = 0; i < N; ++i) {
+		s.insert(i);
+
+		// erase while the migration is in progress
+		if (s.rep().isRehashing() && i % 3 == 0) {
+			EXPECT_EQ(s.erase(i / 2), 1);
+			EXPECT_FALSE(s.contains(i / 2));
+			s.insert(i / 2);
+		}
+	}
+
+	std::unordered_set<int> visited;
+	for (auto x : s) {
+		visited.insert(x);
+	}
+
+	EXPECT_EQ(s.size(), N);
+	EXPECT_EQ(visited.size(), N);
+}
+
+TEST(MyUnorderedSet, merge) {
+	UnorderedSet<int> dst(RehashPolicy::Incremental);
+	UnorderedSet<int> src(RehashPolicy::Incremental);
+
+	// src is rehashing, half of keys are also in dst
+	for (int i = 0; i < N; ++i) {
+		src.insert(i);
+	}
+	for (int i = 0; i < N; i += 2) {
+		dst.insert(i);
+	}
+	while (!src.rep().isRehashing()) {
+		src.insert(N + (int)src.size());
+	}
+
+	const auto total = src.size();
+	std::unordered_set<int const*> nodes;
+	for (auto& x : src) {
+		if (x % 2 == 1 || x >= N) {
+			nodes.insert(&x);
+		}
+	}
+
+	dst.merge(src);
+	EXPECT_EQ(src.size(), N / 2);
+	EXPECT_EQ(dst.size(), total);
+
+	// duplicate keys are left in src
+	int left = 0;
+	for (auto x : src) {
+		EXPECT_EQ(x % 2, 0);
+		EXPECT_LT(x, N);
+		++left;
+	}
+	EXPECT_EQ(left, N / 2);
+
+	std::unordered_set<int> visited;
+	for (auto& x : dst) {
+		visited.insert(x);
+		if (x % 2 == 1 || x >= N) {
+			EXPECT_EQ(nodes.count(&x), 1);
+		}
+	}
+	EXPECT_EQ(visited.size(), total);
+
+	dst.merge(dst);
+	EXPECT_EQ(dst.size(), total);
+
+	dst.merge(UnorderedSet<int>{});
+	EXPECT_EQ(dst.size(), total);
+}
+
+TEST(MyUnorderedMultiSet, insert) {
+	UnorderedMultiSet<int> s;
+	for (int i = 0; i != N; ++i) {
+		s.insert(i % 100);
+	}
+
+	EXPECT_EQ(s.size(), N);
+	EXPECT_EQ(s.count(42), N / 100);
+	EXPECT_EQ(s.erase(42), N / 100);
+	EXPECT_EQ(s.count(42), 0);
+	EXPECT_EQ(s.size(), N - N / 100);
+}
+
+TEST(MyUnorderedSet, copy) {
+	UnorderedSet<std::string> s;
+
+	for (int i = 0; i < N; ++i) {
+		s.insert(std::to_string(i));
+	}
+
+	UnorderedSet<std::string> s2(s);
+	EXPECT_EQ(s2.size(), s.size());
+	for (auto const& x : s) {
+		EXPECT_TRUE(s2.contains(x));
+	}
+
+	UnorderedSet<std::string> s3;
+	s3.insert("a");
+	s3 = s2;
+	EXPECT_FALSE(s3.contains("a"));
+	EXPECT_EQ(s3.size(), N);
+
+	UnorderedSet<std::string> s4(STL_MOVE(s3));
+	EXPECT_EQ(s4.size(), N);
+	EXPECT_TRUE(s3.empty());
+	EXPECT_EQ(s3.find("1"), s3.end());
+}
+
+TEST(MyUnorderedSet, reserve) {
+	UnorderedSet<int> s;
+
+	s.reserve(N);
+	auto bucket_count = s.bucket_count();
+	EXPECT_GE(bucket_count, N);
+
+	for (int i = 0; i < N; ++i) {
+		s.insert(i);
+	}
+
+	EXPECT_EQ(s.bucket_count(), bucket_count);
+}
+
+int main(int argc, char* argv[]) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -103,7 +103,11 @@ TEST(MyVecBehaviour, erase_range) {
 	vec.erase(it5, it8);
 
 	auto il = { 0, 1, 2, 3, 4, 8, 9 };
+	EXPECT_EQ(vec.size(), il.size());
 	EXPECT_EQ(zstl::lexicographical_compare(vec.begin(), vec.end(), il.begin(), il.end()), 0);
+
+	vec.clear();
+	EXPECT_TRUE(vec.empty());
 }
 
 int main(int argc, char* argv[])
@@ -12,11 +12,11 @@ template<typename FI, typename T,
 bool binary_search(FI first, FI last, T const val) {
   using Diff = Iter_diff_type<FI>;
 
-  Diff n = distance(first, last);
-  Diff half = n / 2;
+  Diff n = zstl::distance(first, last);
 
   while (n > 0) {
-    auto mid = advance_iter(first, half);
+    Diff half = n / 2;
+    auto mid = zstl::advance_iter(first, half);
 
     if (*mid < val) {
       first = ++mid;
@@ -44,11 +44,11 @@ template<typename FI, typename T,
 FI lower_bound(FI first,FI last,T const& val) {
   using Diff = Iter_diff_type<FI>;
 
-  Diff n = distance(first, last);
-  Diff half = n / 2;
+  Diff n = zstl::distance(first, last);
 
   while (n > 0) {
-    auto mid = advance_iter(first, half);
+    Diff half = n / 2;
+    auto mid = zstl::advance_iter(first, half);
 
     if (*mid < val) {
       first = ++mid;
@@ -62,6 +62,68 @@ FI lower_bound(FI first,FI last,T const& val) {
   return first;
 }
 
+/**
+ * @brief lower_bound() whose elements are compared by @p cmp(element, val)
+ */
+template<typename FI, typename T, typename Compare,
+  STL_ENABLE_IF((is_forward_iterator<FI>::value), int)>
+FI lower_bound(FI first, FI last, T const& val, Compare cmp) {
+  using Diff = Iter_diff_type<FI>;
+
+  Diff n = zstl::distance(first, last);
+
+  while (n > 0) {
+    Diff half = n / 2;
+    auto mid = zstl::advance_iter(first, half);
+
+    if (cmp(*mid, val)) {
+      first = ++mid;
+      n -= half + 1;
+    }
+    else {
+      n = half;
+    }
+  }
+
+  return first;
+}
+
+/**
+ * @brief find the first iterator whose value > val
+ * @param first @param last bounds of a range
+ * @param val value in [ @p first , @p last ) which should >
+ * @param cmp predicate which is called as cmp(val, element)
+ * @return see brief
+ */
+template<typename FI, typename T, typename Compare,
+  STL_ENABLE_IF((is_forward_iterator<FI>::value), int)>
+FI upper_bound(FI first, FI last, T const& val, Compare cmp) {
+  using Diff = Iter_diff_type<FI>;
+
+  Diff n = zstl::distance(first, last);
+
+  while (n > 0) {
+    Diff half = n / 2;
+    auto mid = zstl::advance_iter(first, half);
+
+    if (!cmp(val, *mid)) {
+      first = ++mid;
+      n -= half + 1;
+    }
+    else {
+      n = half;
+    }
+  }
+
+  return first;
+}
+
+template<typename FI, typename T,
+  STL_ENABLE_IF((is_forward_iterator<FI>::value), int)>
+FI upper_bound(FI first, FI last, T const& val) {
+  return zstl::upper_bound(first, last, val, zstl::less<T>{});
+}
+
 /**
  * @brief Like binary_search() @see binary_search()
  * @param first @param last bounds of a range
@@ -0,0 +1,149 @@
+namespace detail {
+
+// ranges not longer than it are left to the final insertion sort
+constexpr int SORT_THRESHOLD = 16;
+
+template<typename RI, typename Compare>
+void unguarded_linear_insert(RI last, Compare& cmp) {
+  auto val = STL_MOVE(*last);
+  auto next = last;
+  --next;
+  while (cmp(val, *next)) {
+    *last = STL_MOVE(*next);
+    last = next;
+    --next;
+  }
+  *last = STL_MOVE(val);
+}
+
+template<typename RI, typename Compare>
+void insertion_sort(RI first, RI last, Compare& cmp) {
+  if (first == last)
+    return;
+
+  for (auto i = first + 1; i != last; ++i) {
+    if (cmp(*i, *first)) {
+      // the new minimum, shift [first, i) right by one
+      auto val = STL_MOVE(*i);
+      for (auto j = i; j != first; --j) {
+        *j = STL_MOVE(*(j - 1));
+      }
+      *first = STL_MOVE(val);
+    } else {
+      // *first is the sentinel
+      unguarded_linear_insert(i, cmp);
+    }
+  }
+}
+
+template<typename RI, typename Diff, typename T, typename Compare>
+void sift_down(RI first, Diff hole, Diff len, T val, Compare& cmp) {
+  Diff child;
+  while ((child = 2 * hole + 1) < len) {
+    if (child + 1 < len && cmp(first[child], first[child + 1]))
+      ++child;
+    if (!cmp(val, first[child]))
+      break;
+    first[hole] = STL_MOVE(first[child]);
+    hole = child;
+  }
+  first[hole] = STL_MOVE(val);
+}
+
+template<typename RI, typename Compare>
+void heap_sort(RI first, RI last, Compare& cmp) {
+  using Diff = Iter_diff_type<RI>;
+  const Diff len = last - first;
+
+  for (Diff i = len / 2 - 1; i >= 0; --i) {
+    sift_down(first, i, len, STL_MOVE(first[i]), cmp);
+  }
+
+  for (Diff n = len - 1; n > 0; --n) {
+    auto val = STL_MOVE(first[n]);
+    first[n] = STL_MOVE(*first);
+    sift_down(first, Diff(0), n, STL_MOVE(val), cmp);
+  }
+}
+
+// move the median of *a, *b and *c to *result
+template<typename RI, typename Compare>
+void move_median_to_first(RI result, RI a, RI b, RI c, Compare& cmp) {
+  if (cmp(*a, *b)) {
+    if (cmp(*b, *c))
+      zstl::iter_swap(result, b);
+    else if (cmp(*a, *c))
+      zstl::iter_swap(result, c);
+    else
+      zstl::iter_swap(result, a);
+  } else if (cmp(*a, *c)) {
+    zstl::iter_swap(result, a);
+  } else if (cmp(*b, *c)) {
+    zstl::iter_swap(result, c);
+  } else {
+    zstl::iter_swap(result, b);
+  }
+}
+
+// Hoare partition around *pivot, the median of three are the sentinels
+template<typename RI, typename Compare>
+RI unguarded_partition(RI first, RI last, RI pivot, Compare& cmp) {
+  for (;;) {
+    while (cmp(*first, *pivot))
+      ++first;
+    --last;
+    while (cmp(*pivot, *last))
+      --last;
+    if (!(first < last))
+      return first;
+    zstl::iter_swap(first, last);
+    ++first;
+  }
+}
+
+template<typename RI, typename Compare>
+void intro_sort_loop(RI first, RI last, int depth, Compare& cmp) {
+  while (last - first > SORT_THRESHOLD) {
+    if (depth == 0) {
+      heap_sort(first, last, cmp);
+      return;
+    }
+    --depth;
+
+    move_median_to_first(first, first + 1, first + (last - first) / 2, last - 1, cmp);
+    auto cut = unguarded_partition(first + 1, last, first, cmp);
+    // recurse on the right part, loop on the left part
+    intro_sort_loop(cut, last, depth, cmp);
+    last = cut;
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief sort [ @p first, @p last ) by @p cmp, the order of equal elements is not kept
+ * @param first @param last bounds of a range
+ * @note
+ * Introsort: quick sort with median-of-three pivot, which falls back to heap sort
+ * when recursion is deeper than 2lgn, so O(nlgn) in the worst case.
+ * The short partitions are left unsorted and finished by one insertion sort pass.
+ */
+template<typename RI, typename Compare,
+  STL_ENABLE_IF((is_random_access_iterator<RI>::value), int)>
+void sort(RI first, RI last, Compare cmp) {
+  if (last - first < 2)
+    return;
+
+  int depth = 0;
+  for (auto n = last - first; n > 1; n >>= 1)
+    depth += 2;
+
+  detail::intro_sort_loop(first, last, depth, cmp);
+  detail::insertion_sort(first, last, cmp);
+}
+
+template<typename RI,
+  STL_ENABLE_IF((is_random_access_iterator<RI>::value), int)>
+void sort(RI first, RI last) {
+  zstl::sort(first, last, zstl::less<Iter_value_type<RI>>{});
+}
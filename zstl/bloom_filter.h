@@ -0,0 +1,226 @@
+#ifndef ZSTL_BLOOM_FILTER_H
+#define ZSTL_BLOOM_FILTER_H
+
+#include "config.h"
+#include "hash_aux.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace zstl {
+
+inline unsigned popCount(uint64_t x) ZSTL_NOEXCEPT {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    unsigned n = 0;
+    for (; x != 0; x &= x - 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * @class BlockedBloomFilter
+ * @tparam K key type
+ * @tparam Hash hash function of key(default is zstl::hash)
+ * @brief
+ * Approximate membership: contains() may report a key which is not inserted
+ * (false positive), but never misses a key inserted.
+ * All the bits of a key are in one 64-byte block, so query touches only
+ * one cache line instead of k random ones of classic bloom filter,
+ * at the cost of a slightly higher false positive rate.
+ * @see Putze, Sanders, Singler. Cache-, Hash- and Space-Efficient Bloom Filters
+ */
+template<typename K, typename Hash = zstl::hash<K>>
+class BlockedBloomFilter {
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t BLOCK_WORDS = 8;
+    static constexpr size_t BLOCK_BITS = WORD_BITS * BLOCK_WORDS;
+    static constexpr size_t BLOCK_BYTES = BLOCK_WORDS * sizeof(uint64_t);
+public:
+    using key_type = K;
+    using size_type = size_t;
+
+    // the number of keys processed together by *_batch()
+    static constexpr size_type BATCH_SIZE = 16;
+
+    /**
+     * @param expected the number of keys expected to insert
+     * @param bitsPerKey memory budget, 10 bits gives about 1% false positive
+     */
+    explicit BlockedBloomFilter(size_type expected, double bitsPerKey = 10, Hash hash = Hash{})
+        : hash_(hash)
+        , numBlocks_{ blocksFor(expected, bitsPerKey) }
+        , numProbes_{ probesFor(bitsPerKey) }
+        // one more block for aligning blocks to cache line
+        , storage_((numBlocks_ + 1) * BLOCK_WORDS, 0)
+        , blocks_{ alignBlocks(storage_.begin()) }
+    { }
+
+    BlockedBloomFilter(BlockedBloomFilter const&) = delete;
+    BlockedBloomFilter& operator=(BlockedBloomFilter const&) = delete;
+
+    void insert(K const& key) ZSTL_NOEXCEPT
+    { insertHash(hashOf(key)); }
+
+    bool contains(K const& key) const ZSTL_NOEXCEPT
+    { return containsHash(hashOf(key)); }
+
+    /**
+     * @brief insert @p n keys
+     * @note the blocks of a group are prefetched before they are modified
+     */
+    void insert_batch(K const* keys, size_type n) ZSTL_NOEXCEPT {
+        uint64_t hashes[BATCH_SIZE];
+
+        for (size_type first = 0; first < n; first += BATCH_SIZE) {
+            const auto len = n - first < BATCH_SIZE ? n - first : BATCH_SIZE;
+            prefetchGroup(keys + first, len, hashes);
+            for (size_type i = 0; i != len; ++i) {
+                insertHash(hashes[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief query @p n keys, out[i] is the result of keys[i]
+     * @note the cache misses of a group are overlapped
+     */
+    void contains_batch(K const* keys, size_type n, bool* out) const ZSTL_NOEXCEPT {
+        uint64_t hashes[BATCH_SIZE];
+
+        for (size_type first = 0; first < n; first += BATCH_SIZE) {
+            const auto len = n - first < BATCH_SIZE ? n - first : BATCH_SIZE;
+            prefetchGroup(keys + first, len, hashes);
+            for (size_type i = 0; i != len; ++i) {
+                out[first + i] = containsHash(hashes[i]);
+            }
+        }
+    }
+
+    void clear() ZSTL_NOEXCEPT {
+        for (size_type i = 0; i != numBlocks_ * BLOCK_WORDS; ++i) {
+            blocks_[i] = 0;
+        }
+        size_ = 0;
+    }
+
+    /**
+     * @brief the probability that a key not inserted is reported,
+     * estimated by the fill ratio of each block
+     * @note O(memory), don't call it in hot path
+     */
+    double falsePositiveRate() const ZSTL_NOEXCEPT {
+        double sum = 0;
+        for (size_type b = 0; b != numBlocks_; ++b) {
+            unsigned set = 0;
+            for (size_type w = 0; w != BLOCK_WORDS; ++w) {
+                set += popCount(blocks_[b * BLOCK_WORDS + w]);
+            }
+            sum += pow(static_cast<double>(set) / BLOCK_BITS, numProbes_);
+        }
+        return sum / numBlocks_;
+    }
+
+    // the number of insert() call, including duplicate keys
+    size_type size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return numBlocks_ * BLOCK_BYTES; }
+
+    double bitsPerKey() const ZSTL_NOEXCEPT
+    { return size_ ? static_cast<double>(memoryBytes()) * 8 / size_ : 0; }
+
+    int numProbes() const ZSTL_NOEXCEPT
+    { return numProbes_; }
+
+private:
+    static size_type blocksFor(size_type expected, double bitsPerKey) ZSTL_NOEXCEPT {
+        const auto bits = static_cast<double>(expected ? expected : 1) * bitsPerKey;
+        const auto blocks = static_cast<size_type>(ceil(bits / BLOCK_BITS));
+        return blocks ? blocks : 1;
+    }
+
+    // k = ln2 * m / n minimizes the false positive rate
+    static int probesFor(double bitsPerKey) ZSTL_NOEXCEPT {
+        const auto k = static_cast<int>(bitsPerKey * 0.693 + 0.5);
+        return k < 1 ? 1 : (k > 16 ? 16 : k);
+    }
+
+    static uint64_t* alignBlocks(uint64_t* storage) ZSTL_NOEXCEPT {
+        const auto addr = reinterpret_cast<uintptr_t>(storage);
+        return reinterpret_cast<uint64_t*>(
+            (addr + BLOCK_BYTES - 1) / BLOCK_BYTES * BLOCK_BYTES);
+    }
+
+    uint64_t hashOf(K const& key) const ZSTL_NOEXCEPT
+    { return hashMix64(hash_(key)); }
+
+    // high 32 bits select the block without division
+    uint64_t* blockOf(uint64_t h) const ZSTL_NOEXCEPT
+    { return blocks_ + ((h >> 32) * numBlocks_ >> 32) * BLOCK_WORDS; }
+
+    // The bits in block are taken from the top bits of h * C^i,
+    // which depend on all bits of h
+    static uint64_t nextProbe(uint64_t x) ZSTL_NOEXCEPT
+    { return x * 0x9e3779b97f4a7c15ULL; }
+
+    static uint64_t probeMask(uint64_t x) ZSTL_NOEXCEPT
+    { return uint64_t(1) << ((x >> 58) & (WORD_BITS - 1)); }
+
+    static size_type probeWord(uint64_t x) ZSTL_NOEXCEPT
+    { return (x >> 55) & (BLOCK_WORDS - 1); }
+
+    void insertHash(uint64_t h) ZSTL_NOEXCEPT {
+        const auto block = blockOf(h);
+        auto x = h;
+
+        for (int i = 0; i != numProbes_; ++i) {
+            x = nextProbe(x);
+            block[probeWord(x)] |= probeMask(x);
+        }
+
+        ++size_;
+    }
+
+    bool containsHash(uint64_t h) const ZSTL_NOEXCEPT {
+        const auto block = blockOf(h);
+        auto x = h;
+
+        for (int i = 0; i != numProbes_; ++i) {
+            x = nextProbe(x);
+            if ((block[probeWord(x)] & probeMask(x)) == 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void prefetchGroup(K const* keys, size_type n, uint64_t* hashes) const ZSTL_NOEXCEPT {
+        for (size_type i = 0; i != n; ++i) {
+            hashes[i] = hashOf(keys[i]);
+            ZSTL_PREFETCH(blockOf(hashes[i]));
+        }
+    }
+
+    Hash hash_;
+    size_type numBlocks_;
+    int numProbes_;
+    Vector<uint64_t> storage_;
+    // aligned to cache line, point to storage_
+    uint64_t* blocks_;
+    size_type size_ = 0;
+};
+
+template<typename K, typename Hash>
+constexpr typename BlockedBloomFilter<K, Hash>::size_type BlockedBloomFilter<K, Hash>::BATCH_SIZE;
+
+} // namespace zstl
+
+#endif // ZSTL_BLOOM_FILTER_H
@@ -0,0 +1,212 @@
+#ifndef ZSTL_BTREE_MAP_H
+#define ZSTL_BTREE_MAP_H
+
+#include "functional.h"
+#include "stl_btree.h"
+
+namespace zstl {
+
+/**
+ * @class BTreeMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two keys
+ * @tparam Alloc allocator
+ * @tparam NODE_BYTES the size of values in one node
+ * @brief ordered map based on BTree, the key is unique
+ * @note
+ * Unlike Map, insertion and erasure invalidate all iterators,
+ * try_emplace(), insert_or_assign() and operator[] search by key first
+ */
+template<typename K, typename T,
+    typename Compare = zstl::less<K>,
+    typename Alloc = zstl::allocator<zstl::pair<K const, T>>,
+    size_t NODE_BYTES = 256>
+class BTreeMap {
+public:
+    using Rep = BTree<K, zstl::pair<K const, T>, get_first<K const, T>, Compare, Alloc, NODE_BYTES>;
+    using key_type = typename Rep::key_type;
+    using mapped_type = T;
+    using value_type = typename Rep::value_type;
+    using key_compare = typename Rep::key_compare;
+    using allocator_type = typename Rep::allocator_type;
+    using pointer = typename Rep::pointer;
+    using const_pointer = typename Rep::const_pointer;
+    using reference = typename Rep::reference;
+    using const_reference = typename Rep::const_reference;
+    using size_type = typename Rep::size_type;
+    using difference_type = typename Rep::difference_type;
+    using iterator = typename Rep::iterator;
+    using const_iterator = typename Rep::const_iterator;
+    using reverse_iterator = typename Rep::reverse_iterator;
+    using const_reverse_iterator = typename Rep::const_reverse_iterator;
+    using Res = zstl::pair<iterator, bool>;
+
+    BTreeMap() = default;
+
+    // iterator interface
+    iterator begin() ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    iterator end() ZSTL_NOEXCEPT
+    { return rep_.end(); }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return rep_.end(); }
+
+    const_iterator cbegin() const ZSTL_NOEXCEPT
+    { return rep_.cbegin(); }
+
+    const_iterator cend() const ZSTL_NOEXCEPT
+    { return rep_.cend(); }
+
+    reverse_iterator rbegin() ZSTL_NOEXCEPT
+    { return rep_.rbegin(); }
+
+    const_reverse_iterator rbegin() const ZSTL_NOEXCEPT
+    { return rep_.rbegin(); }
+
+    reverse_iterator rend() ZSTL_NOEXCEPT
+    { return rep_.rend(); }
+
+    const_reverse_iterator rend() const ZSTL_NOEXCEPT
+    { return rep_.rend(); }
+
+    // capacity
+    size_type size() const ZSTL_NOEXCEPT
+    { return rep_.size(); }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return rep_.empty(); }
+
+    // element access
+    T& operator[](key_type const& key)
+    { return try_emplace(key).first->second; }
+
+    T& operator[](key_type&& key)
+    { return try_emplace(STL_MOVE(key)).first->second; }
+
+    T& at(key_type const& key) {
+        auto iter = find(key);
+        THROW_RANGE_ERROR_IF(iter == end(), "BTreeMap::at(): key is not exists");
+        return iter->second;
+    }
+
+    T const& at(key_type const& key) const {
+        auto iter = find(key);
+        THROW_RANGE_ERROR_IF(iter == end(), "BTreeMap::at(): key is not exists");
+        return iter->second;
+    }
+
+    // modifiers
+    void clear() ZSTL_NOEXCEPT
+    { rep_.clear(); }
+
+    Res insert(value_type const& x)
+    { return rep_.InsertUnique(x); }
+
+    Res insert(value_type&& x)
+    { return rep_.InsertUnique(STL_MOVE(x)); }
+
+    template<typename II>
+    void insert(II first, II last)
+    { rep_.InsertUnique(first, last); }
+
+    template<typename... Args>
+    Res emplace(Args&&... args)
+    { return rep_.EmplaceUnique(STL_FORWARD(Args, args)...); }
+
+    // construct mapped value from @p args only if @p key is not in map
+    template<typename... Args>
+    Res try_emplace(key_type const& key, Args&&... args)
+    { return rep_.TryEmplaceUnique(key, emplace_second, key, STL_FORWARD(Args, args)...); }
+
+    template<typename... Args>
+    Res try_emplace(key_type&& key, Args&&... args)
+    { return rep_.TryEmplaceUnique(key, emplace_second, STL_MOVE(key), STL_FORWARD(Args, args)...); }
+
+    template<typename M>
+    Res insert_or_assign(key_type const& key, M&& obj) {
+        auto res = rep_.TryEmplaceUnique(key, emplace_second, key, STL_FORWARD(M, obj));
+        if (!res.second) {
+            res.first->second = STL_FORWARD(M, obj);
+        }
+        return res;
+    }
+
+    template<typename M>
+    Res insert_or_assign(key_type&& key, M&& obj) {
+        auto res = rep_.TryEmplaceUnique(key, emplace_second, STL_MOVE(key), STL_FORWARD(M, obj));
+        if (!res.second) {
+            res.first->second = STL_FORWARD(M, obj);
+        }
+        return res;
+    }
+
+    iterator erase(const_iterator pos)
+    { return rep_.erase(pos); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    { return rep_.erase(first, last); }
+
+    size_type erase(key_type const& key)
+    { return rep_.EraseUnique(key); }
+
+    void swap(BTreeMap& rhs) ZSTL_NOEXCEPT
+    { rep_.swap(rhs.rep_); }
+
+    // lookup
+    size_type count(key_type const& key) const
+    { return rep_.contains(key) ? 1 : 0; }
+
+    iterator find(key_type const& key)
+    { return rep_.find(key); }
+
+    const_iterator find(key_type const& key) const
+    { return rep_.find(key); }
+
+    bool contains(key_type const& key) const
+    { return rep_.contains(key); }
+
+    zstl::pair<iterator, iterator> equal_range(key_type const& key)
+    { return rep_.equal_range(key); }
+
+    zstl::pair<const_iterator, const_iterator> equal_range(key_type const& key) const
+    { return rep_.equal_range(key); }
+
+    iterator lower_bound(key_type const& key)
+    { return rep_.lower_bound(key); }
+
+    const_iterator lower_bound(key_type const& key) const
+    { return rep_.lower_bound(key); }
+
+    iterator upper_bound(key_type const& key)
+    { return rep_.upper_bound(key); }
+
+    const_iterator upper_bound(key_type const& key) const
+    { return rep_.upper_bound(key); }
+
+    key_compare key_comp() const
+    { return rep_.key_comp(); }
+
+    // the bytes of nodes, for statistics
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return rep_.memoryBytes(); }
+
+    Rep const& rep() const ZSTL_NOEXCEPT
+    { return rep_; }
+
+private:
+    Rep rep_;
+};
+
+template<typename K, typename T, typename CP, typename Alloc, size_t B>
+inline void swap(BTreeMap<K, T, CP, Alloc, B>& x, BTreeMap<K, T, CP, Alloc, B>& y) ZSTL_NOEXCEPT
+{ x.swap(y); }
+
+} // namespace zstl
+
+#endif // ZSTL_BTREE_MAP_H
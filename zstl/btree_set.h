@@ -0,0 +1,147 @@
+#ifndef ZSTL_BTREE_SET_H
+#define ZSTL_BTREE_SET_H
+
+#include "functional.h"
+#include "stl_btree.h"
+
+namespace zstl {
+
+/**
+ * @class BTreeSet
+ * @tparam T key type
+ * @tparam Compare predicate that compare two keys
+ * @tparam Alloc allocator
+ * @tparam NODE_BYTES the size of values in one node
+ * @brief ordered set based on BTree, it is more compact and cache-friendly than Set
+ * @note unlike Set, insertion and erasure invalidate all iterators
+ */
+template<typename T,
+    typename Compare = zstl::less<T>,
+    typename Alloc = zstl::allocator<T>,
+    size_t NODE_BYTES = 256>
+class BTreeSet {
+public:
+    using Rep = BTree<T, T, identity<T>, Compare, Alloc, NODE_BYTES>;
+    using key_type = typename Rep::key_type;
+    using value_type = typename Rep::value_type;
+    using key_compare = typename Rep::key_compare;
+    using allocator_type = typename Rep::allocator_type;
+    using pointer = typename Rep::const_pointer;
+    using const_pointer = typename Rep::const_pointer;
+    using reference = typename Rep::const_reference;
+    using const_reference = typename Rep::const_reference;
+    using size_type = typename Rep::size_type;
+    using difference_type = typename Rep::difference_type;
+    // the key can't be modified through iterator
+    using iterator = typename Rep::const_iterator;
+    using const_iterator = typename Rep::const_iterator;
+    using reverse_iterator = typename Rep::const_reverse_iterator;
+    using const_reverse_iterator = typename Rep::const_reverse_iterator;
+    using Res = zstl::pair<iterator, bool>;
+
+    BTreeSet() = default;
+
+    template<typename II>
+    BTreeSet(II first, II last)
+    { rep_.InsertUnique(first, last); }
+
+    // iterator interface
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return rep_.end(); }
+
+    const_iterator cbegin() const ZSTL_NOEXCEPT
+    { return rep_.cbegin(); }
+
+    const_iterator cend() const ZSTL_NOEXCEPT
+    { return rep_.cend(); }
+
+    const_reverse_iterator rbegin() const ZSTL_NOEXCEPT
+    { return rep_.rbegin(); }
+
+    const_reverse_iterator rend() const ZSTL_NOEXCEPT
+    { return rep_.rend(); }
+
+    // capacity
+    bool empty() const ZSTL_NOEXCEPT
+    { return rep_.empty(); }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return rep_.size(); }
+
+    // modifiers
+    Res insert(value_type const& val)
+    { return toConst(rep_.InsertUnique(val)); }
+
+    Res insert(value_type&& val)
+    { return toConst(rep_.InsertUnique(STL_MOVE(val))); }
+
+    template<typename II>
+    void insert(II first, II last)
+    { rep_.InsertUnique(first, last); }
+
+    template<typename... Args>
+    Res emplace(Args&&... args)
+    { return toConst(rep_.EmplaceUnique(STL_FORWARD(Args, args)...)); }
+
+    iterator erase(const_iterator pos)
+    { return rep_.erase(pos); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    { return rep_.erase(first, last); }
+
+    size_type erase(key_type const& key)
+    { return rep_.EraseUnique(key); }
+
+    void clear() ZSTL_NOEXCEPT
+    { rep_.clear(); }
+
+    void swap(BTreeSet& rhs) ZSTL_NOEXCEPT
+    { rep_.swap(rhs.rep_); }
+
+    // lookup
+    size_type count(key_type const& key) const
+    { return rep_.contains(key) ? 1 : 0; }
+
+    const_iterator find(key_type const& key) const
+    { return rep_.find(key); }
+
+    bool contains(key_type const& key) const
+    { return rep_.contains(key); }
+
+    zstl::pair<const_iterator, const_iterator> equal_range(key_type const& key) const
+    { return rep_.equal_range(key); }
+
+    const_iterator lower_bound(key_type const& key) const
+    { return rep_.lower_bound(key); }
+
+    const_iterator upper_bound(key_type const& key) const
+    { return rep_.upper_bound(key); }
+
+    key_compare key_comp() const
+    { return rep_.key_comp(); }
+
+    // the bytes of nodes, for statistics
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return rep_.memoryBytes(); }
+
+    Rep const& rep() const ZSTL_NOEXCEPT
+    { return rep_; }
+
+private:
+    // zstl::pair has no converting constructor
+    static Res toConst(zstl::pair<typename Rep::iterator, bool> const& res) ZSTL_NOEXCEPT
+    { return Res(res.first, res.second); }
+
+    Rep rep_;
+};
+
+template<typename T, typename CP, typename Alloc, size_t B>
+inline void swap(BTreeSet<T, CP, Alloc, B>& x, BTreeSet<T, CP, Alloc, B>& y) ZSTL_NOEXCEPT
+{ x.swap(y); }
+
+} // namespace zstl
+
+#endif // ZSTL_BTREE_SET_H
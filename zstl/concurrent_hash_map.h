@@ -0,0 +1,565 @@
+#ifndef ZSTL_CONCURRENT_HASH_MAP_H
+#define ZSTL_CONCURRENT_HASH_MAP_H
+
+#include "allocator.h"
+#include "epoch.h"
+#include "functional.h"
+#include "hash_aux.h"
+#include "noncopyable.h"
+#include "stl_exception.h"
+#include "stl_utility.h"
+#include "hash_table/hash_node.h"
+#include "util/aligned_new.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace zstl {
+
+/**
+ * @class ConcurrentHashMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Hash hash function of key
+ * @tparam KeyEqual predicate that compare two keys whether they are equivalent
+ * @brief
+ * Chaining hash map shared by threads, the key is unique.
+ * (1) Writers lock the stripe which the bucket belongs to,
+ * bucket i belongs to stripe i % STRIPES.
+ * (2) Readers don't lock, they walk the chain in an EpochGuard.
+ * A published node is never modified except its link,
+ * insert_or_assign() replaces the node instead of assigning the value,
+ * and erased nodes are released by EpochManager after readers leave.
+ * (3) Resize locks all stripes and builds a new table with copied nodes,
+ * then publishes it. Readers keep walking the old table meanwhile,
+ * which is released as a whole like erased nodes.
+ * @note
+ * There are no iterators and references to the elements,
+ * because the element may be released once lookup returns.
+ * Use find() to copy the mapped value or visit() to read it in place.
+ */
+template<typename K, typename T,
+	typename Hash = zstl::hash<K>,
+	typename KeyEqual = zstl::equal_to<K>>
+class ConcurrentHashMap : noncopyable, public AlignedNew<64> {
+	using Node = ConcurrentHashNode<zstl::pair<K const, T>>;
+	using NodeAllocator = zstl::allocator<Node>;
+	using Bucket = std::atomic<Node*>;
+
+	struct Table {
+		explicit Table(std::size_t n)
+			: size{ n }
+			, buckets{ new Bucket[n] }
+		{
+			for (std::size_t i = 0; i != n; ++i) {
+				buckets[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~Table() { delete[] buckets; }
+
+		std::size_t size;
+		Bucket* buckets;
+	};
+
+	// pad to cache line to avoid false sharing between stripes
+	struct alignas(64) Stripe {
+		std::mutex mutex;
+		// the number of elements in the buckets of this stripe,
+		// only modified with mutex held
+		std::atomic<std::size_t> count{ 0 };
+	};
+
+public:
+	using key_type = K;
+	using mapped_type = T;
+	using value_type = zstl::pair<K const, T>;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	using size_type = std::size_t;
+
+	static constexpr size_type STRIPES = 128;
+
+	explicit ConcurrentHashMap(size_type bucket_count = 0,
+			Hash const& hf = Hash(), KeyEqual const& eq = KeyEqual())
+		: hash_{ hf }
+		, equal_{ eq }
+		, table_{ new Table(nextPrime(
+				bucket_count < STRIPES ? STRIPES : bucket_count)) }
+	{ }
+
+	// no other thread can access it
+	~ConcurrentHashMap() {
+		auto table = table_.load(std::memory_order_relaxed);
+		destroyTable(table);
+	}
+
+	// lookup
+	/**
+	 * @brief copy the mapped value of @p key to @p out if it exists
+	 * @return whether key exists
+	 */
+	bool find(key_type const& key, mapped_type& out) const {
+		return visit(key, [&out](mapped_type const& val) {
+			out = val;
+		});
+	}
+
+	bool contains(key_type const& key) const {
+		EpochGuard guard;
+		return findNode(key) != nullptr;
+	}
+
+	size_type count(key_type const& key) const
+	{ return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief call @p f with the mapped value of @p key if it exists
+	 * @note
+	 * @p f must not modify the map, and the reference to value
+	 * should not escape from @p f
+	 */
+	template<typename F>
+	bool visit(key_type const& key, F f) const {
+		EpochGuard guard;
+		auto node = findNode(key);
+
+		if (node != nullptr) {
+			f(static_cast<mapped_type const&>(node->val.second));
+			return true;
+		}
+
+		return false;
+	}
+
+	// modifiers
+	bool insert(value_type const& x)
+	{ return try_emplace(x.first, x.second); }
+
+	/**
+	 * @brief insert value constructed from key and @p args if key is not exists
+	 * @return whether the value is inserted
+	 */
+	template<typename... Args>
+	bool try_emplace(key_type const& key, Args&&... args);
+
+	/**
+	 * @brief if key is exists, replace the mapped value with @p obj,
+	 * otherwise insert it just like try_emplace()
+	 * @return whether the value is inserted
+	 */
+	template<typename M>
+	bool insert_or_assign(key_type const& key, M&& obj);
+
+	size_type erase(key_type const& key);
+
+	void clear();
+
+	// capacity
+	/**
+	 * @return the number of elements
+	 * @note the result may be stale when other threads are modifying
+	 */
+	size_type size() const ZSTL_NOEXCEPT;
+
+	bool empty() const ZSTL_NOEXCEPT
+	{ return size() == 0; }
+
+	size_type bucket_count() const ZSTL_NOEXCEPT {
+		EpochGuard guard;
+		return table_.load(std::memory_order_acquire)->size;
+	}
+
+	hasher hash_function() const
+	{ return hash_; }
+
+	key_equal key_eq() const
+	{ return equal_; }
+
+private:
+	// bucket locked by writer, the table can't be replaced until it is unlocked
+	struct LockedBucket {
+		std::unique_lock<std::mutex> lock;
+		Table* table;
+		Bucket* head;
+		Stripe* stripe;
+	};
+
+	size_type bucketIndex(key_type const& key, size_type slots) const
+	{ return hashDivision(hash_(key), slots); }
+
+	// must be called in EpochGuard
+	Node* findNode(key_type const& key) const;
+	LockedBucket lockBucket(key_type const& key);
+
+	// return the link pointing to node whose key is equivalent to key,
+	// or the link which is null if there is no such node
+	Bucket* findLink(Bucket* head, key_type const& key) const;
+
+	// grow if the stripe is overloaded, must be called without lock held
+	void growIfNeeded(Table* table, size_type stripeCount);
+	void grow(Table* table);
+
+	void lockAll();
+	void unlockAll() ZSTL_NOEXCEPT;
+
+	template<typename... Args>
+	static Node* newNode(Args&&... args);
+	static void destroyNode(Node* node) ZSTL_NOEXCEPT;
+	static void destroyTable(Table* table) ZSTL_NOEXCEPT;
+
+	// deleters used by EpochManager
+	static void deleteNode(void* p)
+	{ destroyNode(static_cast<Node*>(p)); }
+
+	static void deleteTable(void* p)
+	{ destroyTable(static_cast<Table*>(p)); }
+
+	Hash hash_;
+	KeyEqual equal_;
+	std::atomic<Table*> table_;
+	Stripe stripes_[STRIPES];
+};
+
+#define TEMPLATE_OF_CONCURRENT_HASH_MAP \
+	template<typename K, typename T, typename Hash, typename KeyEqual>
+
+#define CONCURRENT_HASH_MAP \
+	ConcurrentHashMap<K, T, Hash, KeyEqual>
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+constexpr typename CONCURRENT_HASH_MAP::size_type CONCURRENT_HASH_MAP::STRIPES;
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+auto
+CONCURRENT_HASH_MAP::findNode(key_type const& key) const
+-> Node* {
+	auto table = table_.load(std::memory_order_acquire);
+	auto& head = table->buckets[bucketIndex(key, table->size)];
+
+	for (auto node = head.load(std::memory_order_acquire);
+		 node != nullptr;
+		 node = node->next.load(std::memory_order_acquire)) {
+		if (equal_(node->val.first, key)) {
+			return node;
+		}
+	}
+
+	return nullptr;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+auto
+CONCURRENT_HASH_MAP::lockBucket(key_type const& key)
+-> LockedBucket {
+	for (;;) {
+		auto table = table_.load(std::memory_order_acquire);
+		const auto index = bucketIndex(key, table->size);
+		auto& stripe = stripes_[index % STRIPES];
+
+		std::unique_lock<std::mutex> lock(stripe.mutex);
+
+		// the table is replaced with all stripes locked,
+		// so it is stable if it is not replaced before we lock
+		if (table_.load(std::memory_order_relaxed) == table) {
+			return LockedBucket{ STL_MOVE(lock), table, &table->buckets[index], &stripe };
+		}
+	}
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+auto
+CONCURRENT_HASH_MAP::findLink(Bucket* head, key_type const& key) const
+-> Bucket* {
+	auto link = head;
+
+	for (auto node = link->load(std::memory_order_relaxed);
+		 node != nullptr;
+		 node = link->load(std::memory_order_relaxed)) {
+		if (equal_(node->val.first, key)) {
+			break;
+		}
+		link = &node->next;
+	}
+
+	return link;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+template<typename... Args>
+bool
+CONCURRENT_HASH_MAP::try_emplace(key_type const& key, Args&&... args) {
+	EpochGuard guard;
+	Table* table;
+	size_type count;
+
+	{
+		auto bucket = lockBucket(key);
+		auto link = findLink(bucket.head, key);
+
+		if (link->load(std::memory_order_relaxed) != nullptr) {
+			return false;
+		}
+
+		auto node = newNode(key, T(STL_FORWARD(Args, args)...));
+		node->next.store(bucket.head->load(std::memory_order_relaxed),
+						 std::memory_order_relaxed);
+		// publish the initialized node to readers
+		bucket.head->store(node, std::memory_order_release);
+
+		table = bucket.table;
+		count = bucket.stripe->count.load(std::memory_order_relaxed) + 1;
+		bucket.stripe->count.store(count, std::memory_order_relaxed);
+	}
+
+	growIfNeeded(table, count);
+	return true;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+template<typename M>
+bool
+CONCURRENT_HASH_MAP::insert_or_assign(key_type const& key, M&& obj) {
+	EpochGuard guard;
+	Table* table;
+	size_type count;
+
+	{
+		auto bucket = lockBucket(key);
+		auto link = findLink(bucket.head, key);
+		auto old = link->load(std::memory_order_relaxed);
+
+		if (old != nullptr) {
+			// readers may be reading old value, replace the node
+			auto node = newNode(key, STL_FORWARD(M, obj));
+			node->next.store(old->next.load(std::memory_order_relaxed),
+							 std::memory_order_relaxed);
+			link->store(node, std::memory_order_release);
+			bucket.lock.unlock();
+
+			EpochManager::instance().retire(old, &deleteNode);
+			return false;
+		}
+
+		auto node = newNode(key, STL_FORWARD(M, obj));
+		node->next.store(bucket.head->load(std::memory_order_relaxed),
+						 std::memory_order_relaxed);
+		bucket.head->store(node, std::memory_order_release);
+
+		table = bucket.table;
+		count = bucket.stripe->count.load(std::memory_order_relaxed) + 1;
+		bucket.stripe->count.store(count, std::memory_order_relaxed);
+	}
+
+	growIfNeeded(table, count);
+	return true;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+auto
+CONCURRENT_HASH_MAP::erase(key_type const& key)
+-> size_type {
+	EpochGuard guard;
+	Node* node;
+
+	{
+		auto bucket = lockBucket(key);
+		auto link = findLink(bucket.head, key);
+		node = link->load(std::memory_order_relaxed);
+
+		if (node == nullptr) {
+			return 0;
+		}
+
+		// the link of erased node is kept,
+		// so the readers on it can continue
+		link->store(node->next.load(std::memory_order_relaxed),
+					std::memory_order_release);
+
+		auto& count = bucket.stripe->count;
+		count.store(count.load(std::memory_order_relaxed) - 1,
+					std::memory_order_relaxed);
+	}
+
+	EpochManager::instance().retire(node, &deleteNode);
+	return 1;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::clear() {
+	EpochGuard guard;
+	lockAll();
+
+	auto table = table_.load(std::memory_order_relaxed);
+	Table* fresh;
+
+	TRY_BEGIN
+		fresh = new Table(table->size);
+	TRY_END
+	CATCH_ALL_BEGIN
+		unlockAll();
+		RETHROW
+	CATCH_END
+
+	for (auto& stripe : stripes_) {
+		stripe.count.store(0, std::memory_order_relaxed);
+	}
+
+	table_.store(fresh, std::memory_order_release);
+	unlockAll();
+
+	EpochManager::instance().retire(table, &deleteTable);
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+auto
+CONCURRENT_HASH_MAP::size() const ZSTL_NOEXCEPT
+-> size_type {
+	size_type n = 0;
+	for (auto& stripe : stripes_) {
+		n += stripe.count.load(std::memory_order_relaxed);
+	}
+
+	return n;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::growIfNeeded(Table* table, size_type stripeCount) {
+	// load factor of this stripe exceeds 1.0
+	if (stripeCount > table->size / STRIPES + 1) {
+		grow(table);
+	}
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::grow(Table* table) {
+	lockAll();
+
+	// other thread has resized it, or the load of table is uneven
+	if (table_.load(std::memory_order_relaxed) != table ||
+		size() < table->size) {
+		unlockAll();
+		return ;
+	}
+
+	const auto nextSize = nextPrime(table->size + 1);
+	if (nextSize <= table->size) {
+		unlockAll();
+		return ;
+	}
+
+	Table* newTable = nullptr;
+
+	TRY_BEGIN
+		newTable = new Table(nextSize);
+
+		// readers are walking the old table, so the nodes are copied
+		for (size_type i = 0; i != table->size; ++i) {
+			for (auto node = table->buckets[i].load(std::memory_order_relaxed);
+				 node != nullptr;
+				 node = node->next.load(std::memory_order_relaxed)) {
+				auto& head = newTable->buckets[bucketIndex(node->val.first, nextSize)];
+				auto copy = newNode(node->val);
+				copy->next.store(head.load(std::memory_order_relaxed),
+								 std::memory_order_relaxed);
+				head.store(copy, std::memory_order_relaxed);
+			}
+		}
+	TRY_END
+	CATCH_ALL_BEGIN
+		if (newTable != nullptr) {
+			destroyTable(newTable);
+		}
+		unlockAll();
+		RETHROW
+	CATCH_END
+
+	for (auto& stripe : stripes_) {
+		stripe.count.store(0, std::memory_order_relaxed);
+	}
+
+	for (size_type i = 0; i != nextSize; ++i) {
+		size_type n = 0;
+		for (auto node = newTable->buckets[i].load(std::memory_order_relaxed);
+			 node != nullptr;
+			 node = node->next.load(std::memory_order_relaxed)) {
+			++n;
+		}
+
+		auto& count = stripes_[i % STRIPES].count;
+		count.store(count.load(std::memory_order_relaxed) + n,
+					std::memory_order_relaxed);
+	}
+
+	// publish the new table with all nodes initialized
+	table_.store(newTable, std::memory_order_release);
+	unlockAll();
+
+	EpochManager::instance().retire(table, &deleteTable);
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::lockAll() {
+	// writer holds at most one stripe, lock in order to avoid deadlock
+	for (auto& stripe : stripes_) {
+		stripe.mutex.lock();
+	}
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::unlockAll() ZSTL_NOEXCEPT {
+	for (auto& stripe : stripes_) {
+		stripe.mutex.unlock();
+	}
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+template<typename... Args>
+auto
+CONCURRENT_HASH_MAP::newNode(Args&&... args)
+-> Node* {
+	NodeAllocator alloc;
+	Node* node = alloc.allocate();
+
+	TRY_BEGIN
+		alloc.construct(node, value_type(STL_FORWARD(Args, args)...));
+	TRY_END
+	CATCH_ALL_BEGIN
+		alloc.deallocate(node);
+		RETHROW
+	CATCH_END
+
+	return node;
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::destroyNode(Node* node) ZSTL_NOEXCEPT {
+	NodeAllocator alloc;
+	alloc.destroy(node);
+	alloc.deallocate(node);
+}
+
+TEMPLATE_OF_CONCURRENT_HASH_MAP
+void
+CONCURRENT_HASH_MAP::destroyTable(Table* table) ZSTL_NOEXCEPT {
+	for (size_type i = 0; i != table->size; ++i) {
+		auto node = table->buckets[i].load(std::memory_order_relaxed);
+		while (node != nullptr) {
+			auto next = node->next.load(std::memory_order_relaxed);
+			destroyNode(node);
+			node = next;
+		}
+	}
+
+	delete table;
+}
+
+} // namespace zstl
+
+#endif // ZSTL_CONCURRENT_HASH_MAP_H
@@ -0,0 +1,224 @@
+#ifndef ZSTL_CONCURRENT_ORDERED_MAP_H
+#define ZSTL_CONCURRENT_ORDERED_MAP_H
+
+#include "epoch.h"
+#include "noncopyable.h"
+#include "persistent_map.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace zstl {
+
+/**
+ * @class ConcurrentOrderedMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two keys
+ * @brief
+ * Ordered map shared by threads, the key is unique, which is read-optimized.
+ * (1) The elements are kept in versions of PersistentMap, the current version
+ * is published by an atomic pointer and never modified.
+ * (2) Readers don't lock, they load the current version in an EpochGuard and
+ * search it, so a range scan sees a consistent view of one version.
+ * (3) Writers are serialized by a mutex, the writer modifies its own copy
+ * which only copies the O(lgn) path shared with the current version,
+ * then publishes the copy and retires the old version to EpochManager.
+ * @note
+ * Like ConcurrentHashMap, there are no iterators,
+ * use visit() or scan() to read in place, or snapshot() to keep a version.
+ * update() applies a batch of modifications and publishes them once.
+ */
+template<typename K, typename T,
+	typename Compare = zstl::less<K>>
+class ConcurrentOrderedMap : noncopyable {
+	struct Version {
+		PersistentMap<K, T, Compare> map;
+	};
+
+public:
+	using Snapshot = PersistentMap<K, T, Compare>;
+	using key_type = K;
+	using mapped_type = T;
+	using value_type = zstl::pair<K const, T>;
+	using key_compare = Compare;
+	using size_type = std::size_t;
+
+	ConcurrentOrderedMap()
+		: current_{ new Version }
+	{ }
+
+	explicit ConcurrentOrderedMap(Compare const& cmp)
+		: master_{ cmp }
+		, current_{ new Version{ master_ } }
+	{ }
+
+	// no other thread can access it
+	~ConcurrentOrderedMap()
+	{ delete current_.load(std::memory_order_relaxed); }
+
+	// lookup
+	/**
+	 * @brief copy the mapped value of @p key to @p out if it exists
+	 * @return whether key exists
+	 */
+	bool find(key_type const& key, mapped_type& out) const {
+		EpochGuard guard;
+		return version()->map.find(key, out);
+	}
+
+	/**
+	 * @brief call @p f with the mapped value of @p key if it exists
+	 * @note the reference to value should not escape from @p f
+	 */
+	template<typename F>
+	bool visit(key_type const& key, F f) const {
+		EpochGuard guard;
+		return version()->map.visit(key, f);
+	}
+
+	bool contains(key_type const& key) const {
+		EpochGuard guard;
+		return version()->map.contains(key);
+	}
+
+	size_type count(key_type const& key) const
+	{ return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief call @p f with each element in [ @p first, @p last ) in order
+	 * @note
+	 * All elements are from one version, i.e. the modifications
+	 * published during the scan are not observed.
+	 * @p f should be short since the retired versions are kept until it returns.
+	 */
+	template<typename F>
+	void scan(key_type const& first, key_type const& last, F f) const {
+		EpochGuard guard;
+		auto const& map = version()->map;
+		auto cmp = map.key_comp();
+
+		for (auto iter = map.lower_bound(first);
+			iter != map.end() && cmp(iter->first, last); ++iter) {
+			f(*iter);
+		}
+	}
+
+	// call @p f with each element in order, like scan()
+	template<typename F>
+	void forEach(F f) const {
+		EpochGuard guard;
+		for (auto const& x : version()->map) {
+			f(x);
+		}
+	}
+
+	/**
+	 * @brief get the current version, which can be kept and iterated without guard
+	 * @note O(1)
+	 */
+	Snapshot snapshot() const {
+		EpochGuard guard;
+		return version()->map;
+	}
+
+	// modifiers
+	bool insert(value_type const& x)
+	{ return try_emplace(x.first, x.second); }
+
+	/**
+	 * @brief insert value constructed from key and @p args if key is not exists
+	 * @return whether the value is inserted
+	 */
+	template<typename... Args>
+	bool try_emplace(key_type const& key, Args&&... args) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		const bool inserted = master_.try_emplace(key, STL_FORWARD(Args, args)...);
+		if (inserted)
+			publish();
+		return inserted;
+	}
+
+	/**
+	 * @brief if key is exists, replace the mapped value with @p obj,
+	 * otherwise insert it just like try_emplace()
+	 * @return whether the value is inserted
+	 */
+	template<typename M>
+	bool insert_or_assign(key_type const& key, M&& obj) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		const bool inserted = master_.insert_or_assign(key, STL_FORWARD(M, obj));
+		publish();
+		return inserted;
+	}
+
+	size_type erase(key_type const& key) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		const auto n = master_.erase(key);
+		if (n != 0)
+			publish();
+		return n;
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		master_.clear();
+		publish();
+	}
+
+	/**
+	 * @brief call @p f with the writable map, then publish the result once
+	 * @note
+	 * Readers observe all modifications of @p f or none of them.
+	 * @p f works on a copy of the map(O(1)), which replaces it only after
+	 * @p f returns, so nothing is kept if @p f throws.
+	 */
+	template<typename F>
+	void update(F f) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto map = master_;
+		f(map);
+		master_.swap(map);
+		publish();
+	}
+
+	// capacity
+	/**
+	 * @return the number of elements in the current version
+	 * @note the result may be stale when other threads are modifying
+	 */
+	size_type size() const {
+		EpochGuard guard;
+		return version()->map.size();
+	}
+
+	bool empty() const
+	{ return size() == 0; }
+
+	key_compare key_comp() const
+	{ return master_.key_comp(); }
+
+private:
+	// must be called in EpochGuard
+	Version const* version() const ZSTL_NOEXCEPT
+	{ return current_.load(std::memory_order_acquire); }
+
+	// must be called with mutex held
+	void publish() {
+		auto old = current_.exchange(new Version{ master_ }, std::memory_order_acq_rel);
+		EpochManager::instance().retire(old, &deleteVersion);
+	}
+
+	// deleter used by EpochManager
+	static void deleteVersion(void* p)
+	{ delete static_cast<Version*>(p); }
+
+	// the map modified by writer, which shares nodes with the current version
+	Snapshot master_;
+	std::atomic<Version*> current_;
+	std::mutex mutex_;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_CONCURRENT_ORDERED_MAP_H
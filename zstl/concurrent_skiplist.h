@@ -0,0 +1,413 @@
+#ifndef ZSTL_CONCURRENT_SKIPLIST_H
+#define ZSTL_CONCURRENT_SKIPLIST_H
+
+#include "allocator.h"
+#include "epoch.h"
+#include "functional.h"
+#include "noncopyable.h"
+#include "skiplist.h"
+#include "stl_exception.h"
+#include "stl_utility.h"
+
+#include <atomic>
+#include <new>
+#include <stdint.h>
+
+namespace zstl {
+
+namespace detail {
+
+/**
+ * @struct ConcurrentSkipListNode
+ * @brief
+ * Node of ConcurrentSkipList, the links of its levels follow it in the same block.
+ * The lowest bit of links()[i] marks the node is erased at level i.
+ * @note The node is never constructed as a whole, the fields are constructed one by one.
+ */
+template<typename V>
+struct ConcurrentSkipListNode {
+	using Link = std::atomic<ConcurrentSkipListNode*>;
+
+	V val;
+	// the inserter and the eraser, the last one retires the node
+	std::atomic<int> owners;
+	int height;
+
+	Link* links() ZSTL_NOEXCEPT
+	{ return reinterpret_cast<Link*>(this + 1); }
+};
+
+} // namespace detail
+
+/**
+ * @class ConcurrentSkipList
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two keys
+ * @brief
+ * Ordered map shared by threads based on lock-free skip list, the key is unique,
+ * which is used as ordered index modified by multiple writers.
+ * (1) Readers don't lock and don't write, they walk the links in an EpochGuard.
+ * (2) Writers don't lock, insertion links the node at level 0 by CAS, which is
+ * the linearization point, then links the upper levels one by one.
+ * (3) Erasure marks the links of node from top to level 0, the one marks level 0
+ * erases it, then the marked node is unlinked by any writer passing it.
+ * The node is retired to EpochManager after both its inserter and eraser
+ * have finished, so it is not linked again at an upper level after being released.
+ * @note
+ * Like ConcurrentHashMap, there are no iterators and the published value is
+ * never modified, use visit() or scan() to read in place.
+ * scan() is not a snapshot, it observes the modifications before it reaches them.
+ * @see Herlihy, Shavit. The Art of Multiprocessor Programming, 14.4
+ */
+template<typename K, typename T,
+	typename Compare = zstl::less<K>>
+class ConcurrentSkipList : noncopyable {
+	using Node = detail::ConcurrentSkipListNode<zstl::pair<K const, T>>;
+	using Link = typename Node::Link;
+
+	// the unit of node block
+	struct alignas(Node) Unit {
+		unsigned char bytes[alignof(Node)];
+	};
+
+	using UnitAllocator = zstl::allocator<Unit>;
+
+public:
+	// supports 4^16 elements in expected O(lgn)
+	static constexpr int MAX_HEIGHT = 16;
+
+	using key_type = K;
+	using mapped_type = T;
+	using value_type = zstl::pair<K const, T>;
+	using key_compare = Compare;
+	using size_type = std::size_t;
+
+	explicit ConcurrentSkipList(Compare const& cmp = Compare())
+		: cmp_{ cmp }
+	{
+		for (int i = 0; i != MAX_HEIGHT; ++i) {
+			new (&head()->links()[i]) Link(nullptr);
+		}
+	}
+
+	// no other thread can access it
+	~ConcurrentSkipList() {
+		auto x = head()->links()[0].load(std::memory_order_relaxed);
+		while (x) {
+			auto next = unmarked(x->links()[0].load(std::memory_order_relaxed));
+			// the erased nodes are unlinked and retired already
+			deleteNode(x);
+			x = next;
+		}
+	}
+
+	// lookup
+	/**
+	 * @brief copy the mapped value of @p key to @p out if it exists
+	 * @return whether key exists
+	 */
+	bool find(key_type const& key, mapped_type& out) const {
+		return visit(key, [&out](mapped_type const& val) {
+			out = val;
+		});
+	}
+
+	/**
+	 * @brief call @p f with the mapped value of @p key if it exists
+	 * @note the reference to value should not escape from @p f
+	 */
+	template<typename F>
+	bool visit(key_type const& key, F f) const {
+		EpochGuard guard;
+		auto x = lowerBound(key);
+		if (x && !cmp_(key, x->val.first)) {
+			f(static_cast<mapped_type const&>(x->val.second));
+			return true;
+		}
+		return false;
+	}
+
+	bool contains(key_type const& key) const {
+		EpochGuard guard;
+		auto x = lowerBound(key);
+		return x && !cmp_(key, x->val.first);
+	}
+
+	size_type count(key_type const& key) const
+	{ return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief call @p f with each element in [ @p first, @p last ) in order
+	 * @note
+	 * The elements inserted or erased concurrently may be observed or not.
+	 * @p f should be short since the retired nodes are kept until it returns.
+	 */
+	template<typename F>
+	void scan(key_type const& first, key_type const& last, F f) const {
+		EpochGuard guard;
+		for (auto x = lowerBound(first); x && cmp_(x->val.first, last); x = nextAlive(x)) {
+			f(static_cast<value_type const&>(x->val));
+		}
+	}
+
+	// call @p f with each element in order, like scan()
+	template<typename F>
+	void forEach(F f) const {
+		EpochGuard guard;
+		for (auto x = nextAlive(head()); x; x = nextAlive(x)) {
+			f(static_cast<value_type const&>(x->val));
+		}
+	}
+
+	// modifiers
+	bool insert(value_type const& x)
+	{ return try_emplace(x.first, x.second); }
+
+	/**
+	 * @brief insert value constructed from key and @p args if key is not exists
+	 * @return whether the value is inserted
+	 * @note the node is allocated after the key is not found
+	 */
+	template<typename... Args>
+	bool try_emplace(key_type const& key, Args&&... args) {
+		EpochGuard guard;
+		Node* preds[MAX_HEIGHT];
+		Node* succs[MAX_HEIGHT];
+		const int height = randomHeight();
+		const int levels = raiseLevel(height);
+		Node* node = nullptr;
+
+		for (;;) {
+			auto x = findPreds(key, preds, succs, levels, false);
+			if (x && !cmp_(key, x->val.first)) {
+				// never published
+				if (node)
+					deleteNode(node);
+				return false;
+			}
+
+			if (!node)
+				node = createNode(height, key, STL_FORWARD(Args, args)...);
+			for (int i = 0; i != height; ++i) {
+				node->links()[i].store(succs[i], std::memory_order_relaxed);
+			}
+
+			auto expected = succs[0];
+			if (preds[0]->links()[0].compare_exchange_strong(expected, node,
+					std::memory_order_release, std::memory_order_relaxed))
+				break;
+		}
+
+		count_.fetch_add(1, std::memory_order_relaxed);
+		linkUpper(node, preds, succs, levels);
+
+		// the links of the upper levels may be made after the eraser unlinks them
+		if (isMarked(node->links()[0].load(std::memory_order_acquire)))
+			findPreds(key, preds, succs, levels, true);
+		release(node);
+		return true;
+	}
+
+	size_type erase(key_type const& key) {
+		EpochGuard guard;
+		Node* preds[MAX_HEIGHT];
+		Node* succs[MAX_HEIGHT];
+		const int levels = level_.load(std::memory_order_acquire);
+
+		auto node = findPreds(key, preds, succs, levels, false);
+		if (!node || cmp_(key, node->val.first))
+			return 0;
+
+		// mark the upper levels first, so the inserter stops linking them
+		for (int i = node->height - 1; i > 0; --i) {
+			auto succ = node->links()[i].load(std::memory_order_acquire);
+			while (!isMarked(succ) &&
+				!node->links()[i].compare_exchange_weak(succ, marked(succ),
+					std::memory_order_acq_rel, std::memory_order_acquire))
+			{ }
+		}
+
+		// who marks level 0 erases it
+		auto succ = node->links()[0].load(std::memory_order_acquire);
+		for (;;) {
+			if (isMarked(succ))
+				return 0;
+			if (node->links()[0].compare_exchange_weak(succ, marked(succ),
+					std::memory_order_acq_rel, std::memory_order_acquire))
+				break;
+		}
+
+		count_.fetch_sub(1, std::memory_order_relaxed);
+		// unlink it from all levels, levels may be loaded before it is raised for node
+		findPreds(key, preds, succs, levels < node->height ? node->height : levels, true);
+		release(node);
+		return 1;
+	}
+
+	// capacity
+	/**
+	 * @return the number of elements
+	 * @note the result may be stale when other threads are modifying
+	 */
+	size_type size() const ZSTL_NOEXCEPT
+	{ return count_.load(std::memory_order_relaxed); }
+
+	bool empty() const ZSTL_NOEXCEPT
+	{ return size() == 0; }
+
+	key_compare key_comp() const
+	{ return cmp_; }
+
+private:
+	static bool isMarked(Node* p) ZSTL_NOEXCEPT
+	{ return reinterpret_cast<uintptr_t>(p) & 1; }
+
+	static Node* marked(Node* p) ZSTL_NOEXCEPT
+	{ return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(p) | 1); }
+
+	static Node* unmarked(Node* p) ZSTL_NOEXCEPT
+	{ return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(p) & ~uintptr_t(1)); }
+
+	Node* head() const ZSTL_NOEXCEPT
+	{ return reinterpret_cast<Node*>(const_cast<Unit*>(head_)); }
+
+	static constexpr std::size_t units(int height) ZSTL_NOEXCEPT
+	{ return (sizeof(Node) + height * sizeof(Link) + sizeof(Unit) - 1) / sizeof(Unit); }
+
+	static int randomHeight() ZSTL_NOEXCEPT {
+		static thread_local uint64_t seed =
+			0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&seed);
+		return static_cast<int>(detail::skipListHeight(detail::xorshift64(seed), MAX_HEIGHT));
+	}
+
+	// @return the number of levels to search, which covers height
+	int raiseLevel(int height) ZSTL_NOEXCEPT {
+		auto level = level_.load(std::memory_order_acquire);
+		while (level < height &&
+			!level_.compare_exchange_weak(level, height, std::memory_order_acq_rel))
+		{ }
+		return level < height ? height : level;
+	}
+
+	template<typename... Args>
+	static Node* createNode(int height, key_type const& key, Args&&... args) {
+		UnitAllocator alloc;
+		auto node = reinterpret_cast<Node*>(alloc.allocate(units(height)));
+		STL_TRY {
+			alloc.construct(&node->val, emplace_second, key, STL_FORWARD(Args, args)...);
+		} CATCH_ALL {
+			alloc.deallocate(reinterpret_cast<Unit*>(node), units(height));
+			RETHROW
+		}
+
+		new (&node->owners) std::atomic<int>(2);
+		node->height = height;
+		for (int i = 0; i != height; ++i) {
+			new (&node->links()[i]) Link(nullptr);
+		}
+		return node;
+	}
+
+	// deleter used by EpochManager
+	static void deleteNode(void* p) {
+		UnitAllocator alloc;
+		auto node = static_cast<Node*>(p);
+		alloc.destroy(&node->val);
+		alloc.deallocate(reinterpret_cast<Unit*>(node), units(node->height));
+	}
+
+	// called by the inserter and the eraser when they have finished
+	static void release(Node* node) {
+		if (node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			EpochManager::instance().retire(node, &deleteNode);
+	}
+
+	/**
+	 * @brief search from the top of @p levels, fill the last node before @p key
+	 * and the next one at each level, unlink the marked nodes on the way
+	 * @param upper if true, skip the nodes equal to key too, i.e. the node of key
+	 * is unlinked from all levels if it is marked
+	 * @return succs[0]
+	 * @note must be called in EpochGuard
+	 */
+	Node* findPreds(key_type const& key, Node** preds, Node** succs, int levels, bool upper) const {
+	retry:
+		auto pred = head();
+		for (int i = levels - 1; i >= 0; --i) {
+			auto curr = unmarked(pred->links()[i].load(std::memory_order_acquire));
+			while (curr) {
+				auto succ = curr->links()[i].load(std::memory_order_acquire);
+				if (isMarked(succ)) {
+					// fails if pred is marked or the link is changed
+					if (!pred->links()[i].compare_exchange_strong(curr, unmarked(succ),
+							std::memory_order_acq_rel, std::memory_order_relaxed))
+						goto retry;
+					curr = unmarked(succ);
+					continue;
+				}
+
+				if (upper ? cmp_(key, curr->val.first) : !cmp_(curr->val.first, key))
+					break;
+				pred = curr;
+				curr = succ;
+			}
+			preds[i] = pred;
+			succs[i] = curr;
+		}
+		return succs[0];
+	}
+
+	// link the upper levels of node until it is marked
+	void linkUpper(Node* node, Node** preds, Node** succs, int levels) {
+		for (int i = 1; i < node->height; ++i) {
+			for (;;) {
+				// only the eraser changes the link before the node is linked at this level
+				auto old = node->links()[i].load(std::memory_order_acquire);
+				if (isMarked(old))
+					return;
+				if (old != succs[i] && !node->links()[i].compare_exchange_strong(old, succs[i],
+						std::memory_order_acq_rel, std::memory_order_acquire))
+					return;
+
+				auto expected = succs[i];
+				if (preds[i]->links()[i].compare_exchange_strong(expected, node,
+						std::memory_order_release, std::memory_order_relaxed))
+					break;
+				findPreds(node->val.first, preds, succs, levels, false);
+			}
+		}
+	}
+
+	// the first node not less than key which is not marked
+	Node* lowerBound(key_type const& key) const {
+		auto pred = head();
+		for (int i = level_.load(std::memory_order_acquire) - 1; i >= 0; --i) {
+			auto curr = unmarked(pred->links()[i].load(std::memory_order_acquire));
+			while (curr && cmp_(curr->val.first, key)) {
+				pred = curr;
+				curr = unmarked(curr->links()[i].load(std::memory_order_acquire));
+			}
+		}
+		auto x = unmarked(pred->links()[0].load(std::memory_order_acquire));
+		return x && isMarked(x->links()[0].load(std::memory_order_acquire)) ? nextAlive(x) : x;
+	}
+
+	// the next node of x at level 0 which is not marked
+	static Node* nextAlive(Node* x) ZSTL_NOEXCEPT {
+		x = unmarked(x->links()[0].load(std::memory_order_acquire));
+		while (x && isMarked(x->links()[0].load(std::memory_order_acquire)))
+			x = unmarked(x->links()[0].load(std::memory_order_acquire));
+		return x;
+	}
+
+	Unit head_[units(MAX_HEIGHT)];
+	// the levels in use, only increased
+	std::atomic<int> level_{ 1 };
+	std::atomic<size_type> count_{ 0 };
+	Compare cmp_;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_CONCURRENT_SKIPLIST_H
@@ -45,4 +45,11 @@ using sz_t=std::size_t;
 #define ZSTL_NOEXCEPT throw()
 #endif
 
+// Hint to load the cache line which contains addr for reading
+#if defined(__GNUC__) || defined(__clang__)
+#define ZSTL_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define ZSTL_PREFETCH(addr) ((void)(addr))
+#endif
+
 #endif //ZSTL_CONFIG_H
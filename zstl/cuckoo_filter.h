@@ -0,0 +1,376 @@
+#ifndef ZSTL_CUCKOO_FILTER_H
+#define ZSTL_CUCKOO_FILTER_H
+
+#include "config.h"
+#include "hash_aux.h"
+#include "type_traits.h"
+#include "vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace zstl {
+
+/**
+ * @class CuckooFilter
+ * @tparam K key type
+ * @tparam Hash hash function of key(default is zstl::hash)
+ * @tparam Fingerprint unsigned integer type which stores fingerprint,
+ * the false positive rate is about 8 / 2^bits at full load
+ * @brief
+ * Approximate membership which supports erase().
+ * Each key is a fingerprint in one of two candidate buckets of 4 slots,
+ * the alternate bucket is computed from current bucket and fingerprint,
+ * so the fingerprint can be kicked to its alternate bucket
+ * without knowing the original key.
+ * @note
+ * insert() fails when the filter is almost full(about 95% load),
+ * after that the filter is still correct but rejects further insert().
+ * Erasing a key that was not inserted may remove other key's fingerprint.
+ * @see Fan, Andersen, Kaminsky, Mitzenmacher. Cuckoo Filter: Practically Better Than Bloom
+ */
+template<typename K, typename Hash = zstl::hash<K>, typename Fingerprint = uint16_t>
+class CuckooFilter {
+    static_assert(Is_unsigned<Fingerprint>::value && sizeof(Fingerprint) <= 4,
+                  "Fingerprint must be unsigned integer no longer than 32 bits");
+
+    static constexpr size_t SLOTS = 4;
+    static constexpr int MAX_KICKS = 500;
+    // fingerprint 0 denotes empty slot
+    static constexpr uint64_t FINGERPRINT_MAX = Fingerprint(~Fingerprint(0));
+public:
+    using key_type = K;
+    using size_type = size_t;
+
+    // the number of keys processed together by contains_batch()
+    static constexpr size_type BATCH_SIZE = 16;
+
+    /**
+     * @param capacity the number of keys expected to insert
+     */
+    explicit CuckooFilter(size_type capacity, Hash hash = Hash{})
+        : hash_(hash)
+        , numBuckets_{ bucketsFor(capacity) }
+        , slots_(numBuckets_ * SLOTS, 0)
+    { }
+
+    /**
+     * @brief insert fingerprint of key
+     * @return false if the filter is full
+     * @note inserting a key twice stores two fingerprints
+     */
+    bool insert(K const& key) ZSTL_NOEXCEPT;
+
+    bool contains(K const& key) const ZSTL_NOEXCEPT
+    { return containsHash(hashOf(key)); }
+
+    /**
+     * @brief remove one fingerprint of key
+     * @return false if the fingerprint is not found
+     */
+    bool erase(K const& key) ZSTL_NOEXCEPT;
+
+    /**
+     * @brief insert @p n keys
+     * @return the number of keys inserted, less than n if it is full
+     */
+    size_type insert_batch(K const* keys, size_type n) ZSTL_NOEXCEPT;
+
+    /**
+     * @brief query @p n keys, out[i] is the result of keys[i]
+     * @note both buckets of keys in a group are prefetched first
+     */
+    void contains_batch(K const* keys, size_type n, bool* out) const ZSTL_NOEXCEPT;
+
+    void clear() ZSTL_NOEXCEPT;
+
+    /**
+     * @brief the probability that a key not inserted is reported:
+     * each of fingerprints in its two buckets matches by 1 / (2^bits - 1)
+     */
+    double falsePositiveRate() const ZSTL_NOEXCEPT
+    { return 2.0 * SLOTS * loadFactor() / FINGERPRINT_MAX; }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    size_type capacity() const ZSTL_NOEXCEPT
+    { return slots_.size(); }
+
+    double loadFactor() const ZSTL_NOEXCEPT
+    { return static_cast<double>(size_) / capacity(); }
+
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return slots_.size() * sizeof(Fingerprint); }
+
+    double bitsPerKey() const ZSTL_NOEXCEPT
+    { return size_ ? static_cast<double>(memoryBytes()) * 8 / size_ : 0; }
+
+    // whether an insert() has failed
+    bool full() const ZSTL_NOEXCEPT
+    { return victim_.used; }
+
+private:
+    struct Victim {
+        bool used = false;
+        size_type bucket = 0;
+        Fingerprint fingerprint = 0;
+    };
+
+    static size_type bucketsFor(size_type capacity) ZSTL_NOEXCEPT {
+        // 95% is the achievable load factor of 4-way buckets
+        return static_cast<size_type>(capacity / (0.95 * SLOTS)) + 1;
+    }
+
+    // map 32-bit x to [0, n) by multiply instead of division
+    static size_type reduce(uint32_t x, size_type n) ZSTL_NOEXCEPT
+    { return static_cast<size_type>((static_cast<uint64_t>(x) * n) >> 32); }
+
+    uint64_t hashOf(K const& key) const ZSTL_NOEXCEPT
+    { return hashMix64(hash_(key)); }
+
+    // high 32 bits give non-zero fingerprint, low 32 bits give bucket
+    static Fingerprint fingerprintOf(uint64_t h) ZSTL_NOEXCEPT
+    { return static_cast<Fingerprint>((h >> 32) % FINGERPRINT_MAX + 1); }
+
+    size_type indexOf(uint64_t h) const ZSTL_NOEXCEPT
+    { return reduce(static_cast<uint32_t>(h), numBuckets_); }
+
+    /**
+     * alt = (H(fp) - index) mod m is symmetric:
+     * altIndex(altIndex(i, f), f) == i,
+     * unlike the xor of original paper, m needs not be power of 2
+     */
+    size_type altIndex(size_type index, Fingerprint fp) const ZSTL_NOEXCEPT {
+        const auto hf = reduce(static_cast<uint32_t>(fp * 0x5bd1e995u), numBuckets_);
+        return hf >= index ? hf - index : hf + numBuckets_ - index;
+    }
+
+    Fingerprint* bucket(size_type index) ZSTL_NOEXCEPT
+    { return slots_.begin() + index * SLOTS; }
+
+    Fingerprint const* bucket(size_type index) const ZSTL_NOEXCEPT
+    { return slots_.begin() + index * SLOTS; }
+
+    bool insertHash(uint64_t h) ZSTL_NOEXCEPT
+    { return insertFingerprint(indexOf(h), fingerprintOf(h)); }
+
+    bool insertFingerprint(size_type index, Fingerprint fp) ZSTL_NOEXCEPT;
+    bool containsHash(uint64_t h) const ZSTL_NOEXCEPT;
+    bool insertToBucket(size_type index, Fingerprint fp) ZSTL_NOEXCEPT;
+    bool bucketContains(size_type index, Fingerprint fp) const ZSTL_NOEXCEPT;
+    bool eraseFromBucket(size_type index, Fingerprint fp) ZSTL_NOEXCEPT;
+
+    Hash hash_;
+    size_type numBuckets_;
+    Vector<Fingerprint> slots_;
+    size_type size_ = 0;
+
+    // The fingerprint kicked out by the last failed insert(),
+    // it is kept so no inserted key is lost
+    Victim victim_;
+    // state of xorshift which selects the slot to kick
+    uint32_t random_ = 2463534242u;
+};
+
+#define TEMPLATE_OF_CUCKOO_FILTER \
+template<typename K, typename Hash, typename Fingerprint>
+
+#define CUCKOO_FILTER \
+CuckooFilter<K, Hash, Fingerprint>
+
+TEMPLATE_OF_CUCKOO_FILTER
+constexpr size_t CUCKOO_FILTER::SLOTS;
+
+TEMPLATE_OF_CUCKOO_FILTER
+constexpr int CUCKOO_FILTER::MAX_KICKS;
+
+TEMPLATE_OF_CUCKOO_FILTER
+constexpr uint64_t CUCKOO_FILTER::FINGERPRINT_MAX;
+
+TEMPLATE_OF_CUCKOO_FILTER
+constexpr typename CUCKOO_FILTER::size_type CUCKOO_FILTER::BATCH_SIZE;
+
+TEMPLATE_OF_CUCKOO_FILTER
+inline bool
+CUCKOO_FILTER::insert(K const& key) ZSTL_NOEXCEPT {
+    return insertHash(hashOf(key));
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+bool
+CUCKOO_FILTER::insertFingerprint(size_type index, Fingerprint fp) ZSTL_NOEXCEPT {
+    if (victim_.used) {
+        return false;
+    }
+
+    if (insertToBucket(index, fp) || insertToBucket(altIndex(index, fp), fp)) {
+        ++size_;
+        return true;
+    }
+
+    // kick a random fingerprint to its alternate bucket
+    index = (random_ & 1) ? altIndex(index, fp) : index;
+    for (int kick = 0; kick != MAX_KICKS; ++kick) {
+        random_ ^= random_ << 13;
+        random_ ^= random_ >> 17;
+        random_ ^= random_ << 5;
+
+        auto& slot = bucket(index)[random_ % SLOTS];
+        const auto kicked = slot;
+        slot = fp;
+        fp = kicked;
+
+        index = altIndex(index, fp);
+        if (insertToBucket(index, fp)) {
+            ++size_;
+            return true;
+        }
+    }
+
+    // the key is in filter, but some other fingerprint is homeless
+    victim_.used = true;
+    victim_.bucket = index;
+    victim_.fingerprint = fp;
+    ++size_;
+    return true;
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+bool
+CUCKOO_FILTER::containsHash(uint64_t h) const ZSTL_NOEXCEPT {
+    const auto fp = fingerprintOf(h);
+    const auto i1 = indexOf(h);
+    const auto i2 = altIndex(i1, fp);
+
+    if (bucketContains(i1, fp) || bucketContains(i2, fp)) {
+        return true;
+    }
+
+    return victim_.used && victim_.fingerprint == fp &&
+           (victim_.bucket == i1 || victim_.bucket == i2);
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+bool
+CUCKOO_FILTER::erase(K const& key) ZSTL_NOEXCEPT {
+    const auto h = hashOf(key);
+    const auto fp = fingerprintOf(h);
+    const auto i1 = indexOf(h);
+    const auto i2 = altIndex(i1, fp);
+
+    if (eraseFromBucket(i1, fp) || eraseFromBucket(i2, fp)) {
+        --size_;
+
+        // a slot is free, try to place the victim again
+        if (victim_.used) {
+            const auto victim = victim_;
+            victim_.used = false;
+            --size_;
+            insertFingerprint(victim.bucket, victim.fingerprint);
+        }
+        return true;
+    }
+
+    if (victim_.used && victim_.fingerprint == fp &&
+        (victim_.bucket == i1 || victim_.bucket == i2)) {
+        victim_.used = false;
+        --size_;
+        return true;
+    }
+
+    return false;
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+auto
+CUCKOO_FILTER::insert_batch(K const* keys, size_type n) ZSTL_NOEXCEPT
+-> size_type {
+    uint64_t hashes[BATCH_SIZE];
+
+    for (size_type first = 0; first < n; first += BATCH_SIZE) {
+        const auto len = n - first < BATCH_SIZE ? n - first : BATCH_SIZE;
+        for (size_type i = 0; i != len; ++i) {
+            hashes[i] = hashOf(keys[first + i]);
+            ZSTL_PREFETCH(bucket(indexOf(hashes[i])));
+        }
+
+        for (size_type i = 0; i != len; ++i) {
+            if (!insertHash(hashes[i])) {
+                return first + i;
+            }
+        }
+    }
+
+    return n;
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+void
+CUCKOO_FILTER::contains_batch(K const* keys, size_type n, bool* out) const ZSTL_NOEXCEPT {
+    uint64_t hashes[BATCH_SIZE];
+
+    for (size_type first = 0; first < n; first += BATCH_SIZE) {
+        const auto len = n - first < BATCH_SIZE ? n - first : BATCH_SIZE;
+        for (size_type i = 0; i != len; ++i) {
+            const auto h = hashOf(keys[first + i]);
+            const auto index = indexOf(h);
+            hashes[i] = h;
+            ZSTL_PREFETCH(bucket(index));
+            ZSTL_PREFETCH(bucket(altIndex(index, fingerprintOf(h))));
+        }
+
+        for (size_type i = 0; i != len; ++i) {
+            out[first + i] = containsHash(hashes[i]);
+        }
+    }
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+void
+CUCKOO_FILTER::clear() ZSTL_NOEXCEPT {
+    for (auto& slot : slots_) {
+        slot = 0;
+    }
+    size_ = 0;
+    victim_ = Victim{};
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+inline bool
+CUCKOO_FILTER::insertToBucket(size_type index, Fingerprint fp) ZSTL_NOEXCEPT {
+    auto slots = bucket(index);
+    for (size_type i = 0; i != SLOTS; ++i) {
+        if (slots[i] == 0) {
+            slots[i] = fp;
+            return true;
+        }
+    }
+    return false;
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+inline bool
+CUCKOO_FILTER::bucketContains(size_type index, Fingerprint fp) const ZSTL_NOEXCEPT {
+    auto slots = bucket(index);
+    // no early exit, so it is compiled to branchless compares
+    static_assert(SLOTS == 4, "unrolled for 4 slots");
+    return (slots[0] == fp) | (slots[1] == fp) | (slots[2] == fp) | (slots[3] == fp);
+}
+
+TEMPLATE_OF_CUCKOO_FILTER
+inline bool
+CUCKOO_FILTER::eraseFromBucket(size_type index, Fingerprint fp) ZSTL_NOEXCEPT {
+    auto slots = bucket(index);
+    for (size_type i = 0; i != SLOTS; ++i) {
+        if (slots[i] == fp) {
+            slots[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace zstl
+
+#endif // ZSTL_CUCKOO_FILTER_H
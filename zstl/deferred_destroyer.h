@@ -0,0 +1,119 @@
+#ifndef ZSTL_DEFERRED_DESTROYER_H
+#define ZSTL_DEFERRED_DESTROYER_H
+
+#include "config.h"
+#include "noncopyable.h"
+#include "stl_move.h"
+#include "type_traits.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace zstl {
+
+/**
+ * @class DeferredDestroyer
+ * @brief
+ * Destroy objects in a background thread, e.g. large trees on the reload path,
+ * so the caller only pays for the move.
+ * @code
+ * DeferredDestroyer destroyer;
+ * destroyer.retire(STL_MOVE(old_table)); // old_table is empty now
+ * @endcode
+ * @note
+ * The destructor of retired object must not depend on the caller's thread,
+ * the pending objects are destroyed before the destroyer is destroyed.
+ */
+class DeferredDestroyer : noncopyable {
+    struct Holder {
+        virtual ~Holder() = default;
+        Holder* next = nullptr;
+    };
+
+    template<typename T>
+    struct HolderImpl : Holder {
+        explicit HolderImpl(T&& x)
+            : obj(STL_MOVE(x))
+        { }
+
+        T obj;
+    };
+
+public:
+    DeferredDestroyer()
+        : worker_([this]() { run(); })
+    { }
+
+    ~DeferredDestroyer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+    }
+
+    /**
+     * @brief move @p obj into the queue, it is destroyed by the worker later
+     */
+    template<typename T>
+    void retire(T&& obj) {
+        static_assert(!Is_lvalue_reference<T>::value,
+            "retire() takes the ownership, pass the object by STL_MOVE()");
+
+        Holder* holder = new HolderImpl<T>(STL_MOVE(obj));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            holder->next = head_;
+            head_ = holder;
+            ++pending_;
+        }
+        cv_.notify_one();
+    }
+
+    // wait until all retired objects are destroyed
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this]() { return head_ != nullptr || stop_; });
+            if (head_ == nullptr)
+                return;
+
+            auto list = head_;
+            head_ = nullptr;
+            lock.unlock();
+
+            std::size_t n = 0;
+            while (list) {
+                auto next = list->next;
+                delete list;
+                list = next;
+                ++n;
+            }
+
+            lock.lock();
+            pending_ -= n;
+            done_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_;
+    Holder* head_ = nullptr;
+    std::size_t pending_ = 0;
+    bool stop_ = false;
+    // started after the fields above are initialized
+    std::thread worker_;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_DEFERRED_DESTROYER_H
@@ -0,0 +1,115 @@
+#ifndef ZSTL_EPOCH_H
+#define ZSTL_EPOCH_H
+
+#include "config.h"
+#include "noncopyable.h"
+#include "vector.h"
+#include "util/aligned_new.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace zstl {
+
+/**
+ * @class EpochManager
+ * @brief
+ * Epoch-based reclamation, used by the containers whose readers don't lock.
+ * The reader enters a critical section by EpochGuard, during which
+ * the objects it can reach are not released.
+ * The writer unlinks the object from shared structure first then retire() it,
+ * the object is released after every thread in critical section has
+ * observed a newer epoch, i.e. global epoch has advanced twice.
+ * @note
+ * There is only one instance in the process,
+ * every thread get its record at the first use and return it when exits.
+ * @see Keir Fraser, Practical lock-freedom, 5.2.3
+ */
+class EpochManager : noncopyable {
+public:
+    using Deleter = void(*)(void*);
+
+    static EpochManager& instance();
+
+    // critical section, can be nested
+    void enter() ZSTL_NOEXCEPT;
+    void leave() ZSTL_NOEXCEPT;
+
+    /**
+     * @brief release @p p by @p deleter once no reader can reach it
+     * @note @p p must have been unlinked
+     */
+    void retire(void* p, Deleter deleter);
+
+    /**
+     * @brief try to advance epoch and release what is safe to release
+     * in the record of calling thread
+     * @note
+     * Call it out of critical section, and objects retired by
+     * this thread are released if other threads are not in critical section.
+     */
+    void collect();
+
+    uint64_t epoch() const ZSTL_NOEXCEPT
+    { return epoch_.load(std::memory_order_acquire); }
+
+    ~EpochManager();
+private:
+    struct Retired {
+        void* ptr;
+        Deleter deleter;
+    };
+
+    // epoch % 3 selects limbo list
+    static constexpr int LIMBO_NUM = 3;
+
+    // try to advance the epoch every RETIRE_THRESHOLD retire() call
+    static constexpr int RETIRE_THRESHOLD = 64;
+
+    // aligned on heap to avoid false sharing between threads
+    struct alignas(64) Record : AlignedNew<64> {
+        // 0 if the owner is not in critical section,
+        // otherwise the epoch it entered
+        std::atomic<uint64_t> local{ 0 };
+        std::atomic<bool> used{ true };
+        Record* next = nullptr;
+
+        // the fields below are only accessed by the owner
+        int depth = 0;
+        int retireCount = 0;
+        uint64_t limboEpoch[LIMBO_NUM] = { 0, 0, 0 };
+        Vector<Retired> limbo[LIMBO_NUM];
+    };
+
+    EpochManager() = default;
+
+    Record* record();
+    Record* acquireRecord();
+    void releaseRecord(Record* rec) ZSTL_NOEXCEPT;
+
+    bool tryAdvance() ZSTL_NOEXCEPT;
+    void reclaim(Record* rec, uint64_t epoch);
+    static void freeLimbo(Vector<Retired>& limbo);
+
+    std::atomic<uint64_t> epoch_{ 1 };
+    std::atomic<Record*> records_{ nullptr };
+
+    friend struct EpochThreadRecord;
+};
+
+/**
+ * @class EpochGuard
+ * @brief RAII of critical section of EpochManager
+ */
+class EpochGuard : noncopyable {
+public:
+    EpochGuard() ZSTL_NOEXCEPT
+    { EpochManager::instance().enter(); }
+
+    ~EpochGuard() ZSTL_NOEXCEPT
+    { EpochManager::instance().leave(); }
+};
+
+} // namespace zstl
+
+#endif // ZSTL_EPOCH_H
@@ -0,0 +1,551 @@
+#ifndef ZSTL_FLAT_MAP_H
+#define ZSTL_FLAT_MAP_H
+
+#include "flat_set.h"
+#include "stl_exception.h"
+#include "utility.h"
+
+namespace zstl {
+
+namespace detail {
+
+/**
+ * @brief the reference of FlatMapSplitIterator, like pair<K const&, V&>
+ * @note it is also the pointer type, so it->second works through the proxy
+ */
+template<typename K, typename V>
+struct FlatMapSplitRef {
+    K const& first;
+    V& second;
+
+    FlatMapSplitRef* operator->() ZSTL_NOEXCEPT
+    { return this; }
+};
+
+/**
+ * @class FlatMapSplitIterator
+ * @tparam V mapped type, T const for const_iterator
+ * @brief random access iterator over the parallel key and value arrays
+ */
+template<typename K, typename V>
+class FlatMapSplitIterator {
+    template<typename, typename> friend class FlatMapSplitIterator;
+public:
+    using iterator_category = Random_access_iterator_tag;
+    using value_type = zstl::pair<K, Remove_const_t<V>>;
+    using difference_type = std::ptrdiff_t;
+    using reference = FlatMapSplitRef<K, V>;
+    using pointer = FlatMapSplitRef<K, V>;
+    using Self = FlatMapSplitIterator;
+
+    FlatMapSplitIterator() = default;
+
+    FlatMapSplitIterator(K const* key, V* val) ZSTL_NOEXCEPT
+        : key_(key)
+        , val_(val)
+    { }
+
+    // iterator to const_iterator
+    template<typename U, STL_ENABLE_IF((Is_same<U const, V>::value), int)>
+    FlatMapSplitIterator(FlatMapSplitIterator<K, U> const& iter) ZSTL_NOEXCEPT
+        : key_(iter.key_)
+        , val_(iter.val_)
+    { }
+
+    reference operator*() const ZSTL_NOEXCEPT
+    { return reference{ *key_, *val_ }; }
+
+    pointer operator->() const ZSTL_NOEXCEPT
+    { return **this; }
+
+    reference operator[](difference_type n) const ZSTL_NOEXCEPT
+    { return reference{ key_[n], val_[n] }; }
+
+    Self& operator++() ZSTL_NOEXCEPT
+    { ++key_; ++val_; return *this; }
+
+    Self operator++(int) ZSTL_NOEXCEPT
+    { auto tmp = *this; ++*this; return tmp; }
+
+    Self& operator--() ZSTL_NOEXCEPT
+    { --key_; --val_; return *this; }
+
+    Self operator--(int) ZSTL_NOEXCEPT
+    { auto tmp = *this; --*this; return tmp; }
+
+    Self& operator+=(difference_type n) ZSTL_NOEXCEPT
+    { key_ += n; val_ += n; return *this; }
+
+    Self& operator-=(difference_type n) ZSTL_NOEXCEPT
+    { return *this += -n; }
+
+    Self operator+(difference_type n) const ZSTL_NOEXCEPT
+    { return Self(key_ + n, val_ + n); }
+
+    Self operator-(difference_type n) const ZSTL_NOEXCEPT
+    { return Self(key_ - n, val_ - n); }
+
+    difference_type operator-(Self const& rhs) const ZSTL_NOEXCEPT
+    { return key_ - rhs.key_; }
+
+    bool operator==(Self const& rhs) const ZSTL_NOEXCEPT
+    { return key_ == rhs.key_; }
+
+    bool operator!=(Self const& rhs) const ZSTL_NOEXCEPT
+    { return key_ != rhs.key_; }
+
+    bool operator<(Self const& rhs) const ZSTL_NOEXCEPT
+    { return key_ < rhs.key_; }
+
+    bool operator>(Self const& rhs) const ZSTL_NOEXCEPT
+    { return rhs < *this; }
+
+    bool operator<=(Self const& rhs) const ZSTL_NOEXCEPT
+    { return !(rhs < *this); }
+
+    bool operator>=(Self const& rhs) const ZSTL_NOEXCEPT
+    { return !(*this < rhs); }
+
+private:
+    K const* key_ = nullptr;
+    V* val_ = nullptr;
+};
+
+/**
+ * @brief storage of FlatMap which keeps pair<K, T> in one array
+ */
+template<typename K, typename T>
+class FlatMapPairStorage {
+public:
+    using value_type = zstl::pair<K, T>;
+    using Rep = Vector<value_type>;
+    using size_type = typename Rep::size_type;
+    using iterator = typename Rep::iterator;
+    using const_iterator = typename Rep::const_iterator;
+
+    iterator begin() ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return rep_.size(); }
+
+    size_type capacity() const ZSTL_NOEXCEPT
+    { return rep_.capacity(); }
+
+    K const& key(size_type i) const ZSTL_NOEXCEPT
+    { return rep_[i].first; }
+
+    template<typename Compare>
+    size_type lowerBound(K const& key, Compare const& cmp) const {
+        return zstl::lower_bound(rep_.begin(), rep_.end(), key,
+            [&cmp](value_type const& x, K const& k) { return cmp(x.first, k); }) - rep_.begin();
+    }
+
+    template<typename Compare>
+    size_type upperBound(K const& key, Compare const& cmp) const {
+        return zstl::upper_bound(rep_.begin(), rep_.end(), key,
+            [&cmp](K const& k, value_type const& x) { return cmp(k, x.first); }) - rep_.begin();
+    }
+
+    template<typename U, typename... Args>
+    iterator emplace(size_type i, U&& key, Args&&... args)
+    { return rep_.emplace(rep_.begin() + i, emplace_second, STL_FORWARD(U, key), STL_FORWARD(Args, args)...); }
+
+    void erase(size_type first, size_type last)
+    { rep_.erase(rep_.begin() + first, rep_.begin() + last); }
+
+    template<typename II, typename Compare>
+    void insert(II first, II last, Compare const& cmp) {
+        const auto n = rep_.size();
+        STL_TRY {
+            for (; first != last; ++first) {
+                rep_.emplace_back(*first);
+            }
+            flatMergeUnique(rep_, n, get_first<K, T>{}, cmp);
+        }
+        CATCH_ALL {
+            rep_.erase(rep_.begin() + n, rep_.end());
+            RETHROW
+        }
+    }
+
+    void reserve(size_type n)
+    { rep_.reserve(n); }
+
+    void shrink_to_fit()
+    { rep_.shrink_to_fit(); }
+
+    void clear() ZSTL_NOEXCEPT
+    { rep_.clear(); }
+
+    void swap(FlatMapPairStorage& rhs) ZSTL_NOEXCEPT
+    { rep_.swap(rhs.rep_); }
+
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return rep_.capacity() * sizeof(value_type); }
+
+private:
+    Rep rep_;
+};
+
+/**
+ * @brief storage of FlatMap which keeps keys and values in two parallel arrays
+ * @note binary search only touches the dense key array
+ */
+template<typename K, typename T>
+class FlatMapSplitStorage {
+public:
+    using value_type = zstl::pair<K, T>;
+    using size_type = typename Vector<K>::size_type;
+    using iterator = FlatMapSplitIterator<K, T>;
+    using const_iterator = FlatMapSplitIterator<K, T const>;
+
+    iterator begin() ZSTL_NOEXCEPT
+    { return iterator(keys_.data(), vals_.data()); }
+
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return const_iterator(keys_.data(), vals_.data()); }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return keys_.size(); }
+
+    size_type capacity() const ZSTL_NOEXCEPT
+    { return keys_.capacity(); }
+
+    K const& key(size_type i) const ZSTL_NOEXCEPT
+    { return keys_[i]; }
+
+    template<typename Compare>
+    size_type lowerBound(K const& key, Compare const& cmp) const
+    { return zstl::lower_bound(keys_.begin(), keys_.end(), key, cmp) - keys_.begin(); }
+
+    template<typename Compare>
+    size_type upperBound(K const& key, Compare const& cmp) const
+    { return zstl::upper_bound(keys_.begin(), keys_.end(), key, cmp) - keys_.begin(); }
+
+    template<typename U, typename... Args>
+    iterator emplace(size_type i, U&& key, Args&&... args) {
+        keys_.emplace(keys_.begin() + i, STL_FORWARD(U, key));
+        STL_TRY {
+            vals_.emplace(vals_.begin() + i, STL_FORWARD(Args, args)...);
+        }
+        CATCH_ALL {
+            keys_.erase(keys_.begin() + i);
+            RETHROW
+        }
+        return begin() + i;
+    }
+
+    void erase(size_type first, size_type last) {
+        keys_.erase(keys_.begin() + first, keys_.begin() + last);
+        vals_.erase(vals_.begin() + first, vals_.begin() + last);
+    }
+
+    /**
+     * @brief sort and dedup the new pairs in a temporary array, then merge the two arrays
+     * @note If it throws, the keys and values are unchanged and have the same length.
+     * The old elements are only moved if the move cannot throw, otherwise copied.
+     */
+    template<typename II, typename Compare>
+    void insert(II first, II last, Compare const& cmp) {
+        Vector<value_type> pairs;
+        for (; first != last; ++first) {
+            pairs.emplace_back(*first);
+        }
+        flatMergeUnique(pairs, 0, get_first<K, T>{}, cmp);
+        if (pairs.empty())
+            return;
+
+        if (keys_.empty() || cmp(keys_.back(), pairs.front().first)) {
+            const auto n = keys_.size();
+            keys_.reserve(n + pairs.size());
+            vals_.reserve(n + pairs.size());
+            STL_TRY {
+                for (auto& x : pairs) {
+                    keys_.push_back(STL_MOVE(x.first));
+                    vals_.push_back(STL_MOVE(x.second));
+                }
+            }
+            CATCH_ALL {
+                keys_.erase(keys_.begin() + n, keys_.end());
+                vals_.erase(vals_.begin() + n, vals_.end());
+                RETHROW
+            }
+            return;
+        }
+
+        Vector<K> keys;
+        Vector<T> vals;
+        keys.reserve(keys_.size() + pairs.size());
+        vals.reserve(keys_.size() + pairs.size());
+
+        size_type i = 0;
+        auto iter = pairs.begin();
+        while (i != keys_.size() && iter != pairs.end()) {
+            if (cmp(iter->first, keys_[i])) {
+                keys.push_back(STL_MOVE(iter->first));
+                vals.push_back(STL_MOVE(iter->second));
+                ++iter;
+            } else {
+                if (!cmp(keys_[i], iter->first))
+                    ++iter;
+                keys.push_back(zstl::move_if_noexcept(keys_[i]));
+                vals.push_back(zstl::move_if_noexcept(vals_[i]));
+                ++i;
+            }
+        }
+        for (; i != keys_.size(); ++i) {
+            keys.push_back(zstl::move_if_noexcept(keys_[i]));
+            vals.push_back(zstl::move_if_noexcept(vals_[i]));
+        }
+        for (; iter != pairs.end(); ++iter) {
+            keys.push_back(STL_MOVE(iter->first));
+            vals.push_back(STL_MOVE(iter->second));
+        }
+
+        keys_.swap(keys);
+        vals_.swap(vals);
+    }
+
+    void reserve(size_type n) {
+        keys_.reserve(n);
+        vals_.reserve(n);
+    }
+
+    void shrink_to_fit() {
+        keys_.shrink_to_fit();
+        vals_.shrink_to_fit();
+    }
+
+    void clear() ZSTL_NOEXCEPT {
+        keys_.clear();
+        vals_.clear();
+    }
+
+    void swap(FlatMapSplitStorage& rhs) ZSTL_NOEXCEPT {
+        keys_.swap(rhs.keys_);
+        vals_.swap(rhs.vals_);
+    }
+
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return keys_.capacity() * sizeof(K) + vals_.capacity() * sizeof(T); }
+
+private:
+    Vector<K> keys_;
+    Vector<T> vals_;
+};
+
+} // namespace detail
+
+/**
+ * @class FlatMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two keys
+ * @tparam SPLIT_KEYS keep keys and values in two arrays(see SplitFlatMap)
+ * @brief ordered map based on sorted Vector, the key is unique
+ * @note
+ * Like FlatSet, lookup is binary search and single insertion or erasure is O(n),
+ * all of them invalidate iterators.
+ * The value_type is pair<K, T> since elements are moved in the array,
+ * the key must not be modified through iterator.
+ * If SPLIT_KEYS is true, the binary search only touches the keys, which is
+ * better for large mapped type, but the iterator returns a proxy reference.
+ */
+template<typename K, typename T,
+    typename Compare = zstl::less<K>,
+    bool SPLIT_KEYS = false>
+class FlatMap {
+public:
+    using Rep = Conditional_t<SPLIT_KEYS,
+        detail::FlatMapSplitStorage<K, T>,
+        detail::FlatMapPairStorage<K, T>>;
+    using key_type = K;
+    using mapped_type = T;
+    using value_type = typename Rep::value_type;
+    using key_compare = Compare;
+    using size_type = typename Rep::size_type;
+    using difference_type = std::ptrdiff_t;
+    using iterator = typename Rep::iterator;
+    using const_iterator = typename Rep::const_iterator;
+    using Res = zstl::pair<iterator, bool>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(Compare const& cmp)
+        : cmp_(cmp)
+    { }
+
+    template<typename II>
+    FlatMap(II first, II last)
+    { insert(first, last); }
+
+    // iterator interface
+    iterator begin() ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    iterator end() ZSTL_NOEXCEPT
+    { return rep_.begin() + rep_.size(); }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return rep_.begin() + rep_.size(); }
+
+    const_iterator cbegin() const ZSTL_NOEXCEPT
+    { return begin(); }
+
+    const_iterator cend() const ZSTL_NOEXCEPT
+    { return end(); }
+
+    // capacity
+    bool empty() const ZSTL_NOEXCEPT
+    { return rep_.size() == 0; }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return rep_.size(); }
+
+    size_type capacity() const ZSTL_NOEXCEPT
+    { return rep_.capacity(); }
+
+    void reserve(size_type n)
+    { rep_.reserve(n); }
+
+    void shrink_to_fit()
+    { rep_.shrink_to_fit(); }
+
+    // accessor
+    T& operator[](key_type const& key)
+    { return (*try_emplace(key).first).second; }
+
+    T& operator[](key_type&& key)
+    { return (*try_emplace(STL_MOVE(key)).first).second; }
+
+    T& at(key_type const& key) {
+        auto iter = find(key);
+        THROW_RANGE_ERROR_IF(iter == end(), "FlatMap::at(): key is not exists");
+        return (*iter).second;
+    }
+
+    T const& at(key_type const& key) const {
+        auto iter = find(key);
+        THROW_RANGE_ERROR_IF(iter == end(), "FlatMap::at(): key is not exists");
+        return (*iter).second;
+    }
+
+    // modifiers
+    Res insert(value_type const& x)
+    { return try_emplace(x.first, x.second); }
+
+    Res insert(value_type&& x)
+    { return try_emplace(STL_MOVE(x.first), STL_MOVE(x.second)); }
+
+    /**
+     * @brief append [ @p first, @p last ), then sort and merge them at once
+     * @note the existing value is kept if its key is inserted again
+     */
+    template<typename II>
+    void insert(II first, II last)
+    { rep_.insert(first, last, cmp_); }
+
+    template<typename U, typename... Args>
+    Res try_emplace(U&& key, Args&&... args) {
+        const auto i = rep_.lowerBound(key, cmp_);
+        if (i != rep_.size() && !cmp_(key, rep_.key(i)))
+            return Res(begin() + i, false);
+        return Res(rep_.emplace(i, STL_FORWARD(U, key), STL_FORWARD(Args, args)...), true);
+    }
+
+    template<typename M>
+    Res insert_or_assign(key_type const& key, M&& obj) {
+        auto res = try_emplace(key, STL_FORWARD(M, obj));
+        if (!res.second)
+            (*res.first).second = STL_FORWARD(M, obj);
+        return res;
+    }
+
+    iterator erase(const_iterator pos) {
+        const auto i = pos - cbegin();
+        rep_.erase(i, i + 1);
+        return begin() + i;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        const auto i = first - cbegin();
+        rep_.erase(i, last - cbegin());
+        return begin() + i;
+    }
+
+    size_type erase(key_type const& key) {
+        const auto i = findIndex(key);
+        if (i == rep_.size())
+            return 0;
+        rep_.erase(i, i + 1);
+        return 1;
+    }
+
+    void clear() ZSTL_NOEXCEPT
+    { rep_.clear(); }
+
+    void swap(FlatMap& rhs) ZSTL_NOEXCEPT {
+        rep_.swap(rhs.rep_);
+        STL_SWAP(cmp_, rhs.cmp_);
+    }
+
+    // lookup
+    size_type count(key_type const& key) const
+    { return contains(key) ? 1 : 0; }
+
+    iterator find(key_type const& key)
+    { return begin() + findIndex(key); }
+
+    const_iterator find(key_type const& key) const
+    { return begin() + findIndex(key); }
+
+    bool contains(key_type const& key) const
+    { return findIndex(key) != rep_.size(); }
+
+    iterator lower_bound(key_type const& key)
+    { return begin() + rep_.lowerBound(key, cmp_); }
+
+    const_iterator lower_bound(key_type const& key) const
+    { return begin() + rep_.lowerBound(key, cmp_); }
+
+    iterator upper_bound(key_type const& key)
+    { return begin() + rep_.upperBound(key, cmp_); }
+
+    const_iterator upper_bound(key_type const& key) const
+    { return begin() + rep_.upperBound(key, cmp_); }
+
+    key_compare key_comp() const
+    { return cmp_; }
+
+    // the bytes of the arrays, for statistics
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return rep_.memoryBytes(); }
+
+private:
+    // return size() if key is not found
+    size_type findIndex(key_type const& key) const {
+        const auto i = rep_.lowerBound(key, cmp_);
+        return i != rep_.size() && !cmp_(key, rep_.key(i)) ? i : rep_.size();
+    }
+
+    Rep rep_;
+    Compare cmp_;
+};
+
+template<typename K, typename T, typename Compare = zstl::less<K>>
+using SplitFlatMap = FlatMap<K, T, Compare, true>;
+
+template<typename K, typename T, typename CP, bool S>
+inline void swap(FlatMap<K, T, CP, S>& x, FlatMap<K, T, CP, S>& y) ZSTL_NOEXCEPT
+{ x.swap(y); }
+
+} // namespace zstl
+
+#endif // ZSTL_FLAT_MAP_H
@@ -0,0 +1,257 @@
+#ifndef ZSTL_FLAT_SET_H
+#define ZSTL_FLAT_SET_H
+
+#include "functional.h"
+#include "stl_exception.h"
+#include "stl_algorithm.h"
+#include "vector.h"
+
+namespace zstl {
+
+namespace detail {
+
+/**
+ * @brief sort the appended [ n, size ) of @p vec, drop its duplicate keys and
+ * merge it into the sorted [ 0, n )
+ * @param vec the first @p n elements are sorted and unique by key
+ * @param get_key get the key of element
+ * @note
+ * The element already in [ 0, n ) is kept if its key is also appended,
+ * which one of the equal appended elements is kept is unspecified.
+ * If all appended keys are greater than the old ones, no element is moved twice.
+ * If it throws, [ 0, n ) is unchanged, the caller should drop [ n, size ).
+ */
+template<typename V, typename Alloc, typename GetKey, typename Compare>
+void flatMergeUnique(Vector<V, Alloc>& vec, size_t n, GetKey get_key, Compare const& cmp) {
+    auto value_cmp = [&](V const& x, V const& y) {
+        return cmp(get_key(x), get_key(y));
+    };
+
+    auto first = vec.begin() + n;
+    auto last = vec.end();
+    zstl::sort(first, last, value_cmp);
+
+    // drop the duplicates in the appended part
+    if (first != last) {
+        auto result = first;
+        for (auto it = first + 1; it != last; ++it) {
+            if (value_cmp(*result, *it) && ++result != it)
+                *result = STL_MOVE(*it);
+        }
+        vec.erase(result + 1, last);
+    }
+
+    if (n == 0 || n == vec.size() || value_cmp(vec[n - 1], vec[n]))
+        return;
+
+    Vector<V, Alloc> merged;
+    merged.reserve(vec.size());
+
+    auto first1 = vec.begin();
+    auto last1 = first1 + n;
+    auto first2 = last1;
+    auto last2 = vec.end();
+    while (first1 != last1 && first2 != last2) {
+        if (value_cmp(*first2, *first1)) {
+            merged.push_back(STL_MOVE(*first2++));
+        } else {
+            if (!value_cmp(*first1, *first2))
+                ++first2;
+            merged.push_back(zstl::move_if_noexcept(*first1++));
+        }
+    }
+    for (; first1 != last1; ++first1)
+        merged.push_back(zstl::move_if_noexcept(*first1));
+    for (; first2 != last2; ++first2)
+        merged.push_back(STL_MOVE(*first2));
+
+    vec.swap(merged);
+}
+
+} // namespace detail
+
+/**
+ * @class FlatSet
+ * @tparam T key type
+ * @tparam Compare predicate that compare two keys
+ * @tparam Alloc allocator
+ * @brief ordered set based on sorted Vector, the keys are stored contiguously
+ * @note
+ * Lookup is binary search on a dense array, so it is faster and much smaller than Set,
+ * but single insertion and erasure are O(n) and invalidate all iterators.
+ * Build it by the bulk insert(first, last) which sorts and merges once.
+ */
+template<typename T,
+    typename Compare = zstl::less<T>,
+    typename Alloc = zstl::allocator<T>>
+class FlatSet {
+public:
+    using Rep = Vector<T, Alloc>;
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using pointer = T const*;
+    using const_pointer = T const*;
+    using reference = T const&;
+    using const_reference = T const&;
+    using size_type = typename Rep::size_type;
+    using difference_type = typename Rep::difference_type;
+    // the key can't be modified through iterator
+    using iterator = typename Rep::const_iterator;
+    using const_iterator = typename Rep::const_iterator;
+    using reverse_iterator = typename Rep::const_reverse_iterator;
+    using const_reverse_iterator = typename Rep::const_reverse_iterator;
+    using Res = zstl::pair<iterator, bool>;
+
+    FlatSet() = default;
+
+    explicit FlatSet(Compare const& cmp)
+        : cmp_(cmp)
+    { }
+
+    template<typename II>
+    FlatSet(II first, II last)
+    { insert(first, last); }
+
+    // iterator interface
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return rep_.begin(); }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return rep_.end(); }
+
+    const_iterator cbegin() const ZSTL_NOEXCEPT
+    { return rep_.cbegin(); }
+
+    const_iterator cend() const ZSTL_NOEXCEPT
+    { return rep_.cend(); }
+
+    const_reverse_iterator rbegin() const ZSTL_NOEXCEPT
+    { return rep_.rbegin(); }
+
+    const_reverse_iterator rend() const ZSTL_NOEXCEPT
+    { return rep_.rend(); }
+
+    // capacity
+    bool empty() const ZSTL_NOEXCEPT
+    { return rep_.empty(); }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return rep_.size(); }
+
+    size_type capacity() const ZSTL_NOEXCEPT
+    { return rep_.capacity(); }
+
+    void reserve(size_type n)
+    { rep_.reserve(n); }
+
+    void shrink_to_fit()
+    { rep_.shrink_to_fit(); }
+
+    // modifiers
+    Res insert(value_type const& val)
+    { return insertAux(val); }
+
+    Res insert(value_type&& val)
+    { return insertAux(STL_MOVE(val)); }
+
+    /**
+     * @brief append [ @p first, @p last ), then sort and merge them at once
+     * @note O(n + klgk) for k new keys, instead of O(nk) by the single insert()
+     * If it throws, the set is unchanged.
+     */
+    template<typename II>
+    void insert(II first, II last) {
+        const auto n = rep_.size();
+        STL_TRY {
+            for (; first != last; ++first) {
+                rep_.emplace_back(*first);
+            }
+            detail::flatMergeUnique(rep_, n, identity<T>{}, cmp_);
+        }
+        CATCH_ALL {
+            rep_.erase(rep_.begin() + n, rep_.end());
+            RETHROW
+        }
+    }
+
+    template<typename... Args>
+    Res emplace(Args&&... args)
+    { return insertAux(value_type(STL_FORWARD(Args, args)...)); }
+
+    iterator erase(const_iterator pos)
+    { return rep_.erase(pos); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    { return rep_.erase(first, last); }
+
+    size_type erase(key_type const& key) {
+        auto iter = find(key);
+        if (iter == end())
+            return 0;
+        rep_.erase(iter);
+        return 1;
+    }
+
+    void clear() ZSTL_NOEXCEPT
+    { rep_.clear(); }
+
+    void swap(FlatSet& rhs) ZSTL_NOEXCEPT {
+        rep_.swap(rhs.rep_);
+        STL_SWAP(cmp_, rhs.cmp_);
+    }
+
+    // lookup
+    size_type count(key_type const& key) const
+    { return contains(key) ? 1 : 0; }
+
+    const_iterator find(key_type const& key) const {
+        auto iter = lower_bound(key);
+        return iter != end() && !cmp_(key, *iter) ? iter : end();
+    }
+
+    bool contains(key_type const& key) const
+    { return find(key) != end(); }
+
+    zstl::pair<const_iterator, const_iterator> equal_range(key_type const& key) const {
+        auto iter = find(key);
+        return zstl::make_pair(iter, iter == end() ? iter : iter + 1);
+    }
+
+    const_iterator lower_bound(key_type const& key) const
+    { return zstl::lower_bound(rep_.begin(), rep_.end(), key, cmp_); }
+
+    const_iterator upper_bound(key_type const& key) const
+    { return zstl::upper_bound(rep_.begin(), rep_.end(), key, cmp_); }
+
+    key_compare key_comp() const
+    { return cmp_; }
+
+    // the bytes of the array, for statistics
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return rep_.capacity() * sizeof(T); }
+
+    Rep const& rep() const ZSTL_NOEXCEPT
+    { return rep_; }
+
+private:
+    template<typename V>
+    Res insertAux(V&& val) {
+        auto iter = lower_bound(val);
+        if (iter != end() && !cmp_(val, *iter))
+            return Res(iter, false);
+        return Res(rep_.emplace(iter, STL_FORWARD(V, val)), true);
+    }
+
+    Rep rep_;
+    Compare cmp_;
+};
+
+template<typename T, typename CP, typename Alloc>
+inline void swap(FlatSet<T, CP, Alloc>& x, FlatSet<T, CP, Alloc>& y) ZSTL_NOEXCEPT
+{ x.swap(y); }
+
+} // namespace zstl
+
+#endif // ZSTL_FLAT_SET_H
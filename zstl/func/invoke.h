@@ -111,7 +111,8 @@ namespace zstl{
 
     template<typename F,typename ...Args>
     constexpr auto
-    invoke(F&& f,Args&&... args) noexcept(noexcept(f))
+    invoke(F&& f,Args&&... args)
+	noexcept(noexcept(detail::invoke_impl(zstl::forward<F>(f),zstl::forward<Args>(args)...)))
 	-> decltype(detail::invoke_impl(zstl::forward<F>(f),zstl::forward<Args>(args)...))
     {
         return detail::invoke_impl(zstl::forward<F>(f),zstl::forward<Args>(args)...);
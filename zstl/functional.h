@@ -128,7 +128,7 @@ struct less {
 	}
 };
 
-template<typename T>
+template<typename T=void>
 struct equal_to{
 	using first_argument_type   =T;
 	using second_argument_type  =T;
@@ -139,9 +139,24 @@ struct equal_to{
 	}
 };
 
+// transparent version, can compare different types
+// e.g. std::string and string_view
+template<>
+struct equal_to<void> {
+	using is_transparent = void;
+
+	template<typename T1,typename T2>
+	constexpr auto operator()(T1&& lhs, T2&& rhs) const
+		noexcept(noexcept(static_cast<T1&&>(lhs)==static_cast<T2&&>(rhs)))
+	-> decltype(static_cast<T1&&>(lhs)==static_cast<T2&&>(rhs)) {
+		return static_cast<T1&&>(lhs)==static_cast<T2&&>(rhs);
+	}
+};
+
+// return reference to avoid copying key in the lookup of containers
 template<typename T>
 struct identity{
-	T operator()(T const& x) const{
+	T const& operator()(T const& x) const{
 		return x;
 	}
 };
@@ -151,7 +166,7 @@ struct get_first{
 	using argument_type =pair<T1,T2>;
 	using result_type   =T1;
 
-	T1 operator()(pair<T1,T2> const& p){
+	T1 const& operator()(pair<T1,T2> const& p) const{
 		return p.first;
 	} 
 };
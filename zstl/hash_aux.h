@@ -3,7 +3,9 @@
 
 #include "stl_algorithm.h"
 #include "type_traits.h"
+#include "string_view.h"
 #include <stdint.h>
+#include <string.h>
 #include <string>
 
 namespace zstl {
@@ -47,8 +49,30 @@ template <>
 struct Is_string<std::string> : _true_type
 { };
 
+template <>
+struct Is_string<string_view> : _true_type
+{ };
+
 } // namespace detail
 
+/**
+ * @brief
+ * The hash of string of characters
+ * std::string, string_view and C-style string share it,
+ * so they produce identical value for same characters.
+ */
+inline size_t hashString(char const* str, size_t len) noexcept
+{
+    size_t hashval = 0;
+
+    for (size_t i = 0; i != len; ++i)
+    {
+        hashval = 37 * hashval + str[i];
+    }
+
+    return hashval;
+}
+
 // hash function
 template<typename K, typename = void>
 struct hash
@@ -79,33 +103,50 @@ struct hash<K, zstl::Enable_if_t<detail::Is_cstring<K>::value>>
 {
     size_t operator()(K str) const
     {
-        size_t hashval = 0;
-
-        for (size_t i = 0; str[i] != '\0'; ++i)
-        {
-            hashval = 37 * hashval + str[i];
-        }
-
-        return hashval;
+        return hashString(str, strlen(str));
     }
 };
 
 template <typename K>
 struct hash<K, zstl::Enable_if_t<detail::Is_string<K>::value>>
 {
-    size_t operator()(K str) const
+    size_t operator()(K const& str) const
+    {
+        return hashString(str.data(), str.size());
+    }
+};
+
+/**
+ * @struct string_hash
+ * @brief
+ * Transparent hash function of string(is_transparent is defined),
+ * used with equal_to<> to enable heterogeneous lookup in HashTable,
+ * e.g. search std::string keys by string_view or C-style string
+ * without constructing temporary std::string.
+ */
+struct string_hash
+{
+    using is_transparent = void;
+
+    size_t operator()(string_view str) const noexcept
     {
-        size_t hashval = 0;
+        return hashString(str.data(), str.size());
+    }
 
-        for (auto &ch : str)
-        {
-            hashval = hashval * 37 + ch;
-        }
+    size_t operator()(std::string const& str) const noexcept
+    {
+        return hashString(str.data(), str.size());
+    }
 
-        return hashval;
+    size_t operator()(char const* str) const noexcept
+    {
+        return hash<char const*>{}(str);
     }
 };
 
+// Check if hash function or key comparator is transparent
+DEFINE_HAS_TYPE(is_transparent)
+
 /**
  * @fn hashDivision
  * @brief 
@@ -118,6 +159,23 @@ ZSTL_CONSTEXPR uint64_t hashDivision(uint64_t key, uint64_t slotsNum) {
     return key % slotsNum;
 }
 
+/**
+ * @fn hashMix64
+ * @brief
+ * Scatter the bits of hash value, every input bit affects every output bit.
+ * zstl::hash of integer is identity, which is fine for division method
+ * but not for the structures that take bits of hash directly(e.g. filters).
+ * @see the finalizer of MurmurHash3
+ */
+ZSTL_CONSTEXPR uint64_t hashMix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
 } // namespace zstl
 
 #endif
\ No newline at end of file
@@ -0,0 +1,316 @@
+#ifndef ZSTL_HASH_SNAPSHOT_H
+#define ZSTL_HASH_SNAPSHOT_H
+
+#include "hash_aux.h"
+#include "mapped_file.h"
+#include "string_view.h"
+#include "type_traits.h"
+#include "vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+namespace zstl {
+
+/**
+ * Layout of snapshot file, native byte order and
+ * every position is an offset from the beginning of file,
+ * so the file can be mapped at any address and used in place:
+ *   HashSnapshotHeader
+ *   uint64_t buckets[bucketCount + 1]
+ *     the entries of bucket i are [buckets[i], buckets[i+1])
+ *   Entry entries[elementCount]
+ *     packed (key, value), grouped by bucket
+ *   char blob[blobSize]
+ *     the characters of string fields
+ * Each section starts at multiple of SECTION_ALIGN.
+ */
+struct HashSnapshotHeader {
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr size_t SECTION_ALIGN = 16;
+
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t entrySize;
+    uint64_t bucketCount;
+    uint64_t elementCount;
+    uint64_t bucketsOffset;
+    uint64_t entriesOffset;
+    uint64_t blobOffset;
+    uint64_t blobSize;
+};
+
+// string field is stored as a range of blob
+struct SnapshotString {
+    uint64_t offset;
+    uint64_t size;
+};
+
+/**
+ * Describe how a field(key or value) is stored in snapshot:
+ * trivially copyable type is copied as is,
+ * std::string is appended to blob and read back as string_view.
+ * Other types are not supported.
+ */
+template<typename T, typename = void>
+struct SnapshotField;
+
+template<typename T>
+struct SnapshotField<T, Enable_if_t<Is_trivially_copyable<T>::value>> {
+    using stored_type = T;
+    using view_type = T;
+    using arg_type = T const&;
+
+    static stored_type store(T const& x, std::string&)
+    { return x; }
+
+    static T const& load(stored_type const& x, char const*) ZSTL_NOEXCEPT
+    { return x; }
+};
+
+template<>
+struct SnapshotField<std::string> {
+    using stored_type = SnapshotString;
+    using view_type = string_view;
+    using arg_type = string_view;
+
+    static stored_type store(std::string const& x, std::string& blob) {
+        SnapshotString str{ blob.size(), x.size() };
+        blob += x;
+        return str;
+    }
+
+    static string_view load(stored_type const& x, char const* blob) ZSTL_NOEXCEPT
+    { return string_view(blob + x.offset, x.size); }
+};
+
+/**
+ * The default hash of snapshot.
+ * std::string key is hashed by string_hash,
+ * so it can be searched by string_view without copy.
+ * @note
+ * The hash must be same when the snapshot is written and read,
+ * i.e. it must not depend on process(e.g. random seed)
+ */
+template<typename K>
+struct SnapshotHash : hash<K>
+{ };
+
+template<>
+struct SnapshotHash<std::string> : string_hash
+{ };
+
+template<typename K, typename T>
+struct SnapshotEntry {
+    typename SnapshotField<K>::stored_type key;
+    typename SnapshotField<T>::stored_type value;
+};
+
+// the key and mapped type of map whose value is pair
+template<typename Map>
+using SnapshotKeyOf = Remove_cv_t<decltype(declval<typename Map::value_type>().first)>;
+
+template<typename Map>
+using SnapshotMappedOf = Remove_cv_t<decltype(declval<typename Map::value_type>().second)>;
+
+namespace detail {
+
+/**
+ * @brief write the sections to path.tmp then rename it to @p path,
+ * so the reader never maps a partially written file
+ * @note throw std::runtime_error if failed
+ */
+void writeHashSnapshot(
+    char const* path,
+    uint32_t entrySize,
+    uint64_t bucketCount,
+    uint64_t elementCount,
+    void const* buckets,
+    void const* entries,
+    void const* blob,
+    uint64_t blobSize);
+
+/**
+ * @brief check header and the bounds of sections
+ * @note throw std::runtime_error if the file is not a valid snapshot
+ * with the entry size
+ */
+HashSnapshotHeader const&
+checkHashSnapshot(MappedFile const& file, char const* path, uint32_t entrySize);
+
+} // namespace detail
+
+/**
+ * @brief write the elements of @p map to snapshot file
+ * @tparam Map container whose value is pair(e.g. UnorderedMap)
+ * @tparam Hash hash used by HashSnapshot to read the file
+ * @note
+ * The load factor of snapshot is 1.0, and each bucket costs 8 bytes.
+ * Building it needs memory about the size of file.
+ */
+template<typename Map, typename Hash = SnapshotHash<SnapshotKeyOf<Map>>>
+void
+saveHashSnapshot(Map const& map, char const* path, Hash hash = Hash{}) {
+    using K = SnapshotKeyOf<Map>;
+    using T = SnapshotMappedOf<Map>;
+    using Entry = SnapshotEntry<K, T>;
+
+    static_assert(alignof(Entry) <= HashSnapshotHeader::SECTION_ALIGN,
+                  "The entry is over aligned");
+
+    const uint64_t n = map.size();
+    const uint64_t bucketCount = n ? n : 1;
+
+    // counting sort the elements by bucket
+    Vector<uint64_t> buckets(bucketCount + 1, 0);
+    Vector<uint64_t> slots(n, 0);
+
+    size_t i = 0;
+    for (auto const& kv : map) {
+        slots[i] = hashDivision(hash(kv.first), bucketCount);
+        ++buckets[slots[i] + 1];
+        ++i;
+    }
+
+    for (uint64_t b = 0; b != bucketCount; ++b) {
+        buckets[b + 1] += buckets[b];
+    }
+
+    // The padding of entries is zero, so the same map produces same file
+    Vector<char> entries(n * sizeof(Entry), 0);
+    Vector<uint64_t> cursors(buckets.begin(), buckets.end());
+    std::string blob;
+
+    i = 0;
+    for (auto const& kv : map) {
+        const auto key = SnapshotField<K>::store(kv.first, blob);
+        const auto value = SnapshotField<T>::store(kv.second, blob);
+
+        auto entry = entries.begin() + cursors[slots[i++]]++ * sizeof(Entry);
+        memcpy(entry + offsetof(Entry, key), &key, sizeof key);
+        memcpy(entry + offsetof(Entry, value), &value, sizeof value);
+    }
+
+    detail::writeHashSnapshot(
+        path, sizeof(Entry), bucketCount, n,
+        buckets.begin(), entries.begin(), blob.data(), blob.size());
+}
+
+/**
+ * @class HashSnapshot
+ * @tparam K key type, trivially copyable or std::string
+ * @tparam T mapped type, trivially copyable or std::string
+ * @tparam Hash must be same as the one used by saveHashSnapshot()
+ * @brief
+ * Read-only map over the file written by saveHashSnapshot().
+ * The file is mapped and searched in place without deserializing,
+ * so opening it is O(1) and the pages are faulted in by lookups.
+ * The string is returned as string_view into the mapping,
+ * which is valid as long as the snapshot.
+ * @note
+ * Only the header and the bounds of sections are checked when opening,
+ * the content is trusted since touching all of it defeats the purpose.
+ */
+template<typename K, typename T, typename Hash = SnapshotHash<K>>
+class HashSnapshot {
+    using KeyField = SnapshotField<K>;
+    using MappedField = SnapshotField<T>;
+    using Entry = SnapshotEntry<K, T>;
+public:
+    using key_type = K;
+    using mapped_type = T;
+    using size_type = size_t;
+    // the type of lookup key, string_view for std::string
+    using key_arg = typename KeyField::arg_type;
+    using key_view = typename KeyField::view_type;
+    using mapped_view = typename MappedField::view_type;
+
+    HashSnapshot() = default;
+
+    explicit HashSnapshot(char const* path, Hash hash = Hash{})
+        : file_(path)
+        , hash_(hash)
+    {
+        auto const& header = detail::checkHashSnapshot(file_, path, sizeof(Entry));
+        auto const base = file_.data();
+
+        buckets_ = reinterpret_cast<uint64_t const*>(base + header.bucketsOffset);
+        entries_ = reinterpret_cast<Entry const*>(base + header.entriesOffset);
+        blob_ = base + header.blobOffset;
+        bucketCount_ = header.bucketCount;
+        size_ = header.elementCount;
+    }
+
+    /**
+     * @brief search @p key and store the view of its value in @p out
+     * @return false if key is not found, @p out is not modified
+     */
+    bool find(key_arg key, mapped_view& out) const {
+        auto entry = findEntry(key);
+        if (entry) {
+            out = MappedField::load(entry->value, blob_);
+            return true;
+        }
+        return false;
+    }
+
+    bool contains(key_arg key) const
+    { return findEntry(key) != nullptr; }
+
+    size_type count(key_arg key) const
+    { return findEntry(key) ? 1 : 0; }
+
+    /**
+     * @brief call f(key_view, mapped_view) for each element
+     * @note in the order of buckets
+     */
+    template<typename F>
+    void forEach(F f) const {
+        for (size_type i = 0; i != size_; ++i) {
+            f(KeyField::load(entries_[i].key, blob_),
+              MappedField::load(entries_[i].value, blob_));
+        }
+    }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return size_ == 0; }
+
+    size_type bucket_count() const ZSTL_NOEXCEPT
+    { return bucketCount_; }
+
+    MappedFile const& file() const ZSTL_NOEXCEPT
+    { return file_; }
+
+private:
+    Entry const* findEntry(key_arg key) const {
+        if (bucketCount_ == 0) {
+            return nullptr;
+        }
+
+        const auto b = hashDivision(hash_(key), bucketCount_);
+        for (auto i = buckets_[b]; i != buckets_[b + 1]; ++i) {
+            if (KeyField::load(entries_[i].key, blob_) == key) {
+                return &entries_[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    MappedFile file_;
+    Hash hash_;
+    uint64_t const* buckets_ = nullptr;
+    Entry const* entries_ = nullptr;
+    char const* blob_ = nullptr;
+    uint64_t bucketCount_ = 0;
+    uint64_t size_ = 0;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_HASH_SNAPSHOT_H
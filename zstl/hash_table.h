@@ -6,13 +6,34 @@
 #include "allocator.h"
 #include "vector.h"
 #include "hash_aux.h"
+#include "hash_table/hash_node.h"
+#include "hash_table/hash_stats.h"
+#include "hash_table/bucket_bitmap.h"
+#include "hash_table/node_handle.h"
 
 #ifdef HASH_DEBUG
 #include <iostream>
-#endif 
+#endif
 
 namespace zstl {
 
+/**
+ * @enum RehashPolicy
+ * @brief
+ * Determine how the table is expanded when load factor exceeds 1.0
+ * (1) Once: move every node to the new table in one go
+ * (2) Incremental: keep the old and new table at the same time,
+ * each insert only migrates a bounded number of buckets,
+ * and lookups consult both tables until the migration is completed:
+ * a key belongs to the bucket of old table if it has not been migrated,
+ * otherwise the bucket of new table.
+ * This bounds the latency of single insert.
+ */
+enum class RehashPolicy : bool {
+    Once = false,
+    Incremental = true
+};
+
 /**
  * @class HashTable
  * @tparam V value type
@@ -21,7 +42,7 @@ namespace zstl {
  * @tparam GK method which get key from value
  * @tparam EK method which compares two key whether them is equivalent
  * @tparam Alloc Allocator type(default is zstl::allocator)
- * @brief 
+ * @brief
  * Implementation of hash table.
  * Its average time complexity of search is O(1)
  * @see <<Introdunction To Algorithms>> 11.2
@@ -31,12 +52,6 @@ typename V,typename K,typename H,typename GK,typename EK,
 typename Alloc=zstl::allocator<V>>
 class HashTable;
 
-/**
- * @struct HashNode
- * @tparam T value type of hashtable
- * @brief node of linked list which used in chaining hashtable
- */
-
 /**
  * @class HashConstIterator
  * @tparam V value type
@@ -64,29 +79,27 @@ public:
     using node            = HashNode<V>;
     using hash_table      = HashTable<V, K, H, GK, EK, Alloc>;
 
-    HashConstIterator(node *cur, hash_table const &ht)
+    HashConstIterator()
+        : cur_{ nullptr }
+        , ht_{ nullptr }
+        , bucket_{ static_cast<size_type>(-1) }
+    { }
+
+    // bucket is the cursor of hashtable, unknown(-1) by default
+    HashConstIterator(node *cur, hash_table const &ht,
+                      size_type bucket = static_cast<size_type>(-1))
         : cur_{ cur }
-        , ht_{ ht }
+        , ht_{ &ht }
+        , bucket_{ bucket }
     { }
 
-    reference operator*() const ZSTL_NOEXCEPT 
+    reference operator*() const ZSTL_NOEXCEPT
     { return cur_->val; }
     pointer   operator->() const ZSTL_NOEXCEPT
-    { return cur_; }
+    { return &cur_->val; }
 
     self& operator++() {
-        const auto old_node = cur_;
-        cur_ = cur_->next;
-
-        if (!cur_) {
-            auto hash_val = ht_.hashVal(old_node->val) + 1;
-
-            for (; hash_val < ht_.tableSize(); ++hash_val) {
-                cur_ = ht_.table()[hash_val]->next;
-                if (cur_)
-                    break;
-            }
-        }
+        cur_ = ht_->nextNode(cur_, bucket_);
         return *this;
     }
 
@@ -106,7 +119,9 @@ public:
 
 protected:
     node* cur_;
-    hash_table const& ht_;
+    hash_table const* ht_;
+    // the bucket of cur_, so moving to next chain need not rehash the key
+    size_type bucket_;
 
     friend class HashTable<V,K,H,GK,EK,Alloc>;
 };
@@ -122,7 +137,7 @@ protected:
  * @tparam Alloc Allocator type(default is zstl::allocator)
  */
 template <
-typename V, typename K, typename H, typename GK, typename EK, 
+typename V, typename K, typename H, typename GK, typename EK,
 typename Alloc>
 class HashIterator : public HashConstIterator<V, K, H, GK, EK, Alloc>
 {
@@ -137,29 +152,22 @@ public:
     using base              = HashConstIterator<V,K,H,GK,EK,Alloc>;
     using node              = typename base::node;
     using hash_table        = typename base::hash_table;
+    using size_type         = typename base::size_type;
+
+    HashIterator() = default;
 
-    HashIterator(node *cur, hash_table const &ht)
-        : base::HashConstIterator(cur, ht)
+    HashIterator(node *cur, hash_table const &ht,
+                 size_type bucket = static_cast<size_type>(-1))
+        : base::HashConstIterator(cur, ht, bucket)
     { }
 
-    reference operator*() const ZSTL_NOEXCEPT 
+    reference operator*() const ZSTL_NOEXCEPT
     { return cur_->val; }
     pointer   operator->() const ZSTL_NOEXCEPT
-    { return cur_; }
+    { return &cur_->val; }
 
     self& operator++() {
-        const auto old_node = cur_;
-        cur_ = cur_->next;
-
-        if (!cur_) {
-            auto hash_val = ht_.hashVal(old_node->val) + 1;
-
-            for (; hash_val < ht_.tableSize(); ++hash_val) {
-                cur_ = ht_.table()[hash_val]->next;
-                if (cur_)
-                    break;
-            }
-        }
+        cur_ = ht_->nextNode(cur_, bucket_);
         return *this;
     }
 
@@ -173,6 +181,7 @@ public:
 
     using base::cur_;
     using base::ht_;
+    using base::bucket_;
 };
 
 template<
@@ -201,43 +210,181 @@ public:
     using iterator        = typename HashIterator<V, K, H, GK, EK, Alloc>::iterator;
     using const_iterator  = typename HashConstIterator<V, K, H, GK, EK, Alloc>::const_iterator;
     using Self            = HashTable;
+    using node_type       = HashNodeHandle<V, NodeAllocator>;
+    using insert_return_type = NodeInsertReturn<iterator, node_type>;
+
+    /**
+     * Check if heterogeneous lookup by KT is enabled
+     * @note KT is dependent, so that the lookup overloads can be SFINAE out
+     */
+    template<typename KT>
+    struct IsTransparent
+    : Bool_constant<HasTypeT_is_transparent<H>::value &&
+                    HasTypeT_is_transparent<EK>::value>
+    { };
+
+    /**
+     * The maximum number of non-empty buckets
+     * migrated by one modifying operation in incremental rehash
+     */
+    static constexpr size_type REHASH_STEP = 4;
+
+    /**
+     * The number of keys resolved together by find_batch(),
+     * it bounds the cache misses in flight
+     */
+    static constexpr size_type BATCH_SIZE = 16;
+
+    /**
+     * The number of buckets checked one by one when iterating
+     * before looking up the occupancy bitmap
+     */
+    static constexpr size_type BUCKET_PROBE = 4;
 
     //contruct/copy/deconsturct
-    HashTable() 
+    HashTable()
         : impl_{ 0 }
     { }
 
     explicit HashTable(size_type const n)
         : impl_{ n }
-    { initTable(n); }
+    { }
+
+    explicit HashTable(RehashPolicy policy)
+        : impl_{ 0, policy }
+    { }
+
+    HashTable(size_type const n, RehashPolicy policy)
+        : impl_{ n, policy }
+    { }
 
     ~HashTable() { clear(); }
-    // HashTable(HashTable const &);
-    // HashTable(HashTable &&);
-    // HashTable &operator=(HashTable const &);
-    // HashTable &operator=(HashTable &&);
+    HashTable(HashTable const& rhs);
+    HashTable(HashTable&& rhs) ZSTL_NOEXCEPT;
+    HashTable& operator=(HashTable const& rhs);
+    HashTable& operator=(HashTable&& rhs) ZSTL_NOEXCEPT;
+
+    void swap(HashTable& rhs) ZSTL_NOEXCEPT;
 
     //modifiers
+    /**
+     * @brief insert value if there is no element with equivalent key
+     * @note
+     * search the key of value first,
+     * only allocate node when it is actually inserted
+     */
+    zstl::pair<iterator, bool> insertUnique(value_type const& val)
+    { return tryEmplaceUnique(getKey()(val), val); }
+
+    zstl::pair<iterator, bool> insertUnique(value_type&& val)
+    { return tryEmplaceUnique(getKey()(val), STL_MOVE(val)); }
+
+    /**
+     * @brief construct value in place and insert it if key is unique
+     * @note
+     * the key is unknown until the value is constructed,
+     * so node is created first and dropped if key is duplicate
+     */
+    template<typename... Args>
+    zstl::pair<iterator, bool> emplaceUnique(Args&&... args);
+
+    /**
+     * @brief construct value from @p args only if @p key is not in table
+     * @param key the key of the value constructed from args
+     * @param args arguments used to construct value
+     */
+    template<typename... Args>
+    zstl::pair<iterator, bool> tryEmplaceUnique(key_type const& key, Args&&... args);
+
+    /**
+     * @brief insert value even if there are elements with equivalent key
+     * @note
+     * The new node is linked right after the first element with equivalent key,
+     * so the elements with same key are adjacent in chain(a group)
+     * and equal_range() is a contiguous walk.
+     * Rehash keeps the groups although moveBucket() reverses the chain:
+     * a group is contiguous in one old chain and goes to one new bucket,
+     * so its nodes are pushed to the front of it one after another
+     * with no other key in between.
+     */
+    iterator insertEqual(value_type const& val)
+    { return emplaceEqual(val); }
+
+    iterator insertEqual(value_type&& val)
+    { return emplaceEqual(STL_MOVE(val)); }
+
     template<typename... Args>
-    zstl::pair<iterator, bool> insertUnique(Args&&... args);
+    iterator emplaceEqual(Args&&... args);
+
+    /**
+     * @brief remove the element at pos
+     * @return iterator following the removed element
+     * @note erase() don't migrate buckets in incremental rehash,
+     * so it is safe to erase elements during iterating
+     */
+    iterator erase(const_iterator pos);
+
+    // remove all elements with equivalent key, return the number of them
+    size_type erase(key_type const& key);
+
+    /**
+     * Node handle interface:
+     * extract() unlinks the node from table and hands it to caller,
+     * insertUnique(node_type) and mergeUnique() relink the existing node,
+     * so no node is allocated or freed and the value is not copied.
+     * @note The tables must share allocator(this is ensured by same type
+     * since allocator is stateless)
+     */
+    node_type extract(const_iterator pos);
+    node_type extract(key_type const& key);
+
+    /**
+     * @brief insert the node owned by @p nh if its key is unique
+     * @return the node is given back if it is not inserted
+     */
+    insert_return_type insertUnique(node_type&& nh);
+
+    // insert the node owned by @p nh, end() if nh is empty
+    iterator insertEqual(node_type&& nh);
+
+    /**
+     * @brief relink the nodes of @p other whose key is not in this table
+     * @note the nodes with duplicate key are left in @p other
+     */
+    void mergeUnique(HashTable& other);
+
+    void mergeUnique(HashTable&& other)
+    { mergeUnique(other); }
 
     void clear();
 
     // position interface
     iterator begin() ZSTL_NOEXCEPT
-    { return makeIter(getFirstList()); }
+    {
+        size_type cursor;
+        auto first = getFirstList(cursor);
+        return makeIter(first, cursor);
+    }
 
     iterator end() ZSTL_NOEXCEPT
     { return makeIter(nullptr); }
 
     const_iterator begin() const ZSTL_NOEXCEPT
-    { return makeConstIter(getFirstList()); }
+    {
+        size_type cursor;
+        auto first = getFirstList(cursor);
+        return makeConstIter(first, cursor);
+    }
 
     const_iterator end() const ZSTL_NOEXCEPT
     { return makeConstIter(nullptr); }
 
     const_iterator cbegin() const ZSTL_NOEXCEPT
-    { return makeConstIter(getFirstList()); }
+    {
+        size_type cursor;
+        auto first = getFirstList(cursor);
+        return makeConstIter(first, cursor);
+    }
 
     const_iterator cend() const ZSTL_NOEXCEPT
     { return makeConstIter(nullptr); }
@@ -249,14 +396,14 @@ public:
     size_type size() const ZSTL_NOEXCEPT
     { return impl_.numElements; }
 
-    bool empty() const ZSTL_NOEXCEPT 
-    { return size(); }
+    bool empty() const ZSTL_NOEXCEPT
+    { return size() == 0; }
 
     size_type max_size() const ZSTL_NOEXCEPT
     { return PRIME_LIST[PRIMES_NUM-1]; }
 
     Table const& table() const ZSTL_NOEXCEPT
-    { return impl_.table; }    
+    { return impl_.table; }
 
     size_type tableSize() const ZSTL_NOEXCEPT
     { return impl_.table.size(); }
@@ -273,31 +420,125 @@ public:
     HashMethod hashMethod() const ZSTL_NOEXCEPT
     { return impl_.hashMethod; }
 
-    size_type table_num(key_type const& key) const;
+    // the index of bucket which key belongs to
+    size_type table_num(key_type const& key) const
+    { return hashKey(key); }
+
+    // the length of chain in bucket table_num
     size_type table_count(size_type table_num) const;
 
     // special search operation
     iterator find(key_type const& key);
-    // size_type count(key_type const& key);
-    // pair<iterator,iterator> equal_range(key_type const& key);
-    // pair<const_iterator,const_iterator> equal_range(key_type const& key) const;
+    const_iterator find(key_type const& key) const;
+
+    // the size of group, it stops at the end of group
+    size_type count(key_type const& key) const
+    { return countGroup(findNode(key), key); }
+
+    bool contains(key_type const& key) const
+    { return findNode(key) != nullptr; }
+
+    pair<iterator,iterator> equal_range(key_type const& key);
+    pair<const_iterator,const_iterator> equal_range(key_type const& key) const;
+
+    /**
+     * Heterogeneous lookup:
+     * If both H and EK define is_transparent(e.g. string_hash and equal_to<>),
+     * the lookup accept any type which can be hashed and compared with key,
+     * so no temporary key_type is constructed.
+     * @note H must produce identical hash value for equivalent keys of different types
+     */
+    template<typename KT, typename = Enable_if_t<IsTransparent<KT>::value>>
+    iterator find(KT const& key)
+    { return makeIter(findNode(key)); }
+
+    template<typename KT, typename = Enable_if_t<IsTransparent<KT>::value>>
+    const_iterator find(KT const& key) const
+    { return makeConstIter(findNode(key)); }
+
+    template<typename KT, typename = Enable_if_t<IsTransparent<KT>::value>>
+    size_type count(KT const& key) const
+    { return countGroup(findNode(key), key); }
+
+    template<typename KT, typename = Enable_if_t<IsTransparent<KT>::value>>
+    bool contains(KT const& key) const
+    { return findNode(key) != nullptr; }
+
+    /**
+     * @brief search @p n keys, store the result of keys[i] in out[i]
+     * @note
+     * The keys are resolved by group of BATCH_SIZE in three passes:
+     * compute hash and prefetch the bucket of each key,
+     * then load the bucket and prefetch its first node,
+     * at last walk the chains.
+     * Therefore, the memory accesses of different keys are overlapped
+     * instead of stalling on each one like looping over find().
+     * This is profitable when table is much larger than cache.
+     */
+    void find_batch(key_type const* keys, size_type n, iterator* out)
+    { findBatch(keys, n, out); }
+
+    void find_batch(key_type const* keys, size_type n, const_iterator* out) const
+    { findBatch(keys, n, out); }
+
+    template<typename KT, typename = Enable_if_t<IsTransparent<KT>::value>>
+    void find_batch(KT const* keys, size_type n, iterator* out)
+    { findBatch(keys, n, out); }
+
+    template<typename KT, typename = Enable_if_t<IsTransparent<KT>::value>>
+    void find_batch(KT const* keys, size_type n, const_iterator* out) const
+    { findBatch(keys, n, out); }
 
-    
     // rehash
     void rehash(size_type hint);
 
+    void reserve(size_type n)
+    { rehash(n); }
+
+    /**
+     * @brief
+     * Migrate at most n non-empty buckets from old table to new table
+     * @note do nothing if there is no incremental rehash in progress
+     */
+    void rehashStep(size_type n = REHASH_STEP);
+
+    /**
+     * @brief whether an incremental rehash is in progress
+     */
+    bool isRehashing() const ZSTL_NOEXCEPT
+    { return !impl_.oldTable.empty(); }
+
+    RehashPolicy rehashPolicy() const ZSTL_NOEXCEPT
+    { return impl_.rehashPolicy; }
+
+    void setRehashPolicy(RehashPolicy policy) ZSTL_NOEXCEPT
+    { impl_.rehashPolicy = policy; }
+
     double load_factor() const ZSTL_NOEXCEPT
     { return static_cast<double>(size()) / tableSize(); }
 
+    // statistics
+    /**
+     * @brief walk every bucket to collect the distribution of chains
+     * @note O(bucket number), don't call it in hot path
+     */
+    HashTableStats stats() const;
+
+    HashTableCounters const& counters() const ZSTL_NOEXCEPT
+    { return impl_.counters; }
+
+    void resetCounters() ZSTL_NOEXCEPT
+    { impl_.counters = HashTableCounters{}; }
+
     // allocator
-    allocator_type&
-    get_allocator() const ZSTL_NOEXCEPT 
+    allocator_type
+    get_allocator() const ZSTL_NOEXCEPT
     { return impl_; }
 
-    ZSTL_CONSTEXPR size_type 
+    ZSTL_CONSTEXPR size_type
     hashKey(key_type const& key) const ZSTL_NOEXCEPT;
 
-    ZSTL_CONSTEXPR size_type 
+    ZSTL_CONSTEXPR size_type
     hashVal(value_type const& val) const ZSTL_NOEXCEPT;
 
     // debug helper
@@ -309,62 +550,135 @@ public:
     friend bool operator!=(HashTable const& lhs,HashTable const& rhs) noexcept;
 private:
     NodeAllocator&
-    getNodeAllocator() 
+    getNodeAllocator()
     { return impl_; }
 
-    void initTable(size_type const n);
-    Node* getFirstList() const;
+    /**
+     * The bucket cursor carried by iterator:
+     * index of table(), or index of old table marked by OLD_CURSOR,
+     * UNKNOWN_CURSOR means it is computed from the key when needed
+     */
+    static constexpr size_type OLD_CURSOR = ~(~size_type(0) >> 1);
+    static constexpr size_type UNKNOWN_CURSOR = ~size_type(0);
+
+    Node* getFirstList(size_type& cursor) const;
+    Node* nextNode(Node* node, size_type& cursor) const;
+    size_type cursorOf(Node* node) const;
+    static size_type firstBucketFrom(
+        Table const& table, BucketBitmap const& occupied, size_type index) ZSTL_NOEXCEPT;
 
     Table& table() ZSTL_NOEXCEPT
     { return impl_.table; }
 
-    void reclaimSentinel(Table& table);
-
     void incElemensNum(size_type n) ZSTL_NOEXCEPT
     { impl_.numElements += n; }
 
     void decElementNums(size_type n) ZSTL_NOEXCEPT
-    { impl_.numElement -= n; }
-
-    template<typename Args> pair<iterator,bool> insert_unique_norehash(Args&& val);
-    template<typename Args> iterator insert_unique_norehash(const_iterator hint,Args&& val);
+    { impl_.numElements -= n; }
 
-    template<typename Args> iterator insert_equal_norehash(Args&& val);
-    template<typename Args> iterator insert_equal_norehash(const_iterator hint,Args&& val);
-    
     // hash function forward
+    template<typename KT>
+    size_type bucketIndex(KT const& key, size_type slots) const ZSTL_NOEXCEPT
+    { return hashMethod()(hash()(key), slots); }
+
+    // lookup helper
+    // KT is key_type or other type when heterogeneous lookup is enabled
+    template<typename KT>
+    Node* findNode(KT const& key) const;
+
+    // the last node of group which begins with first
+    template<typename KT>
+    Node* groupLast(Node* first, KT const& key) const;
+
+    template<typename KT>
+    size_type countGroup(Node* first, KT const& key) const;
+
+    // link the node after the first one with equivalent key if exists
+    void linkNodeEqual(Node* node);
+
+    // resolve at most BATCH_SIZE keys, see find_batch()
+    template<typename KT>
+    void findNodes(KT const* keys, size_type n, Node** nodes) const;
+
+    template<typename KT, typename Iter>
+    void findBatch(KT const* keys, size_type n, Iter* out) const;
+
+    // During incremental rehash, the key belongs to the bucket of old table
+    // if that bucket has not been migrated, otherwise the bucket of new table.
+    // Therefore, every key is just in one bucket.
+    struct BucketPos {
+        bool old;
+        size_type index;
+    };
+
+    template<typename KT>
+    BucketPos bucketPos(KT const& key) const ZSTL_NOEXCEPT;
+
+    template<typename KT>
+    Node* const& bucketHead(KT const& key) const ZSTL_NOEXCEPT
+    { return bucketAt(bucketPos(key)); }
+
+    Node* const& bucketAt(BucketPos pos) const ZSTL_NOEXCEPT
+    { return pos.old ? impl_.oldTable[pos.index] : table()[pos.index]; }
+
+    Node*& bucketAt(BucketPos pos) ZSTL_NOEXCEPT
+    { return pos.old ? impl_.oldTable[pos.index] : table()[pos.index]; }
+
+    // keep the bit of bucket consistent with whether it is empty
+    void updateOccupied(BucketPos pos) ZSTL_NOEXCEPT;
+
+    // rehash helper
+    void moveBucket(Node*& head) ZSTL_NOEXCEPT;
+    void finishRehash() ZSTL_NOEXCEPT;
 
     //linked list helper
-    template<typename ...Args> 
+    template<typename ...Args>
     Node* newNode(Args&&... val);
     void destroyNode(Node* node);
+    void destroyList(Node*& head);
+    void destroyTable(Table& table, BucketBitmap& occupied);
+    void linkNode(BucketPos pos, Node* node) ZSTL_NOEXCEPT;
+    void unlinkNode(Node* node) ZSTL_NOEXCEPT;
+    // link the node whose key is known not in table
+    void relinkNode(Node* node);
+    void mergeBuckets(HashTable& other, Table& table,
+                      BucketBitmap& occupied, size_type first);
+    void copyFrom(HashTable const& rhs);
 
     //iterator construct helper
-    iterator 
-    makeIter(Node* node) const ZSTL_NOEXCEPT
-    { return iterator(node,*this); }
+    iterator
+    makeIter(Node* node, size_type cursor = UNKNOWN_CURSOR) const ZSTL_NOEXCEPT
+    { return iterator(node,*this,cursor); }
 
 
-    const_iterator 
-    makeConstIter(Node* node) const ZSTL_NOEXCEPT
-    { return const_iterator(node,*this); }
+    const_iterator
+    makeConstIter(Node* node, size_type cursor = UNKNOWN_CURSOR) const ZSTL_NOEXCEPT
+    { return const_iterator(node,*this,cursor); }
 
     //friend declaration
     friend class HashIterator<V,K,H,GK,EK,Alloc>;
     friend class HashConstIterator<V,K,H,GK,EK,Alloc>;
 
 private:
-    struct Impl 
+    struct Impl
     : NodeAllocator
     , Alloc {
         explicit Impl(
-            size_type n, 
+            size_type n,
+            RehashPolicy rehashPolicy_ = RehashPolicy::Once,
             H hashFun_ = H{},
-            HashMethod hashMethod_ = &hashDivision)
-            : hashFun{ hashFun_ }
+            HashMethod hashMethod_ = &hashDivision,
+            GK getKey_ = GK{},
+            EK equalKey_ = EK{})
+            : getKey{ getKey_ }
+            , equalKey{ equalKey_ }
+            , hashFun{ hashFun_ }
             , hashMethod{ hashMethod_ }
             , numElements{ 0 }
-            , table{ n, nullptr }
+            , table(n, nullptr)
+            , occupied(n)
+            , rehashIndex{ 0 }
+            , rehashPolicy{ rehashPolicy_ }
         { }
 
         GK getKey;
@@ -373,6 +687,19 @@ private:
         HashMethod hashMethod;
         size_type numElements;
         Vector<Node*> table;
+        BucketBitmap occupied;
+
+        // Used for incremental rehash only.
+        // The buckets of oldTable whose index is less than rehashIndex
+        // have been migrated to table(empty).
+        Vector<Node*> oldTable;
+        BucketBitmap oldOccupied;
+        size_type rehashIndex;
+        RehashPolicy rehashPolicy;
+
+        HashTableCounters counters;
+        // when the unfinished migration started
+        HashStatsClock::time_point rehashStart;
     };
 
     Impl impl_;
@@ -384,11 +711,26 @@ private:
 #define HASHTABLE \
     HashTable<V, K, H, GK, EK, Alloc>
 
+TEMPLATE_OF_HASHTABLE
+constexpr typename HASHTABLE::size_type HASHTABLE::REHASH_STEP;
+
+TEMPLATE_OF_HASHTABLE
+constexpr typename HASHTABLE::size_type HASHTABLE::BATCH_SIZE;
+
+TEMPLATE_OF_HASHTABLE
+constexpr typename HASHTABLE::size_type HASHTABLE::BUCKET_PROBE;
+
+TEMPLATE_OF_HASHTABLE
+constexpr typename HASHTABLE::size_type HASHTABLE::OLD_CURSOR;
+
+TEMPLATE_OF_HASHTABLE
+constexpr typename HASHTABLE::size_type HASHTABLE::UNKNOWN_CURSOR;
+
 TEMPLATE_OF_HASHTABLE
 ZSTL_CONSTEXPR auto
 HASHTABLE::hashKey(key_type const& key) const ZSTL_NOEXCEPT
 -> size_type {
-    return hashMethod()(hash()(key), tableSize());
+    return bucketIndex(key, tableSize());
 }
 
 TEMPLATE_OF_HASHTABLE
@@ -398,21 +740,122 @@ HASHTABLE::hashVal(value_type const& val) const ZSTL_NOEXCEPT
     return hashKey(getKey()(val));
 }
 
+TEMPLATE_OF_HASHTABLE
+HASHTABLE::HashTable(HashTable const& rhs)
+    : impl_{
+        rhs.tableSize(), rhs.rehashPolicy(), rhs.hash(), rhs.hashMethod(),
+        rhs.getKey(), rhs.equalKey() }
+{
+    copyFrom(rhs);
+}
+
+TEMPLATE_OF_HASHTABLE
+HASHTABLE::HashTable(HashTable&& rhs) ZSTL_NOEXCEPT
+    : impl_{
+        0, rhs.rehashPolicy(), rhs.hash(), rhs.hashMethod(),
+        rhs.getKey(), rhs.equalKey() }
+{
+    this->swap(rhs);
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::operator=(HashTable const& rhs)
+-> HashTable& {
+    if (this != &rhs) {
+        HashTable tmp(rhs);
+        this->swap(tmp);
+    }
+
+    return *this;
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::operator=(HashTable&& rhs) ZSTL_NOEXCEPT
+-> HashTable& {
+    if (this != &rhs) {
+        HashTable tmp(STL_MOVE(rhs));
+        this->swap(tmp);
+    }
+
+    return *this;
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::swap(HashTable& rhs) ZSTL_NOEXCEPT {
+    STL_SWAP(impl_.getKey, rhs.impl_.getKey);
+    STL_SWAP(impl_.equalKey, rhs.impl_.equalKey);
+    STL_SWAP(impl_.hashFun, rhs.impl_.hashFun);
+    STL_SWAP(impl_.hashMethod, rhs.impl_.hashMethod);
+    STL_SWAP(impl_.numElements, rhs.impl_.numElements);
+    impl_.table.swap(rhs.impl_.table);
+    impl_.occupied.swap(rhs.impl_.occupied);
+    impl_.oldTable.swap(rhs.impl_.oldTable);
+    impl_.oldOccupied.swap(rhs.impl_.oldOccupied);
+    STL_SWAP(impl_.rehashIndex, rhs.impl_.rehashIndex);
+    STL_SWAP(impl_.rehashPolicy, rhs.impl_.rehashPolicy);
+    STL_SWAP(impl_.counters, rhs.impl_.counters);
+    STL_SWAP(impl_.rehashStart, rhs.impl_.rehashStart);
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::copyFrom(HashTable const& rhs) {
+    // The table size is same as rhs
+    // but the unmigrated nodes of rhs are rehashed to new table here
+    TRY_BEGIN
+        for (auto const& val : rhs) {
+            linkNode(BucketPos{ false, hashVal(val) }, newNode(val));
+        }
+    TRY_END
+    CATCH_ALL_BEGIN
+        clear();
+        RETHROW
+    CATCH_END
+}
+
 TEMPLATE_OF_HASHTABLE
 template<typename ...Args>
 auto
-HASHTABLE::insertUnique(Args&& ...args) 
+HASHTABLE::tryEmplaceUnique(key_type const& key, Args&& ...args)
 -> zstl::pair<iterator, bool> {
+    // check if there are value with same key in table
+    auto dup = findNode(key);
+    if (dup) {
+        // exist same key
+        // no node is constructed
+        // and return status code(denoetd in pair::second)
+        return zstl::make_pair(makeIter(dup), false);
+    }
+
     rehash(size() + 1);
+    rehashStep();
+
+    // key may be a part of args which is moved to the new node,
+    // so get the bucket before constructing it
+    const auto pos = bucketPos(key);
+    const auto node = newNode(STL_FORWARD(Args, args)...);
+
+    linkNode(pos, node);
+    return zstl::make_pair(makeIter(node), true);
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename ...Args>
+auto
+HASHTABLE::emplaceUnique(Args&& ...args)
+-> zstl::pair<iterator, bool> {
+    rehash(size() + 1);
+    rehashStep();
 
     const auto node = newNode(STL_FORWARD(Args, args)...);
-    auto hashcode = hashVal(node->val);
-    assert(hashcode < tableSize() && hashcode >= 0);
 
-    auto head = table()[hashcode];
     // check if there are value with same key in linked list
-    for (auto h = head->next; h != nullptr; h = h->next) {
-        if (equalKey()(getKey()(h->val), node->val)) {
+    const auto pos = bucketPos(getKey()(node->val));
+    for (auto h = bucketAt(pos); h != nullptr; h = h->next) {
+        if (equalKey()(getKey()(h->val), getKey()(node->val))) {
             // exist same key
             // destory newly constructed node
             // and return status code(denoetd in pair::second)
@@ -423,114 +866,681 @@ HASHTABLE::insertUnique(Args&& ...args)
 
     // insert the newly node to linked list
     // ensure it is unique key in this linked list
-    node->next = head->next;
-    head->next = node;
+    linkNode(pos, node);
+    return zstl::make_pair(makeIter(node), true);
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename ...Args>
+auto
+HASHTABLE::emplaceEqual(Args&& ...args)
+-> iterator {
+    rehash(size() + 1);
+    rehashStep();
+
+    const auto node = newNode(STL_FORWARD(Args, args)...);
+    linkNodeEqual(node);
+    return makeIter(node);
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::insertEqual(node_type&& nh)
+-> iterator {
+    if (nh.empty()) {
+        return end();
+    }
+
+    // rehash may throw, so the handle owns the node until it is linked
+    const auto node = nh.node_;
+    rehash(size() + 1);
+    rehashStep();
+
+    linkNodeEqual(node);
+    nh.release();
+    return makeIter(node);
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::linkNodeEqual(Node* node) {
+    auto const& key = getKey()(node->val);
+    const auto pos = bucketPos(key);
+
+    for (auto h = bucketAt(pos); h != nullptr; h = h->next) {
+        if (equalKey()(getKey()(h->val), key)) {
+            node->next = h->next;
+            h->next = node;
+            incElemensNum(1);
+            return;
+        }
+    }
+
+    linkNode(pos, node);
+}
+
+TEMPLATE_OF_HASHTABLE
+inline void
+HASHTABLE::linkNode(BucketPos pos, Node* node) ZSTL_NOEXCEPT {
+    auto& head = bucketAt(pos);
+    node->next = head;
+    head = node;
+    (pos.old ? impl_.oldOccupied : impl_.occupied).set(pos.index);
     incElemensNum(1);
+}
 
-    return zstl::make_pair(makeIter(node), true);
+TEMPLATE_OF_HASHTABLE
+inline void
+HASHTABLE::updateOccupied(BucketPos pos) ZSTL_NOEXCEPT {
+    if (bucketAt(pos) == nullptr) {
+        (pos.old ? impl_.oldOccupied : impl_.occupied).reset(pos.index);
+    }
 }
 
 TEMPLATE_OF_HASHTABLE
 auto
-HASHTABLE::find(key_type const& key) 
+HASHTABLE::erase(const_iterator pos)
 -> iterator {
-    const auto hashcode = hashKey(key);
+    const auto node = pos.cur_;
+    assert(node);
+
+    auto cursor = pos.bucket_;
+    const auto next = nextNode(node, cursor);
+
+    unlinkNode(node);
+    destroyNode(node);
+
+    return makeIter(next, cursor);
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::unlinkNode(Node* node) ZSTL_NOEXCEPT {
+    // find the link pointing to node and unlink it
+    const auto bucket = bucketPos(getKey()(node->val));
+    auto link = &bucketAt(bucket);
+    while (*link != node) {
+        assert(*link);
+        link = &(*link)->next;
+    }
+
+    *link = node->next;
+    updateOccupied(bucket);
+    decElementNums(1);
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::extract(const_iterator pos)
+-> node_type {
+    const auto node = pos.cur_;
+    assert(node);
+
+    unlinkNode(node);
+    node->next = nullptr;
+    return node_type(node, getNodeAllocator());
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::extract(key_type const& key)
+-> node_type {
+    const auto node = findNode(key);
+    return node ? extract(makeConstIter(node)) : node_type{};
+}
+
+TEMPLATE_OF_HASHTABLE
+inline void
+HASHTABLE::relinkNode(Node* node) {
+    rehash(size() + 1);
+    rehashStep();
+
+    // the bucket is decided after rehash
+    linkNode(bucketPos(getKey()(node->val)), node);
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::insertUnique(node_type&& nh)
+-> insert_return_type {
+    if (nh.empty()) {
+        return insert_return_type{ end(), false, node_type{} };
+    }
+
+    const auto dup = findNode(getKey()(nh.value()));
+    if (dup) {
+        return insert_return_type{ makeIter(dup), false, STL_MOVE(nh) };
+    }
+
+    // rehash may throw, so the handle owns the node until it is linked
+    const auto node = nh.node_;
+    relinkNode(node);
+    nh.release();
+    return insert_return_type{ makeIter(node), true, node_type{} };
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::mergeUnique(HashTable& other) {
+    if (this == &other || other.empty()) {
+        return;
+    }
+
+    // expand once instead of growing while relinking
+    rehash(size() + other.size());
+
+    if (other.isRehashing()) {
+        mergeBuckets(other, other.impl_.oldTable,
+                     other.impl_.oldOccupied, other.impl_.rehashIndex);
+    }
+    mergeBuckets(other, other.table(), other.impl_.occupied, 0);
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::mergeBuckets(HashTable& other, Table& table,
+                        BucketBitmap& occupied, size_type first) {
+    for (auto i = occupied.findNext(first);
+         i < table.size();
+         i = occupied.findNext(i + 1)) {
+        auto link = &table[i];
+        while (*link) {
+            const auto node = *link;
+            if (findNode(getKey()(node->val))) {
+                link = &node->next;
+                continue;
+            }
+
+            *link = node->next;
+            other.decElementNums(1);
+            TRY_BEGIN
+                relinkNode(node);
+            TRY_END
+            CATCH_ALL_BEGIN
+                // give the node back to other
+                *link = node;
+                other.incElemensNum(1);
+                RETHROW
+            CATCH_END
+        }
+
+        if (table[i] == nullptr) {
+            occupied.reset(i);
+        }
+    }
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::erase(key_type const& key)
+-> size_type {
+    if (tableSize() == 0) {
+        return 0;
+    }
+
+    const auto pos = bucketPos(key);
+    auto link = &bucketAt(pos);
+    while (*link && !equalKey()(getKey()((*link)->val), key)) {
+        link = &(*link)->next;
+    }
+
+    // the group is contiguous.
+    // key may refer to an element of the group,
+    // so find the end of group before destroying any node
+    auto last = *link;
+    size_type n = 0;
+    while (last && equalKey()(getKey()(last->val), key)) {
+        last = last->next;
+        ++n;
+    }
+
+    for (auto node = *link; node != last; ) {
+        const auto next = node->next;
+        destroyNode(node);
+        node = next;
+    }
+    *link = last;
+
+    decElementNums(n);
+    updateOccupied(pos);
+    return n;
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename KT>
+inline auto
+HASHTABLE::bucketPos(KT const& key) const ZSTL_NOEXCEPT
+-> BucketPos {
+    if (isRehashing()) {
+        const auto oldHashcode = bucketIndex(key, impl_.oldTable.size());
+
+        if (oldHashcode >= impl_.rehashIndex) {
+            return BucketPos{ true, oldHashcode };
+        }
+    }
+
+    const auto hashcode = bucketIndex(key, tableSize());
     assert(hashcode >= 0 && hashcode < tableSize());
+    return BucketPos{ false, hashcode };
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename KT>
+auto
+HASHTABLE::findNode(KT const& key) const
+-> Node* {
+    if (tableSize() == 0) {
+        return nullptr;
+    }
+
+    for (auto h = bucketHead(key); h != nullptr; h = h->next) {
+        if (equalKey()(getKey()(h->val), key)) {
+            return h;
+        }
+    }
+
+    return nullptr;
+}
 
-    auto head = table()[hashcode];
+TEMPLATE_OF_HASHTABLE
+template<typename KT>
+inline auto
+HASHTABLE::groupLast(Node* first, KT const& key) const
+-> Node* {
+    while (first->next && equalKey()(getKey()(first->next->val), key)) {
+        first = first->next;
+    }
+
+    return first;
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename KT>
+inline auto
+HASHTABLE::countGroup(Node* first, KT const& key) const
+-> size_type {
+    size_type n = 0;
+    for (; first && equalKey()(getKey()(first->val), key); first = first->next) {
+        ++n;
+    }
+
+    return n;
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename KT>
+void
+HASHTABLE::findNodes(KT const* keys, size_type n, Node** nodes) const
+{
+    assert(n <= BATCH_SIZE);
+
+    if (tableSize() == 0) {
+        for (size_type i = 0; i != n; ++i) {
+            nodes[i] = nullptr;
+        }
+        return ;
+    }
+
+    Node* const* buckets[BATCH_SIZE];
+
+    // pass 1: hash and prefetch buckets
+    for (size_type i = 0; i != n; ++i) {
+        buckets[i] = &bucketHead(keys[i]);
+        ZSTL_PREFETCH(buckets[i]);
+    }
 
-    for (; head->next != nullptr; head = head->next) {
-        if (equalKey()(getKey()(head->val), key)) {
-            return makeIter(head);
+    // pass 2: load buckets and prefetch the first nodes
+    for (size_type i = 0; i != n; ++i) {
+        nodes[i] = *buckets[i];
+        if (nodes[i] != nullptr) {
+            ZSTL_PREFETCH(nodes[i]);
         }
     }
 
-    return end();
+    // pass 3: walk the chains
+    for (size_type i = 0; i != n; ++i) {
+        auto h = nodes[i];
+        while (h != nullptr && !equalKey()(getKey()(h->val), keys[i])) {
+            h = h->next;
+        }
+        nodes[i] = h;
+    }
+}
+
+TEMPLATE_OF_HASHTABLE
+template<typename KT, typename Iter>
+void
+HASHTABLE::findBatch(KT const* keys, size_type n, Iter* out) const
+{
+    Node* nodes[BATCH_SIZE];
+
+    for (size_type i = 0; i < n; i += BATCH_SIZE) {
+        const auto len = n - i < BATCH_SIZE ? n - i : BATCH_SIZE;
+        findNodes(keys + i, len, nodes);
+
+        for (size_type j = 0; j != len; ++j) {
+            out[i + j] = Iter(nodes[j], *this);
+        }
+    }
 }
 
 TEMPLATE_OF_HASHTABLE
-inline void 
+auto
+HASHTABLE::table_count(size_type table_num) const
+-> size_type {
+    size_type n = 0;
+    for (auto h = table()[table_num]; h != nullptr; h = h->next) {
+        ++n;
+    }
+
+    return n;
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::stats() const
+-> HashTableStats {
+    HashTableStats res;
+
+    auto account = [&res](Table const& table, size_type first) {
+        for (size_type i = first; i < table.size(); ++i) {
+            size_type len = 0;
+            for (auto h = table[i]; h != nullptr; h = h->next) {
+                ++len;
+            }
+            res.addChain(len);
+        }
+    };
+
+    // the migrated buckets of old table are empty, skip them
+    if (isRehashing()) {
+        account(impl_.oldTable, impl_.rehashIndex);
+    }
+
+    account(table(), 0);
+    res.finish();
+    res.counters = impl_.counters;
+
+    return res;
+}
+
+TEMPLATE_OF_HASHTABLE
+inline auto
+HASHTABLE::find(key_type const& key)
+-> iterator {
+    return makeIter(findNode(key));
+}
+
+TEMPLATE_OF_HASHTABLE
+inline auto
+HASHTABLE::find(key_type const& key) const
+-> const_iterator {
+    return makeConstIter(findNode(key));
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::equal_range(key_type const& key)
+-> pair<iterator, iterator> {
+    const auto node = findNode(key);
+
+    if (node) {
+        size_type cursor = UNKNOWN_CURSOR;
+        const auto next = nextNode(groupLast(node, key), cursor);
+        return zstl::make_pair(makeIter(node), makeIter(next, cursor));
+    }
+
+    return zstl::make_pair(end(), end());
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::equal_range(key_type const& key) const
+-> pair<const_iterator, const_iterator> {
+    const auto node = findNode(key);
+
+    if (node) {
+        size_type cursor = UNKNOWN_CURSOR;
+        const auto next = nextNode(groupLast(node, key), cursor);
+        return zstl::make_pair(makeConstIter(node), makeConstIter(next, cursor));
+    }
+
+    return zstl::make_pair(end(), end());
+}
+
+TEMPLATE_OF_HASHTABLE
+void
 HASHTABLE::rehash(size_type hint) {
-    // If load_factor > 1.0, 
+    // If load_factor > 1.0,
     // we expand the slots num
     if (hint > tableSize()) {
-        const auto oldSize = tableSize();
         const auto nextSize = nextPrime(hint);
 
-        Table oldTable;
-        oldTable.swap(table());
+        if (nextSize <= tableSize()) {
+            return ;
+        }
+
+        // The previous migration must be completed before starting new one,
+        // otherwise there are three tables
+        finishRehash();
+
+        const auto start = HashStatsClock::now();
+        ++impl_.counters.rehashCount;
 
-        table().resize(nextSize);
-        initTable(tableSize());
-        // Since the tableSize() has changed, 
+        // Since the tableSize() has changed,
         // we should reset the linked list to proper location.
         // It is difficult to set in previous table directly,
         // we use a new table then swap them to complete.
-        for (auto head : oldTable) {
-            auto real = head->next;
-            for (; real; real = head->next) {
-                auto newHashcode = hashVal(real->val);
+        Table oldTable(nextSize, nullptr);
+        oldTable.swap(table());
+        BucketBitmap oldOccupied(nextSize);
+        oldOccupied.swap(impl_.occupied);
+
+        if (rehashPolicy() == RehashPolicy::Incremental && size() != 0) {
+            // Just keep the old table,
+            // the buckets are migrated by rehashStep() later
+            impl_.oldTable.swap(oldTable);
+            impl_.oldOccupied.swap(oldOccupied);
+            impl_.rehashIndex = 0;
+            impl_.rehashStart = start;
+        } else {
+            for (auto i = oldOccupied.findNext(0);
+                 i < oldTable.size();
+                 i = oldOccupied.findNext(i + 1)) {
+                moveBucket(oldTable[i]);
+            }
+            impl_.counters.bucketsMigrated += oldTable.size();
+            impl_.counters.rehashNanos += hashStatsElapsed(start);
+        }
+    }
+}
 
-                auto newHead = table()[newHashcode];
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::rehashStep(size_type n) {
+    if (!isRehashing()) {
+        return ;
+    }
 
-                // remove the node from the old linked list
-                head->next = real->next;
+    auto& oldTable = impl_.oldTable;
+    auto& index = impl_.rehashIndex;
+    const auto first = index;
 
-                // insert the old node to new linked list
-                real->next = newHead->next;
-                newHead->next = real;
-            }
+    // A sparse old table may have long runs of empty buckets,
+    // limit the visits to them also to bound the work
+    auto emptyVisits = n * 10;
+
+    while (n != 0 && index < oldTable.size()) {
+        auto& head = oldTable[index++];
+
+        if (head) {
+            moveBucket(head);
+            impl_.oldOccupied.reset(index - 1);
+            --n;
+        } else if (--emptyVisits == 0) {
+            break;
         }
+    }
 
-        reclaimSentinel(oldTable);
+    impl_.counters.bucketsMigrated += index - first;
+
+    if (index == oldTable.size()) {
+        // release the old table
+        Table().swap(oldTable);
+        BucketBitmap().swap(impl_.oldOccupied);
+        index = 0;
+        impl_.counters.rehashNanos += hashStatsElapsed(impl_.rehashStart);
+    }
+}
+
+TEMPLATE_OF_HASHTABLE
+inline void
+HASHTABLE::finishRehash() ZSTL_NOEXCEPT {
+    if (isRehashing()) {
+        rehashStep(impl_.oldTable.size());
+    }
+}
+
+TEMPLATE_OF_HASHTABLE
+inline void
+HASHTABLE::moveBucket(Node*& head) ZSTL_NOEXCEPT {
+    while (head) {
+        auto real = head;
+
+        // remove the node from the old linked list
+        head = real->next;
+
+        // insert the old node to new linked list
+        const auto index = hashVal(real->val);
+        auto& newHead = table()[index];
+        real->next = newHead;
+        newHead = real;
+        impl_.occupied.set(index);
     }
 }
 
 TEMPLATE_OF_HASHTABLE
 inline auto
-HASHTABLE::getFirstList() const
+HASHTABLE::firstBucketFrom(
+    Table const& table, BucketBitmap const& occupied, size_type index) ZSTL_NOEXCEPT
+-> size_type {
+    // In dense table, the following bucket is likely non-empty,
+    // check a few buckets directly before skipping the empty run by bitmap
+    const auto probeEnd = index + BUCKET_PROBE < table.size()
+        ? index + BUCKET_PROBE : table.size();
+    for (; index < probeEnd; ++index) {
+        if (table[index]) {
+            return index;
+        }
+    }
+
+    return occupied.findNext(index);
+}
+
+TEMPLATE_OF_HASHTABLE
+inline auto
+HASHTABLE::getFirstList(size_type& cursor) const
 -> Node* {
-    for (auto& head : table()) {
-        if (head->next) {
-            return head->next;
+    // The unmigrated buckets of old table are iterated first
+    if (isRehashing()) {
+        const auto& oldTable = impl_.oldTable;
+        const auto index = firstBucketFrom(
+            oldTable, impl_.oldOccupied, impl_.rehashIndex);
+        if (index < oldTable.size()) {
+            cursor = index | OLD_CURSOR;
+            return oldTable[index];
         }
     }
 
-    return nullptr;
+    const auto index = firstBucketFrom(table(), impl_.occupied, 0);
+    cursor = index;
+    return index < tableSize() ? table()[index] : nullptr;
 }
 
 TEMPLATE_OF_HASHTABLE
-inline void
-HASHTABLE::initTable(size_type n) {
-    for (auto& head : table()) {
-        // create sentinel(dummy node):
-        // To make implemetation of single linked list operation easier
-        head = newNode();
+auto
+HASHTABLE::cursorOf(Node* node) const
+-> size_type {
+    // The node belongs to old table if
+    // its old bucket has not been migrated
+    if (isRehashing()) {
+        const auto oldIndex = bucketIndex(getKey()(node->val), impl_.oldTable.size());
+        if (oldIndex >= impl_.rehashIndex) {
+            return oldIndex | OLD_CURSOR;
+        }
     }
+
+    return hashVal(node->val);
+}
+
+TEMPLATE_OF_HASHTABLE
+auto
+HASHTABLE::nextNode(Node* node, size_type& cursor) const
+-> Node* {
+    if (node->next) {
+        return node->next;
+    }
+
+    if (cursor == UNKNOWN_CURSOR) {
+        cursor = cursorOf(node);
+    }
+
+    size_type from = cursor + 1;
+    if (cursor & OLD_CURSOR) {
+        const auto& oldTable = impl_.oldTable;
+        const auto index = firstBucketFrom(
+            oldTable, impl_.oldOccupied, (cursor & ~OLD_CURSOR) + 1);
+        if (index < oldTable.size()) {
+            cursor = index | OLD_CURSOR;
+            return oldTable[index];
+        }
+
+        from = 0;
+    }
+
+    const auto index = firstBucketFrom(table(), impl_.occupied, from);
+    cursor = index;
+    return index < tableSize() ? table()[index] : nullptr;
 }
 
 TEMPLATE_OF_HASHTABLE
 inline void
-HASHTABLE::reclaimSentinel(Table& table) {
-    for (auto head : table) {
-        assert(head->next == nullptr);
-        destroyNode(head);
+HASHTABLE::destroyList(Node*& head) {
+    while (head) {
+        auto tmp = head;
+        head = tmp->next;
+
+        destroyNode(tmp);
     }
 }
 
 TEMPLATE_OF_HASHTABLE
 void
 HASHTABLE::clear() {
-    for (auto& head : table()) {
-        while (head->next) {
-            auto tmp = head->next;
-            head->next = tmp->next;
+    destroyTable(table(), impl_.occupied);
 
-            destroyNode(tmp);
-        }                
+    if (isRehashing()) {
+        destroyTable(impl_.oldTable, impl_.oldOccupied);
+
+        Table().swap(impl_.oldTable);
+        BucketBitmap().swap(impl_.oldOccupied);
+        impl_.rehashIndex = 0;
     }
-    
-    reclaimSentinel(table());
+
+    impl_.numElements = 0;
+}
+
+TEMPLATE_OF_HASHTABLE
+void
+HASHTABLE::destroyTable(Table& table, BucketBitmap& occupied) {
+    // only visit the non-empty buckets
+    for (auto i = occupied.findNext(0);
+         i < table.size();
+         i = occupied.findNext(i + 1)) {
+        destroyList(table[i]);
+    }
+
+    occupied.clear();
 }
 
 TEMPLATE_OF_HASHTABLE
@@ -538,13 +1548,14 @@ template<typename ...Args>
 inline auto
 HASHTABLE::newNode(Args&&... args)
 -> Node* {
-    Node* node = NodeAllocTraits::allocate(
-        getNodeAllocator(), sizeof(Node));
+    Node* node = NodeAllocTraits::allocate(getNodeAllocator());
     TRY_BEGIN
+        // construct the value in place instead of moving a temporary,
+        // so the mapped value need not be movable
         NodeAllocTraits::construct(
             getNodeAllocator(),
-            node,
-            value_type(STL_FORWARD(Args, args)...));
+            &node->val,
+            STL_FORWARD(Args, args)...);
     TRY_END
     CATCH_ALL_BEGIN
         NodeAllocTraits::deallocate(
@@ -552,6 +1563,7 @@ HASHTABLE::newNode(Args&&... args)
         RETHROW
     CATCH_END
 
+    node->next = nullptr;
     return node;
 }
 
@@ -568,7 +1580,7 @@ void
 HASHTABLE::printTableLayout() const {
     for (int i = 0; i != tableSize(); ++i) {
         printf("[%d]: ", i);
-        for (auto head = table()[i]->next;
+        for (auto head = table()[i];
              head != nullptr;
              head = head->next) {
             std::cout << "(" << head->val << ")";
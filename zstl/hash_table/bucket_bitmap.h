@@ -0,0 +1,95 @@
+#ifndef ZSTL_HASH_TABLE_BUCKET_BITMAP_H
+#define ZSTL_HASH_TABLE_BUCKET_BITMAP_H
+
+#include "../vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace zstl {
+
+inline unsigned countTrailingZero(uint64_t x) noexcept {
+  // x must not be 0
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  unsigned n = 0;
+  for (; (x & 1) == 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+/**
+ * Occupancy bitmap of buckets, bit i is set if bucket i is not empty.
+ * The iteration of HashTable finds the next non-empty bucket
+ * from it, which skips 64 empty buckets by one word.
+ */
+class BucketBitmap {
+  static constexpr size_t WORD_BITS = 64;
+public:
+  BucketBitmap() = default;
+
+  explicit BucketBitmap(size_t n)
+    : words_((n + WORD_BITS - 1) / WORD_BITS, 0)
+    , size_(n)
+  { }
+
+  void set(size_t i) noexcept
+  { words_[i / WORD_BITS] |= bit(i); }
+
+  void reset(size_t i) noexcept
+  { words_[i / WORD_BITS] &= ~bit(i); }
+
+  bool test(size_t i) const noexcept
+  { return (words_[i / WORD_BITS] & bit(i)) != 0; }
+
+  /**
+   * @brief the index of first set bit which is no less than i
+   * @return size() if there is no such bit
+   */
+  size_t findNext(size_t i) const noexcept {
+    if (i >= size_) {
+      return size_;
+    }
+
+    auto w = i / WORD_BITS;
+    auto bits = words_[w] & (~uint64_t(0) << (i % WORD_BITS));
+
+    while (bits == 0) {
+      if (++w == words_.size()) {
+        return size_;
+      }
+      bits = words_[w];
+    }
+
+    return w * WORD_BITS + countTrailingZero(bits);
+  }
+
+  // reset all bits
+  void clear() noexcept {
+    for (auto& word : words_) {
+      word = 0;
+    }
+  }
+
+  size_t size() const noexcept
+  { return size_; }
+
+  void swap(BucketBitmap& rhs) noexcept {
+    words_.swap(rhs.words_);
+    STL_SWAP(size_, rhs.size_);
+  }
+
+private:
+  static uint64_t bit(size_t i) noexcept
+  { return uint64_t(1) << (i % WORD_BITS); }
+
+  Vector<uint64_t> words_;
+  size_t size_ = 0;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_HASH_TABLE_BUCKET_BITMAP_H
@@ -1,6 +1,8 @@
 #ifndef ZSTL_HASH_TABLE_HASH_NODE_H
 #define ZSTL_HASH_TABLE_HASH_NODE_H
 
+#include <atomic>
+
 namespace zstl {
 
 /**
@@ -28,6 +30,26 @@ struct HashNode {
   { }  
 };
 
+/**
+ * HashNode whose link can be read while it is modified by other thread.
+ * The val is never modified after the node is published.
+ */
+template<typename T>
+struct ConcurrentHashNode {
+  T val;
+  std::atomic<ConcurrentHashNode*> next;
+
+  explicit ConcurrentHashNode(T const& v, ConcurrentHashNode* n = nullptr)
+    : val{ v }
+    , next{ n }
+  { }
+
+  explicit ConcurrentHashNode(T&& v, ConcurrentHashNode* n = nullptr)
+    : val{ STL_MOVE(v) }
+    , next{ n }
+  { }
+};
+
 } // namespace zstl
 
 #endif // ZSTL_HASH_TABLE_HASH_NODE_H
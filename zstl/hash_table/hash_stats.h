@@ -0,0 +1,95 @@
+#ifndef ZSTL_HASH_TABLE_HASH_STATS_H
+#define ZSTL_HASH_TABLE_HASH_STATS_H
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace zstl {
+
+/**
+ * Cumulative counters of HashTable, it is cheap to read.
+ * They are only updated by rehash, and the clock is read just when the table
+ * expands and when its migration finishes, so the incremental rehash steps
+ * in insert and erase only pay an addition.
+ */
+struct HashTableCounters {
+  // the number of table expansions
+  size_t rehashCount = 0;
+  // the number of buckets migrated, including empty ones
+  size_t bucketsMigrated = 0;
+  // the time from the expansions to the end of their migrations,
+  // for incremental rehash it includes the operations in between,
+  // since reading the clock in every rehash step costs more than the step
+  uint64_t rehashNanos = 0;
+};
+
+/**
+ * Snapshot of the distribution of chains in HashTable,
+ * produced by HashTable::stats() which walks every bucket.
+ * A good hash function has few empty buckets and short chains
+ * when load factor is around 1.0, e.g. max chain grows much
+ * faster than log(n) means the keys are clustered.
+ */
+struct HashTableStats {
+  static constexpr size_t HISTOGRAM_SIZE = 8;
+
+  // the buckets of both old and new table during incremental rehash
+  size_t bucketCount = 0;
+  size_t elementCount = 0;
+  size_t emptyBuckets = 0;
+  size_t maxChain = 0;
+
+  // chainHistogram[i] is the number of buckets whose chain length is i,
+  // the last one counts chains no shorter than HISTOGRAM_SIZE - 1
+  size_t chainHistogram[HISTOGRAM_SIZE] = { 0 };
+
+  // the average nodes compared by find() of key in table,
+  // i.e. the average position of elements in their chains
+  double avgSuccessfulProbe = 0;
+  // the average nodes compared by find() of key not in table,
+  // i.e. the average chain length over all buckets
+  double avgUnsuccessfulProbe = 0;
+
+  HashTableCounters counters;
+
+  double loadFactor() const noexcept
+  { return bucketCount ? static_cast<double>(elementCount) / bucketCount : 0; }
+
+  double emptyRatio() const noexcept
+  { return bucketCount ? static_cast<double>(emptyBuckets) / bucketCount : 0; }
+
+  // account a chain of length len
+  void addChain(size_t len) noexcept {
+    ++bucketCount;
+    elementCount += len;
+    if (len == 0) {
+      ++emptyBuckets;
+    }
+    if (len > maxChain) {
+      maxChain = len;
+    }
+    ++chainHistogram[len < HISTOGRAM_SIZE ? len : HISTOGRAM_SIZE - 1];
+
+    // the k-th node of chain is found by k probes
+    avgSuccessfulProbe += static_cast<double>(len) * (len + 1) / 2;
+  }
+
+  // called after all chains are accounted
+  void finish() noexcept {
+    avgSuccessfulProbe = elementCount ? avgSuccessfulProbe / elementCount : 0;
+    avgUnsuccessfulProbe = loadFactor();
+  }
+};
+
+using HashStatsClock = std::chrono::steady_clock;
+
+// the nanoseconds elapsed since start
+inline uint64_t hashStatsElapsed(HashStatsClock::time_point start) noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      HashStatsClock::now() - start).count();
+}
+
+} // namespace zstl
+
+#endif // ZSTL_HASH_TABLE_HASH_STATS_H
@@ -0,0 +1,115 @@
+#ifndef ZSTL_HASH_TABLE_NODE_HANDLE_H
+#define ZSTL_HASH_TABLE_NODE_HANDLE_H
+
+#include "hash_node.h"
+#include "../allocator.h"
+#include "../stl_move.h"
+
+#include <assert.h>
+
+namespace zstl {
+
+template<typename V, typename K, typename H, typename GK, typename EK, typename Alloc>
+class HashTable;
+
+/**
+ * Own a node extracted from HashTable.
+ * The node can be inserted into another HashTable with same allocator
+ * without reallocating it and copying the value,
+ * otherwise it is released when the handle is destroyed.
+ * @note it is move-only, like std::unordered_set::node_type
+ */
+template<typename V, typename NodeAlloc>
+class HashNodeHandle {
+  using Node = HashNode<V>;
+  using NodeAllocTraits = allocator_traits<NodeAlloc>;
+public:
+  using value_type = V;
+  using allocator_type = NodeAlloc;
+
+  HashNodeHandle() = default;
+
+  HashNodeHandle(HashNodeHandle&& rhs) noexcept
+    : node_{ rhs.node_ }
+    , alloc_( rhs.alloc_ )
+  { rhs.node_ = nullptr; }
+
+  HashNodeHandle& operator=(HashNodeHandle&& rhs) noexcept {
+    if (this != &rhs) {
+      reset();
+      node_ = rhs.node_;
+      alloc_ = rhs.alloc_;
+      rhs.node_ = nullptr;
+    }
+    return *this;
+  }
+
+  HashNodeHandle(HashNodeHandle const&) = delete;
+  HashNodeHandle& operator=(HashNodeHandle const&) = delete;
+
+  ~HashNodeHandle() noexcept
+  { reset(); }
+
+  bool empty() const noexcept
+  { return node_ == nullptr; }
+
+  explicit operator bool() const noexcept
+  { return node_ != nullptr; }
+
+  // the value can be modified(include key) before it is inserted
+  value_type& value() const noexcept {
+    assert(node_);
+    return node_->val;
+  }
+
+  allocator_type get_allocator() const
+  { return alloc_; }
+
+  void swap(HashNodeHandle& rhs) noexcept {
+    STL_SWAP(node_, rhs.node_);
+    STL_SWAP(alloc_, rhs.alloc_);
+  }
+
+private:
+  HashNodeHandle(Node* node, NodeAlloc const& alloc) noexcept
+    : node_{ node }
+    , alloc_( alloc )
+  { }
+
+  // give up the ownership
+  Node* release() noexcept {
+    auto node = node_;
+    node_ = nullptr;
+    return node;
+  }
+
+  void reset() noexcept {
+    if (node_) {
+      NodeAllocTraits::destroy(alloc_, node_);
+      NodeAllocTraits::deallocate(alloc_, node_);
+      node_ = nullptr;
+    }
+  }
+
+  Node* node_ = nullptr;
+  NodeAlloc alloc_;
+
+  template<typename, typename, typename, typename, typename, typename>
+  friend class HashTable;
+};
+
+/**
+ * The result of inserting a node handle.
+ * If the key is duplicate, the node is given back
+ * and position points to the element with equivalent key.
+ */
+template<typename Iter, typename NodeHandle>
+struct NodeInsertReturn {
+  Iter position;
+  bool inserted;
+  NodeHandle node;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_HASH_TABLE_NODE_HANDLE_H
@@ -0,0 +1,428 @@
+#ifndef ZSTL_INTERVAL_TREE_H
+#define ZSTL_INTERVAL_TREE_H
+
+#include "stl_tree_impl.h"
+#include "functional.h"
+
+namespace zstl{
+
+/**
+ * @struct Interval
+ * @brief closed interval [lo, hi], lo must not be greater than hi
+ */
+template<typename K>
+struct Interval {
+	K lo;
+	K hi;
+};
+
+template<typename K>
+inline bool operator==(Interval<K> const& x, Interval<K> const& y) {
+	return x.lo == y.lo && x.hi == y.hi;
+}
+
+template<typename K>
+inline bool operator!=(Interval<K> const& x, Interval<K> const& y) {
+	return !(x == y);
+}
+
+/**
+ * @struct IntervalLess
+ * @brief order intervals by lo, then by hi
+ */
+template<typename K, typename Compare>
+struct IntervalLess {
+	bool operator()(Interval<K> const& x, Interval<K> const& y) const {
+		Compare cmp;
+		return cmp(x.lo, y.lo) || (!cmp(y.lo, x.lo) && cmp(x.hi, y.hi));
+	}
+};
+
+/**
+ * @struct RBTreeIntervalNode
+ * @brief base node with the node whose hi is the maximum in subtree(include itself)
+ * @note the node instead of hi is kept since the field of base node is not constructed
+ */
+struct RBTreeIntervalNode : public RBTreeBaseNode {
+	RBTreeBaseNode const* max;
+};
+
+/**
+ * @struct RBTreeIntervalAugment
+ * @tparam Val value type
+ * @tparam GetInterval callable that get the interval from value
+ * @tparam Compare predicate that compare two endpoints, which is stateless
+ * @brief
+ * Augment policy to maintain the maximum endpoint of subtree,
+ * which is used to skip the subtrees that don't overlap the query
+ * @see RBTreeNoAugment
+ */
+template<typename Val, typename GetInterval, typename Compare>
+struct RBTreeIntervalAugment {
+	using NodeBase = RBTreeIntervalNode;
+	using Node = RBTreeNode<Val, RBTreeIntervalAugment>;
+
+	static auto Hi(RBTreeBaseNode const* x) noexcept
+	-> decltype(GetInterval()(zstl::declval<Val const&>()).hi) const& {
+		return GetInterval()(static_cast<Node const*>(x)->val).hi;
+	}
+
+	// the maximum hi in the subtree of x
+	static decltype(auto) MaxHi(RBTreeBaseNode const* x) noexcept {
+		return Hi(static_cast<RBTreeIntervalNode const*>(x)->max);
+	}
+
+	static void Pull(RBTreeBaseNode* x) noexcept {
+		RBTreeBaseNode const* max = x;
+		if (x->left && Compare()(Hi(max), MaxHi(x->left)))
+			max = static_cast<RBTreeIntervalNode const*>(x->left)->max;
+		if (x->right && Compare()(Hi(max), MaxHi(x->right)))
+			max = static_cast<RBTreeIntervalNode const*>(x->right)->max;
+		static_cast<RBTreeIntervalNode*>(x)->max = max;
+	}
+
+	static void PullUp(RBTreeBaseNode* x, RBTreeBaseNode* root) noexcept {
+		for(;;){
+			Pull(x);
+			if(x == root)
+				break;
+			x = x->parent;
+		}
+	}
+
+	// y is the parent of x now, which has all nodes of the old subtree of x
+	static void Rotated(RBTreeBaseNode* x, RBTreeBaseNode* y) noexcept {
+		static_cast<RBTreeIntervalNode*>(y)->max =
+			static_cast<RBTreeIntervalNode*>(x)->max;
+		Pull(x);
+	}
+};
+
+/**
+ * @class IntervalTree
+ * @tparam K endpoint type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two endpoints, which is stateless
+ * @tparam Alloc allocator
+ * @brief
+ * Ordered multimap from closed interval to value based on RBTree,
+ * the intervals are ordered by lo then hi, and each node keeps the maximum hi
+ * of its subtree, so the overlapping ones are found without visiting others.
+ * @note
+ * find_overlapping() returns a lazy range, each step is O(lgn),
+ * i.e. O(k * lgn) to visit all k results, and the one before the first result
+ * is skipped without being compared.
+ * The mapped value can be modified through iterator, but the interval can't.
+ */
+template<typename K, typename T,
+	typename Compare = zstl::less<K>,
+	typename Alloc = zstl::allocator<zstl::pair<Interval<K> const, T>>>
+class IntervalTree {
+	using GetKey = get_first<Interval<K> const, T>;
+	using Augment = RBTreeIntervalAugment<zstl::pair<Interval<K> const, T>, GetKey, Compare>;
+	using BasePtr = RBTreeBaseNode const*;
+
+public:
+	using Rep = RBTree<Interval<K>, zstl::pair<Interval<K> const, T>,
+		GetKey, IntervalLess<K, Compare>, Alloc, Augment>;
+	using key_type = typename Rep::key_type;
+	using endpoint_type = K;
+	using mapped_type = T;
+	using value_type = typename Rep::value_type;
+	using key_compare = typename Rep::key_compare;
+	using allocator_type = typename Rep::allocator_type;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+
+	/**
+	 * @class OverlapIterator
+	 * @brief forward iterator over the intervals overlapping the query in order
+	 * @note base() is the iterator of tree, e.g. used by erase()
+	 */
+	template<typename Iter>
+	class OverlapIterator {
+	public:
+		using value_type = typename Iter::value_type;
+		using reference = typename Iter::reference;
+		using pointer = typename Iter::pointer;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = Forward_iterator_tag;
+
+		OverlapIterator() = default;
+
+		OverlapIterator(Iter iter, K const& lo, K const& hi)
+			: iter_(iter)
+			, lo_(lo)
+			, hi_(hi)
+		{ }
+
+		Iter base() const noexcept
+		{ return iter_; }
+
+		reference operator*() const noexcept
+		{ return *iter_; }
+
+		pointer operator->() const noexcept
+		{ return iter_.operator->(); }
+
+		OverlapIterator& operator++() {
+			iter_ = Iter(const_cast<RBTreeBaseNode*>(NextOverlap(iter_.node(), lo_, hi_)));
+			return *this;
+		}
+
+		OverlapIterator operator++(int) {
+			auto tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		friend bool operator==(OverlapIterator const& x, OverlapIterator const& y) noexcept
+		{ return x.iter_ == y.iter_; }
+
+		friend bool operator!=(OverlapIterator const& x, OverlapIterator const& y) noexcept
+		{ return !(x == y); }
+
+	private:
+		Iter iter_;
+		K lo_;
+		K hi_;
+	};
+
+	/**
+	 * @class OverlapRange
+	 * @brief [begin(), end()) of the intervals overlapping the query
+	 */
+	template<typename Iter>
+	class OverlapRange {
+	public:
+		using iterator = OverlapIterator<Iter>;
+
+		OverlapRange(iterator first, iterator last)
+			: first_(first)
+			, last_(last)
+		{ }
+
+		iterator begin() const noexcept
+		{ return first_; }
+
+		iterator end() const noexcept
+		{ return last_; }
+
+		bool empty() const noexcept
+		{ return first_ == last_; }
+
+	private:
+		iterator first_;
+		iterator last_;
+	};
+
+	using overlap_range = OverlapRange<iterator>;
+	using const_overlap_range = OverlapRange<const_iterator>;
+
+	IntervalTree() = default;
+	~IntervalTree() = default;
+
+	template<typename II, typename = Enable_if_t<is_input_iterator<II>::value>>
+	IntervalTree(II first, II last)
+	{ rb_.InsertEqual(first, last); }
+
+	IntervalTree(IntervalTree const& rhs) = default;
+	IntervalTree& operator=(IntervalTree const& rhs) = default;
+
+	IntervalTree(IntervalTree&& rhs) noexcept = default;
+	IntervalTree& operator=(IntervalTree&& rhs) noexcept = default;
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rb_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rb_.begin(); }
+
+	iterator end() noexcept
+	{ return rb_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rb_.end(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rb_.size(); }
+
+	bool empty() const noexcept
+	{ return size() == 0; }
+
+	//modifiers
+	void clear() noexcept
+	{ rb_.clear(); }
+
+	iterator insert(value_type const& x)
+	{ return rb_.InsertEqual(x); }
+
+	iterator insert(value_type&& x)
+	{ return rb_.InsertEqual(STL_MOVE(x)); }
+
+	template<typename II>
+	void insert(II first, II last)
+	{ rb_.InsertEqual(first, last); }
+
+	/**
+	 * @brief insert [ @p lo, @p hi ] with the mapped value constructed from @p args
+	 * @note the same interval can be inserted more than once
+	 */
+	template<typename... Args>
+	iterator emplace(K const& lo, K const& hi, Args&&... args) {
+		return rb_.EmplaceEqual(emplace_second, key_type{ lo, hi },
+			STL_FORWARD(Args, args)...);
+	}
+
+	iterator erase(const_iterator pos)
+	{ return rb_.erase(pos); }
+
+	// remove all the values of interval @p key
+	size_type erase(key_type const& key)
+	{ return rb_.erase(key); }
+
+	void swap(IntervalTree& rhs) noexcept
+	{ rb_.swap(rhs.rb_); }
+
+	//lookup
+	iterator find(key_type const& key)
+	{ return rb_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rb_.find(key); }
+
+	size_type count(key_type const& key) const
+	{ return rb_.count(key); }
+
+	/**
+	 * @brief the intervals overlapping [ @p lo, @p hi ] in order
+	 * @note it is lazy, the tree must not be modified during the iteration,
+	 * except erasing the element of current iterator(by its base())
+	 */
+	overlap_range find_overlapping(K const& lo, K const& hi) {
+		auto last = rb_.end();
+		return overlap_range(
+			{ iterator(const_cast<RBTreeBaseNode*>(FirstOverlap(last.node(), lo, hi))), lo, hi },
+			{ last, lo, hi });
+	}
+
+	const_overlap_range find_overlapping(K const& lo, K const& hi) const {
+		auto last = rb_.end();
+		return const_overlap_range(
+			{ const_iterator(FirstOverlap(last.node(), lo, hi)), lo, hi },
+			{ last, lo, hi });
+	}
+
+	// stabbing query: the intervals which contains @p point
+	overlap_range find_overlapping(K const& point)
+	{ return find_overlapping(point, point); }
+
+	const_overlap_range find_overlapping(K const& point) const
+	{ return find_overlapping(point, point); }
+
+	// O(lgn)
+	bool overlaps(K const& lo, K const& hi) const
+	{ return FirstOverlap(rb_.end().node(), lo, hi) != rb_.end().node(); }
+
+	bool contains(K const& point) const
+	{ return overlaps(point, point); }
+
+	key_compare key_comp() const noexcept
+	{ return rb_.key_comp(); }
+
+private:
+	// whether x overlaps [lo, hi]
+	static bool Overlaps(BasePtr x, K const& lo, K const& hi) {
+		Compare cmp;
+		auto const& interval = GetKey()(static_cast<typename Augment::Node const*>(x)->val);
+		return !cmp(hi, interval.lo) && !cmp(interval.hi, lo);
+	}
+
+	// whether some interval in the subtree of x ends after lo
+	static bool Reachable(BasePtr x, K const& lo) {
+		return x && !Compare()(Augment::MaxHi(x), lo);
+	}
+
+	/**
+	 * @brief the first node in the subtree of x overlapping [lo, hi]
+	 * @return null if not found
+	 * @note
+	 * If the left subtree is reachable but has no result,
+	 * the lo of x is greater than hi, so the nodes after it have no result too.
+	 */
+	static BasePtr FirstOverlapIn(BasePtr x, K const& lo, K const& hi) {
+		Compare cmp;
+		while (Reachable(x, lo)) {
+			if (Reachable(x->left, lo)) {
+				x = x->left;
+				continue;
+			}
+
+			if (cmp(hi, GetKey()(static_cast<typename Augment::Node const*>(x)->val).lo))
+				return nullptr;
+			if (Overlaps(x, lo, hi))
+				return x;
+			x = x->right;
+		}
+
+		return nullptr;
+	}
+
+	static BasePtr FirstOverlap(BasePtr header, K const& lo, K const& hi) {
+		auto x = FirstOverlapIn(header->parent, lo, hi);
+		return x ? x : header;
+	}
+
+	/**
+	 * @brief the first node after x overlapping [lo, hi], or header if not found
+	 * @pre x is not header
+	 */
+	static BasePtr NextOverlap(BasePtr x, K const& lo, K const& hi) {
+		if (auto found = FirstOverlapIn(x->right, lo, hi))
+			return found;
+
+		for (;;) {
+			// the nodes after x are the ancestors whose left subtree has x,
+			// and their right subtrees
+			auto p = x->parent;
+			while (p->parent != x && p->right == x) {
+				x = p;
+				p = x->parent;
+			}
+
+			// x is root, p is header
+			if (p->parent == x)
+				return p;
+
+			x = p;
+			if (Compare()(hi, GetKey()(static_cast<typename Augment::Node const*>(x)->val).lo))
+				break;
+			if (Overlaps(x, lo, hi))
+				return x;
+			if (auto found = FirstOverlapIn(x->right, lo, hi))
+				return found;
+		}
+
+		// the lo of x is greater than hi, so are the nodes after it
+		while (x->parent->parent != x)
+			x = x->parent;
+		return x->parent;
+	}
+
+	Rep rb_;
+};
+
+template<typename K, typename T, typename CP, typename Alloc>
+inline void swap(IntervalTree<K, T, CP, Alloc>& x, IntervalTree<K, T, CP, Alloc>& y) noexcept {
+	x.swap(y);
+}
+
+} // namespace zstl
+
+#endif // ZSTL_INTERVAL_TREE_H
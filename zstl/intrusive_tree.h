@@ -0,0 +1,424 @@
+#ifndef ZSTL_INTRUSIVE_TREE_H
+#define ZSTL_INTRUSIVE_TREE_H
+
+#include "stl_tree.h"
+#include "functional.h"
+#include "noncopyable.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace zstl {
+
+namespace detail {
+
+/**
+ * @brief get the object which embeds @p node as its member @p Hook
+ * @note
+ * The offset of hook is computed from a fake object address, which is aligned
+ * for T and never dereferenced, since member pointer can't be used in offsetof.
+ */
+template<typename T, RBTreeBaseNode T::* Hook>
+inline T* intrusiveOwner(RBTreeBaseNode const* node) noexcept {
+    constexpr uintptr_t FAKE = 0x1000;
+    const auto offset = reinterpret_cast<uintptr_t>(
+        &(reinterpret_cast<T const*>(FAKE)->*Hook)) - FAKE;
+    return reinterpret_cast<T*>(
+        reinterpret_cast<uintptr_t>(node) - offset);
+}
+
+} // namespace detail
+
+/**
+ * @class IntrusiveTreeIterator
+ * @brief bidirectional iterator of IntrusiveTree, which refers to the user object
+ */
+template<typename T, RBTreeBaseNode T::* Hook, typename Ref, typename Ptr>
+class IntrusiveTreeIterator {
+    using BasePtr = RBTreeBaseNode*;
+    using Self = IntrusiveTreeIterator;
+    using Iterator = IntrusiveTreeIterator<T, Hook, T&, T*>;
+public:
+    using value_type = T;
+    using reference = Ref;
+    using pointer = Ptr;
+    using difference_type = ptrdiff_t;
+    using iterator_category = Bidirectional_iterator_tag;
+
+    IntrusiveTreeIterator() noexcept
+        : node_(nullptr)
+    { }
+
+    explicit IntrusiveTreeIterator(RBTreeBaseNode const* node) noexcept
+        : node_(const_cast<BasePtr>(node))
+    { }
+
+    // iterator to const_iterator, a template so that it is not the copy constructor
+    template<typename It, typename = Enable_if_t<
+        Is_same<It, Iterator>::value && !Is_same<It, Self>::value>>
+    IntrusiveTreeIterator(It const& iter) noexcept
+        : node_(iter.node_)
+    { }
+
+    reference operator*() const noexcept
+    { return *detail::intrusiveOwner<T, Hook>(node_); }
+
+    pointer operator->() const noexcept
+    { return detail::intrusiveOwner<T, Hook>(node_); }
+
+    Self& operator++() noexcept {
+        node_ = RBTreeIncrement(node_);
+        return *this;
+    }
+
+    Self operator++(int) noexcept {
+        auto ret = *this;
+        ++*this;
+        return ret;
+    }
+
+    Self& operator--() noexcept {
+        node_ = RBTreeDecrement(node_);
+        return *this;
+    }
+
+    Self operator--(int) noexcept {
+        auto ret = *this;
+        --*this;
+        return ret;
+    }
+
+    friend bool operator==(Self const& x, Self const& y) noexcept
+    { return x.node_ == y.node_; }
+
+    friend bool operator!=(Self const& x, Self const& y) noexcept
+    { return x.node_ != y.node_; }
+
+    Iterator ConstCast() const noexcept
+    { return Iterator(node_); }
+
+    BasePtr node_;
+};
+
+/**
+ * @class IntrusiveTree
+ * @tparam T the type of user object
+ * @tparam Hook the RBTreeBaseNode member of T used by this tree
+ * @tparam Key key type
+ * @tparam GetKey callable that gets the key from T const&
+ * @tparam Compare predicate that compares two keys
+ * @brief
+ * Red-black tree whose nodes are embedded in user objects, so it never allocates.
+ * An object can be in several trees(i.e. indexes) with different hooks,
+ * e.g.
+ * struct Timer {
+ *     RBTreeBaseNode by_deadline;
+ *     RBTreeBaseNode by_id;
+ *     ...
+ * };
+ * The rebalance algorithms are shared with RBTree.
+ * @note
+ * The tree doesn't own the objects, which must outlive their membership,
+ * and an object must not be linked to two trees by the same hook.
+ * The key of a linked object must not be modified.
+ */
+template<typename T, RBTreeBaseNode T::* Hook, typename Key,
+    typename GetKey, typename Compare = zstl::less<Key>>
+class IntrusiveTree : noncopyable {
+    using BasePtr = RBTreeBaseNode*;
+    using ConstBasePtr = RBTreeBaseNode const*;
+    using Augment = RBTreeNoAugment;
+public:
+    using key_type = Key;
+    using value_type = T;
+    using key_compare = Compare;
+    using reference = T&;
+    using const_reference = T const&;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator = IntrusiveTreeIterator<T, Hook, T&, T*>;
+    using const_iterator = IntrusiveTreeIterator<T, Hook, T const&, T const*>;
+    using reverse_iterator = zstl::reverse_iterator<iterator>;
+    using const_reverse_iterator = zstl::reverse_iterator<const_iterator>;
+
+    IntrusiveTree() = default;
+
+    explicit IntrusiveTree(Compare const& cmp)
+        : impl_(cmp)
+    { }
+
+    // the objects are kept linked to the new tree
+    IntrusiveTree(IntrusiveTree&& other) noexcept
+        : impl_(STL_MOVE(other.impl_))
+    { }
+
+    IntrusiveTree& operator=(IntrusiveTree&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~IntrusiveTree() noexcept
+    { clear(); }
+
+    void swap(IntrusiveTree& other) noexcept {
+        zstl::swap(impl_.key_compare_, other.impl_.key_compare_);
+        impl_.Swap(other.impl_);
+    }
+
+    iterator begin() noexcept
+    { return iterator(impl_.header.left); }
+
+    const_iterator begin() const noexcept
+    { return const_iterator(impl_.header.left); }
+
+    iterator end() noexcept
+    { return iterator(&impl_.header); }
+
+    const_iterator end() const noexcept
+    { return const_iterator(&impl_.header); }
+
+    const_iterator cbegin() const noexcept
+    { return begin(); }
+
+    const_iterator cend() const noexcept
+    { return end(); }
+
+    reverse_iterator rbegin() noexcept
+    { return reverse_iterator(end()); }
+
+    const_reverse_iterator rbegin() const noexcept
+    { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend() noexcept
+    { return reverse_iterator(begin()); }
+
+    const_reverse_iterator rend() const noexcept
+    { return const_reverse_iterator(begin()); }
+
+    size_type size() const noexcept
+    { return impl_.node_count; }
+
+    bool empty() const noexcept
+    { return impl_.node_count == 0; }
+
+    key_compare key_comp() const
+    { return impl_.key_compare_; }
+
+    /**
+     * @brief get the iterator of a linked object in O(1)
+     */
+    iterator iterator_to(T& x) noexcept
+    { return iterator(&(x.*Hook)); }
+
+    const_iterator iterator_to(T const& x) const noexcept
+    { return const_iterator(&(x.*Hook)); }
+
+    /**
+     * @brief link @p x if no object with equal key is linked
+     * @return the position of x or the object with equal key, and whether x is linked
+     */
+    pair<iterator, bool> insert_unique(T& x) {
+        auto const& key = GetKey()(x);
+        BasePtr y = &impl_.header;
+        BasePtr cur = impl_.header.parent;
+        bool comp = true;
+
+        while (cur) {
+            y = cur;
+            comp = impl_.key_compare_(key, Key_(cur));
+            cur = comp ? cur->left : cur->right;
+        }
+
+        // the predecessor of x is the only one can be equal to it
+        iterator pred(y);
+        if (comp) {
+            if (pred == begin()) {
+                return zstl::make_pair(Link(x, y, true), true);
+            }
+            --pred;
+        }
+
+        if (impl_.key_compare_(Key_(pred.node_), key)) {
+            return zstl::make_pair(Link(x, y, comp), true);
+        }
+
+        return zstl::make_pair(pred, false);
+    }
+
+    /**
+     * @brief link @p x after the objects with equal key
+     */
+    iterator insert_equal(T& x) {
+        auto const& key = GetKey()(x);
+        BasePtr y = &impl_.header;
+        BasePtr cur = impl_.header.parent;
+        bool comp = true;
+
+        while (cur) {
+            y = cur;
+            comp = impl_.key_compare_(key, Key_(cur));
+            cur = comp ? cur->left : cur->right;
+        }
+
+        return Link(x, y, comp);
+    }
+
+    /**
+     * @brief unlink the object at @p pos
+     * @return the next position
+     */
+    iterator erase(const_iterator pos) noexcept {
+        assert(pos != end());
+        auto next = pos.ConstCast();
+        ++next;
+        Unlink(pos.node_);
+        return next;
+    }
+
+    /**
+     * @brief unlink the linked object @p x in O(lgn) without search
+     */
+    void erase(T& x) noexcept
+    { Unlink(&(x.*Hook)); }
+
+    /**
+     * @brief unlink all objects with @p key
+     * @return the number of objects unlinked
+     */
+    size_type erase(Key const& key) {
+        auto first = lower_bound(key);
+        auto last = upper_bound(key);
+        size_type n = 0;
+        while (first != last) {
+            first = erase(first);
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     * @brief unlink all objects in O(1),
+     * the hooks of them are left as is
+     */
+    void clear() noexcept
+    { impl_.Reset(); }
+
+    /**
+     * @brief unlink all objects and call @p disposer(T*) for each one,
+     * which may destroy the object, e.g. clear_and_dispose([](T* x) { delete x; })
+     */
+    template<typename Disposer>
+    void clear_and_dispose(Disposer disposer) noexcept {
+        Dispose(impl_.header.parent, disposer);
+        impl_.Reset();
+    }
+
+    iterator find(Key const& key)
+    { return static_cast<IntrusiveTree const&>(*this).find(key).ConstCast(); }
+
+    const_iterator find(Key const& key) const {
+        auto pos = lower_bound(key);
+        return pos == end() || impl_.key_compare_(key, Key_(pos.node_))
+            ? end() : pos;
+    }
+
+    bool contains(Key const& key) const
+    { return find(key) != end(); }
+
+    size_type count(Key const& key) const
+    { return zstl::distance(lower_bound(key), upper_bound(key)); }
+
+    iterator lower_bound(Key const& key)
+    { return static_cast<IntrusiveTree const&>(*this).lower_bound(key).ConstCast(); }
+
+    const_iterator lower_bound(Key const& key) const {
+        ConstBasePtr y = &impl_.header;
+        ConstBasePtr x = impl_.header.parent;
+        while (x) {
+            if (!impl_.key_compare_(Key_(x), key)) {
+                y = x;
+                x = x->left;
+            } else {
+                x = x->right;
+            }
+        }
+        return const_iterator(y);
+    }
+
+    iterator upper_bound(Key const& key)
+    { return static_cast<IntrusiveTree const&>(*this).upper_bound(key).ConstCast(); }
+
+    const_iterator upper_bound(Key const& key) const {
+        ConstBasePtr y = &impl_.header;
+        ConstBasePtr x = impl_.header.parent;
+        while (x) {
+            if (impl_.key_compare_(key, Key_(x))) {
+                y = x;
+                x = x->left;
+            } else {
+                x = x->right;
+            }
+        }
+        return const_iterator(y);
+    }
+
+private:
+    static decltype(auto) Key_(ConstBasePtr x)
+    { return GetKey()(*detail::intrusiveOwner<T, Hook>(x)); }
+
+    iterator Link(T& x, BasePtr parent, bool insert_left) noexcept {
+        BasePtr node = &(x.*Hook);
+        node->left = nullptr;
+        node->right = nullptr;
+        node->color = RBTreeColor::Red;
+        RBTreeInsertAndFixup<Augment>(insert_left, node, parent, &impl_.header);
+        ++impl_.node_count;
+        return iterator(node);
+    }
+
+    void Unlink(BasePtr node) noexcept {
+        RBTreeEraseAndFixup<Augment>(node,
+            impl_.header.parent, impl_.header.left, impl_.header.right);
+        --impl_.node_count;
+        node->parent = node->left = node->right = nullptr;
+    }
+
+    template<typename Disposer>
+    static void Dispose(BasePtr x, Disposer& disposer) noexcept {
+        while (x) {
+            Dispose(x->right, disposer);
+            auto left = x->left;
+            disposer(detail::intrusiveOwner<T, Hook>(x));
+            x = left;
+        }
+    }
+
+    struct Impl : KeyCompare<Compare>, RBTreeHeader {
+        Impl() = default;
+
+        explicit Impl(Compare const& cmp)
+            : KeyCompare<Compare>(cmp)
+        { }
+
+        Impl(Impl&&) = default;
+
+        using RBTreeHeader::Reset;
+        using KeyCompare<Compare>::key_compare_;
+    };
+
+    Impl impl_;
+};
+
+template<typename T, RBTreeBaseNode T::* Hook, typename Key, typename GetKey, typename Compare>
+inline void swap(IntrusiveTree<T, Hook, Key, GetKey, Compare>& x,
+                 IntrusiveTree<T, Hook, Key, GetKey, Compare>& y) noexcept
+{ x.swap(y); }
+
+} // namespace zstl
+
+#endif // ZSTL_INTRUSIVE_TREE_H
@@ -0,0 +1,477 @@
+#ifndef ZSTL_LRU_CACHE_H
+#define ZSTL_LRU_CACHE_H
+
+#include "functional.h"
+#include "hash_aux.h"
+#include "hash_table.h"
+#include "stl_exception.h"
+#include "func/function.h"
+#include "util/aligned_new.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+
+namespace zstl {
+
+/**
+ * The recency links embedded in the cached element,
+ * so the element, the hash chain and the links share one node
+ * instead of a hash node plus a list node per element.
+ */
+struct CacheLink {
+    CacheLink* prev;
+    CacheLink* next;
+    // CLOCK reference bit, unused by LRU
+    bool referenced;
+};
+
+template<typename K, typename V>
+struct CacheEntry : CacheLink {
+    K key;
+    V value;
+
+    template<typename VT>
+    CacheEntry(K const& k, VT&& v)
+        : CacheLink{ nullptr, nullptr, false }
+        , key(k)
+        , value(STL_FORWARD(VT, v))
+    { }
+};
+
+template<typename K, typename V>
+struct GetCacheKey {
+    K const& operator()(CacheEntry<K, V> const& entry) const ZSTL_NOEXCEPT
+    { return entry.key; }
+};
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+    double hitRate() const ZSTL_NOEXCEPT
+    { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0; }
+
+    CacheStats& operator+=(CacheStats const& rhs) ZSTL_NOEXCEPT {
+        hits += rhs.hits;
+        misses += rhs.misses;
+        evictions += rhs.evictions;
+        return *this;
+    }
+};
+
+/**
+ * Circular list with sentinel, shared by the replacement policies.
+ */
+class CacheRing {
+public:
+    CacheRing() ZSTL_NOEXCEPT
+        : head_{ &head_, &head_, false }
+    { }
+
+    CacheRing(CacheRing const&) = delete;
+    CacheRing& operator=(CacheRing const&) = delete;
+
+    // insert @p link before @p pos
+    static void link(CacheLink* pos, CacheLink* link) ZSTL_NOEXCEPT {
+        link->prev = pos->prev;
+        link->next = pos;
+        pos->prev->next = link;
+        pos->prev = link;
+    }
+
+    static void unlink(CacheLink* link) ZSTL_NOEXCEPT {
+        link->prev->next = link->next;
+        link->next->prev = link->prev;
+    }
+
+    CacheLink* head() ZSTL_NOEXCEPT
+    { return &head_; }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return head_.next == &head_; }
+
+    void reset() ZSTL_NOEXCEPT
+    { head_.prev = head_.next = &head_; }
+
+private:
+    CacheLink head_;
+};
+
+/**
+ * Least recently used: hit moves the element to the front,
+ * the victim is the back.
+ */
+class LruReplacement {
+public:
+    void insert(CacheLink* link) ZSTL_NOEXCEPT
+    { CacheRing::link(ring_.head()->next, link); }
+
+    void touch(CacheLink* link) ZSTL_NOEXCEPT {
+        if (ring_.head()->next != link) {
+            CacheRing::unlink(link);
+            CacheRing::link(ring_.head()->next, link);
+        }
+    }
+
+    void remove(CacheLink* link) ZSTL_NOEXCEPT
+    { CacheRing::unlink(link); }
+
+    // ring is not empty
+    CacheLink* victim() ZSTL_NOEXCEPT
+    { return ring_.head()->prev; }
+
+    void clear() ZSTL_NOEXCEPT
+    { ring_.reset(); }
+
+private:
+    CacheRing ring_;
+};
+
+/**
+ * CLOCK(second chance): hit only sets the reference bit,
+ * the hand sweeps the ring and clears the bits until it meets
+ * an element which is not referenced since the last sweep.
+ * Hit writes one flag instead of relinking four pointers,
+ * it approximates LRU.
+ */
+class ClockReplacement {
+public:
+    ClockReplacement() ZSTL_NOEXCEPT
+        : hand_{ ring_.head() }
+    { }
+
+    // insert behind the hand as referenced, so it survives at least one sweep
+    void insert(CacheLink* link) ZSTL_NOEXCEPT {
+        link->referenced = true;
+        CacheRing::link(hand_, link);
+    }
+
+    void touch(CacheLink* link) ZSTL_NOEXCEPT
+    { link->referenced = true; }
+
+    void remove(CacheLink* link) ZSTL_NOEXCEPT {
+        if (hand_ == link) {
+            hand_ = link->next;
+        }
+        CacheRing::unlink(link);
+    }
+
+    // ring is not empty
+    CacheLink* victim() ZSTL_NOEXCEPT {
+        for (;; hand_ = hand_->next) {
+            if (hand_ == ring_.head()) {
+                continue;
+            }
+            if (!hand_->referenced) {
+                return hand_;
+            }
+            hand_->referenced = false;
+        }
+    }
+
+    void clear() ZSTL_NOEXCEPT {
+        ring_.reset();
+        hand_ = ring_.head();
+    }
+
+private:
+    CacheRing ring_;
+    CacheLink* hand_;
+};
+
+/**
+ * @class BoundedCache
+ * @tparam K key type
+ * @tparam V cached value type
+ * @tparam Replacement LruReplacement or ClockReplacement
+ * @tparam Hash hash function of key
+ * @tparam KeyEqual predicate that compare two keys whether they are equivalent
+ * @brief
+ * Cache holding at most capacity() elements.
+ * The elements are stored in HashTable and chained by the links embedded in them,
+ * so get/put/evict are O(1) with one allocation per element.
+ * When put() exceeds the capacity, the victim chosen by Replacement is evicted
+ * and passed to the eviction callback.
+ * @note
+ * Not thread-safe, see ShardedCache.
+ * The cache is not copyable or movable since the elements link to the sentinel.
+ */
+template<typename K, typename V, typename Replacement,
+    typename Hash = zstl::hash<K>,
+    typename KeyEqual = zstl::equal_to<K>>
+class BoundedCache {
+    using Entry = CacheEntry<K, V>;
+    using Table = HashTable<Entry, K, Hash, GetCacheKey<K, V>, KeyEqual>;
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using hasher = Hash;
+    using size_type = size_t;
+    // called with the evicted element before it is destroyed
+    using evict_callback = zstl::function<void(K const&, V&)>;
+
+    explicit BoundedCache(size_type capacity, evict_callback onEvict = evict_callback())
+        : table_(capacity + 1)
+        , capacity_{ capacity }
+        , onEvict_(STL_MOVE(onEvict))
+    { THROW_LENGTH_ERROR_IF(capacity == 0, "The capacity of cache must be positive"); }
+
+    BoundedCache(BoundedCache const&) = delete;
+    BoundedCache& operator=(BoundedCache const&) = delete;
+
+    /**
+     * @brief search @p key and mark it as recently used
+     * @return pointer to the value, or nullptr if miss.
+     * It is invalidated once the element is evicted
+     */
+    V* get(K const& key) {
+        auto iter = table_.find(key);
+        if (iter == table_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+
+        ++stats_.hits;
+        replacement_.touch(&*iter);
+        return &iter->value;
+    }
+
+    // copy the value to @p out if hit
+    bool get(K const& key, V& out) {
+        auto value = get(key);
+        if (value != nullptr) {
+            out = *value;
+        }
+        return value != nullptr;
+    }
+
+    // search @p key without affecting the recency and stats
+    V const* peek(K const& key) const {
+        auto iter = table_.find(key);
+        return iter != table_.end() ? &iter->value : nullptr;
+    }
+
+    bool contains(K const& key) const
+    { return table_.contains(key); }
+
+    /**
+     * @brief insert or assign the value of @p key and mark it as recently used
+     * @return true if it is inserted
+     */
+    template<typename VT>
+    bool put(K const& key, VT&& value) {
+        auto res = table_.tryEmplaceUnique(key, key, STL_FORWARD(VT, value));
+        auto& entry = *res.first;
+
+        if (!res.second) {
+            entry.value = STL_FORWARD(VT, value);
+            replacement_.touch(&entry);
+            return false;
+        }
+
+        replacement_.insert(&entry);
+        shrink(capacity_);
+        return true;
+    }
+
+    /**
+     * @brief remove @p key, the eviction callback is not called
+     * @return true if it is removed
+     */
+    bool erase(K const& key) {
+        auto iter = table_.find(key);
+        if (iter == table_.end()) {
+            return false;
+        }
+
+        replacement_.remove(&*iter);
+        table_.erase(iter);
+        return true;
+    }
+
+    // the eviction callback is not called
+    void clear() {
+        replacement_.clear();
+        table_.clear();
+    }
+
+    void onEvict(evict_callback f)
+    { onEvict_ = STL_MOVE(f); }
+
+    // evict elements if @p capacity is less than size()
+    void setCapacity(size_type capacity) {
+        THROW_LENGTH_ERROR_IF(capacity == 0, "The capacity of cache must be positive");
+        capacity_ = capacity;
+        shrink(capacity_);
+        table_.reserve(capacity_ + 1);
+    }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return table_.size(); }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return table_.empty(); }
+
+    size_type capacity() const ZSTL_NOEXCEPT
+    { return capacity_; }
+
+    CacheStats const& stats() const ZSTL_NOEXCEPT
+    { return stats_; }
+
+    void resetStats() ZSTL_NOEXCEPT
+    { stats_ = CacheStats{}; }
+
+private:
+    void shrink(size_type capacity) {
+        while (table_.size() > capacity) {
+            auto& victim = static_cast<Entry&>(*replacement_.victim());
+            replacement_.remove(&victim);
+            ++stats_.evictions;
+
+            // the victim is out of the ring,
+            // so it must leave the table even if the callback throws
+            if (onEvict_) {
+                STL_TRY {
+                    onEvict_(victim.key, victim.value);
+                } CATCH_ALL {
+                    table_.erase(victim.key);
+                    RETHROW
+                }
+            }
+            table_.erase(victim.key);
+        }
+    }
+
+    Table table_;
+    Replacement replacement_;
+    size_type capacity_;
+    evict_callback onEvict_;
+    CacheStats stats_;
+};
+
+template<typename K, typename V,
+    typename Hash = zstl::hash<K>,
+    typename KeyEqual = zstl::equal_to<K>>
+using LruCache = BoundedCache<K, V, LruReplacement, Hash, KeyEqual>;
+
+template<typename K, typename V,
+    typename Hash = zstl::hash<K>,
+    typename KeyEqual = zstl::equal_to<K>>
+using ClockCache = BoundedCache<K, V, ClockReplacement, Hash, KeyEqual>;
+
+/**
+ * @class ShardedCache
+ * @tparam Cache LruCache or ClockCache
+ * @tparam SHARDS the number of shards, power of 2
+ * @brief
+ * Thread-safe cache which splits keys into SHARDS caches by hash,
+ * each shard is guarded by its own mutex.
+ * The capacity is divided evenly, so the eviction is per shard.
+ * @note
+ * The value is copied out since it may be evicted by other thread,
+ * the eviction callback is called with the shard locked.
+ */
+template<typename Cache, size_t SHARDS = 16>
+class ShardedCache : public AlignedNew<64> {
+    static_assert(SHARDS != 0 && (SHARDS & (SHARDS - 1)) == 0,
+                  "The number of shards must be power of 2");
+
+    // pad to cache line to avoid false sharing between shards
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        Cache cache{ 1 };
+    };
+public:
+    using key_type = typename Cache::key_type;
+    using mapped_type = typename Cache::mapped_type;
+    using size_type = size_t;
+    using evict_callback = typename Cache::evict_callback;
+
+    explicit ShardedCache(size_type capacity) {
+        THROW_LENGTH_ERROR_IF(capacity < SHARDS, "The capacity of cache must be at least SHARDS");
+        for (size_type i = 0; i != SHARDS; ++i) {
+            shards_[i].cache.setCapacity(capacity / SHARDS + (i < capacity % SHARDS));
+        }
+    }
+
+    ShardedCache(ShardedCache const&) = delete;
+    ShardedCache& operator=(ShardedCache const&) = delete;
+
+    bool get(key_type const& key, mapped_type& out) {
+        auto& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.get(key, out);
+    }
+
+    template<typename VT>
+    bool put(key_type const& key, VT&& value) {
+        auto& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.put(key, STL_FORWARD(VT, value));
+    }
+
+    bool erase(key_type const& key) {
+        auto& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.erase(key);
+    }
+
+    // set the eviction callback of all shards
+    template<typename F>
+    void onEvict(F const& f) {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.onEvict(f);
+        }
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.clear();
+        }
+    }
+
+    // not a snapshot, the shards are visited one by one
+    size_type size() {
+        size_type n = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            n += shard.cache.size();
+        }
+        return n;
+    }
+
+    CacheStats stats() {
+        CacheStats sum;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            sum += shard.cache.stats();
+        }
+        return sum;
+    }
+
+private:
+    // the high bits select shard, the low bits select bucket in shard
+    Shard& shardOf(key_type const& key) {
+        const auto h = hashMix64(hash_(key));
+        return shards_[SHARDS == 1 ? 0 : h >> (64 - log2Shards())];
+    }
+
+    static constexpr int log2Shards() ZSTL_NOEXCEPT {
+        int n = 0;
+        while ((size_t(1) << n) < SHARDS) {
+            ++n;
+        }
+        return n;
+    }
+
+    Shard shards_[SHARDS];
+    typename Cache::hasher hash_;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_LRU_CACHE_H
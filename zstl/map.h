@@ -0,0 +1,504 @@
+#ifndef _ZXY_ZSTL_INCLUDE_MAP_H_
+#define _ZXY_ZSTL_INCLUDE_MAP_H_
+#include "stl_algobase.h"
+#include "stl_tree.h"
+#include "functional.h"
+
+namespace zstl{
+
+/**
+ * @class Map
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two keys
+ * @tparam Alloc allocator
+ * @tparam Augment RBTreeSizeAugment enables rank(), select() and distance() in O(lgn)
+ * @brief ordered map based on RBTree, the key is unique
+ * @note
+ * try_emplace(), insert_or_assign() and operator[] search the position by key first,
+ * the node is only allocated when it is actually inserted
+ */
+template<typename K, typename T,
+	typename Compare = zstl::less<K>,
+	typename Alloc = zstl::allocator<zstl::pair<K const, T>>,
+	typename Augment = RBTreeNoAugment>
+class Map{
+public:
+	using Rep = RBTree<K, zstl::pair<K const, T>, get_first<K const, T>, Compare, Alloc, Augment>;
+	using key_type = typename Rep::key_type;
+	using mapped_type = T;
+	using value_type = typename Rep::value_type;
+	using key_compare = typename Rep::key_compare;
+	using allocator_type = typename Rep::allocator_type;
+	using pointer = typename Rep::pointer;
+	using const_pointer = typename Rep::const_pointer;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+	using reverse_iterator = typename Rep::reverse_iterator;
+	using const_reverse_iterator = typename Rep::const_reverse_iterator;
+	using Res = zstl::pair<iterator, bool>;
+
+	Map() = default;
+	~Map() = default;
+
+	// O(n) if [first, last) is sorted
+	template<typename II, typename = Enable_if_t<is_input_iterator<II>::value>>
+	Map(II first, II last)
+	{ rb_.InsertUnique(first, last); }
+
+	Map(Map const& rhs) = default;
+	Map& operator=(Map const& rhs) = default;
+
+	Map(Map&& rhs) noexcept = default;
+	Map& operator=(Map&& rhs) noexcept = default;
+
+	Alloc get_allocator() const noexcept
+	{ return Alloc(); }
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rb_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rb_.begin(); }
+
+	iterator end() noexcept
+	{ return rb_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rb_.end(); }
+
+	const_iterator cbegin() const noexcept
+	{ return rb_.cbegin(); }
+
+	const_iterator cend() const noexcept
+	{ return rb_.cend(); }
+
+	reverse_iterator rbegin() noexcept
+	{ return rb_.rbegin(); }
+
+	const_reverse_iterator rbegin() const noexcept
+	{ return rb_.rbegin(); }
+
+	reverse_iterator rend() noexcept
+	{ return rb_.rend(); }
+
+	const_reverse_iterator rend() const noexcept
+	{ return rb_.rend(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rb_.size(); }
+
+	bool empty() const noexcept
+	{ return size() == 0; }
+
+	//element access
+	T& operator[](key_type const& key)
+	{ return try_emplace(key).first->second; }
+
+	T& operator[](key_type&& key)
+	{ return try_emplace(STL_MOVE(key)).first->second; }
+
+	T& at(key_type const& key) {
+		auto iter = find(key);
+		THROW_RANGE_ERROR_IF(iter == end(), "Map::at(): key is not exists");
+		return iter->second;
+	}
+
+	T const& at(key_type const& key) const {
+		auto iter = find(key);
+		THROW_RANGE_ERROR_IF(iter == end(), "Map::at(): key is not exists");
+		return iter->second;
+	}
+
+	//modifiers
+	void clear() noexcept
+	{ rb_.clear(); }
+
+	Res insert(value_type const& x)
+	{ return rb_.InsertUnique(x); }
+
+	Res insert(value_type&& x)
+	{ return rb_.InsertUnique(STL_MOVE(x)); }
+
+	Res insert(const_iterator hint, value_type const& val)
+	{ return rb_.InsertHintUnique(hint, val); }
+
+	Res insert(const_iterator hint, value_type&& val)
+	{ return rb_.InsertHintUnique(hint, STL_MOVE(val)); }
+
+	template<typename II>
+	void insert(II first, II last)
+	{ rb_.InsertUnique(first, last); }
+
+	/**
+	 * @brief replace the content with sorted range [first, last) in O(n)
+	 * @warning the range must be sorted by key
+	 */
+	template<typename FI>
+	void assign_sorted(FI first, FI last)
+	{ rb_.AssignSortedUnique(first, last); }
+
+	/**
+	 * @brief construct value in place and insert it if key is unique
+	 * @note the key is unknown until the value is constructed,
+	 * use try_emplace() to avoid allocation on duplicate key
+	 */
+	template<typename... Args>
+	Res emplace(Args&&... args)
+	{ return rb_.EmplaceUnique(STL_FORWARD(Args, args)...); }
+
+	template<typename ...Args>
+	Res emplace_hint(const_iterator hint, Args&&... args)
+	{ return rb_.EmplaceHintUnique(hint, STL_FORWARD(Args, args)...); }
+
+	/**
+	 * @brief construct mapped value from @p args only if @p key is not in map
+	 */
+	template<typename... Args>
+	Res try_emplace(key_type const& key, Args&&... args)
+	{ return rb_.TryEmplaceUnique(key, emplace_second, key, STL_FORWARD(Args, args)...); }
+
+	// the key is used for searching before it is moved to the node
+	template<typename... Args>
+	Res try_emplace(key_type&& key, Args&&... args)
+	{ return rb_.TryEmplaceUnique(key, emplace_second, STL_MOVE(key), STL_FORWARD(Args, args)...); }
+
+	/**
+	 * @brief like try_emplace(), but search from @p hint first,
+	 * it is amortized O(1) if key is inserted just before(or after) hint
+	 */
+	template<typename... Args>
+	Res try_emplace(const_iterator hint, key_type const& key, Args&&... args)
+	{ return rb_.TryEmplaceHintUnique(hint, key, emplace_second, key, STL_FORWARD(Args, args)...); }
+
+	template<typename... Args>
+	Res try_emplace(const_iterator hint, key_type&& key, Args&&... args)
+	{ return rb_.TryEmplaceHintUnique(hint, key, emplace_second, STL_MOVE(key), STL_FORWARD(Args, args)...); }
+
+	/**
+	 * @brief assign @p obj to the mapped value if key exists,
+	 * otherwise insert it just like try_emplace()
+	 */
+	template<typename M>
+	Res insert_or_assign(key_type const& key, M&& obj) {
+		// obj is only consumed when new node is constructed
+		auto res = rb_.TryEmplaceUnique(key, emplace_second, key, STL_FORWARD(M, obj));
+		if (!res.second) {
+			res.first->second = STL_FORWARD(M, obj);
+		}
+
+		return res;
+	}
+
+	template<typename M>
+	Res insert_or_assign(key_type&& key, M&& obj) {
+		auto res = rb_.TryEmplaceUnique(key, emplace_second, STL_MOVE(key), STL_FORWARD(M, obj));
+		if (!res.second) {
+			res.first->second = STL_FORWARD(M, obj);
+		}
+
+		return res;
+	}
+
+	template<typename M>
+	Res insert_or_assign(const_iterator hint, key_type const& key, M&& obj) {
+		auto res = rb_.TryEmplaceHintUnique(hint, key, emplace_second, key, STL_FORWARD(M, obj));
+		if (!res.second) {
+			res.first->second = STL_FORWARD(M, obj);
+		}
+
+		return res;
+	}
+
+	template<typename M>
+	Res insert_or_assign(const_iterator hint, key_type&& key, M&& obj) {
+		auto res = rb_.TryEmplaceHintUnique(hint, key, emplace_second, STL_MOVE(key), STL_FORWARD(M, obj));
+		if (!res.second) {
+			res.first->second = STL_FORWARD(M, obj);
+		}
+
+		return res;
+	}
+
+	iterator erase(const_iterator pos)
+	{ return rb_.erase(pos); }
+
+	void erase(const_iterator first, const_iterator last)
+	{ rb_.erase(first, last); }
+
+	size_type erase(key_type const& key)
+	{ return rb_.EraseUnique(key); }
+
+	void swap(Map& rhs) noexcept
+	{ rb_.swap(rhs.rb_); }
+
+	// lookup
+	size_type count(key_type const& key) const
+	{ return rb_.contains(key) ? 1 : 0; }
+
+	iterator find(key_type const& key)
+	{ return rb_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rb_.find(key); }
+
+	bool contains(key_type const& key) const
+	{ return rb_.contains(key); }
+
+	zstl::pair<iterator, iterator>
+	equal_range(key_type const& key)
+	{ return rb_.equal_range(key); }
+
+	zstl::pair<const_iterator, const_iterator>
+	equal_range(key_type const& key) const
+	{ return rb_.equal_range(key); }
+
+	iterator lower_bound(key_type const& key)
+	{ return rb_.lower_bound(key); }
+
+	const_iterator lower_bound(key_type const& key) const
+	{ return rb_.lower_bound(key); }
+
+	iterator upper_bound(key_type const& key)
+	{ return rb_.upper_bound(key); }
+
+	const_iterator upper_bound(key_type const& key) const
+	{ return rb_.upper_bound(key); }
+
+	key_compare key_comp() const
+	{ return rb_.key_comp(); }
+
+	// the number of elements whose key is less than key
+	size_type rank(key_type const& key) const
+	{ return rb_.rank(key); }
+
+	// the k-th smallest element(start from 0), end() if k >= size()
+	iterator select(size_type k)
+	{ return rb_.select(k); }
+
+	const_iterator select(size_type k) const
+	{ return rb_.select(k); }
+
+	size_type index(const_iterator pos) const
+	{ return rb_.index(pos); }
+
+	difference_type distance(const_iterator first, const_iterator last) const
+	{ return rb_.distance(first, last); }
+
+	Rep& rep() noexcept {
+		return rb_;
+	}
+private:
+	Rep rb_;
+};
+
+/**
+ * @class MultiMap
+ * @tparam Augment RBTreeSizeAugment enables rank(), select() and distance() in O(lgn)
+ * @brief ordered map based on RBTree, the elements with same key are allowed,
+ * the element is inserted after the elements with same key
+ */
+template<typename K, typename T,
+	typename Compare = zstl::less<K>,
+	typename Alloc = zstl::allocator<zstl::pair<K const, T>>,
+	typename Augment = RBTreeNoAugment>
+class MultiMap{
+public:
+	using Rep = RBTree<K, zstl::pair<K const, T>, get_first<K const, T>, Compare, Alloc, Augment>;
+	using key_type = typename Rep::key_type;
+	using mapped_type = T;
+	using value_type = typename Rep::value_type;
+	using key_compare = typename Rep::key_compare;
+	using allocator_type = typename Rep::allocator_type;
+	using pointer = typename Rep::pointer;
+	using const_pointer = typename Rep::const_pointer;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+	using reverse_iterator = typename Rep::reverse_iterator;
+	using const_reverse_iterator = typename Rep::const_reverse_iterator;
+
+	MultiMap() = default;
+	~MultiMap() = default;
+
+	// O(n) if [first, last) is sorted
+	template<typename II, typename = Enable_if_t<is_input_iterator<II>::value>>
+	MultiMap(II first, II last)
+	{ rb_.InsertEqual(first, last); }
+
+	MultiMap(MultiMap const& rhs) = default;
+	MultiMap& operator=(MultiMap const& rhs) = default;
+
+	MultiMap(MultiMap&& rhs) noexcept = default;
+	MultiMap& operator=(MultiMap&& rhs) noexcept = default;
+
+	Alloc get_allocator() const noexcept
+	{ return Alloc(); }
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rb_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rb_.begin(); }
+
+	iterator end() noexcept
+	{ return rb_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rb_.end(); }
+
+	const_iterator cbegin() const noexcept
+	{ return rb_.cbegin(); }
+
+	const_iterator cend() const noexcept
+	{ return rb_.cend(); }
+
+	reverse_iterator rbegin() noexcept
+	{ return rb_.rbegin(); }
+
+	const_reverse_iterator rbegin() const noexcept
+	{ return rb_.rbegin(); }
+
+	reverse_iterator rend() noexcept
+	{ return rb_.rend(); }
+
+	const_reverse_iterator rend() const noexcept
+	{ return rb_.rend(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rb_.size(); }
+
+	bool empty() const noexcept
+	{ return size() == 0; }
+
+	//modifiers
+	void clear() noexcept
+	{ rb_.clear(); }
+
+	iterator insert(value_type const& x)
+	{ return rb_.InsertEqual(x); }
+
+	iterator insert(value_type&& x)
+	{ return rb_.InsertEqual(STL_MOVE(x)); }
+
+	iterator insert(const_iterator hint, value_type const& val)
+	{ return rb_.InsertHintEqual(hint, val); }
+
+	iterator insert(const_iterator hint, value_type&& val)
+	{ return rb_.InsertHintEqual(hint, STL_MOVE(val)); }
+
+	template<typename II>
+	void insert(II first, II last)
+	{ rb_.InsertEqual(first, last); }
+
+	/**
+	 * @brief replace the content with sorted range [first, last) in O(n)
+	 * @warning the range must be sorted by key
+	 */
+	template<typename FI>
+	void assign_sorted(FI first, FI last)
+	{ rb_.AssignSortedEqual(first, last); }
+
+	template<typename... Args>
+	iterator emplace(Args&&... args)
+	{ return rb_.EmplaceEqual(STL_FORWARD(Args, args)...); }
+
+	template<typename ...Args>
+	iterator emplace_hint(const_iterator hint, Args&&... args)
+	{ return rb_.EmplaceHintEqual(hint, STL_FORWARD(Args, args)...); }
+
+	iterator erase(const_iterator pos)
+	{ return rb_.erase(pos); }
+
+	void erase(const_iterator first, const_iterator last)
+	{ rb_.erase(first, last); }
+
+	size_type erase(key_type const& key)
+	{ return rb_.erase(key); }
+
+	void swap(MultiMap& rhs) noexcept
+	{ rb_.swap(rhs.rb_); }
+
+	// lookup
+	size_type count(key_type const& key) const
+	{ return rb_.count(key); }
+
+	iterator find(key_type const& key)
+	{ return rb_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rb_.find(key); }
+
+	bool contains(key_type const& key) const
+	{ return rb_.contains(key); }
+
+	zstl::pair<iterator, iterator>
+	equal_range(key_type const& key)
+	{ return rb_.equal_range(key); }
+
+	zstl::pair<const_iterator, const_iterator>
+	equal_range(key_type const& key) const
+	{ return rb_.equal_range(key); }
+
+	iterator lower_bound(key_type const& key)
+	{ return rb_.lower_bound(key); }
+
+	const_iterator lower_bound(key_type const& key) const
+	{ return rb_.lower_bound(key); }
+
+	iterator upper_bound(key_type const& key)
+	{ return rb_.upper_bound(key); }
+
+	const_iterator upper_bound(key_type const& key) const
+	{ return rb_.upper_bound(key); }
+
+	key_compare key_comp() const
+	{ return rb_.key_comp(); }
+
+	// the number of elements whose key is less than key
+	size_type rank(key_type const& key) const
+	{ return rb_.rank(key); }
+
+	// the k-th smallest element(start from 0), end() if k >= size()
+	iterator select(size_type k)
+	{ return rb_.select(k); }
+
+	const_iterator select(size_type k) const
+	{ return rb_.select(k); }
+
+	size_type index(const_iterator pos) const
+	{ return rb_.index(pos); }
+
+	difference_type distance(const_iterator first, const_iterator last) const
+	{ return rb_.distance(first, last); }
+
+	Rep& rep() noexcept {
+		return rb_;
+	}
+private:
+	Rep rb_;
+};
+
+template<typename K, typename T, typename Compare, typename Alloc, typename Augment>
+inline void swap(Map<K, T, Compare, Alloc, Augment>& lhs, Map<K, T, Compare, Alloc, Augment>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+template<typename K, typename T, typename Compare, typename Alloc, typename Augment>
+inline void swap(MultiMap<K, T, Compare, Alloc, Augment>& lhs, MultiMap<K, T, Compare, Alloc, Augment>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+} //namespace zstl
+
+
+#endif //_ZXY_ZSTL_INCLUDE_MAP_H_
@@ -0,0 +1,52 @@
+#ifndef ZSTL_MAPPED_FILE_H
+#define ZSTL_MAPPED_FILE_H
+
+#include "config.h"
+#include "noncopyable.h"
+
+#include <stddef.h>
+
+namespace zstl {
+
+/**
+ * @class MappedFile
+ * @brief
+ * Map the whole file into memory read-only,
+ * the pages are faulted in when they are accessed first.
+ * @note
+ * POSIX only(mmap), throw std::runtime_error if it fails to open or map
+ */
+class MappedFile : noncopyable {
+public:
+    MappedFile() = default;
+    explicit MappedFile(char const* path);
+
+    MappedFile(MappedFile&& rhs) ZSTL_NOEXCEPT;
+    MappedFile& operator=(MappedFile&& rhs) ZSTL_NOEXCEPT;
+
+    ~MappedFile();
+
+    char const* data() const ZSTL_NOEXCEPT
+    { return data_; }
+
+    size_t size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return size_ == 0; }
+
+    /**
+     * @brief hint the kernel to read ahead the whole file
+     * @note the file is still faulted in lazily if it is not called
+     */
+    void willNeed() const ZSTL_NOEXCEPT;
+
+    void swap(MappedFile& rhs) ZSTL_NOEXCEPT;
+private:
+    char const* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace zstl
+
+#endif // ZSTL_MAPPED_FILE_H
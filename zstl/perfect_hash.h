@@ -0,0 +1,340 @@
+#ifndef ZSTL_PERFECT_HASH_H
+#define ZSTL_PERFECT_HASH_H
+
+#include "config.h"
+#include "hash_aux.h"
+#include "string_view.h"
+#include "typelist.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdexcept>
+
+namespace zstl {
+
+/**
+ * @class PerfectHashTraits
+ * @brief
+ * constexpr hash and equality used by PerfectHashSet/PerfectHashMap.
+ * The primary template handles integers and enumerations,
+ * specialize it for other literal key types.
+ */
+template<typename K>
+struct PerfectHashTraits {
+    static constexpr uint64_t hash(K key) noexcept
+    { return hashMix64(static_cast<uint64_t>(key)); }
+
+    static constexpr bool equal(K x, K y) noexcept
+    { return x == y; }
+};
+
+// FNV-1a, since zstl::string_hash is not constexpr.
+// Its high bits are well mixed, which are the only bits used by PerfectHashSet.
+template<>
+struct PerfectHashTraits<string_view> {
+    static constexpr uint64_t hash(string_view key) noexcept {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (string_view::size_type i = 0; i != key.size(); ++i) {
+            h = (h ^ static_cast<unsigned char>(key[i])) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // operator== of string_view is not constexpr(memcmp)
+    static constexpr bool equal(string_view x, string_view y) noexcept {
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (string_view::size_type i = 0; i != x.size(); ++i) {
+            if (x[i] != y[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+namespace detail {
+
+constexpr size_t perfectHashPow2(size_t n) noexcept {
+    size_t p = 2;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+constexpr int perfectHashLog2(size_t pow2) noexcept {
+    int n = 0;
+    while ((size_t(1) << n) < pow2) {
+        ++n;
+    }
+    return n;
+}
+
+} // namespace detail
+
+/**
+ * @class PerfectHashSet
+ * @tparam K literal key type, hashed by Traits
+ * @tparam N the number of keys
+ * @brief
+ * Collision-free table of a fixed key set, built by constexpr constructor
+ * (hash and displace): keys are grouped into buckets by hash,
+ * then from the largest bucket, a seed is searched per bucket
+ * which sends its keys to empty slots.
+ * Lookup is one seed load, one slot probe and one key comparison,
+ * there is no heap allocation.
+ * @note
+ * The constructor throws(or fails to compile in constant expression)
+ * if the keys are duplicate.
+ * @see Belazzougui, Botelho, Dietzfelbinger. Hash, displace, and compress
+ */
+template<typename K, size_t N, typename Traits = PerfectHashTraits<K>>
+class PerfectHashSet {
+    static_assert(N > 0, "PerfectHashSet requires at least one key");
+    static_assert(N < 0xffffffffu, "PerfectHashSet is too large");
+
+    // load factor in [0.4, 0.8], average bucket size is about 2
+    static constexpr size_t SLOTS = detail::perfectHashPow2(N + N / 4 + 1);
+    static constexpr size_t BUCKETS = detail::perfectHashPow2(N / 2);
+    static constexpr int SLOT_SHIFT = 64 - detail::perfectHashLog2(SLOTS);
+    static constexpr int BUCKET_SHIFT = 64 - detail::perfectHashLog2(BUCKETS);
+    static constexpr uint32_t EMPTY = 0xffffffffu;
+    static constexpr uint32_t MAX_SEED = 1u << 16;
+public:
+    using key_type = K;
+    using size_type = size_t;
+
+    static constexpr size_type npos = size_type(-1);
+
+    constexpr explicit PerfectHashSet(K const (&keys)[N])
+        : keys_{}, index_{}, seeds_{}
+    { build(keys); }
+
+    /**
+     * @return position of @p key in the array passed to constructor,
+     * or npos if not found, so that keys can be mapped to dense ids
+     */
+    constexpr size_type indexOf(K const& key) const noexcept {
+        const auto slot = slotOf(Traits::hash(key));
+        return index_[slot] != EMPTY && Traits::equal(keys_[slot], key)
+            ? index_[slot] : npos;
+    }
+
+    constexpr bool contains(K const& key) const noexcept
+    { return indexOf(key) != npos; }
+
+    constexpr size_type count(K const& key) const noexcept
+    { return contains(key) ? 1 : 0; }
+
+    constexpr size_type size() const noexcept
+    { return N; }
+
+    constexpr size_type slot_count() const noexcept
+    { return SLOTS; }
+
+private:
+    static constexpr size_type bucketOf(uint64_t h) noexcept
+    { return h >> BUCKET_SHIFT; }
+
+    // multiply-shift takes the top bits, which depend on all bits of h ^ seed
+    static constexpr size_type slotWith(uint64_t h, uint64_t seed) noexcept
+    { return ((h ^ seed) * 0x9e3779b97f4a7c15ULL) >> SLOT_SHIFT; }
+
+    constexpr size_type slotOf(uint64_t h) const noexcept
+    { return slotWith(h, seeds_[bucketOf(h)]); }
+
+    constexpr void build(K const (&keys)[N]) {
+        uint64_t hashes[N] = {};
+        for (size_type i = 0; i != N; ++i) {
+            hashes[i] = Traits::hash(keys[i]);
+            for (size_type j = 0; j != i; ++j) {
+                if (Traits::equal(keys[i], keys[j])) {
+                    throw std::invalid_argument("PerfectHashSet: duplicate key");
+                }
+            }
+        }
+
+        // counting sort of keys by bucket
+        size_type first[BUCKETS + 1] = {};
+        size_type members[N] = {};
+        for (size_type i = 0; i != N; ++i) {
+            ++first[bucketOf(hashes[i]) + 1];
+        }
+        for (size_type b = 0; b != BUCKETS; ++b) {
+            first[b + 1] += first[b];
+        }
+        size_type fill[BUCKETS] = {};
+        for (size_type i = 0; i != N; ++i) {
+            const auto b = bucketOf(hashes[i]);
+            members[first[b] + fill[b]++] = i;
+        }
+
+        // the largest bucket is placed first while most slots are empty
+        size_type order[BUCKETS] = {};
+        for (size_type b = 0; b != BUCKETS; ++b) {
+            size_type pos = b;
+            for (; pos != 0 && fill[order[pos - 1]] < fill[b]; --pos) {
+                order[pos] = order[pos - 1];
+            }
+            order[pos] = b;
+        }
+
+        for (size_type i = 0; i != SLOTS; ++i) {
+            index_[i] = EMPTY;
+        }
+
+        for (size_type k = 0; k != BUCKETS && fill[order[k]] != 0; ++k) {
+            const auto b = order[k];
+            if (!placeBucket(b, hashes, members + first[b], fill[b])) {
+                throw std::logic_error("PerfectHashSet: no seed found");
+            }
+        }
+
+        for (size_type i = 0; i != SLOTS; ++i) {
+            if (index_[i] != EMPTY) {
+                keys_[i] = keys[index_[i]];
+            }
+        }
+    }
+
+    constexpr bool placeBucket(size_type b, uint64_t const* hashes,
+                               size_type const* members, size_type n) {
+        for (uint32_t seed = 0; seed != MAX_SEED; ++seed) {
+            const auto mixed = hashMix64(seed);
+            size_type placed = 0;
+
+            for (; placed != n; ++placed) {
+                const auto slot = slotWith(hashes[members[placed]], mixed);
+                if (index_[slot] != EMPTY) {
+                    break;
+                }
+                index_[slot] = static_cast<uint32_t>(members[placed]);
+            }
+
+            if (placed == n) {
+                seeds_[b] = mixed;
+                return true;
+            }
+
+            // rollback the keys of this bucket
+            while (placed != 0) {
+                --placed;
+                index_[slotWith(hashes[members[placed]], mixed)] = EMPTY;
+            }
+        }
+        return false;
+    }
+
+    K keys_[SLOTS];
+    // position of key in the constructor argument, EMPTY if slot is empty
+    uint32_t index_[SLOTS];
+    uint64_t seeds_[BUCKETS];
+};
+
+template<typename K, size_t N, typename Traits>
+constexpr typename PerfectHashSet<K, N, Traits>::size_type PerfectHashSet<K, N, Traits>::npos;
+
+/**
+ * @class PerfectHashEntry
+ * @brief key-value pair to initialize PerfectHashMap
+ */
+template<typename K, typename V>
+struct PerfectHashEntry {
+    K key;
+    V value;
+};
+
+/**
+ * @class PerfectHashMap
+ * @brief PerfectHashSet of keys with values indexed by the key position
+ * @see PerfectHashSet
+ */
+template<typename K, typename V, size_t N, typename Traits = PerfectHashTraits<K>>
+class PerfectHashMap {
+    using Entry = PerfectHashEntry<K, V>;
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = size_t;
+
+    constexpr explicit PerfectHashMap(Entry const (&entries)[N])
+        : PerfectHashMap(entries, keysOf(entries))
+    { }
+
+    // @return the value of @p key, or nullptr if not found
+    constexpr V const* find(K const& key) const noexcept {
+        const auto i = keys_.indexOf(key);
+        return i != keys_.npos ? &values_[i] : nullptr;
+    }
+
+    // @return the value of @p key, or @p dflt if not found
+    constexpr V get(K const& key, V const& dflt) const noexcept {
+        const auto i = keys_.indexOf(key);
+        return i != keys_.npos ? values_[i] : dflt;
+    }
+
+    constexpr bool contains(K const& key) const noexcept
+    { return keys_.contains(key); }
+
+    constexpr size_type count(K const& key) const noexcept
+    { return keys_.count(key); }
+
+    constexpr size_type size() const noexcept
+    { return N; }
+
+private:
+    struct KeyArray {
+        K keys[N];
+    };
+
+    static constexpr KeyArray keysOf(Entry const (&entries)[N]) noexcept {
+        KeyArray arr{};
+        for (size_type i = 0; i != N; ++i) {
+            arr.keys[i] = entries[i].key;
+        }
+        return arr;
+    }
+
+    constexpr PerfectHashMap(Entry const (&entries)[N], KeyArray const& arr)
+        : keys_(arr.keys), values_{}
+    {
+        for (size_type i = 0; i != N; ++i) {
+            values_[i] = entries[i].value;
+        }
+    }
+
+    PerfectHashSet<K, N, Traits> keys_;
+    V values_[N];
+};
+
+/**
+ * @brief make PerfectHashSet from keys,
+ * e.g. makePerfectHashSet<string_view>({ "if"_sv, "else"_sv })
+ */
+template<typename K, size_t N>
+constexpr PerfectHashSet<K, N> makePerfectHashSet(K const (&keys)[N])
+{ return PerfectHashSet<K, N>(keys); }
+
+/**
+ * @brief make PerfectHashSet from compile-time values,
+ * e.g. makePerfectHashSet(mpl::Valuelist<int, 3, 7, 42>{})
+ */
+template<typename T, T... Values>
+constexpr PerfectHashSet<T, sizeof...(Values)> makePerfectHashSet(mpl::Valuelist<T, Values...>) {
+    const T keys[] = { Values... };
+    return PerfectHashSet<T, sizeof...(Values)>(keys);
+}
+
+/**
+ * @brief make PerfectHashMap from entries,
+ * e.g. makePerfectHashMap<string_view, int>({ { "if"_sv, 1 }, { "else"_sv, 2 } })
+ */
+template<typename K, typename V, size_t N>
+constexpr PerfectHashMap<K, V, N> makePerfectHashMap(PerfectHashEntry<K, V> const (&entries)[N])
+{ return PerfectHashMap<K, V, N>(entries); }
+
+} // namespace zstl
+
+#endif // ZSTL_PERFECT_HASH_H
@@ -0,0 +1,516 @@
+#ifndef ZSTL_PERSISTENT_MAP_H
+#define ZSTL_PERSISTENT_MAP_H
+
+#include "allocator.h"
+#include "functional.h"
+#include "stl_exception.h"
+#include "utility.h"
+#include "vector.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace zstl {
+
+namespace detail {
+
+template<typename V>
+struct PersistentNode {
+    template<typename... Args>
+    explicit PersistentNode(Args&&... args)
+        : val(STL_FORWARD(Args, args)...)
+    { }
+
+    // the number of parents and maps which own this node
+    std::atomic<uint32_t> refs{ 1 };
+    unsigned char height = 1;
+    PersistentNode* left = nullptr;
+    PersistentNode* right = nullptr;
+    V val;
+};
+
+} // namespace detail
+
+/**
+ * @class PersistentMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Compare predicate that compare two keys
+ * @brief
+ * Ordered map based on AVL tree whose nodes are reference counted and shared
+ * between versions, the key is unique.
+ * (1) Copying the map is O(1), the copy is a snapshot that is not affected by
+ * later modifications of either map.
+ * (2) Modifiers copy the shared nodes on the search path (and the rotated ones),
+ * which is O(lgn) nodes, the nodes only owned by this map are modified in place.
+ * So a writer can publish a snapshot per change in O(lgn) instead of copying the tree.
+ * (3) A shared node is never modified, so different maps which share nodes
+ * can be used by different threads without lock, like shared_ptr.
+ * But one map object can't be modified and read concurrently.
+ * @note
+ * Modifiers invalidate the iterators of this map, but not of its snapshots.
+ * If a modifier throws, the content is not changed, but the tree may be left unbalanced.
+ */
+template<typename K, typename T,
+    typename Compare = zstl::less<K>>
+class PersistentMap {
+    using Node = detail::PersistentNode<zstl::pair<K const, T>>;
+    using NodeAllocator = zstl::allocator<Node>;
+
+public:
+    using key_type = K;
+    using mapped_type = T;
+    using value_type = zstl::pair<K const, T>;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * @brief in-order iterator which keeps the path from root in a stack
+     */
+    class const_iterator {
+        friend class PersistentMap;
+    public:
+        using iterator_category = Forward_iterator_tag;
+        using value_type = PersistentMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type const&;
+        using pointer = value_type const*;
+
+        const_iterator() = default;
+
+        reference operator*() const ZSTL_NOEXCEPT
+        { return path_.back()->val; }
+
+        pointer operator->() const ZSTL_NOEXCEPT
+        { return &path_.back()->val; }
+
+        const_iterator& operator++() {
+            auto node = path_.back();
+            path_.pop_back();
+            pushLeft(node->right);
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const_iterator const& rhs) const ZSTL_NOEXCEPT {
+            return path_.empty() ? rhs.path_.empty()
+                : !rhs.path_.empty() && path_.back() == rhs.path_.back();
+        }
+
+        bool operator!=(const_iterator const& rhs) const ZSTL_NOEXCEPT
+        { return !(*this == rhs); }
+
+    private:
+        void pushLeft(Node const* node) {
+            for (; node != nullptr; node = node->left) {
+                path_.push_back(node);
+            }
+        }
+
+        Vector<Node const*> path_;
+    };
+
+    using iterator = const_iterator;
+
+    PersistentMap() = default;
+
+    explicit PersistentMap(Compare const& cmp)
+        : cmp_(cmp)
+    { }
+
+    // share all nodes with rhs
+    PersistentMap(PersistentMap const& rhs) ZSTL_NOEXCEPT
+        : root_(acquire(rhs.root_))
+        , size_(rhs.size_)
+        , cmp_(rhs.cmp_)
+    { }
+
+    PersistentMap(PersistentMap&& rhs) ZSTL_NOEXCEPT
+        : root_(rhs.root_)
+        , size_(rhs.size_)
+        , cmp_(rhs.cmp_)
+    {
+        rhs.root_ = nullptr;
+        rhs.size_ = 0;
+    }
+
+    PersistentMap& operator=(PersistentMap const& rhs) ZSTL_NOEXCEPT {
+        PersistentMap(rhs).swap(*this);
+        return *this;
+    }
+
+    PersistentMap& operator=(PersistentMap&& rhs) ZSTL_NOEXCEPT {
+        PersistentMap(STL_MOVE(rhs)).swap(*this);
+        return *this;
+    }
+
+    ~PersistentMap()
+    { release(root_); }
+
+    // the same as copy, for readability at the publish point
+    PersistentMap snapshot() const ZSTL_NOEXCEPT
+    { return *this; }
+
+    // iterator interface
+    const_iterator begin() const {
+        const_iterator iter;
+        iter.pushLeft(root_);
+        return iter;
+    }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return const_iterator(); }
+
+    // capacity
+    bool empty() const ZSTL_NOEXCEPT
+    { return size_ == 0; }
+
+    size_type size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    // lookup
+    /**
+     * @brief copy the mapped value of @p key to @p out if it exists
+     * @return whether key exists
+     */
+    bool find(key_type const& key, mapped_type& out) const {
+        auto node = findNode(key);
+        if (node == nullptr)
+            return false;
+        out = node->val.second;
+        return true;
+    }
+
+    /**
+     * @brief call @p f with the mapped value of @p key if it exists
+     * @return whether key exists
+     */
+    template<typename F>
+    bool visit(key_type const& key, F f) const {
+        auto node = findNode(key);
+        if (node == nullptr)
+            return false;
+        f(static_cast<mapped_type const&>(node->val.second));
+        return true;
+    }
+
+    T const& at(key_type const& key) const {
+        auto node = findNode(key);
+        THROW_RANGE_ERROR_IF(node == nullptr, "PersistentMap::at(): key is not exists");
+        return node->val.second;
+    }
+
+    bool contains(key_type const& key) const
+    { return findNode(key) != nullptr; }
+
+    size_type count(key_type const& key) const
+    { return contains(key) ? 1 : 0; }
+
+    // the first element whose key is not less than key
+    const_iterator lower_bound(key_type const& key) const {
+        const_iterator iter;
+        for (Node const* node = root_; node != nullptr; ) {
+            if (cmp_(node->val.first, key)) {
+                node = node->right;
+            } else {
+                iter.path_.push_back(node);
+                node = node->left;
+            }
+        }
+        return iter;
+    }
+
+    key_compare key_comp() const
+    { return cmp_; }
+
+    // modifiers
+    bool insert(value_type const& x)
+    { return try_emplace(x.first, x.second); }
+
+    /**
+     * @brief insert value constructed from key and @p args if key is not exists
+     * @return whether the value is inserted
+     * @note nothing is copied if key exists
+     */
+    template<typename U, typename... Args>
+    bool try_emplace(U&& key, Args&&... args) {
+        if (contains(key))
+            return false;
+        insertAux(root_, STL_FORWARD(U, key), STL_FORWARD(Args, args)...);
+        ++size_;
+        return true;
+    }
+
+    /**
+     * @brief assign @p obj to the mapped value of @p key, insert it if key is not exists
+     * @return whether the value is inserted
+     */
+    template<typename M>
+    bool insert_or_assign(key_type const& key, M&& obj) {
+        if (!contains(key)) {
+            insertAux(root_, key, STL_FORWARD(M, obj));
+            ++size_;
+            return true;
+        }
+
+        Node** link = &root_;
+        for (;;) {
+            unshareLink(*link);
+            auto node = *link;
+            if (cmp_(key, node->val.first)) {
+                link = &node->left;
+            } else if (cmp_(node->val.first, key)) {
+                link = &node->right;
+            } else {
+                node->val.second = STL_FORWARD(M, obj);
+                return false;
+            }
+        }
+    }
+
+    size_type erase(key_type const& key) {
+        if (!contains(key))
+            return 0;
+        eraseAux(root_, key);
+        --size_;
+        return 1;
+    }
+
+    void clear() ZSTL_NOEXCEPT {
+        release(root_);
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+    void swap(PersistentMap& rhs) ZSTL_NOEXCEPT {
+        STL_SWAP(root_, rhs.root_);
+        STL_SWAP(size_, rhs.size_);
+        STL_SWAP(cmp_, rhs.cmp_);
+    }
+
+#ifdef PERSISTENT_MAP_DEBUG
+    // check the order, heights and balance factors
+    bool verify() const {
+        size_type n = 0;
+        return verifyAux(root_, nullptr, nullptr, n) >= 0 && n == size_;
+    }
+#endif
+
+private:
+    Node const* findNode(key_type const& key) const {
+        Node const* node = root_;
+        while (node != nullptr) {
+            if (cmp_(key, node->val.first))
+                node = node->left;
+            else if (cmp_(node->val.first, key))
+                node = node->right;
+            else
+                return node;
+        }
+        return nullptr;
+    }
+
+    // key is not exists
+    template<typename U, typename... Args>
+    void insertAux(Node*& link, U&& key, Args&&... args) {
+        if (link == nullptr) {
+            link = newNode(emplace_second, STL_FORWARD(U, key), STL_FORWARD(Args, args)...);
+            return;
+        }
+
+        unshareLink(link);
+        if (cmp_(key, link->val.first))
+            insertAux(link->left, STL_FORWARD(U, key), STL_FORWARD(Args, args)...);
+        else
+            insertAux(link->right, STL_FORWARD(U, key), STL_FORWARD(Args, args)...);
+        rebalance(link);
+    }
+
+    // key exists
+    void eraseAux(Node*& link, key_type const& key) {
+        unshareLink(link);
+        auto node = link;
+
+        if (cmp_(key, node->val.first)) {
+            eraseAux(node->left, key);
+        } else if (cmp_(node->val.first, key)) {
+            eraseAux(node->right, key);
+        } else if (node->left == nullptr || node->right == nullptr) {
+            // the child is moved to link
+            link = node->left != nullptr ? node->left : node->right;
+            destroyNode(node);
+            return;
+        } else {
+            // replace the node by the minimum of its right subtree
+            auto min = detachMin(node->right);
+            min->left = node->left;
+            min->right = node->right;
+            destroyNode(node);
+            link = min;
+        }
+
+        rebalance(link);
+    }
+
+    // unlink the minimum node of subtree and return it, which is only owned by caller
+    Node* detachMin(Node*& link) {
+        unshareLink(link);
+        auto node = link;
+
+        if (node->left == nullptr) {
+            link = node->right;
+            node->right = nullptr;
+            return node;
+        }
+
+        auto min = detachMin(node->left);
+        rebalance(link);
+        return min;
+    }
+
+    // the node of link is only owned by this map, its children may be shared
+    static void rebalance(Node*& link) {
+        auto node = link;
+        const int diff = height(node->left) - height(node->right);
+
+        if (diff > 1) {
+            if (height(node->left->left) < height(node->left->right))
+                rotateLeft(node->left);
+            rotateRight(link);
+        } else if (diff < -1) {
+            if (height(node->right->right) < height(node->right->left))
+                rotateRight(node->right);
+            rotateLeft(link);
+        } else {
+            fixHeight(node);
+        }
+    }
+
+    static void rotateLeft(Node*& link) {
+        unshareLink(link);
+        unshareLink(link->right);
+        auto node = link;
+        auto right = node->right;
+        node->right = right->left;
+        right->left = node;
+        fixHeight(node);
+        fixHeight(right);
+        link = right;
+    }
+
+    static void rotateRight(Node*& link) {
+        unshareLink(link);
+        unshareLink(link->left);
+        auto node = link;
+        auto left = node->left;
+        node->left = left->right;
+        left->right = node;
+        fixHeight(node);
+        fixHeight(left);
+        link = left;
+    }
+
+    static int height(Node const* node) ZSTL_NOEXCEPT
+    { return node != nullptr ? node->height : 0; }
+
+    static void fixHeight(Node* node) ZSTL_NOEXCEPT {
+        const int lh = height(node->left);
+        const int rh = height(node->right);
+        node->height = static_cast<unsigned char>(1 + (lh < rh ? rh : lh));
+    }
+
+    /**
+     * @brief make the node of link only owned by this map, copy it if it is shared
+     * @note
+     * The acquire load pairs with the release in release(), so the reads of
+     * the other owners happen before the modification here.
+     * If copy throws, nothing is changed.
+     */
+    static void unshareLink(Node*& link) {
+        auto node = link;
+        if (node->refs.load(std::memory_order_acquire) == 1)
+            return;
+
+        auto copy = newNode(node->val);
+        copy->left = acquire(node->left);
+        copy->right = acquire(node->right);
+        copy->height = node->height;
+        release(node);
+        link = copy;
+    }
+
+    static Node* acquire(Node* node) ZSTL_NOEXCEPT {
+        if (node != nullptr)
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    // destroy the nodes which are not owned by others
+    static void release(Node* node) ZSTL_NOEXCEPT {
+        while (node != nullptr && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            release(node->left);
+            auto right = node->right;
+            destroyNode(node);
+            node = right;
+        }
+    }
+
+    template<typename... Args>
+    static Node* newNode(Args&&... args) {
+        NodeAllocator alloc;
+        Node* node = alloc.allocate();
+
+        TRY_BEGIN
+            alloc.construct(node, STL_FORWARD(Args, args)...);
+        TRY_END
+        CATCH_ALL_BEGIN
+            alloc.deallocate(node);
+            RETHROW
+        CATCH_END
+
+        return node;
+    }
+
+    static void destroyNode(Node* node) ZSTL_NOEXCEPT {
+        NodeAllocator alloc;
+        alloc.destroy(node);
+        alloc.deallocate(node);
+    }
+
+#ifdef PERSISTENT_MAP_DEBUG
+    // return height or -1 if invalid
+    int verifyAux(Node const* node, K const* lo, K const* hi, size_type& n) const {
+        if (node == nullptr)
+            return 0;
+        if ((lo && !cmp_(*lo, node->val.first)) || (hi && !cmp_(node->val.first, *hi)))
+            return -1;
+
+        ++n;
+        const int lh = verifyAux(node->left, lo, &node->val.first, n);
+        const int rh = verifyAux(node->right, &node->val.first, hi, n);
+        if (lh < 0 || rh < 0 || lh - rh > 1 || rh - lh > 1)
+            return -1;
+
+        const int h = 1 + (lh < rh ? rh : lh);
+        return h == node->height ? h : -1;
+    }
+#endif
+
+    Node* root_ = nullptr;
+    size_type size_ = 0;
+    Compare cmp_;
+};
+
+template<typename K, typename T, typename CP>
+inline void swap(PersistentMap<K, T, CP>& x, PersistentMap<K, T, CP>& y) ZSTL_NOEXCEPT
+{ x.swap(y); }
+
+} // namespace zstl
+
+#endif // ZSTL_PERSISTENT_MAP_H
@@ -0,0 +1,164 @@
+#ifndef ZSTL_POOL_ALLOCATOR_H
+#define ZSTL_POOL_ALLOCATOR_H
+
+#include "stl_construct.h"
+#include "stl_utility.h"
+#include "type_traits.h"
+
+#include <new>
+
+namespace zstl {
+
+/**
+ * @class PoolAllocator
+ * @tparam T value type
+ * @tparam SLAB_BYTES the size of slab which single objects are carved from
+ * @brief
+ * Stateful allocator for node-based containers, each instance owns its pool.
+ * Single objects are bumped from slabs and recycled by a free list,
+ * deallocate_all() returns all slabs at once without visiting the objects,
+ * which is used by the container to drop its nodes in O(slabs).
+ * @note
+ * Memory can only be deallocated by the pool which allocates it,
+ * so a copy of the allocator is a new empty pool, and the move steals the pool.
+ * Arrays(n != 1) are allocated from operator new directly.
+ */
+template<typename T, std::size_t SLAB_BYTES = 64 * 1024>
+class PoolAllocator {
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // the first slot of a slab links the slabs
+    static constexpr std::size_t SLOTS_PER_SLAB =
+        SLAB_BYTES / sizeof(Slot) > 2 ? SLAB_BYTES / sizeof(Slot) : 2;
+
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef std::size_t size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template<typename U>
+    struct Rebind {
+        using type = PoolAllocator<U, SLAB_BYTES>;
+    };
+
+    template<typename U>
+    using rebind = typename Rebind<U>::type;
+
+    PoolAllocator() = default;
+
+    PoolAllocator(PoolAllocator const&) ZSTL_NOEXCEPT
+    { }
+
+    PoolAllocator(PoolAllocator&& rhs) ZSTL_NOEXCEPT
+    { swap(rhs); }
+
+    PoolAllocator& operator=(PoolAllocator&& rhs) ZSTL_NOEXCEPT {
+        deallocate_all();
+        swap(rhs);
+        return *this;
+    }
+
+    // the pool is kept, the memory allocated by this pool is still valid
+    PoolAllocator& operator=(PoolAllocator const&) ZSTL_NOEXCEPT
+    { return *this; }
+
+    ~PoolAllocator()
+    { deallocate_all(); }
+
+    T* allocate(size_t n = 1) {
+        if (n != 1)
+            return static_cast<T*>(::operator new(sizeof(T) * n));
+
+        if (free_) {
+            auto slot = free_;
+            free_ = slot->next;
+            return reinterpret_cast<T*>(slot);
+        }
+
+        if (cur_ == end_)
+            newSlab();
+        return reinterpret_cast<T*>(cur_++);
+    }
+
+    void deallocate(T* ptr, std::size_t n = 1) ZSTL_NOEXCEPT {
+        if (n != 1) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto slot = reinterpret_cast<Slot*>(ptr);
+        slot->next = free_;
+        free_ = slot;
+    }
+
+    template<typename...Args, typename U>
+    void construct(U* ptr, Args&&... args) const {
+        zstl::construct(ptr, zstl::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U* ptr) const {
+        zstl::destroy(ptr);
+    }
+
+    template<typename U>
+    void destroy(U* first, U* last) const {
+        zstl::destroy(first, last);
+    }
+
+    /**
+     * @brief free all slabs, i.e. all single objects allocated by this pool
+     * @note the objects must have been destroyed or be trivially destructible
+     */
+    void deallocate_all() ZSTL_NOEXCEPT {
+        while (slabs_) {
+            auto next = slabs_->next;
+            ::operator delete(slabs_);
+            slabs_ = next;
+        }
+        free_ = cur_ = end_ = nullptr;
+    }
+
+    void swap(PoolAllocator& rhs) ZSTL_NOEXCEPT {
+        STL_SWAP(slabs_, rhs.slabs_);
+        STL_SWAP(free_, rhs.free_);
+        STL_SWAP(cur_, rhs.cur_);
+        STL_SWAP(end_, rhs.end_);
+    }
+
+private:
+    void newSlab() {
+        auto slab = static_cast<Slot*>(::operator new(sizeof(Slot) * SLOTS_PER_SLAB));
+        slab->next = slabs_;
+        slabs_ = slab;
+        cur_ = slab + 1;
+        end_ = slab + SLOTS_PER_SLAB;
+    }
+
+    Slot* slabs_ = nullptr;
+    Slot* free_ = nullptr;
+    Slot* cur_ = nullptr;
+    Slot* end_ = nullptr;
+};
+
+/**
+ * @brief whether Alloc can release all objects at once by deallocate_all()
+ */
+template<typename Alloc, typename = void>
+struct has_deallocate_all : _false_type { };
+
+template<typename Alloc>
+struct has_deallocate_all<Alloc,
+    Void_t<decltype(zstl::declval<Alloc&>().deallocate_all())>>
+    : _true_type { };
+
+} // namespace zstl
+
+#endif // ZSTL_POOL_ALLOCATOR_H
@@ -6,13 +6,18 @@
 
 namespace zstl{
 
+/**
+ * @class Set
+ * @tparam Augment RBTreeSizeAugment enables rank(), select() and distance() in O(lgn)
+ */
 template<typename T, 
 	 typename Compare = zstl::less<T>,
-	 typename Alloc = zstl::allocator<T>>
+	 typename Alloc = zstl::allocator<T>,
+	 typename Augment = RBTreeNoAugment>
 class Set{
 //TODO: BINARY_CALLABLE_CHECK
 public:
-	using Rep = RBTree<T, T, identity<T>, Compare, Alloc>;
+	using Rep = RBTree<T, T, identity<T>, Compare, Alloc, Augment>;
 	using key_type = typename Rep::key_type;
 	using value_type = typename Rep::value_type;
 	using key_compare = typename Rep::key_compare;
@@ -22,7 +27,9 @@ public:
 	using reference = typename Rep::reference;
 	using const_reference = typename Rep::const_reference;
 	using size_type = typename Rep::size_type;
-	using defference_type = typename Rep::difference_type;
+	using difference_type = typename Rep::difference_type;
+	// misspelled name of the old version
+	using defference_type [[deprecated("use difference_type")]] = difference_type;
 	using iterator = typename Rep::iterator;
 	using const_iterator = typename Rep::const_iterator;
 	using reverse_iterator = typename Rep::reverse_iterator;
@@ -31,6 +38,12 @@ public:
 
 	Set() = default;
 	~Set() = default;
+
+	// O(n) if [first, last) is sorted
+	template<typename II, typename = Enable_if_t<is_input_iterator<II>::value>>
+	Set(II first, II last)
+	{ rb_.InsertUnique(first, last); }
+
 	Set(Set const& rhs) = default;
 	Set& operator=(Set const& rhs) = default;
 
@@ -98,9 +111,17 @@ public:
 	void insert(II first, II last) 
 	{ return rb_.InsertUnique(first, last); }
 
+	/**
+	 * @brief replace the content with sorted range [first, last) in O(n)
+	 * @warning the range must be sorted
+	 */
+	template<typename FI>
+	void assign_sorted(FI first, FI last)
+	{ rb_.AssignSortedUnique(first, last); }
+
 	template<typename... Args>
 	zstl::pair<iterator, bool> emplace(Args&&... args)
-	{ return rb_.EmplaceEqual(STL_FORWARD(Args, args)...); }
+	{ return rb_.EmplaceUnique(STL_FORWARD(Args, args)...); }
 
 	template<typename ...Args>
 	zstl::pair<iterator, bool> emplace_hint(const_iterator hint, Args&&... args)
@@ -113,14 +134,26 @@ public:
 	{ return rb_.erase(first, last); }
 
 	size_type erase(key_type const& key)
-	{ return rb_.erase(key); }
+	{ return rb_.EraseUnique(key); }
 
 	void swap(Set& rhs) noexcept(noexcept(this->rb_.swap(rhs.rb_)))
 	{ rb_.swap(rhs.rb_); }
 
+	// move all elements of rhs to the end in O(lgn),
+	// the elements of rhs must be greater than the elements of *this
+	void join(Set& rhs) noexcept
+	{ rb_.Join(rhs.rb_); }
+
+	// @return the elements not less than key, which are moved from *this
+	Set split(key_type const& key) {
+		Set rhs;
+		rb_.Split(key, rhs.rb_);
+		return rhs;
+	}
+
 	// lookup
 	size_type count(key_type const& key) const
-	{ return rb_.count(key); }
+	{ return rb_.contains(key) ? 1 : 0; }
 	
 	iterator find(key_type const& key) 
 	{ return rb_.find(key); }
@@ -129,7 +162,7 @@ public:
 	{ return rb_.find(key); }
 
 	bool contains(key_type const& key) const
-	{ return contains(key); }
+	{ return rb_.contains(key); }
 
 	zstl::pair<iterator, iterator>
 	equal_range(key_type const& key)
@@ -154,28 +187,108 @@ public:
 	key_compare key_comp() const
 	{ return rb_.key_comp(); }
 
+	// the number of elements less than key
+	size_type rank(key_type const& key) const
+	{ return rb_.rank(key); }
+
+	// the k-th smallest element(start from 0), end() if k >= size()
+	const_iterator select(size_type k) const
+	{ return rb_.select(k); }
+
+	size_type index(const_iterator pos) const
+	{ return rb_.index(pos); }
+
+	difference_type distance(const_iterator first, const_iterator last) const
+	{ return rb_.distance(first, last); }
+
 	Rep& rep() noexcept {
 		return rb_;
 	}
+
+	Rep const& rep() const noexcept {
+		return rb_;
+	}
 private:
 	Rep rb_;
 };
 
-template<typename T, typename Compare, typename Alloc>
+template<typename T, typename Compare, typename Alloc, typename Augment>
 bool operator==(
-		Set<T, Compare, Alloc> const& lhs,
-		Set<T, Compare, Alloc> const& rhs)
+		Set<T, Compare, Alloc, Augment> const& lhs,
+		Set<T, Compare, Alloc, Augment> const& rhs)
 { 
 	return lexicographical_compare(lhs.begin(), lhs.end(),
 									rhs.begin(), rhs.end());
 }
 
-template<typename T, typename Compare, typename Alloc>
+template<typename T, typename Compare, typename Alloc, typename Augment>
 bool operator!=(
-		Set<T, Compare, Alloc> const& lhs,
-		Set<T, Compare, Alloc> const& rhs)
+		Set<T, Compare, Alloc, Augment> const& lhs,
+		Set<T, Compare, Alloc, Augment> const& rhs)
 { return !(lhs == rhs); }
 
+
+namespace detail {
+
+template<typename S>
+struct IsSet : _false_type {};
+
+template<typename T, typename Compare, typename Alloc, typename Augment>
+struct IsSet<Set<T, Compare, Alloc, Augment>> : _true_type {};
+
+template<typename S1, typename S2>
+using SetAlgebraResult = Enable_if_t<
+	IsSet<Decay_t<S1>>::value && Is_same<Decay_t<S1>, Decay_t<S2>>::value,
+	Decay_t<S1>>;
+
+} // namespace detail
+
+/**
+ * @brief set algebra of RBTree, which takes O(m lg(n/m + 1)) comparisons
+ * for the sets of size m and n(m <= n)
+ * @note
+ * The result is made from one operand: the larger one for union, the smaller
+ * one for intersection and lhs for difference. It is moved if it is a rvalue,
+ * otherwise copied. The other operand is only read, except that union
+ * relinks its nodes(or the copies of them if it is a lvalue).
+ * @see RBTree::Union()
+ */
+template<typename S1, typename S2>
+detail::SetAlgebraResult<S1, S2> set_union(S1&& lhs, S2&& rhs) {
+	if (lhs.size() < rhs.size()) {
+		Decay_t<S1> res(STL_FORWARD(S2, rhs));
+		Decay_t<S1> small(STL_FORWARD(S1, lhs));
+		res.rep().Union(small.rep());
+		return res;
+	}
+
+	Decay_t<S1> res(STL_FORWARD(S1, lhs));
+	Decay_t<S1> small(STL_FORWARD(S2, rhs));
+	res.rep().Union(small.rep());
+	return res;
+}
+
+// the result is taken from the smaller one
+template<typename S1, typename S2>
+detail::SetAlgebraResult<S1, S2> set_intersection(S1&& lhs, S2&& rhs) {
+	if (rhs.size() < lhs.size()) {
+		Decay_t<S1> res(STL_FORWARD(S2, rhs));
+		res.rep().Intersect(lhs.rep());
+		return res;
+	}
+
+	Decay_t<S1> res(STL_FORWARD(S1, lhs));
+	res.rep().Intersect(rhs.rep());
+	return res;
+}
+
+// @return the elements of lhs which are not in rhs, rhs is only read
+template<typename S1, typename S2>
+detail::SetAlgebraResult<S1, S2> set_difference(S1&& lhs, S2&& rhs) {
+	Decay_t<S1> res(STL_FORWARD(S1, lhs));
+	res.rep().Difference(rhs.rep());
+	return res;
+}
 		
 } //namespace zstl
 
@@ -0,0 +1,577 @@
+#ifndef ZSTL_SKIPLIST_H
+#define ZSTL_SKIPLIST_H
+
+#include "allocator.h"
+#include "config.h"
+#include "functional.h"
+#include "stl_algobase.h"
+#include "stl_exception.h"
+#include "stl_iterator.h"
+#include "stl_utility.h"
+
+#include <stdint.h>
+
+namespace zstl {
+
+namespace detail {
+
+/**
+ * @struct SkipListNode
+ * @brief
+ * Node of SkipList, the links of its levels follow it in the same block,
+ * i.e. links()[i] is the next node at level i, links()[0] is the order of all nodes.
+ * @note The node is never constructed as a whole, only val is constructed.
+ */
+template<typename T>
+struct SkipListNode {
+    T val;
+    // the previous node at level 0
+    SkipListNode* prev;
+    std::size_t height;
+
+    SkipListNode** links() ZSTL_NOEXCEPT
+    { return reinterpret_cast<SkipListNode**>(this + 1); }
+};
+
+/**
+ * @brief 64-bit xorshift, which is enough to pick the height of node
+ * @see George Marsaglia. Xorshift RNGs
+ */
+inline uint64_t xorshift64(uint64_t& state) ZSTL_NOEXCEPT {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**
+ * @brief height in [1, max_height], each level is promoted with probability 1/4
+ */
+inline std::size_t skipListHeight(uint64_t r, std::size_t max_height) ZSTL_NOEXCEPT {
+    std::size_t height = 1;
+    while (height < max_height && (r & 3) == 0) {
+        ++height;
+        r >>= 2;
+    }
+    return height;
+}
+
+} // namespace detail
+
+/**
+ * @class SkipListIterator
+ * @brief bidirectional iterator of SkipList, the key can't be modified through it
+ */
+template<typename T>
+class SkipListIterator {
+    using Node = detail::SkipListNode<T>;
+public:
+    using value_type = T;
+    using reference = T const&;
+    using pointer = T const*;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = Bidirectional_iterator_tag;
+
+    SkipListIterator() = default;
+
+    explicit SkipListIterator(Node* node)
+        : node_(node)
+    { }
+
+    Node* node() const ZSTL_NOEXCEPT
+    { return node_; }
+
+    reference operator*() const ZSTL_NOEXCEPT
+    { return node_->val; }
+
+    pointer operator->() const ZSTL_NOEXCEPT
+    { return &node_->val; }
+
+    SkipListIterator& operator++() ZSTL_NOEXCEPT {
+        node_ = node_->links()[0];
+        return *this;
+    }
+
+    SkipListIterator operator++(int) ZSTL_NOEXCEPT {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    SkipListIterator& operator--() ZSTL_NOEXCEPT {
+        node_ = node_->prev;
+        return *this;
+    }
+
+    SkipListIterator operator--(int) ZSTL_NOEXCEPT {
+        auto tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    friend bool operator==(SkipListIterator const& x, SkipListIterator const& y) ZSTL_NOEXCEPT
+    { return x.node_ == y.node_; }
+
+    friend bool operator!=(SkipListIterator const& x, SkipListIterator const& y) ZSTL_NOEXCEPT
+    { return !(x == y); }
+
+private:
+    Node* node_ = nullptr;
+};
+
+/**
+ * @class SkipList
+ * @tparam T key type
+ * @tparam Compare predicate that compare two keys
+ * @tparam Alloc allocator, which is rebound to allocate the blocks of nodes
+ * @brief ordered set based on skip list, the key is unique
+ * @note
+ * The interface is same as Set except the RBTree specific ones(join, split, rank...).
+ * Each node and its links are allocated in one block whose size depends on its height,
+ * the expected number of links per node is 4/3.
+ * The head is the end() and the sentinel of all levels, which is kept in the object,
+ * so the move re-points the last node of each level to the new head in O(lgn).
+ * The hint of insert() is ignored.
+ */
+template<typename T,
+    typename Compare = zstl::less<T>,
+    typename Alloc = zstl::allocator<T>>
+class SkipList {
+    using Node = detail::SkipListNode<T>;
+
+    // the unit of node block
+    struct alignas(Node) Unit {
+        unsigned char bytes[alignof(Node)];
+    };
+
+    using UnitAllocator = typename Alloc::template rebind<Unit>;
+
+public:
+    // supports 4^16 elements in expected O(lgn)
+    static constexpr std::size_t MAX_HEIGHT = 16;
+
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using pointer = T const*;
+    using const_pointer = T const*;
+    using reference = T const&;
+    using const_reference = T const&;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = SkipListIterator<T>;
+    using const_iterator = SkipListIterator<T>;
+    using reverse_iterator = zstl::reverse_iterator<iterator>;
+    using const_reverse_iterator = zstl::reverse_iterator<const_iterator>;
+    using Res = zstl::pair<iterator, bool>;
+
+    SkipList()
+    { reset(); }
+
+    explicit SkipList(Compare const& cmp)
+        : cmp_(cmp)
+    { reset(); }
+
+    template<typename II, typename = Enable_if_t<is_input_iterator<II>::value>>
+    SkipList(II first, II last)
+        : SkipList()
+    { insert(first, last); }
+
+    // the copy has the same heights of nodes
+    SkipList(SkipList const& rhs)
+        : cmp_(rhs.cmp_)
+        , seed_(rhs.seed_)
+    {
+        reset();
+        STL_TRY {
+            Node* tails[MAX_HEIGHT];
+            initTails(tails);
+            for (auto x = rhs.first(); x != rhs.head(); x = x->links()[0]) {
+                append(createNode(x->height, x->val), tails);
+            }
+        } CATCH_ALL {
+            clear();
+            RETHROW
+        }
+    }
+
+    SkipList(SkipList&& rhs) ZSTL_NOEXCEPT
+        : cmp_(rhs.cmp_)
+        , seed_(rhs.seed_)
+    {
+        reset();
+        steal(rhs);
+    }
+
+    SkipList& operator=(SkipList const& rhs) {
+        if (this != &rhs) {
+            SkipList tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SkipList& operator=(SkipList&& rhs) ZSTL_NOEXCEPT {
+        if (this != &rhs) {
+            clear();
+            cmp_ = rhs.cmp_;
+            steal(rhs);
+        }
+        return *this;
+    }
+
+    ~SkipList()
+    { clear(); }
+
+    Alloc get_allocator() const ZSTL_NOEXCEPT
+    { return Alloc(); }
+
+    // iterator interface
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return const_iterator(first()); }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return const_iterator(head()); }
+
+    const_iterator cbegin() const ZSTL_NOEXCEPT
+    { return begin(); }
+
+    const_iterator cend() const ZSTL_NOEXCEPT
+    { return end(); }
+
+    const_reverse_iterator rbegin() const ZSTL_NOEXCEPT
+    { return const_reverse_iterator(end()); }
+
+    const_reverse_iterator rend() const ZSTL_NOEXCEPT
+    { return const_reverse_iterator(begin()); }
+
+    // capacity
+    size_type size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return size_ == 0; }
+
+    // modifiers
+    void clear() ZSTL_NOEXCEPT {
+        auto x = first();
+        while (x != head()) {
+            auto next = x->links()[0];
+            dropNode(x);
+            x = next;
+        }
+        reset();
+    }
+
+    Res insert(value_type const& x)
+    { return insertAux(x); }
+
+    Res insert(value_type&& x)
+    { return insertAux(STL_MOVE(x)); }
+
+    Res insert(const_iterator, value_type const& x)
+    { return insertAux(x); }
+
+    Res insert(const_iterator, value_type&& x)
+    { return insertAux(STL_MOVE(x)); }
+
+    template<typename II>
+    void insert(II first, II last) {
+        for (; first != last; ++first) {
+            insertAux(*first);
+        }
+    }
+
+    /**
+     * @brief replace the content with sorted range [first, last) in O(n)
+     * @warning the range must be sorted by key
+     */
+    template<typename FI>
+    void assign_sorted(FI first, FI last) {
+        clear();
+        Node* tails[MAX_HEIGHT];
+        initTails(tails);
+        for (; first != last; ++first) {
+            if (tails[0] == head() || cmp_(tails[0]->val, *first))
+                append(createNode(randomHeight(), *first), tails);
+        }
+    }
+
+    /**
+     * @brief construct value in place and insert it if key is unique
+     * @note the key is unknown until the value is constructed
+     */
+    template<typename... Args>
+    Res emplace(Args&&... args) {
+        auto node = createNode(randomHeight(), STL_FORWARD(Args, args)...);
+        Node* preds[MAX_HEIGHT];
+        auto y = findPreds(node->val, preds);
+        if (y != head() && !cmp_(node->val, y->val)) {
+            dropNode(node);
+            return Res(iterator(y), false);
+        }
+
+        link(node, preds);
+        return Res(iterator(node), true);
+    }
+
+    template<typename... Args>
+    Res emplace_hint(const_iterator, Args&&... args)
+    { return emplace(STL_FORWARD(Args, args)...); }
+
+    // O(lgn) since the predecessors at each level are searched
+    iterator erase(const_iterator pos) {
+        auto node = pos.node();
+        Node* preds[MAX_HEIGHT];
+        findPreds(node->val, preds);
+        auto next = node->links()[0];
+        unlink(node, preds);
+        dropNode(node);
+        return iterator(next);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        if (first == begin() && last == end()) {
+            clear();
+        } else {
+            while (first != last)
+                first = erase(first);
+        }
+        return iterator(last.node());
+    }
+
+    size_type erase(key_type const& key) {
+        Node* preds[MAX_HEIGHT];
+        auto node = findPreds(key, preds);
+        if (node == head() || cmp_(key, node->val))
+            return 0;
+
+        unlink(node, preds);
+        dropNode(node);
+        return 1;
+    }
+
+    void swap(SkipList& rhs) ZSTL_NOEXCEPT {
+        SkipList tmp(STL_MOVE(rhs));
+        rhs = STL_MOVE(*this);
+        *this = STL_MOVE(tmp);
+    }
+
+    // lookup
+    size_type count(key_type const& key) const
+    { return contains(key) ? 1 : 0; }
+
+    const_iterator find(key_type const& key) const {
+        auto x = lowerBound(key);
+        return const_iterator(x != head() && !cmp_(key, x->val) ? x : head());
+    }
+
+    bool contains(key_type const& key) const
+    { return find(key) != end(); }
+
+    zstl::pair<const_iterator, const_iterator> equal_range(key_type const& key) const {
+        auto first = find(key);
+        auto last = first;
+        if (last != end())
+            ++last;
+        return zstl::make_pair(first, last);
+    }
+
+    const_iterator lower_bound(key_type const& key) const
+    { return const_iterator(lowerBound(key)); }
+
+    const_iterator upper_bound(key_type const& key) const {
+        auto x = lowerBound(key);
+        return const_iterator(x != head() && !cmp_(key, x->val) ? x->links()[0] : x);
+    }
+
+    key_compare key_comp() const
+    { return cmp_; }
+
+private:
+    Node* head() const ZSTL_NOEXCEPT
+    { return reinterpret_cast<Node*>(const_cast<Unit*>(head_)); }
+
+    Node* first() const ZSTL_NOEXCEPT
+    { return head()->links()[0]; }
+
+    static constexpr std::size_t units(std::size_t height) ZSTL_NOEXCEPT
+    { return (sizeof(Node) + height * sizeof(Node*) + sizeof(Unit) - 1) / sizeof(Unit); }
+
+    std::size_t randomHeight() ZSTL_NOEXCEPT
+    { return detail::skipListHeight(detail::xorshift64(seed_), MAX_HEIGHT); }
+
+    // empty list: all levels of head point to itself
+    void reset() ZSTL_NOEXCEPT {
+        auto h = head();
+        h->prev = h;
+        h->height = MAX_HEIGHT;
+        for (std::size_t i = 0; i != MAX_HEIGHT; ++i) {
+            h->links()[i] = h;
+        }
+        level_ = 1;
+        size_ = 0;
+    }
+
+    template<typename... Args>
+    Node* createNode(std::size_t height, Args&&... args) {
+        auto node = reinterpret_cast<Node*>(alloc_.allocate(units(height)));
+        STL_TRY {
+            alloc_.construct(&node->val, STL_FORWARD(Args, args)...);
+        } CATCH_ALL {
+            alloc_.deallocate(reinterpret_cast<Unit*>(node), units(height));
+            RETHROW
+        }
+        node->height = height;
+        return node;
+    }
+
+    void dropNode(Node* node) ZSTL_NOEXCEPT {
+        alloc_.destroy(&node->val);
+        alloc_.deallocate(reinterpret_cast<Unit*>(node), units(node->height));
+    }
+
+    /**
+     * @brief fill @p preds with the last node less than @p key at each level in use
+     * @return the first node not less than @p key, i.e. head if not found
+     */
+    Node* findPreds(key_type const& key, Node** preds) const {
+        auto x = head();
+        // the node stopped the search at upper level, which is not less than key
+        Node* bound = head();
+        for (auto i = level_; i-- != 0; ) {
+            Node* y;
+            while ((y = x->links()[i]) != bound && cmp_(y->val, key))
+                x = y;
+            bound = y;
+            preds[i] = x;
+        }
+        return x->links()[0];
+    }
+
+    Node* lowerBound(key_type const& key) const {
+        auto x = head();
+        Node* bound = head();
+        for (auto i = level_; i-- != 0; ) {
+            Node* y;
+            while ((y = x->links()[i]) != bound && cmp_(y->val, key))
+                x = y;
+            bound = y;
+        }
+        return x->links()[0];
+    }
+
+    // link node after preds
+    void link(Node* node, Node** preds) ZSTL_NOEXCEPT {
+        for (; level_ < node->height; ++level_) {
+            preds[level_] = head();
+        }
+
+        for (std::size_t i = 0; i != node->height; ++i) {
+            node->links()[i] = preds[i]->links()[i];
+            preds[i]->links()[i] = node;
+        }
+        node->prev = preds[0];
+        node->links()[0]->prev = node;
+        ++size_;
+    }
+
+    void unlink(Node* node, Node** preds) ZSTL_NOEXCEPT {
+        for (std::size_t i = 0; i != node->height; ++i) {
+            preds[i]->links()[i] = node->links()[i];
+        }
+        node->links()[0]->prev = node->prev;
+        while (level_ > 1 && head()->links()[level_ - 1] == head())
+            --level_;
+        --size_;
+    }
+
+    template<typename V>
+    Res insertAux(V&& val) {
+        Node* preds[MAX_HEIGHT];
+        auto y = findPreds(val, preds);
+        if (y != head() && !cmp_(val, y->val))
+            return Res(iterator(y), false);
+
+        auto node = createNode(randomHeight(), STL_FORWARD(V, val));
+        link(node, preds);
+        return Res(iterator(node), true);
+    }
+
+    void initTails(Node** tails) const ZSTL_NOEXCEPT {
+        for (std::size_t i = 0; i != MAX_HEIGHT; ++i) {
+            tails[i] = head();
+        }
+    }
+
+    // append node after all nodes, tails are the last nodes of each level
+    void append(Node* node, Node** tails) ZSTL_NOEXCEPT {
+        for (std::size_t i = 0; i != node->height; ++i) {
+            node->links()[i] = head();
+            tails[i]->links()[i] = node;
+            tails[i] = node;
+        }
+        node->prev = head()->prev;
+        head()->prev = node;
+        if (level_ < node->height)
+            level_ = node->height;
+        ++size_;
+    }
+
+    // take the nodes of rhs, this must be empty
+    void steal(SkipList& rhs) ZSTL_NOEXCEPT {
+        alloc_ = STL_MOVE(rhs.alloc_);
+        if (rhs.empty())
+            return;
+
+        auto h = head();
+        auto rh = rhs.head();
+        h->prev = rh->prev;
+        for (std::size_t i = 0; i != rhs.level_; ++i) {
+            h->links()[i] = rh->links()[i];
+        }
+        first()->prev = h;
+
+        // the last node of level i is found from the last one of level i + 1
+        auto x = h;
+        for (auto i = rhs.level_; i-- != 0; ) {
+            while (x->links()[i] != rh)
+                x = x->links()[i];
+            x->links()[i] = h;
+        }
+
+        level_ = rhs.level_;
+        size_ = rhs.size_;
+        rhs.reset();
+    }
+
+    Unit head_[units(MAX_HEIGHT)];
+    std::size_t level_;
+    std::size_t size_;
+    UnitAllocator alloc_;
+    Compare cmp_;
+    uint64_t seed_ = 0x9E3779B97F4A7C15ULL;
+};
+
+template<typename T, typename CP, typename Alloc>
+inline void swap(SkipList<T, CP, Alloc>& x, SkipList<T, CP, Alloc>& y) ZSTL_NOEXCEPT
+{ x.swap(y); }
+
+template<typename T, typename CP, typename Alloc>
+bool operator==(SkipList<T, CP, Alloc> const& x, SkipList<T, CP, Alloc> const& y) {
+    return x.size() == y.size() && zstl::equal(x.begin(), x.end(), y.begin());
+}
+
+template<typename T, typename CP, typename Alloc>
+bool operator!=(SkipList<T, CP, Alloc> const& x, SkipList<T, CP, Alloc> const& y)
+{ return !(x == y); }
+
+template<typename T, typename CP, typename Alloc>
+bool operator<(SkipList<T, CP, Alloc> const& x, SkipList<T, CP, Alloc> const& y) {
+    return zstl::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
+} // namespace zstl
+
+#endif // ZSTL_SKIPLIST_H
@@ -34,6 +34,9 @@ namespace zstl {
 #include "algo/reverse.h"
 #include "algo/rotate.h"
 
+// Sorting operations
+#include "algo/sort.h"
+
 // Binary Search operation
 // (on sorted sequence)
 #include "algo/binary_search.h"
@@ -0,0 +1,1130 @@
+#ifndef ZSTL_STL_BTREE_H
+#define ZSTL_STL_BTREE_H
+
+#include "allocator.h"
+#include "config.h"
+#include "stl_construct.h"
+#include "stl_exception.h"
+#include "stl_iterator.h"
+#include "stl_move.h"
+#include "utility.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace zstl {
+
+/**
+ * The common header of leaf and inner node.
+ * @note count is the number of values in leaf,
+ * and the number of separator keys in inner node
+ */
+struct BTreeNodeBase {
+    bool leaf;
+    uint16_t count;
+};
+
+namespace detail {
+
+/**
+ * @brief the type relocated in leaf
+ * @note
+ * pair<K const, T> is relocated as pair<K, T>, otherwise moving it copies the key,
+ * which may throw and leave a hole in the node.
+ * They have the same layout, the const one is only exposed to user.
+ */
+template<typename V>
+struct BTreeSlot {
+    using type = V;
+};
+
+template<typename K, typename T>
+struct BTreeSlot<zstl::pair<K const, T>> {
+    using type = zstl::pair<K, T>;
+};
+
+} // namespace detail
+
+/**
+ * @class BTreeLeaf
+ * @brief leaf holds the values, the leaves are doubly linked in key order
+ */
+template<typename V, size_t N>
+struct BTreeLeaf : BTreeNodeBase {
+    using Slot = typename detail::BTreeSlot<V>::type;
+
+    BTreeLeaf* prev;
+    BTreeLeaf* next;
+    // only [0, count) are constructed
+    alignas(V) unsigned char storage[N * sizeof(V)];
+
+    V* values() ZSTL_NOEXCEPT
+    { return reinterpret_cast<V*>(storage); }
+
+    V const* values() const ZSTL_NOEXCEPT
+    { return reinterpret_cast<V const*>(storage); }
+
+    // the values viewed as relocatable slots
+    Slot* slots() ZSTL_NOEXCEPT
+    { return reinterpret_cast<Slot*>(storage); }
+};
+
+/**
+ * @class BTreeInner
+ * @brief
+ * Inner node holds copies of keys separating its children,
+ * all keys in children[i] are in [keys[i-1], keys[i]).
+ */
+template<typename K, size_t N>
+struct BTreeInner : BTreeNodeBase {
+    BTreeNodeBase* children[N + 1];
+    alignas(K) unsigned char storage[N * sizeof(K)];
+
+    K* keys() ZSTL_NOEXCEPT
+    { return reinterpret_cast<K*>(storage); }
+
+    K const* keys() const ZSTL_NOEXCEPT
+    { return reinterpret_cast<K const*>(storage); }
+};
+
+namespace detail {
+
+constexpr size_t btreeSlots(size_t bytes, size_t elem) noexcept
+{ return bytes / elem < 4 ? 4 : (bytes / elem > 0xfff0 ? 0xfff0 : bytes / elem); }
+
+// move-construct *dst from *src, then destroy *src
+template<typename T>
+inline void btreeRelocate(T* dst, T* src) {
+    zstl::construct(dst, STL_MOVE(*src));
+    zstl::destroy(src);
+}
+
+// make arr[pos] be raw by moving [pos, count) one slot right
+template<typename T>
+inline void btreeShiftRight(T* arr, size_t pos, size_t count) {
+    for (size_t i = count; i > pos; --i) {
+        btreeRelocate(arr + i, arr + i - 1);
+    }
+}
+
+// fill the raw arr[pos] by moving (pos, count) one slot left
+template<typename T>
+inline void btreeShiftLeft(T* arr, size_t pos, size_t count) {
+    for (size_t i = pos; i + 1 < count; ++i) {
+        btreeRelocate(arr + i, arr + i + 1);
+    }
+}
+
+} // namespace detail
+
+/**
+ * @class BTreeIterator
+ * @brief position in leaf, end() is the past-the-end position of the last leaf
+ * @note any insertion or erasure invalidates all iterators
+ */
+template<typename V, typename Ref, typename Ptr, typename Leaf>
+struct BTreeIterator {
+    using value_type        = V;
+    using reference         = Ref;
+    using pointer           = Ptr;
+    using difference_type   = std::ptrdiff_t;
+    using iterator_category = Bidirectional_iterator_tag;
+    using Self              = BTreeIterator;
+    using iterator          = BTreeIterator<V, V&, V*, Leaf>;
+
+    BTreeIterator() = default;
+
+    BTreeIterator(Leaf* leaf, size_t pos) ZSTL_NOEXCEPT
+        : leaf_{ leaf }, pos_{ pos }
+    { }
+
+    // iterator => const_iterator, a template so that it is not the copy constructor
+    template<typename It, typename = Enable_if_t<
+        Is_same<It, iterator>::value && !Is_same<It, Self>::value>>
+    BTreeIterator(It const& iter) ZSTL_NOEXCEPT
+        : leaf_{ iter.leaf_ }, pos_{ iter.pos_ }
+    { }
+
+    reference operator*() const ZSTL_NOEXCEPT
+    { return leaf_->values()[pos_]; }
+
+    pointer operator->() const ZSTL_NOEXCEPT
+    { return &leaf_->values()[pos_]; }
+
+    Self& operator++() ZSTL_NOEXCEPT {
+        if (++pos_ == leaf_->count && leaf_->next) {
+            leaf_ = leaf_->next;
+            pos_ = 0;
+        }
+        return *this;
+    }
+
+    Self operator++(int) ZSTL_NOEXCEPT {
+        auto ret = *this;
+        ++*this;
+        return ret;
+    }
+
+    Self& operator--() ZSTL_NOEXCEPT {
+        if (pos_ == 0) {
+            leaf_ = leaf_->prev;
+            pos_ = leaf_->count;
+        }
+        --pos_;
+        return *this;
+    }
+
+    Self operator--(int) ZSTL_NOEXCEPT {
+        auto ret = *this;
+        --*this;
+        return ret;
+    }
+
+    friend bool operator==(Self const& x, Self const& y) ZSTL_NOEXCEPT
+    { return x.leaf_ == y.leaf_ && x.pos_ == y.pos_; }
+
+    friend bool operator!=(Self const& x, Self const& y) ZSTL_NOEXCEPT
+    { return !(x == y); }
+
+    iterator ConstCast() const ZSTL_NOEXCEPT
+    { return iterator(leaf_, pos_); }
+
+    Leaf* leaf_ = nullptr;
+    size_t pos_ = 0;
+};
+
+/**
+ * @class BTree
+ * @tparam K key type
+ * @tparam V value type
+ * @tparam GK get key from value
+ * @tparam Compare key comparator
+ * @tparam Alloc allocator of value(rebound to node)
+ * @tparam NODE_BYTES the size of values(keys and children) in one node
+ * @brief
+ * B+-tree with unique keys, the engine of BTreeSet and BTreeMap.
+ * A leaf stores NODE_BYTES / sizeof(V) values contiguously
+ * instead of one value per RBTree node with three pointers,
+ * so a lookup touches about log_B(n) nodes and scanning is
+ * sequential in memory.
+ * In-node search is branchless binary search.
+ * @note
+ * Values are relocated in the tree by insertion and erasure,
+ * so every iterator is invalidated by them,
+ * and K and V(without the const of key) must be nothrow move constructible.
+ */
+template<typename K, typename V, typename GK, typename Compare, typename Alloc,
+    size_t NODE_BYTES = 256>
+class BTree {
+    static_assert(Is_nothrow_move_constructible<K>::value &&
+        Is_nothrow_move_constructible<typename detail::BTreeSlot<V>::type>::value,
+        "BTree relocates keys and values, their move constructor must be noexcept");
+
+public:
+    static constexpr size_t LEAF_SLOTS = detail::btreeSlots(NODE_BYTES, sizeof(V));
+    static constexpr size_t INNER_SLOTS = detail::btreeSlots(NODE_BYTES, sizeof(K) + sizeof(void*));
+
+private:
+    // the split of a full inner node leaves (INNER_SLOTS - 1) / 2 keys at least,
+    // leaves under LEAF_MIN are only made by the split biased to sorted input
+    static constexpr size_t LEAF_MIN = LEAF_SLOTS / 2;
+    static constexpr size_t INNER_MIN = (INNER_SLOTS - 1) / 2;
+    // every inner node has 2 children at least
+    static constexpr int MAX_HEIGHT = 64;
+
+    using Leaf = BTreeLeaf<V, LEAF_SLOTS>;
+    using Inner = BTreeInner<K, INNER_SLOTS>;
+    using Node = BTreeNodeBase;
+    using LeafAllocator = typename Alloc::template rebind<Leaf>;
+    using InnerAllocator = typename Alloc::template rebind<Inner>;
+    using LeafAllocTraits = allocator_traits<LeafAllocator>;
+    using InnerAllocTraits = allocator_traits<InnerAllocator>;
+
+    // the inner nodes from root to the parent of leaf and the child index in them
+    struct Path {
+        Inner* nodes[MAX_HEIGHT];
+        size_t index[MAX_HEIGHT];
+        int depth = 0;
+    };
+
+public:
+    using key_type        = K;
+    using value_type      = V;
+    using key_compare     = Compare;
+    using size_type       = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = V&;
+    using const_reference = V const&;
+    using pointer         = V*;
+    using const_pointer   = V const*;
+    using allocator_type  = Alloc;
+    using iterator        = BTreeIterator<V, V&, V*, Leaf>;
+    using const_iterator  = BTreeIterator<V, V const&, V const*, Leaf>;
+    using reverse_iterator       = zstl::reverse_iterator<iterator>;
+    using const_reverse_iterator = zstl::reverse_iterator<const_iterator>;
+
+    BTree() = default;
+
+    explicit BTree(Compare const& cmp)
+        : compare_(cmp)
+    { }
+
+    BTree(BTree const& other)
+        : compare_(other.compare_)
+    {
+        if (other.root_) {
+            Leaf* last = nullptr;
+            STL_TRY {
+                root_ = cloneNode(other.root_, last);
+            } CATCH_ALL {
+                // the leaves cloned are linked even if the clone is incomplete
+                freeLeaves(last);
+                RETHROW
+            }
+            rightmost_ = last;
+            height_ = other.height_;
+            size_ = other.size_;
+        }
+    }
+
+    BTree(BTree&& other) ZSTL_NOEXCEPT
+        : compare_(other.compare_)
+    { swap(other); }
+
+    BTree& operator=(BTree const& other) {
+        if (this != &other) {
+            BTree tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    BTree& operator=(BTree&& other) ZSTL_NOEXCEPT {
+        clear();
+        swap(other);
+        return *this;
+    }
+
+    ~BTree() ZSTL_NOEXCEPT
+    { clear(); }
+
+    void swap(BTree& other) ZSTL_NOEXCEPT {
+        zstl::swap(compare_, other.compare_);
+        zstl::swap(root_, other.root_);
+        zstl::swap(leftmost_, other.leftmost_);
+        zstl::swap(rightmost_, other.rightmost_);
+        zstl::swap(size_, other.size_);
+        zstl::swap(height_, other.height_);
+    }
+
+    // iterators
+    iterator begin() ZSTL_NOEXCEPT
+    { return iterator(leftmost_, 0); }
+
+    const_iterator begin() const ZSTL_NOEXCEPT
+    { return const_iterator(leftmost_, 0); }
+
+    iterator end() ZSTL_NOEXCEPT
+    { return iterator(rightmost_, rightmost_ ? rightmost_->count : 0); }
+
+    const_iterator end() const ZSTL_NOEXCEPT
+    { return const_iterator(rightmost_, rightmost_ ? rightmost_->count : 0); }
+
+    const_iterator cbegin() const ZSTL_NOEXCEPT
+    { return begin(); }
+
+    const_iterator cend() const ZSTL_NOEXCEPT
+    { return end(); }
+
+    reverse_iterator rbegin() ZSTL_NOEXCEPT
+    { return reverse_iterator(end()); }
+
+    const_reverse_iterator rbegin() const ZSTL_NOEXCEPT
+    { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend() ZSTL_NOEXCEPT
+    { return reverse_iterator(begin()); }
+
+    const_reverse_iterator rend() const ZSTL_NOEXCEPT
+    { return const_reverse_iterator(begin()); }
+
+    // capacity
+    size_type size() const ZSTL_NOEXCEPT
+    { return size_; }
+
+    bool empty() const ZSTL_NOEXCEPT
+    { return size_ == 0; }
+
+    // the number of levels, 0 if empty
+    int height() const ZSTL_NOEXCEPT
+    { return height_; }
+
+    key_compare key_comp() const
+    { return compare_; }
+
+    // insert
+    /**
+     * @brief construct value from @p args only if @p key is not in tree
+     * @param key the key of the value constructed from args
+     */
+    template<typename... Args>
+    pair<iterator, bool> TryEmplaceUnique(key_type const& key, Args&&... args) {
+        if (!root_) {
+            return zstl::make_pair(emplaceFirst(STL_FORWARD(Args, args)...), true);
+        }
+
+        Path path;
+        auto leaf = descend(key, path);
+        auto pos = leafLowerBound(leaf, key);
+
+        if (pos != leaf->count && !compare_(key, keyOf(leaf->values()[pos]))) {
+            return zstl::make_pair(iterator(leaf, pos), false);
+        }
+
+        return zstl::make_pair(
+            insertAt(path, leaf, pos, STL_FORWARD(Args, args)...), true);
+    }
+
+    template<typename Arg>
+    pair<iterator, bool> InsertUnique(Arg&& arg)
+    { return TryEmplaceUnique(keyOf(arg), STL_FORWARD(Arg, arg)); }
+
+    template<typename... Args>
+    pair<iterator, bool> EmplaceUnique(Args&&... args) {
+        // the key is in the value, so construct it first
+        V value(STL_FORWARD(Args, args)...);
+        return TryEmplaceUnique(keyOf(value), STL_MOVE(value));
+    }
+
+    template<typename II>
+    void InsertUnique(II first, II last) {
+        for (; first != last; ++first) {
+            InsertUnique(*first);
+        }
+    }
+
+    // erase
+    size_type EraseUnique(key_type const& key) {
+        if (!root_) {
+            return 0;
+        }
+
+        Path path;
+        auto leaf = descend(key, path);
+        auto pos = leafLowerBound(leaf, key);
+
+        if (pos == leaf->count || compare_(key, keyOf(leaf->values()[pos]))) {
+            return 0;
+        }
+
+        eraseAt(path, leaf, pos);
+        return 1;
+    }
+
+    // @return the iterator following the erased element
+    iterator erase(const_iterator pos) {
+        Path path;
+        // locate the path of leaf by the key of pos
+        auto leaf = descend(keyOf(*pos), path);
+        assert(leaf == pos.leaf_);
+        return eraseAt(path, leaf, pos.pos_);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        if (first == begin() && last == end()) {
+            clear();
+            return end();
+        }
+
+        // erase() relocates elements, so count them before
+        size_type n = 0;
+        for (auto iter = first; iter != last; ++iter) {
+            ++n;
+        }
+
+        auto iter = first.ConstCast();
+        while (n-- != 0) {
+            iter = erase(iter);
+        }
+        return iter;
+    }
+
+    void clear() ZSTL_NOEXCEPT {
+        if (root_) {
+            freeNode(root_);
+        }
+        root_ = nullptr;
+        leftmost_ = rightmost_ = nullptr;
+        size_ = 0;
+        height_ = 0;
+    }
+
+    // lookup
+    iterator find(key_type const& key)
+    { return findAux(key).ConstCast(); }
+
+    const_iterator find(key_type const& key) const
+    { return findAux(key); }
+
+    bool contains(key_type const& key) const
+    { return findAux(key) != end(); }
+
+    iterator lower_bound(key_type const& key)
+    { return lowerBoundAux(key).ConstCast(); }
+
+    const_iterator lower_bound(key_type const& key) const
+    { return lowerBoundAux(key); }
+
+    iterator upper_bound(key_type const& key)
+    { return upperBoundAux(key).ConstCast(); }
+
+    const_iterator upper_bound(key_type const& key) const
+    { return upperBoundAux(key); }
+
+    pair<iterator, iterator> equal_range(key_type const& key) {
+        auto first = lower_bound(key);
+        auto last = first;
+        if (last != end() && !compare_(key, keyOf(*last))) {
+            ++last;
+        }
+        return zstl::make_pair(first, last);
+    }
+
+    pair<const_iterator, const_iterator> equal_range(key_type const& key) const {
+        auto first = lower_bound(key);
+        auto last = first;
+        if (last != end() && !compare_(key, keyOf(*last))) {
+            ++last;
+        }
+        return zstl::make_pair(first, last);
+    }
+
+    /**
+     * @brief the bytes of nodes allocated
+     * @note O(n / B), for statistics only
+     */
+    size_type memoryBytes() const ZSTL_NOEXCEPT
+    { return root_ ? nodeBytes(root_) : 0; }
+
+#ifdef BTREE_DEBUG
+    // check the order, fill and links of nodes
+    bool verify() const;
+#endif
+
+private:
+    static key_type const& keyOf(V const& value)
+    { return GK()(value); }
+
+    // the number of elements less than key
+    size_type leafLowerBound(Leaf const* leaf, key_type const& key) const {
+        auto base = leaf->values();
+        size_type len = leaf->count;
+        while (len > 1) {
+            const auto half = len / 2;
+            base = compare_(keyOf(base[half - 1]), key) ? base + half : base;
+            len -= half;
+        }
+        return (base - leaf->values()) + (len == 1 && compare_(keyOf(*base), key));
+    }
+
+    // the number of elements not greater than key
+    size_type leafUpperBound(Leaf const* leaf, key_type const& key) const {
+        auto base = leaf->values();
+        size_type len = leaf->count;
+        while (len > 1) {
+            const auto half = len / 2;
+            base = !compare_(key, keyOf(base[half - 1])) ? base + half : base;
+            len -= half;
+        }
+        return (base - leaf->values()) + (len == 1 && !compare_(key, keyOf(*base)));
+    }
+
+    // the child may contain key
+    size_type childIndex(Inner const* inner, key_type const& key) const {
+        auto keys = inner->keys();
+        auto base = keys;
+        size_type len = inner->count;
+        while (len > 1) {
+            const auto half = len / 2;
+            base = !compare_(key, base[half - 1]) ? base + half : base;
+            len -= half;
+        }
+        return (base - keys) + (len == 1 && !compare_(key, *base));
+    }
+
+    Leaf* descend(key_type const& key) const {
+        auto node = root_;
+        while (!node->leaf) {
+            auto inner = static_cast<Inner*>(node);
+            node = inner->children[childIndex(inner, key)];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    Leaf* descend(key_type const& key, Path& path) const {
+        auto node = root_;
+        path.depth = 0;
+        while (!node->leaf) {
+            auto inner = static_cast<Inner*>(node);
+            const auto i = childIndex(inner, key);
+            path.nodes[path.depth] = inner;
+            path.index[path.depth] = i;
+            ++path.depth;
+            node = inner->children[i];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    // pos may be past the end of a leaf which is not the last
+    const_iterator normalize(Leaf* leaf, size_type pos) const ZSTL_NOEXCEPT {
+        if (pos == leaf->count && leaf->next) {
+            return const_iterator(leaf->next, 0);
+        }
+        return const_iterator(leaf, pos);
+    }
+
+    const_iterator findAux(key_type const& key) const {
+        if (!root_) {
+            return end();
+        }
+        auto leaf = descend(key);
+        auto pos = leafLowerBound(leaf, key);
+        if (pos == leaf->count || compare_(key, keyOf(leaf->values()[pos]))) {
+            return end();
+        }
+        return const_iterator(leaf, pos);
+    }
+
+    const_iterator lowerBoundAux(key_type const& key) const {
+        if (!root_) {
+            return end();
+        }
+        auto leaf = descend(key);
+        return normalize(leaf, leafLowerBound(leaf, key));
+    }
+
+    const_iterator upperBoundAux(key_type const& key) const {
+        if (!root_) {
+            return end();
+        }
+        auto leaf = descend(key);
+        return normalize(leaf, leafUpperBound(leaf, key));
+    }
+
+    // node management
+    Leaf* newLeaf() {
+        auto leaf = LeafAllocTraits::allocate(leafAlloc_);
+        leaf->leaf = true;
+        leaf->count = 0;
+        leaf->prev = leaf->next = nullptr;
+        return leaf;
+    }
+
+    Inner* newInner() {
+        auto inner = InnerAllocTraits::allocate(innerAlloc_);
+        inner->leaf = false;
+        inner->count = 0;
+        return inner;
+    }
+
+    void dropLeaf(Leaf* leaf) ZSTL_NOEXCEPT
+    { LeafAllocTraits::deallocate(leafAlloc_, leaf); }
+
+    void dropInner(Inner* inner) ZSTL_NOEXCEPT
+    { InnerAllocTraits::deallocate(innerAlloc_, inner); }
+
+    void freeNode(Node* node) ZSTL_NOEXCEPT {
+        if (node->leaf) {
+            auto leaf = static_cast<Leaf*>(node);
+            zstl::destroy(leaf->values(), leaf->values() + leaf->count);
+            dropLeaf(leaf);
+        } else {
+            auto inner = static_cast<Inner*>(node);
+            for (size_type i = 0; i <= inner->count; ++i) {
+                freeNode(inner->children[i]);
+            }
+            zstl::destroy(inner->keys(), inner->keys() + inner->count);
+            dropInner(inner);
+        }
+    }
+
+    // free the leaves linked before last(included), used by failed clone
+    void freeLeaves(Leaf* last) ZSTL_NOEXCEPT {
+        while (last) {
+            auto prev = last->prev;
+            zstl::destroy(last->values(), last->values() + last->count);
+            dropLeaf(last);
+            last = prev;
+        }
+        root_ = nullptr;
+        leftmost_ = nullptr;
+    }
+
+    // @param last the last leaf cloned, the leaves of clone are linked after it
+    Node* cloneNode(Node const* node, Leaf*& last) {
+        if (node->leaf) {
+            auto src = static_cast<Leaf const*>(node);
+            auto leaf = newLeaf();
+            leaf->prev = last;
+            if (last) {
+                last->next = leaf;
+            } else {
+                leftmost_ = leaf;
+            }
+            last = leaf;
+
+            for (; leaf->count != src->count; ++leaf->count) {
+                zstl::construct(leaf->values() + leaf->count, src->values()[leaf->count]);
+            }
+            return leaf;
+        }
+
+        auto src = static_cast<Inner const*>(node);
+        auto inner = newInner();
+        size_type assigned = 0;
+        STL_TRY {
+            for (size_type i = 0; i <= src->count; ++i) {
+                inner->children[i] = cloneNode(src->children[i], last);
+                ++assigned;
+                if (i != src->count) {
+                    zstl::construct(inner->keys() + i, src->keys()[i]);
+                    ++inner->count;
+                }
+            }
+        } CATCH_ALL {
+            // the leaves are freed by freeLeaves() through the links
+            for (size_type i = 0; i != assigned; ++i) {
+                if (!inner->children[i]->leaf) {
+                    freeInners(static_cast<Inner*>(inner->children[i]));
+                }
+            }
+            zstl::destroy(inner->keys(), inner->keys() + inner->count);
+            dropInner(inner);
+            RETHROW
+        }
+        return inner;
+    }
+
+    // free the inner nodes of a subtree, but not the leaves
+    void freeInners(Inner* inner) ZSTL_NOEXCEPT {
+        for (size_type i = 0; i <= inner->count; ++i) {
+            if (!inner->children[i]->leaf) {
+                freeInners(static_cast<Inner*>(inner->children[i]));
+            }
+        }
+        zstl::destroy(inner->keys(), inner->keys() + inner->count);
+        dropInner(inner);
+    }
+
+    size_type nodeBytes(Node const* node) const ZSTL_NOEXCEPT {
+        if (node->leaf) {
+            return sizeof(Leaf);
+        }
+        auto inner = static_cast<Inner const*>(node);
+        size_type bytes = sizeof(Inner);
+        for (size_type i = 0; i <= inner->count; ++i) {
+            bytes += nodeBytes(inner->children[i]);
+        }
+        return bytes;
+    }
+
+    template<typename... Args>
+    iterator emplaceFirst(Args&&... args) {
+        auto leaf = newLeaf();
+        STL_TRY {
+            zstl::construct(leaf->values(), STL_FORWARD(Args, args)...);
+        } CATCH_ALL {
+            dropLeaf(leaf);
+            RETHROW
+        }
+        leaf->count = 1;
+        root_ = leftmost_ = rightmost_ = leaf;
+        height_ = 1;
+        size_ = 1;
+        return iterator(leaf, 0);
+    }
+
+    /**
+     * @brief insert the value constructed from args at pos of leaf
+     * @note split the full leaf first, so that the tree is valid
+     * even if the constructor throws
+     */
+    template<typename... Args>
+    iterator insertAt(Path& path, Leaf* leaf, size_type pos, Args&&... args) {
+        if (leaf->count == LEAF_SLOTS) {
+            auto right = splitLeaf(path, leaf, pos);
+            if (pos > leaf->count) {
+                pos -= leaf->count;
+                leaf = right;
+            }
+        }
+
+        detail::btreeShiftRight(leaf->slots(), pos, leaf->count);
+        STL_TRY {
+            zstl::construct(leaf->values() + pos, STL_FORWARD(Args, args)...);
+        } CATCH_ALL {
+            detail::btreeShiftLeft(leaf->slots(), pos, leaf->count + 1);
+            RETHROW
+        }
+
+        ++leaf->count;
+        ++size_;
+        return iterator(leaf, pos);
+    }
+
+    /**
+     * @brief move the upper part of the full leaf to a new leaf
+     * @param pos where the new value will be inserted,
+     * appending to the last leaf(or prepending to the first leaf)
+     * leaves it almost full, so sorted input fills the leaves
+     */
+    Leaf* splitLeaf(Path& path, Leaf* leaf, size_type pos) {
+        size_type moved = LEAF_SLOTS / 2;
+        if (pos == LEAF_SLOTS && leaf == rightmost_) {
+            moved = 1;
+        } else if (pos == 0 && leaf == leftmost_) {
+            moved = LEAF_SLOTS - 1;
+        }
+
+        auto right = newLeaf();
+        const auto keep = LEAF_SLOTS - moved;
+        STL_TRY {
+            insertParent(path, path.depth, leaf, keyOf(leaf->values()[keep]), right);
+        } CATCH_ALL {
+            dropLeaf(right);
+            RETHROW
+        }
+
+        for (size_type i = 0; i != moved; ++i) {
+            detail::btreeRelocate(right->slots() + i, leaf->slots() + keep + i);
+        }
+        right->count = static_cast<uint16_t>(moved);
+        leaf->count = static_cast<uint16_t>(keep);
+
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next) {
+            leaf->next->prev = right;
+        } else {
+            rightmost_ = right;
+        }
+        leaf->next = right;
+        return right;
+    }
+
+    /**
+     * @brief insert separator @p key and @p right as the sibling following @p left
+     * @param depth the level of left in path(the parent is path.nodes[depth - 1])
+     */
+    void insertParent(Path& path, int depth, Node* left, key_type const& key, Node* right) {
+        if (depth == 0) {
+            // left is root
+            auto root = newInner();
+            zstl::construct(root->keys(), key);
+            root->count = 1;
+            root->children[0] = left;
+            root->children[1] = right;
+            root_ = root;
+            ++height_;
+            return;
+        }
+
+        // split the full parent first, then insert into the half containing left
+        if (path.nodes[depth - 1]->count == INNER_SLOTS) {
+            splitInner(path, depth - 1);
+        }
+
+        auto parent = path.nodes[depth - 1];
+        const auto idx = path.index[depth - 1];
+        auto keys = parent->keys();
+        detail::btreeShiftRight(keys, idx, parent->count);
+        STL_TRY {
+            zstl::construct(keys + idx, key);
+        } CATCH_ALL {
+            detail::btreeShiftLeft(keys, idx, parent->count + 1);
+            RETHROW
+        }
+
+        for (size_type j = parent->count + 1; j > idx + 1; --j) {
+            parent->children[j] = parent->children[j - 1];
+        }
+        parent->children[idx + 1] = right;
+        ++parent->count;
+    }
+
+    /**
+     * @brief split the full inner node path.nodes[depth],
+     * and update the path to the half containing the child in path
+     */
+    void splitInner(Path& path, int depth) {
+        auto inner = path.nodes[depth];
+        const auto mid = INNER_SLOTS / 2;
+        auto right = newInner();
+
+        STL_TRY {
+            insertParent(path, depth, inner, inner->keys()[mid], right);
+        } CATCH_ALL {
+            dropInner(right);
+            RETHROW
+        }
+
+        // right takes keys (mid, count) and children (mid, count]
+        const auto moved = inner->count - mid - 1;
+        for (size_type j = 0; j != moved; ++j) {
+            detail::btreeRelocate(right->keys() + j, inner->keys() + mid + 1 + j);
+        }
+        for (size_type j = 0; j <= moved; ++j) {
+            right->children[j] = inner->children[mid + 1 + j];
+        }
+        zstl::destroy(inner->keys() + mid);
+        right->count = static_cast<uint16_t>(moved);
+        inner->count = static_cast<uint16_t>(mid);
+
+        if (path.index[depth] > mid) {
+            path.nodes[depth] = right;
+            path.index[depth] -= mid + 1;
+            // the parent of right follows the parent of inner
+            if (depth > 0) {
+                ++path.index[depth - 1];
+            }
+        }
+    }
+
+    /**
+     * @brief erase the value at pos of leaf, then fix the underflow
+     * @return the iterator following the erased value
+     */
+    iterator eraseAt(Path& path, Leaf* leaf, size_type pos) {
+        zstl::destroy(leaf->values() + pos);
+        detail::btreeShiftLeft(leaf->slots(), pos, leaf->count);
+        --leaf->count;
+        --size_;
+
+        if (path.depth == 0) {
+            if (leaf->count == 0) {
+                dropLeaf(leaf);
+                root_ = nullptr;
+                leftmost_ = rightmost_ = nullptr;
+                height_ = 0;
+                return end();
+            }
+            return iterator(leaf, pos);
+        }
+
+        if (leaf->count < LEAF_MIN) {
+            fixLeaf(path, leaf, pos);
+        }
+        return normalize(leaf, pos).ConstCast();
+    }
+
+    // borrow from or merge with a sibling, leaf and pos are updated to the next value
+    void fixLeaf(Path& path, Leaf*& leaf, size_type& pos) {
+        auto parent = path.nodes[path.depth - 1];
+        const auto i = path.index[path.depth - 1];
+        auto left = i > 0 ? static_cast<Leaf*>(parent->children[i - 1]) : nullptr;
+        auto right = i < parent->count ? static_cast<Leaf*>(parent->children[i + 1]) : nullptr;
+
+        if (left && left->count > LEAF_MIN) {
+            detail::btreeShiftRight(leaf->slots(), 0, leaf->count);
+            detail::btreeRelocate(leaf->slots(), left->slots() + left->count - 1);
+            --left->count;
+            ++leaf->count;
+            parent->keys()[i - 1] = keyOf(leaf->values()[0]);
+            ++pos;
+        } else if (right && right->count > LEAF_MIN) {
+            detail::btreeRelocate(leaf->slots() + leaf->count, right->slots());
+            detail::btreeShiftLeft(right->slots(), 0, right->count);
+            --right->count;
+            ++leaf->count;
+            parent->keys()[i] = keyOf(right->values()[0]);
+        } else if (left) {
+            pos += left->count;
+            mergeLeaf(left, leaf);
+            leaf = left;
+            zstl::destroy(parent->keys() + i - 1);
+            eraseKey(path, path.depth - 1, i - 1);
+        } else if (right) {
+            mergeLeaf(leaf, right);
+            zstl::destroy(parent->keys() + i);
+            eraseKey(path, path.depth - 1, i);
+        }
+    }
+
+    // append right to left, and free right
+    void mergeLeaf(Leaf* left, Leaf* right) ZSTL_NOEXCEPT {
+        for (size_type j = 0; j != right->count; ++j) {
+            detail::btreeRelocate(left->slots() + left->count + j, right->slots() + j);
+        }
+        left->count += right->count;
+
+        left->next = right->next;
+        if (right->next) {
+            right->next->prev = left;
+        } else {
+            rightmost_ = left;
+        }
+        dropLeaf(right);
+    }
+
+    /**
+     * @brief remove the raw keys[k] and children[k + 1] of path.nodes[depth]
+     * whose child has been merged into children[k], then fix the underflow
+     */
+    void eraseKey(Path& path, int depth, size_type k) {
+        auto inner = path.nodes[depth];
+        detail::btreeShiftLeft(inner->keys(), k, inner->count);
+        for (size_type j = k + 1; j != inner->count; ++j) {
+            inner->children[j] = inner->children[j + 1];
+        }
+        --inner->count;
+
+        if (depth == 0) {
+            if (inner->count == 0) {
+                // shrink the root
+                root_ = inner->children[0];
+                dropInner(inner);
+                --height_;
+            }
+            return;
+        }
+
+        if (inner->count < INNER_MIN) {
+            fixInner(path, depth);
+        }
+    }
+
+    void fixInner(Path& path, int depth) {
+        auto inner = path.nodes[depth];
+        auto parent = path.nodes[depth - 1];
+        const auto i = path.index[depth - 1];
+        auto left = i > 0 ? static_cast<Inner*>(parent->children[i - 1]) : nullptr;
+        auto right = i < parent->count ? static_cast<Inner*>(parent->children[i + 1]) : nullptr;
+
+        if (left && left->count > INNER_MIN) {
+            // rotate right through the parent
+            detail::btreeShiftRight(inner->keys(), 0, inner->count);
+            detail::btreeRelocate(inner->keys(), parent->keys() + i - 1);
+            detail::btreeRelocate(parent->keys() + i - 1, left->keys() + left->count - 1);
+            for (size_type j = inner->count + 1; j > 0; --j) {
+                inner->children[j] = inner->children[j - 1];
+            }
+            inner->children[0] = left->children[left->count];
+            --left->count;
+            ++inner->count;
+        } else if (right && right->count > INNER_MIN) {
+            // rotate left through the parent
+            detail::btreeRelocate(inner->keys() + inner->count, parent->keys() + i);
+            detail::btreeRelocate(parent->keys() + i, right->keys());
+            detail::btreeShiftLeft(right->keys(), 0, right->count);
+            inner->children[inner->count + 1] = right->children[0];
+            for (size_type j = 0; j != right->count; ++j) {
+                right->children[j] = right->children[j + 1];
+            }
+            --right->count;
+            ++inner->count;
+        } else if (left) {
+            mergeInner(left, parent->keys() + i - 1, inner);
+            eraseKey(path, depth - 1, i - 1);
+        } else if (right) {
+            mergeInner(inner, parent->keys() + i, right);
+            eraseKey(path, depth - 1, i);
+        }
+    }
+
+    // append the separator and right to left, and free right
+    void mergeInner(Inner* left, key_type* separator, Inner* right) ZSTL_NOEXCEPT {
+        detail::btreeRelocate(left->keys() + left->count, separator);
+        for (size_type j = 0; j != right->count; ++j) {
+            detail::btreeRelocate(left->keys() + left->count + 1 + j, right->keys() + j);
+        }
+        for (size_type j = 0; j <= right->count; ++j) {
+            left->children[left->count + 1 + j] = right->children[j];
+        }
+        left->count += right->count + 1;
+        dropInner(right);
+    }
+
+#ifdef BTREE_DEBUG
+    bool verifyNode(Node const* node, int level, key_type const* lo, key_type const* hi,
+                    Leaf const*& prev) const;
+#endif
+
+    Node* root_ = nullptr;
+    Leaf* leftmost_ = nullptr;
+    Leaf* rightmost_ = nullptr;
+    size_type size_ = 0;
+    int height_ = 0;
+    Compare compare_;
+    LeafAllocator leafAlloc_;
+    InnerAllocator innerAlloc_;
+};
+
+template<typename K, typename V, typename GK, typename CP, typename Alloc, size_t B>
+constexpr size_t BTree<K, V, GK, CP, Alloc, B>::LEAF_SLOTS;
+
+template<typename K, typename V, typename GK, typename CP, typename Alloc, size_t B>
+constexpr size_t BTree<K, V, GK, CP, Alloc, B>::INNER_SLOTS;
+
+#ifdef BTREE_DEBUG
+template<typename K, typename V, typename GK, typename CP, typename Alloc, size_t B>
+bool BTree<K, V, GK, CP, Alloc, B>::verify() const {
+    if (!root_) {
+        return size_ == 0 && height_ == 0 && !leftmost_ && !rightmost_;
+    }
+
+    Leaf const* prev = nullptr;
+    if (!verifyNode(root_, 1, nullptr, nullptr, prev)) {
+        return false;
+    }
+
+    size_type n = 0;
+    for (auto leaf = leftmost_; leaf; leaf = leaf->next) {
+        n += leaf->count;
+    }
+    return prev == rightmost_ && n == size_;
+}
+
+template<typename K, typename V, typename GK, typename CP, typename Alloc, size_t B>
+bool BTree<K, V, GK, CP, Alloc, B>::verifyNode(
+    Node const* node, int level, key_type const* lo, key_type const* hi,
+    Leaf const*& prev) const {
+    if (node->leaf) {
+        auto leaf = static_cast<Leaf const*>(node);
+        if (level != height_ || leaf->count == 0 || leaf->prev != prev) {
+            return false;
+        }
+        if (prev && prev->next != leaf) {
+            return false;
+        }
+        for (size_type i = 0; i != leaf->count; ++i) {
+            auto const& key = keyOf(leaf->values()[i]);
+            if ((lo && compare_(key, *lo)) || (hi && !compare_(key, *hi))) {
+                return false;
+            }
+            if (i > 0 && !compare_(keyOf(leaf->values()[i - 1]), key)) {
+                return false;
+            }
+        }
+        prev = leaf;
+        return true;
+    }
+
+    auto inner = static_cast<Inner const*>(node);
+    if (inner->count == 0 || (node != root_ && inner->count < INNER_MIN)) {
+        return false;
+    }
+    for (size_type i = 0; i <= inner->count; ++i) {
+        auto clo = i == 0 ? lo : inner->keys() + i - 1;
+        auto chi = i == inner->count ? hi : inner->keys() + i;
+        if (!verifyNode(inner->children[i], level + 1, clo, chi, prev)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+} // namespace zstl
+
+#endif // ZSTL_STL_BTREE_H
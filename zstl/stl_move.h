@@ -63,7 +63,7 @@ namespace zstl{
 	template<typename T>
 	constexpr Conditional_t<move_if_noexcept_cond<T>::value,  
 	T const&, T&&>
-	move_if_noexcept(T&& x) noexcept
+	move_if_noexcept(T& x) noexcept
 	{ return zstl::move(x); }
 
 	// swap
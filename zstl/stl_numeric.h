@@ -15,7 +15,7 @@ namespace zstl {
     constexpr auto accumulate(II first, II last, T init,BinaryOperation binary_op) {
         auto sum=init;
 		for (; first!=last; ++first)
-            sum=binary_op(init, *first);
+            sum=binary_op(sum, *first);
         return sum;
 	}
 
@@ -10,6 +10,7 @@
 #include "config.h"
 #include "noncopyable.h"
 #include "allocator.h"
+#include "pool_allocator.h"
 
 #include <cstddef>
 #include <cstring>
@@ -76,27 +77,93 @@ struct RBTreeBaseNode {
 
 };
 
+/**
+ * @struct RBTreeNoAugment
+ * @brief 
+ * Augment policy of RBTree, which maintains extra field in node
+ * when the subtree of node is changed.
+ * This one maintains nothing, so the hooks are empty and no cost.
+ * An augment policy provides:
+ * (1) NodeBase: base of RBTreeNode, derived from RBTreeBaseNode
+ * (2) Pull(x): recompute the field of x from its children
+ * (3) PullUp(x, root): Pull() from x to root
+ * (4) Rotated(x, y): x is rotated to the child of y
+ * The field may refer to other nodes in the subtree,
+ * so the copy of tree recomputes it by PullUp() instead of copying.
+ */
+struct RBTreeNoAugment {
+	using NodeBase = RBTreeBaseNode;
+
+	static void Pull(RBTreeBaseNode*) noexcept { }
+	static void PullUp(RBTreeBaseNode*, RBTreeBaseNode*) noexcept { }
+	static void Rotated(RBTreeBaseNode*, RBTreeBaseNode*) noexcept { }
+};
+
+/**
+ * @struct RBTreeSizedNode
+ * @brief base node with the size of subtree(include itself)
+ */
+struct RBTreeSizedNode : public RBTreeBaseNode {
+	std::size_t size;
+};
+
+/**
+ * @struct RBTreeSizeAugment
+ * @brief 
+ * Augment policy to maintain subtree size,
+ * which is used for order statistics(rank, select and distance in O(lgn))
+ * @see RBTreeNoAugment
+ */
+struct RBTreeSizeAugment {
+	using NodeBase = RBTreeSizedNode;
+
+	static std::size_t Size(RBTreeBaseNode const* x) noexcept {
+		return x ? static_cast<RBTreeSizedNode const*>(x)->size : 0;
+	}
+
+	static void Pull(RBTreeBaseNode* x) noexcept {
+		static_cast<RBTreeSizedNode*>(x)->size = Size(x->left) + Size(x->right) + 1;
+	}
+
+	// the parent of root is header(not sized) or null(detached)
+	static void PullUp(RBTreeBaseNode* x, RBTreeBaseNode* root) noexcept {
+		for(;;){
+			Pull(x);
+			if(x == root)
+				break;
+			x = x->parent;
+		}
+	}
+
+	// y is the parent of x now, which has all nodes of the old subtree of x
+	static void Rotated(RBTreeBaseNode* x, RBTreeBaseNode* y) noexcept {
+		static_cast<RBTreeSizedNode*>(y)->size = Size(x);
+		Pull(x);
+	}
+};
+
 /**
  * @struct RBTreeNode
  * @tparam Val value type
+ * @tparam Augment augment policy, @see RBTreeNoAugment
  * @brief actual RBTree node type
  */
-template<typename Val>
-struct RBTreeNode : public RBTreeBaseNode{
-	using LinkType = RBTreeNode<Val>*;
-	using ConstLinkType = RBTreeNode<Val> const*;
+template<typename Val, typename Augment = RBTreeNoAugment>
+struct RBTreeNode : public Augment::NodeBase {
+	using LinkType = RBTreeNode*;
+	using ConstLinkType = RBTreeNode const*;
 	
 	LinkType Left() noexcept
-	{ return static_cast<LinkType>(left); }
+	{ return static_cast<LinkType>(this->left); }
 
 	ConstLinkType Left() const noexcept 
-	{ return static_cast<ConstLinkType>(left); }
+	{ return static_cast<ConstLinkType>(this->left); }
 
 	LinkType Right() noexcept 
-	{ return static_cast<LinkType>(right); }
+	{ return static_cast<LinkType>(this->right); }
 
 	ConstLinkType Right() const noexcept 
-	{ return static_cast<ConstLinkType>(right); }
+	{ return static_cast<ConstLinkType>(this->right); }
 
 	Val val;
 };
@@ -116,26 +183,44 @@ struct RBTreeHeader {
 	}
 	
 	RBTreeHeader(RBTreeHeader && other) noexcept{
+		header.color = RBTreeColor::Red;
 		if(other.header.parent != nullptr)
 			MoveData(other);
-		else{
-			header.color = RBTreeColor::Red;
+		else
 			Reset();
-		}
+	}
+
+	/**
+	 * @brief exchange the nodes of two trees
+	 * @note the root links to its header, so it must be relinked
+	 */
+	void Swap(RBTreeHeader& other) noexcept {
+		zstl::swap(header.parent, other.header.parent);
+		zstl::swap(header.left, other.header.left);
+		zstl::swap(header.right, other.header.right);
+		zstl::swap(node_count, other.node_count);
+
+		Relink();
+		other.Relink();
 	}
 
 protected:
 	void MoveData(RBTreeHeader& from){
-		header.color = from.header.color;
 		header.left = from.header.left;
 		header.right = from.header.right;
 		header.parent = from.header.parent; // root
 		header.parent->parent = &header; // reset header
+		node_count = from.node_count;
 
-		// FIXME test if error occur
-		from.header.parent->parent = nullptr;		
+		from.Reset();
+	}
 
-		node_count = from.node_count;
+	// point the root or the empty header to this header
+	void Relink() noexcept {
+		if(header.parent != nullptr)
+			header.parent->parent = &header;
+		else
+			Reset();
 	}
 
 	/**
@@ -163,19 +248,20 @@ RBTreeBaseNode const* RBTreeDecrement(RBTreeBaseNode const* node) noexcept;
 /**
  * @struct RBTreeIterator
  * @tparam T value type
+ * @tparam Augment augment policy of node
  * @note begin() = header.left, end() = header
  */
-template<typename T>
+template<typename T, typename Augment = RBTreeNoAugment>
 struct RBTreeIterator {
 	using value_type = T;
 	using reference = T&;
 	using pointer = T*;
-	using distance_type = std::ptrdiff_t;
-	using iterator_catogory = Bidirectional_iterator_tag;
+	using difference_type = std::ptrdiff_t;
+	using iterator_category = Bidirectional_iterator_tag;
 
 	using BasePtr = RBTreeBaseNode::BasePtr;
-	using LinkType = typename RBTreeNode<T>::LinkType;
-	using ConstLinkType = typename RBTreeNode<T>::ConstLinkType;
+	using LinkType = typename RBTreeNode<T, Augment>::LinkType;
+	using ConstLinkType = typename RBTreeNode<T, Augment>::ConstLinkType;
 
 	using Self = RBTreeIterator;
 
@@ -238,18 +324,19 @@ struct RBTreeIterator {
 /**
  * @struct RBTreeConstIterator
  * @tparam T value type
+ * @tparam Augment augment policy of node
  * @note RBTreeIterator must be able to convert into RBTreeConstIterator
  */
-template<typename T>
+template<typename T, typename Augment = RBTreeNoAugment>
 struct RBTreeConstIterator{
 	using value_type = T;
 	using reference = T const&;
 	using pointer = T const*;
-	using distance_type = std::ptrdiff_t;
-	using iterator_catogory = Bidirectional_iterator_tag;
+	using difference_type = std::ptrdiff_t;
+	using iterator_category = Bidirectional_iterator_tag;
 
 	using BasePtr = RBTreeBaseNode::ConstBasePtr;
-	using LinkType = typename RBTreeNode<T>::ConstLinkType;
+	using LinkType = typename RBTreeNode<T, Augment>::ConstLinkType;
 	using Self = RBTreeConstIterator;
 
 	RBTreeConstIterator()
@@ -259,7 +346,7 @@ struct RBTreeConstIterator{
 		: node_(p)
 	{}
 	
-	RBTreeConstIterator(RBTreeIterator<T> const& iter)
+	RBTreeConstIterator(RBTreeIterator<T, Augment> const& iter)
 		: node_(iter.node_)
 	{}
 	
@@ -267,7 +354,7 @@ struct RBTreeConstIterator{
 		return static_cast<LinkType>(node_);
 	}
 	
-	RBTreeIterator<T> ConstCast() noexcept {
+	RBTreeIterator<T, Augment> ConstCast() noexcept {
 		return const_cast<RBTreeBaseNode*>(node_);
 	}
 
@@ -338,7 +425,10 @@ struct KeyCompare{
  * @param x inserted node
  * @param p parents of x
  * @param header header sentinel pointing to leftmost, rightmost and root
+ * @tparam Augment augment policy to maintain, @see RBTreeNoAugment
+ * @note the algorithms are defined in stl_tree_impl.h, @see RBTREE_INSTANTIATE
  */
+template<typename Augment>
 void RBTreeInsertAndFixup(
 	const bool insert_left,
 	RBTreeBaseNode* x,
@@ -357,6 +447,7 @@ void RBTreeInsertAndFixup(
  * because RBTreeBaseNode destructor is non-virtual
  * @see https://conzxy.github.io/2021/01/26/CLRS/Search-Tree/BlackRedTree/
  */
+template<typename Augment>
 RBTreeBaseNode* 
 RBTreeEraseAndFixup(
 	RBTreeBaseNode* x, 
@@ -383,6 +474,65 @@ inline std::size_t BH(RBTreeBaseNode const* node, RBTreeBaseNode const* root) no
 		return bh + BH(node->parent, root);
 }
 
+/**
+ * @brief the number of black nodes on the path from x to a leaf(include x)
+ * @note null has black height 0
+ */
+int RBTreeBlackHeight(RBTreeBaseNode const* x) noexcept;
+
+/**
+ * @brief join two detached trees with a middle node in O(|left_bh - right_bh| + 1)
+ * @param left detached tree(the parent of root is null) whose elements are before mid
+ * @param left_bh black height of left
+ * @param mid the node placed between left and right
+ * @param right detached tree whose elements are after mid
+ * @param right_bh black height of right
+ * @param bh black height of the joined tree
+ * @return the root of the joined tree, whose parent is null
+ * @pre the roots of left and right are black
+ * @see Tarjan. Data Structures and Network Algorithms, chapter 4
+ */
+template<typename Augment>
+RBTreeBaseNode* RBTreeJoin(
+	RBTreeBaseNode* left,
+	int left_bh,
+	RBTreeBaseNode* mid,
+	RBTreeBaseNode* right,
+	int right_bh,
+	int& bh) noexcept;
+
+/**
+ * @brief join two detached trees in O(lgn),
+ * the minimum of right is removed and used as the middle node
+ * @see RBTreeJoin()
+ */
+template<typename Augment>
+RBTreeBaseNode* RBTreeJoin2(
+	RBTreeBaseNode* left,
+	int left_bh,
+	RBTreeBaseNode* right,
+	int right_bh,
+	int& bh) noexcept;
+
+/**
+ * @brief instantiate the algorithms above for Augment
+ * @note
+ * The definitions are in stl_tree_impl.h, the ones for built-in policies
+ * are instantiated in stl_tree.cc, so other translation units don't.
+ */
+#define RBTREE_INSTANTIATE(Extern, Augment) \
+Extern template void RBTreeInsertAndFixup<Augment>( \
+	const bool, RBTreeBaseNode*, RBTreeBaseNode*, RBTreeBaseNode*) noexcept; \
+Extern template RBTreeBaseNode* RBTreeEraseAndFixup<Augment>( \
+	RBTreeBaseNode*, RBTreeBaseNode*&, RBTreeBaseNode*&, RBTreeBaseNode*&); \
+Extern template RBTreeBaseNode* RBTreeJoin<Augment>( \
+	RBTreeBaseNode*, int, RBTreeBaseNode*, RBTreeBaseNode*, int, int&) noexcept; \
+Extern template RBTreeBaseNode* RBTreeJoin2<Augment>( \
+	RBTreeBaseNode*, int, RBTreeBaseNode*, int, int&) noexcept
+
+RBTREE_INSTANTIATE(extern, RBTreeNoAugment);
+RBTREE_INSTANTIATE(extern, RBTreeSizeAugment);
+
 // For debug
 #ifdef RBTREE_DEBUG
 #define TEST_RB_PROPERTY(rbtree) \
@@ -405,7 +555,8 @@ inline std::size_t BH(RBTreeBaseNode const* node, RBTreeBaseNode const* root) no
  * @tparam Alloc allocator
  */
 template<typename Key, typename Val, typename GetKey, typename Compare,
-	typename Alloc = zstl::allocator<Val>>
+	typename Alloc = zstl::allocator<Val>,
+	typename Augment = RBTreeNoAugment>
 class RBTree {
 public:
 	using key_type = Key;
@@ -421,14 +572,15 @@ public:
 	
 private:
   using get_key = GetKey;
-	using NodeAllocator = typename Alloc::template rebind<RBTreeNode<Val>>;
+	using Node = RBTreeNode<Val, Augment>;
+	using NodeAllocator = typename Alloc::template rebind<Node>;
 	using AllocTraits = allocator_traits<NodeAllocator>;
 
 protected:
 	using BasePtr = RBTreeBaseNode*;
 	using ConstBasePtr = RBTreeBaseNode const*;
-	using LinkType = RBTreeNode<Val>*;
-	using ConstLinkType = RBTreeNode<Val> const*;
+	using LinkType = Node*;
+	using ConstLinkType = Node const*;
 
 public:
 	/**
@@ -586,7 +738,7 @@ protected:
 		}
 		CATCH_ALL
 		{
-			ptr->~RBTreeNode<Val>();
+			ptr->~Node();
 			PutNode(ptr);
 			RETHROW
 		}	
@@ -676,13 +828,14 @@ protected:
 		return impl_.header.right;
 	}
 
-	static const Key
+	// return reference to avoid copying key in each comparison
+	static Key const&
 	_Key(ConstLinkType x) {
 		//TODO: static_assert(Is_invocable_v)
 		return GetKey()(x->val);
 	}
 
-	static const Key
+	static Key const&
 	_Key(ConstBasePtr x) {
 		return GetKey()(static_cast<ConstLinkType>(x)->val);
 	}
@@ -748,8 +901,8 @@ protected:
 	}
 
 public:
-	using iterator = RBTreeIterator<Val>;
-	using const_iterator = RBTreeConstIterator<Val>;
+	using iterator = RBTreeIterator<Val, Augment>;
+	using const_iterator = RBTreeConstIterator<Val, Augment>;
 	using reverse_iterator = zstl::reverse_iterator<iterator>;
 	using const_reverse_iterator = zstl::reverse_iterator<const_iterator>;
 
@@ -782,27 +935,27 @@ public:
 	}
 
 	reverse_iterator rbegin() noexcept {
-		return reverse_iterator(begin());
+		return reverse_iterator(end());
 	}
 
 	const_reverse_iterator rbegin() const noexcept {
-		return const_reverse_iterator(begin());
+		return const_reverse_iterator(end());
 	}
 
 	const_reverse_iterator crbegin() const noexcept {
-		return const_reverse_iterator(cbegin());
+		return const_reverse_iterator(cend());
 	}
 
 	reverse_iterator rend() noexcept {
-		return reverse_iterator(end());
+		return reverse_iterator(begin());
 	}
 
 	const_reverse_iterator rend() const noexcept {
-		return const_reverse_iterator(end());
+		return const_reverse_iterator(begin());
 	}
 
 	const_reverse_iterator crend() const noexcept {
-		return const_reverse_iterator(cend());
+		return const_reverse_iterator(cbegin());
 	}
 	
 	size_type size() const noexcept {
@@ -810,14 +963,11 @@ public:
 	}
 	
 	bool empty() const noexcept {
-		return impl_.node_count
-			&& Header()->left == Header()
-			&& Header()->right == Header()
-			&& Header()->parent == nullptr;
+		return impl_.node_count == 0;
 	}
 
 	void clear() noexcept {
-		Erase(static_cast<LinkType>(Root()));
+		EraseAll();
 		impl_.Reset();
 	}
 
@@ -825,7 +975,7 @@ public:
 	
 	~RBTree(){
 		if(Root())
-			Erase(static_cast<LinkType>(Root()));
+			EraseAll();
 	}
 
 	RBTree(RBTree const& rhs) {
@@ -833,11 +983,10 @@ public:
 		Copy(rhs, policy);
 	}
 	
+	// the header of rhs is reset by RBTreeHeader
 	RBTree(RBTree&& rhs) noexcept
 		: impl_(zstl::move(rhs.impl_))
-	{
-		rhs.Header()->Reset;
-	}
+	{ }
 	
 	RBTree& operator=(RBTree const& rhs){
 		if(this != &rhs){
@@ -850,16 +999,18 @@ public:
 	
 	RBTree& operator=(RBTree&& rhs) noexcept {
 		if(this != &rhs){
-			impl_.impl_ = zstl::move(rhs.impl_);
-			rhs.Header()->Reset();
-
-			return *this;
+			clear();
+			swap(rhs);
 		}
+
+		return *this;
 	}
 
-	void swap(RBTree const& rhs) noexcept {
-		using zstl::swap;
-		swap(this->impl_, rhs.impl_);
+	void swap(RBTree& rhs) noexcept {
+		zstl::swap(impl_.key_compare_, rhs.impl_.key_compare_);
+		// the nodes belong to the pool of stateful allocator
+		zstl::swap(GetNodeAllocator(), rhs.GetNodeAllocator());
+		impl_.Swap(rhs.impl_);
 	}
 
 	///////////////////////////////
@@ -887,40 +1038,65 @@ public:
 
 	template<typename Arg>
 	iterator InsertEqual(Arg&& arg) {
-    auto res = GetInsertUniquePos(GetKey()(arg));
+    auto res = GetInsertEqualPos(GetKey()(arg));
     return InsertAux(STL_FORWARD(Arg, arg), res.first, res.second);
   }
 
+	/**
+	 * @brief insert the elements in [first, last)
+	 * @note
+	 * If the tree is empty and the range is sorted(checked in one pass),
+	 * the tree is built in O(n) by AssignSortedUnique(),
+	 * otherwise the elements are inserted with the hint end(),
+	 * which is O(1) for each element greater than the maximum
+	 */
 	template<
 	typename II, 
 	typename = Enable_if_t<is_input_iterator<II>::value>>
 	void InsertUnique(II first, II last) {
-		for (; first != last; ++first) {
-			InsertUnique(*first);
-		}
+		InsertRange(first, last, true, 
+			typename iterator_traits<II>::iterator_category{});
 	}	
 
 	template<
 	typename II, 
 	typename = Enable_if_t<is_input_iterator<II>::value>>
 	void InsertEqual(II first, II last) {
-		for (; first != last; ++first) {
-			InsertEqual(*first);
-		}
+		InsertRange(first, last, false, 
+			typename iterator_traits<II>::iterator_category{});
 	}	
 
+	/**
+	 * @brief replace the content with the sorted range [first, last) in O(n)
+	 * @note
+	 * The elements are counted first, then the nodes are created in order
+	 * and linked to a perfectly balanced tree in the same pass,
+	 * whose deepest level is red if it is not full.
+	 * For AssignSortedUnique(), only the first one of equal elements is kept.
+	 * The range must be sorted by key_comp(), otherwise the tree is broken.
+	 * If a node throws when it is constructed, the tree is unchanged.
+	 */
+	template<typename FI>
+	void AssignSortedUnique(FI first, FI last) {
+		AssignSorted(first, last, true);
+	}
+
+	template<typename FI>
+	void AssignSortedEqual(FI first, FI last) {
+		AssignSorted(first, last, false);
+	}
+
 	template<typename ...Args>
 	pair<iterator, bool> EmplaceUnique(Args&&... args) {
     auto new_node = CreateNode(STL_FORWARD(Args, args)...);
     
     STL_TRY { 
       auto res = GetInsertUniquePos(_Key(new_node));
-      assert(res.first == nullptr);
       if (res.second) {
-        return make_pair(EmplaceAux(new_node, res.first, res.second), true);
+        return zstl::make_pair(EmplaceAux(new_node, res.first, res.second), true);
       } else {
         DropNode(new_node);
-        return make_pair(iterator(res.first), false);
+        return zstl::make_pair(iterator(res.first), false);
       }
     } CATCH_ALL {
       DropNode(new_node); 
@@ -933,7 +1109,7 @@ public:
     auto new_node = CreateNode(STL_FORWARD(Args, args)...);
 
     STL_TRY {
-      auto res = GetInsertUniquePos(_Key(new_node));
+      auto res = GetInsertEqualPos(_Key(new_node));
       assert(res.first == nullptr);
     
       return EmplaceAux(new_node, res.first, res.second); 
@@ -948,10 +1124,10 @@ public:
     auto res = GetInsertUniqueHintPos(pos, GetKey()(arg));
   
     if (res.second == nullptr) {
-      return make_pair(iterator(res.first), false);
+      return zstl::make_pair(iterator(res.first), false);
     } 
 
-    return make_pair(
+    return zstl::make_pair(
         InsertAux(STL_FORWARD(Arg, arg), res.first, res.second),
         true);
   }
@@ -968,14 +1144,15 @@ public:
 		const_iterator pos,
 		Args&&... args) {
     auto new_node = CreateNode(STL_FORWARD(Args, args)...);
-    auto res = GetInsertUniqueHintPos(pos, _key(new_node));
 
-    if (res.second == nullptr) {
-      return make_pair(res.first, false);
-    }
-  
     STL_TRY {
-      return make_pair(
+      auto res = GetInsertUniqueHintPos(pos, _Key(new_node));
+      if (res.second == nullptr) {
+        DropNode(new_node);
+        return zstl::make_pair(iterator(res.first), false);
+      }
+
+      return zstl::make_pair(
           EmplaceAux(new_node, res.first, res.second),
           true);
     } CATCH_ALL {
@@ -989,16 +1166,52 @@ public:
 		const_iterator pos,
 		Args&&... args) {
     auto new_node = CreateNode(STL_FORWARD(Args, args)...);
-    auto res = GetInsertEqualHintPos(pos, _Key(new_node));
-    
+
     STL_TRY {
-      return InsertAux(new_node, res.first, res.second);
+      auto res = GetInsertEqualHintPos(pos, _Key(new_node));
+      return EmplaceAux(new_node, res.first, res.second);
     } CATCH_ALL {
       DropNode(new_node);
       RETHROW
     }
   }
 
+	/**
+	 * @brief construct value from @p args only if @p key is not in tree
+	 * @param key the key of the value constructed from args
+	 * @note
+	 * The position is searched by key first,
+	 * so no node is created and dropped if key is duplicate
+	 */
+	template<typename ...Args>
+	pair<iterator, bool> TryEmplaceUnique(key_type const& key, Args&&... args) {
+    auto res = GetInsertUniquePos(key);
+
+    if (res.second == nullptr) {
+      return zstl::make_pair(iterator(res.first), false);
+    }
+
+    return zstl::make_pair(
+        CreateAndEmplace(res.first, res.second, STL_FORWARD(Args, args)...),
+        true);
+  }
+
+	template<typename ...Args>
+	pair<iterator, bool> TryEmplaceHintUnique(
+		const_iterator pos,
+		key_type const& key,
+		Args&&... args) {
+    auto res = GetInsertUniqueHintPos(pos, key);
+
+    if (res.second == nullptr) {
+      return zstl::make_pair(iterator(res.first), false);
+    }
+
+    return zstl::make_pair(
+        CreateAndEmplace(res.first, res.second, STL_FORWARD(Args, args)...),
+        true);
+  }
+
 	//////////////////////////////
 	/////////ERASE MODULE/////////
 	//////////////////////////////
@@ -1016,6 +1229,20 @@ public:
 		return next;
 	}
 
+	/**
+	 * @brief erase the element with key if it exists
+	 * @note only for the tree whose keys are unique,
+	 * it saves the search of upper bound
+	 */
+	size_type EraseUnique(Key const& key){
+		auto pos = find(key);
+		if(pos == end())
+			return 0;
+
+		EraseAux(pos);
+		return 1;
+	}
+
 	size_type erase(Key const& key){
 		auto range = equal_range(key);
 		int cnt = 0;
@@ -1038,6 +1265,128 @@ public:
 				erase(first++);
 	}
 
+	///////////////////////////////
+	//////JOIN & SPLIT MODULE//////
+	///////////////////////////////
+	// The nodes are relinked instead of copied, they are joined by
+	// black height(i.e. no subtree size or extra field in node).
+	// Compare shall not throw, otherwise the detached nodes are leaked.
+
+	/**
+	 * @brief move all elements of @p rhs to the end of this tree in O(lgn)
+	 * @pre the keys of rhs are not less than the keys of this tree,
+	 * and greater than them if the keys are unique
+	 */
+	void Join(RBTree& rhs) noexcept {
+		if (rhs.empty())
+			return;
+
+		const auto n = size() + rhs.size();
+		auto left = Release();
+		Install(JoinTree(left, rhs.Release()), n);
+	}
+
+	/**
+	 * @brief move the elements whose keys are not less than @p key to @p rhs
+	 * @note
+	 * The tree is split in O(lgn). With RBTreeSizeAugment the sizes are read
+	 * from the roots, otherwise they are counted by walking from the split point
+	 * in O(min(size(), rhs.size())). The old elements of rhs are destroyed.
+	 */
+	void Split(Key const& key, RBTree& rhs) {
+		assert(this != &rhs);
+		rhs.clear();
+		const auto n = size();
+
+		Subtree left, right;
+		SplitTree(Release(), key, left, right, nullptr);
+		Install(left, 0);
+		rhs.Install(right, 0);
+		CountSplit(rhs, n, Bool_constant<Is_same<Augment, RBTreeSizeAugment>::value>{});
+	}
+
+	/**
+	 * @brief set algebra of two trees whose keys are unique,
+	 * the result is stored in this tree
+	 * @note
+	 * Let m and n be the sizes of the smaller and the larger tree(m <= n).
+	 * The elements of the smaller tree are visited in order and located in
+	 * the larger one by FingerLowerBound(), so O(m lg(n/m + 1)) comparisons
+	 * are taken and the larger tree is never walked or copied.
+	 * Only the nodes of the smaller tree are relinked or destroyed, except
+	 * Intersect() on the larger tree, which must drop its unmatched nodes.
+	 */
+	// move the elements of rhs which are not in this tree to it, rhs is empty then.
+	// The smaller tree is merged into the larger one, whose element is kept
+	// for equal elements.
+	void Union(RBTree& rhs) {
+		static_assert(!has_deallocate_all<NodeAllocator>::value,
+			"the nodes can't be relinked to other tree if they are released by pool");
+		assert(this != &rhs);
+		if (size() < rhs.size())
+			swap(rhs);
+
+		auto x = rhs.Root();
+		rhs.impl_.Reset();
+		ConstBasePtr hint = LeftMost();
+		// the nodes of rhs are taken out in order
+		Teardown(x, [this, &hint](LinkType node) {
+			hint = FingerLowerBound(hint, _Key(node));
+			if (hint != Header() && !impl_.key_compare_(_Key(node), _Key(hint)))
+				DropNode(node);
+			else
+				LinkBefore(node, const_cast<BasePtr>(hint));
+		});
+	}
+
+	// erase the elements which are not in rhs, rhs is not modified.
+	// Call it on the smaller tree, otherwise the dropped nodes take O(n).
+	void Intersect(RBTree const& rhs) {
+		assert(this != &rhs);
+		auto hint = rhs.LeftMost();
+		for (auto first = begin(); first != end(); ) {
+			hint = rhs.FingerLowerBound(hint, _Key(first.node_));
+			if (hint == rhs.Header()) {
+				erase(first, end());
+				break;
+			}
+
+			if (impl_.key_compare_(_Key(first.node_), _Key(hint)))
+				first = erase(first);
+			else
+				++first;
+		}
+	}
+
+	// erase the elements which are in rhs, rhs is not modified
+	void Difference(RBTree const& rhs) {
+		assert(this != &rhs);
+		if (size() <= rhs.size()) {
+			auto hint = rhs.LeftMost();
+			for (auto first = begin(); first != end(); ) {
+				hint = rhs.FingerLowerBound(hint, _Key(first.node_));
+				if (hint == rhs.Header())
+					break;
+
+				if (!impl_.key_compare_(_Key(first.node_), _Key(hint)))
+					first = erase(first);
+				else
+					++first;
+			}
+		} else {
+			// look up the elements of rhs in this tree and erase them in place
+			ConstBasePtr hint = LeftMost();
+			for (auto first = rhs.begin(); first != rhs.end(); ++first) {
+				hint = FingerLowerBound(hint, _Key(first.node_));
+				if (hint == Header())
+					break;
+
+				if (!impl_.key_compare_(_Key(first.node_), _Key(hint)))
+					hint = erase(const_iterator(hint)).node_;
+			}
+		}
+	}
+
 	///////////////////////////////
 	/////////LOOPUP MODULE/////////
 	///////////////////////////////
@@ -1094,33 +1443,11 @@ public:
 	 * that is greater than key
 	 */
 	iterator upper_bound(Key const& key) {
-		auto y = Header();
-		auto x = Root();
-
-		while(x){
-			if(key_comp(key, _Key(x))){
-				y = x;
-				x = x->right;
-			}
-			else x = x->left;
-		}
-
-		return y;
+		return const_cast<BasePtr>(UpperBound(Root(), Header(), key));
 	}
 
 	const_iterator upper_bound(Key const& key) const {
-		auto y = Header();
-		auto x = Root();
-
-		while(x){
-			if(impl_.key_compare_(key, _Key(x))){
-				y = x;
-				x = x->right;
-			}
-			else x = x->left;
-		}
-
-		return y;
+		return UpperBound(Root(), Header(), key);
 	}
 	
 	/**
@@ -1128,33 +1455,11 @@ public:
 	 * element that is not less than given key
 	 */
 	iterator lower_bound(Key const& key){
-		auto y = Header();
-		auto x = Root();
-
-		while(x){
-			if(impl_.key_compare_(_Key(x), key)){
-				y = x;
-				x = x->left;
-			}
-			else x = x->right;
-		}
-
-		return y;
+		return const_cast<BasePtr>(LowerBound(Root(), Header(), key));
 	}
 
 	const_iterator lower_bound(Key const& key) const {
-		auto y = Header();
-		auto x = Root();
-
-		while(x){
-			if(impl_.key_compare_(_Key(x), key)){
-				y = x;
-				x = x->left;
-			}
-			else x = x->right;
-		}
-
-		return y;
+		return LowerBound(Root(), Header(), key);
 	}
 
 	/**
@@ -1162,11 +1467,15 @@ public:
 	 * with the given key in the container
 	 */
 	pair<iterator, iterator> equal_range(Key const& key){
-		return make_pair(lower_bound(key), upper_bound(key));
+		auto range = EqualRange(key);
+		return zstl::make_pair(
+			iterator(const_cast<BasePtr>(range.first)),
+			iterator(const_cast<BasePtr>(range.second)));
 	}
 
 	pair<const_iterator, const_iterator> equal_range(Key const& key) const {
-		return make_pair(lower_bound(key), upper_bound(key));
+		auto range = EqualRange(key);
+		return zstl::make_pair(const_iterator(range.first), const_iterator(range.second));
 	}
 
 	/**
@@ -1174,7 +1483,83 @@ public:
 	 */
 	size_type count(Key const& key) const {
 		auto range = equal_range(key);
-		return distance(range.first, range.second);
+		return zstl::distance(range.first, range.second);
+	}
+
+	/////////////////////////////////
+	/////ORDER STATISTICS MODULE/////
+	/////////////////////////////////
+	// Only for RBTreeSizeAugment, each one is O(lgn)
+
+	/**
+	 * @brief the number of elements less than @p key
+	 */
+	size_type rank(Key const& key) const {
+		static_assert(Is_same<Augment, RBTreeSizeAugment>::value,
+			"rank() requires RBTreeSizeAugment");
+		size_type r = 0;
+		auto x = Root();
+		while (x) {
+			if (impl_.key_compare_(_Key(x), key)) {
+				r += Augment::Size(x->left) + 1;
+				x = x->right;
+			} else {
+				x = x->left;
+			}
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief the k-th smallest element(start from 0)
+	 * @return end() if k >= size()
+	 */
+	const_iterator select(size_type k) const {
+		static_assert(Is_same<Augment, RBTreeSizeAugment>::value,
+			"select() requires RBTreeSizeAugment");
+		auto x = Root();
+		while (x) {
+			const auto left = Augment::Size(x->left);
+			if (k < left) {
+				x = x->left;
+			} else if (k == left) {
+				return const_iterator(x);
+			} else {
+				k -= left + 1;
+				x = x->right;
+			}
+		}
+
+		return end();
+	}
+
+	iterator select(size_type k) {
+		return static_cast<RBTree const&>(*this).select(k).ConstCast();
+	}
+
+	/**
+	 * @brief the position of @p pos, i.e. distance(begin(), pos)
+	 */
+	size_type index(const_iterator pos) const {
+		static_assert(Is_same<Augment, RBTreeSizeAugment>::value,
+			"index() requires RBTreeSizeAugment");
+		if (pos == end())
+			return size();
+
+		auto x = pos.node_;
+		auto i = Augment::Size(x->left);
+		for (; x != Root(); x = x->parent) {
+			if (x->parent->right == x)
+				i += Augment::Size(x->parent->left) + 1;
+		}
+
+		return i;
+	}
+
+	difference_type distance(const_iterator first, const_iterator last) const {
+		return static_cast<difference_type>(index(last)) 
+			- static_cast<difference_type>(index(first));
 	}
 
 #ifdef RBTREE_DEBUG
@@ -1210,6 +1595,18 @@ private:
     return new_node;
 	}
 
+	template<typename ...Args>
+	iterator CreateAndEmplace(BasePtr cur, BasePtr p, Args&&... args) {
+    auto new_node = CreateNode(STL_FORWARD(Args, args)...);
+
+    STL_TRY {
+      return EmplaceAux(new_node, cur, p);
+    } CATCH_ALL {
+      DropNode(new_node);
+      RETHROW
+    }
+  }
+
   iterator EmplaceAux(LinkType new_node, BasePtr cur, BasePtr p) {
 		// insert_left used for RBTreeInsertAndFixup() to reset link
 		//
@@ -1224,7 +1621,7 @@ private:
 		bool insert_left = cur || p == Header() ||
 				impl_.key_compare_(_Key(new_node), _Key(p));
      
-		RBTreeInsertAndFixup(insert_left, new_node, p, Header());
+		RBTreeInsertAndFixup<Augment>(insert_left, new_node, p, Header());
 		++impl_.node_count;
 
 		return new_node;
@@ -1237,6 +1634,53 @@ private:
   // parameters that are used for constructing value
   pair<BasePtr, BasePtr> GetInsertUniquePos(key_type const& key);
   pair<BasePtr, BasePtr> GetInsertEqualPos(key_type const& key);
+
+	// search in subtree x, y is the result if not found in x
+	ConstBasePtr LowerBound(ConstBasePtr x, ConstBasePtr y, Key const& key) const {
+		while(x){
+			if(!impl_.key_compare_(_Key(x), key)){
+				y = x;
+				x = x->left;
+			}
+			else x = x->right;
+		}
+
+		return y;
+	}
+
+	ConstBasePtr UpperBound(ConstBasePtr x, ConstBasePtr y, Key const& key) const {
+		while(x){
+			if(impl_.key_compare_(key, _Key(x))){
+				y = x;
+				x = x->left;
+			}
+			else x = x->right;
+		}
+
+		return y;
+	}
+
+	// descend once until the first equal node,
+	// then the two bounds are searched in its two subtrees
+	pair<ConstBasePtr, ConstBasePtr> EqualRange(Key const& key) const {
+		auto y = Header();
+		auto x = Root();
+
+		while(x){
+			if(impl_.key_compare_(_Key(x), key))
+				x = x->right;
+			else if(impl_.key_compare_(key, _Key(x))){
+				y = x;
+				x = x->left;
+			}else{
+				return zstl::make_pair(
+					LowerBound(x->left, x, key), 
+					UpperBound(x->right, y, key));
+			}
+		}
+
+		return zstl::make_pair(y, y);
+	}
   pair<BasePtr, BasePtr> GetInsertUniqueHintPos(
       const_iterator pos, 
       key_type const& key);
@@ -1263,19 +1707,346 @@ private:
       RightMost() = Maximum(Root());
       impl_.node_count = rb.impl_.node_count;
     } else {
-      clear();
+      // the nodes left in policy are released by itself
       impl_.Reset(); 
     }
 	}
 
+	//////////////////////
+	//////BULK INSERT/////
+	//////////////////////
+	template<typename II>
+	void InsertRange(II first, II last, bool unique, Input_iterator_tag) {
+		for (; first != last; ++first) {
+			if (unique)
+				InsertHintUnique(end(), *first);
+			else
+				InsertHintEqual(end(), *first);
+		}
+	}
+
+	template<typename FI>
+	void InsertRange(FI first, FI last, bool unique, Forward_iterator_tag) {
+		size_type n = 0;
+		if (empty() && CountSorted(first, last, unique, n))
+			BuildSorted(first, n, unique);
+		else
+			InsertRange(first, last, unique, Input_iterator_tag{});
+	}
+
+	/**
+	 * @brief count the elements will be in tree
+	 * @return false if [first, last) is not sorted
+	 */
+	template<typename FI>
+	bool CountSorted(FI first, FI last, bool unique, size_type& n) const {
+		n = 0;
+		if (first == last)
+			return true;
+
+		auto prev = first;
+		for (++first, n = 1; first != last; ++first, ++prev) {
+			if (impl_.key_compare_(GetKey()(*prev), GetKey()(*first)))
+				++n;
+			else if (impl_.key_compare_(GetKey()(*first), GetKey()(*prev)))
+				return false;
+			else if (!unique)
+				++n;
+		}
+
+		return true;
+	}
+
+	template<typename FI>
+	void AssignSorted(FI first, FI last, bool unique) {
+		size_type n = 0;
+		CountSorted(first, last, unique, n);
+		BuildSorted(first, n, unique);
+	}
+
+	// build a new tree of n elements from first, then replace the old one
+	template<typename FI>
+	void BuildSorted(FI first, size_type n, bool unique) {
+		// all levels except the deepest one are full,
+		// color the deepest one red if it is not full
+		int height = 0;
+		while ((size_type(2) << height) <= n)
+			++height;
+		const int red_depth = 
+			(size_type(2) << height) - 1 == n ? -1 : height;
+
+		BasePtr last = nullptr;
+		auto root = BuildBalanced(first, n, 0, red_depth, unique, last);
+
+		clear();
+		if (root == nullptr)
+			return;
+
+		Root() = root;
+		root->parent = Header();
+		LeftMost() = Minimum(root);
+		RightMost() = last;
+		impl_.node_count = n;
+	}
+
+	/**
+	 * @brief create the nodes of n elements from first in order,
+	 * and link them to a balanced subtree in the same pass
+	 * @param last the last node created, the elements equal to it are skipped if unique
+	 * @note the subtree created is freed if exception is thrown
+	 */
+	template<typename FI>
+	BasePtr BuildBalanced(
+		FI& first, 
+		size_type n, 
+		int depth, 
+		int red_depth,
+		bool unique,
+		BasePtr& last) {
+		if (n == 0)
+			return nullptr;
+
+		const auto left_n = (n - 1) / 2;
+		auto left = BuildBalanced(first, left_n, depth + 1, red_depth, unique, last);
+		LinkType node = nullptr;
+
+		STL_TRY {
+			if (unique && last) {
+				while (!impl_.key_compare_(_Key(last), GetKey()(*first)))
+					++first;
+			}
+
+			node = CreateNode(*first);
+			++first;
+
+			node->color = depth == red_depth ? RBTreeColor::Red : RBTreeColor::Black;
+			node->left = left;
+			if (left)
+				left->parent = node;
+			last = node;
+
+			auto right = BuildBalanced(first, n - left_n - 1, depth + 1, red_depth, unique, last);
+			node->right = right;
+			if (right)
+				right->parent = node;
+			Augment::Pull(node);
+		} CATCH_ALL {
+			if (node)
+				Erase(node);
+			else if (left)
+				Erase(static_cast<LinkType>(left));
+			RETHROW
+		}
+
+		return node;
+	}
+
+	/////////////////////
+	////JOIN SPLIT AUX///
+	/////////////////////
+	// detached subtree whose root is black and has no parent
+	struct Subtree {
+		BasePtr root;
+		int bh;
+	};
+
+	// take out all nodes, then this tree is empty
+	Subtree Release() noexcept {
+		static_assert(!has_deallocate_all<NodeAllocator>::value,
+			"the nodes can't be relinked to other tree if they are released by pool");
+		Subtree t{ Root(), RBTreeBlackHeight(Root()) };
+		if (t.root)
+			t.root->parent = nullptr;
+		impl_.Reset();
+		return t;
+	}
+
+	void Install(Subtree t, size_type n) noexcept {
+		assert(Root() == nullptr);
+		if (t.root == nullptr)
+			return;
+
+		Root() = t.root;
+		t.root->parent = Header();
+		LeftMost() = Minimum(t.root);
+		RightMost() = Maximum(t.root);
+		impl_.node_count = n;
+	}
+
+	/**
+	 * @brief detach the child of a subtree root
+	 * @param bh black height of x as a child of black node
+	 */
+	static Subtree Child(BasePtr x, int bh) noexcept {
+		if (x) {
+			x->parent = nullptr;
+			if (x->color == RBTreeColor::Red) {
+				x->color = RBTreeColor::Black;
+				++bh;
+			}
+		}
+
+		return Subtree{ x, bh };
+	}
+
+	static Subtree JoinTree(Subtree left, BasePtr mid, Subtree right) noexcept {
+		Subtree t;
+		t.root = RBTreeJoin<Augment>(left.root, left.bh, mid, right.root, right.bh, t.bh);
+		return t;
+	}
+
+	static Subtree JoinTree(Subtree left, Subtree right) noexcept {
+		Subtree t;
+		t.root = RBTreeJoin2<Augment>(left.root, left.bh, right.root, right.bh, t.bh);
+		return t;
+	}
+
+	/**
+	 * @brief split t to the elements less than key and the others
+	 * @param found if not null, the node equal to key is detached to it
+	 * instead of joined to right(it must be initialized to null)
+	 */
+	void SplitTree(Subtree t, Key const& key, Subtree& left, Subtree& right, BasePtr* found) {
+		if (t.root == nullptr) {
+			left = right = Subtree{ nullptr, 0 };
+			return;
+		}
+
+		auto x = t.root;
+		auto x_left = Child(x->left, t.bh - 1);
+		auto x_right = Child(x->right, t.bh - 1);
+
+		if (impl_.key_compare_(_Key(x), key)) {
+			Subtree mid;
+			SplitTree(x_right, key, mid, right, found);
+			left = JoinTree(x_left, x, mid);
+		} else if (found && !impl_.key_compare_(key, _Key(x))) {
+			*found = x;
+			left = x_left;
+			right = x_right;
+		} else {
+			Subtree mid;
+			SplitTree(x_left, key, left, mid, found);
+			right = JoinTree(mid, x, x_right);
+		}
+	}
+
+	// the sizes of both halves are stored in the roots
+	void CountSplit(RBTree& rhs, size_type n, _true_type) noexcept {
+		impl_.node_count = Augment::Size(Root());
+		rhs.impl_.node_count = n - impl_.node_count;
+	}
+
+	void CountSplit(RBTree& rhs, size_type n, _false_type) noexcept {
+		auto last = end();
+		auto first = rhs.begin();
+		size_type k = 0;
+		for (; last != begin() && first != rhs.end(); ++k) {
+			--last;
+			++first;
+		}
+
+		impl_.node_count = last == begin() ? k : n - k;
+		rhs.impl_.node_count = n - impl_.node_count;
+	}
+
+	/**
+	 * @brief lower bound of @p key searched up from @p hint
+	 * @param hint a node or header, the keys before it must be less than @p key
+	 * @note
+	 * It climbs to the lowest ancestor whose right boundary is not less than key,
+	 * then descends. For m ascending keys, each one searched from the result
+	 * of the last one, the nodes visited are in the union of their search paths,
+	 * which has O(m lg(n/m + 1)) nodes.
+	 */
+	ConstBasePtr FingerLowerBound(ConstBasePtr hint, Key const& key) const {
+		if (hint == Header() || !impl_.key_compare_(_Key(hint), key))
+			return hint;
+
+		// the key of x is less than key in the climbing
+		auto x = hint;
+		for (; x != Root(); x = x->parent) {
+			if (x->parent->left == x && !impl_.key_compare_(_Key(x->parent), key))
+				return LowerBound(x->right, x->parent, key);
+		}
+
+		return LowerBound(x->right, Header(), key);
+	}
+
+	// link detached node before pos(header means the end), no comparison is taken
+	void LinkBefore(LinkType node, BasePtr pos) noexcept {
+		node->left = nullptr;
+		node->right = nullptr;
+		node->color = RBTreeColor::Red;
+
+		bool insert_left = true;
+		if (pos == Header()) {
+			if (Root()) {
+				pos = RightMost();
+				insert_left = false;
+			}
+		} else if (pos->left) {
+			pos = Maximum(pos->left);
+			insert_left = false;
+		}
+
+		RBTreeInsertAndFixup<Augment>(insert_left, node, pos, Header());
+		++impl_.node_count;
+	}
+
 	////////////////////
 	//////ERASE AUX/////
 	////////////////////
 	/**
-	 * @brief erase all node from root top-down
-	 * @complexity O(h^2) = O((lgn)^2)
+	 * @brief erase all node of subtree @p root
+	 * @complexity O(n) time and O(1) space
+	 */
+	void Erase(LinkType root) noexcept {
+		Teardown(root, [this](LinkType node) {
+			DropNode(node);
+		});
+	}
+
+	/**
+	 * @brief call @p drop with each node of subtree @p x, no parent link is used
+	 * @note
+	 * The left child is rotated up until there is no left child,
+	 * then the root is dropped and its right child is the next root.
+	 * Every node is rotated at most once, so it is O(n) without stack.
 	 */
-	void Erase(LinkType root) noexcept;
+	template<typename Drop>
+	static void Teardown(BasePtr x, Drop drop) noexcept {
+		while (x) {
+			if (auto y = x->left) {
+				x->left = y->right;
+				y->right = x;
+				x = y;
+			} else {
+				auto right = x->right;
+				drop(static_cast<LinkType>(x));
+				x = right;
+			}
+		}
+	}
+
+	// erase all nodes, the header is not reset
+	void EraseAll() noexcept {
+		EraseAll(Bool_constant<has_deallocate_all<NodeAllocator>::value>{});
+	}
+
+	void EraseAll(_false_type) noexcept {
+		Erase(static_cast<LinkType>(Root()));
+	}
+
+	// the pool frees all nodes at once, the walk is only for destructors
+	void EraseAll(_true_type) noexcept {
+		if (!Is_trivially_destructible<Val>::value) {
+			Teardown(Root(), [this](LinkType node) {
+				DestroyNode(node);
+			});
+		}
+		GetNodeAllocator().deallocate_all();
+	}
 	void EraseAux(const_iterator node) noexcept;
 
 	/////////////////////
@@ -1316,13 +2087,13 @@ protected:
 
 
 /******* implemetation ********/
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-inline void swap(RBTree<K, V, GK, CP, Alloc> const& lhs, RBTree<K, V, GK, CP, Alloc> const& rhs) noexcept {
-	return lhs.swap(rhs);
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+inline void swap(RBTree<K, V, GK, CP, Alloc, Aug>& lhs, RBTree<K, V, GK, CP, Alloc, Aug>& rhs) noexcept {
+	lhs.swap(rhs);
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-auto RBTree<K, V, GK, CP, Alloc>::GetInsertUniquePos(key_type const& key) 
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+auto RBTree<K, V, GK, CP, Alloc, Aug>::GetInsertUniquePos(key_type const& key) 
 -> pair<BasePtr, BasePtr> {
 	// use y as a trailing pointer to track the new_node
 	auto y = Header();
@@ -1390,8 +2161,8 @@ auto RBTree<K, V, GK, CP, Alloc>::GetInsertUniquePos(key_type const& key)
 
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-auto RBTree<K, V, GK, CP, Alloc>::GetInsertEqualPos(key_type const& key)
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+auto RBTree<K, V, GK, CP, Alloc, Aug>::GetInsertEqualPos(key_type const& key)
 -> pair<BasePtr, BasePtr> {
 	auto y = Header();
 	auto x = Root();
@@ -1401,11 +2172,11 @@ auto RBTree<K, V, GK, CP, Alloc>::GetInsertEqualPos(key_type const& key)
 		x = impl_.key_compare_(key, _Key(x)) ? x->left : x->right;
 	}
 
-	return make_pair(x, y);
+	return zstl::make_pair(x, y);
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-auto RBTree<K, V, GK, CP, Alloc>::GetInsertUniqueHintPos(
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+auto RBTree<K, V, GK, CP, Alloc, Aug>::GetInsertUniqueHintPos(
 	const_iterator pos_,
   key_type const& key)
 -> pair<BasePtr, BasePtr> {
@@ -1468,8 +2239,8 @@ auto RBTree<K, V, GK, CP, Alloc>::GetInsertUniqueHintPos(
 	}
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-auto RBTree<K, V, GK, CP, Alloc>::GetInsertEqualHintPos(
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+auto RBTree<K, V, GK, CP, Alloc, Aug>::GetInsertEqualHintPos(
 	const_iterator pos_, 
 	key_type const& key) 
 -> pair<BasePtr, BasePtr> {
@@ -1516,10 +2287,10 @@ auto RBTree<K, V, GK, CP, Alloc>::GetInsertEqualHintPos(
 	}
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-void RBTree<K, V, GK, CP, Alloc>::EraseAux(const_iterator pos) noexcept {
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+void RBTree<K, V, GK, CP, Alloc, Aug>::EraseAux(const_iterator pos) noexcept {
 	auto node = static_cast<LinkType>(
-      RBTreeEraseAndFixup(const_cast<BasePtr>(pos.node_),
+      RBTreeEraseAndFixup<Aug>(const_cast<BasePtr>(pos.node_),
 													Root(), LeftMost(), RightMost()));
 
 	DropNode(node);
@@ -1527,8 +2298,8 @@ void RBTree<K, V, GK, CP, Alloc>::EraseAux(const_iterator pos) noexcept {
 }
 
 #ifdef RBTREE_DEBUG
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-pair<bool, const char*> RBTree<K, V, GK, CP, Alloc>::IsRequired() const {
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+pair<bool, const char*> RBTree<K, V, GK, CP, Alloc, Aug>::IsRequired() const {
 	if(size() == 0)
 		return make_pair(begin() == end() && Header()->left == Header() 
 			&& Header()->right == Header() && Header()->parent == nullptr, "Header()'s invariant broken when node_count == 0");
@@ -1571,13 +2342,13 @@ pair<bool, const char*> RBTree<K, V, GK, CP, Alloc>::IsRequired() const {
 	return make_pair(true, "");
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-void RBTree<K, V, GK, CP, Alloc>::PrintRoot(ConstLinkType root, std::ostream& os) const {
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+void RBTree<K, V, GK, CP, Alloc, Aug>::PrintRoot(ConstLinkType root, std::ostream& os) const {
 	os << root->val << ((root->color == RBTreeColor::Red) ? "(Red)" : "(Black)") << '\n';
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-void RBTree<K, V, GK, CP, Alloc>::PrintSubTree(ConstLinkType root, std::ostream& os, std::string const& prefix) const {
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+void RBTree<K, V, GK, CP, Alloc, Aug>::PrintSubTree(ConstLinkType root, std::ostream& os, std::string const& prefix) const {
     if(! root) return ;
 
     bool has_right = root->right;
@@ -1606,8 +2377,8 @@ void RBTree<K, V, GK, CP, Alloc>::PrintSubTree(ConstLinkType root, std::ostream&
     }
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-void RBTree<K, V, GK, CP, Alloc>::Print(std::ostream& os) const {
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
+void RBTree<K, V, GK, CP, Alloc, Aug>::Print(std::ostream& os) const {
     if(!Root()) return ;
 
 	auto root = static_cast<ConstLinkType>(Root()); 
@@ -1617,11 +2388,12 @@ void RBTree<K, V, GK, CP, Alloc>::Print(std::ostream& os) const {
 
 #endif
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
+template<typename K, typename V, typename GK, typename CP, typename Alloc, typename Aug>
 template<typename Policy>
-typename RBTree<K, V, GK, CP, Alloc>::LinkType
-RBTree<K, V, GK, CP, Alloc>::Copy(LinkType x, BasePtr p, Policy& policy){
+typename RBTree<K, V, GK, CP, Alloc, Aug>::LinkType
+RBTree<K, V, GK, CP, Alloc, Aug>::Copy(LinkType x, BasePtr p, Policy& policy){
   auto top = CloneNode(Value(x), policy);
+  top->color = x->color;
   top->parent = p;
 
   STL_TRY{
@@ -1635,6 +2407,7 @@ RBTree<K, V, GK, CP, Alloc>::Copy(LinkType x, BasePtr p, Policy& policy){
     // x  
     while(x){
       auto y = CloneNode(Value(x), policy);
+      y->color = x->color;
       p->left = y;
       y->parent = p;
 
@@ -1643,24 +2416,17 @@ RBTree<K, V, GK, CP, Alloc>::Copy(LinkType x, BasePtr p, Policy& policy){
       p = y;
       x = Left(x);
     }
+
+    // the right subtrees are done, pull the left spine from bottom
+    Aug::PullUp(p, top);
   } CATCH_ALL {
-    erase(top);
+    Erase(top);
+    RETHROW
   }
 
   return top;
 }
 
-template<typename K, typename V, typename GK, typename CP, typename Alloc>
-void RBTree<K, V, GK, CP, Alloc>::Erase(LinkType root) noexcept {
-	//no rebalance
-	while(root){
-    // erase right subtree on the left child line
-		Erase(Right(root));
-		auto y = Left(root);
-		DropNode(root);
-		root = y;
-	}
-}
 
 
 }//namespace zstl
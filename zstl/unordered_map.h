@@ -0,0 +1,492 @@
+#ifndef ZSTL_UNORDERED_MAP_H
+#define ZSTL_UNORDERED_MAP_H
+
+#include "hash_table.h"
+#include "functional.h"
+
+namespace zstl {
+
+/**
+ * @class UnorderedMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Hash hash function of key
+ * @tparam KeyEqual predicate that compare two keys whether they are equivalent
+ * @tparam Alloc allocator
+ * @brief map based on chaining HashTable, the key is unique
+ * @note
+ * try_emplace(), insert_or_assign() and operator[] search the key first,
+ * the node is only allocated when it is actually inserted
+ */
+template<typename K, typename T,
+	typename Hash = zstl::hash<K>,
+	typename KeyEqual = zstl::equal_to<K>,
+	typename Alloc = zstl::allocator<zstl::pair<K const, T>>>
+class UnorderedMap {
+public:
+	using Rep = HashTable<zstl::pair<K const, T>, K, Hash,
+		get_first<K const, T>, KeyEqual, Alloc>;
+	using key_type = typename Rep::key_type;
+	using mapped_type = T;
+	using value_type = typename Rep::value_type;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	using allocator_type = typename Rep::allocator_type;
+	using pointer = typename Rep::pointer;
+	using const_pointer = typename Rep::const_pointer;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+	using node_type = typename Rep::node_type;
+	using insert_return_type = typename Rep::insert_return_type;
+	using Res = zstl::pair<iterator, bool>;
+
+	UnorderedMap() = default;
+	~UnorderedMap() = default;
+	UnorderedMap(UnorderedMap const& rhs) = default;
+	UnorderedMap& operator=(UnorderedMap const& rhs) = default;
+
+	UnorderedMap(UnorderedMap&& rhs) noexcept = default;
+	UnorderedMap& operator=(UnorderedMap&& rhs) noexcept = default;
+
+	explicit UnorderedMap(size_type bucket_count)
+		: rep_(bucket_count)
+	{ }
+
+	explicit UnorderedMap(RehashPolicy policy)
+		: rep_(policy)
+	{ }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	UnorderedMap(II first, II last)
+	{ insert(first, last); }
+
+	Alloc get_allocator() const noexcept
+	{ return rep_.get_allocator(); }
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rep_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rep_.begin(); }
+
+	iterator end() noexcept
+	{ return rep_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rep_.end(); }
+
+	const_iterator cbegin() const noexcept
+	{ return rep_.cbegin(); }
+
+	const_iterator cend() const noexcept
+	{ return rep_.cend(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rep_.size(); }
+
+	bool empty() const noexcept
+	{ return rep_.empty(); }
+
+	size_type max_size() const noexcept
+	{ return rep_.max_size(); }
+
+	//element access
+	T& operator[](key_type const& key)
+	{ return rep_.tryEmplaceUnique(key, emplace_second, key).first->second; }
+
+	T& operator[](key_type&& key)
+	{ return rep_.tryEmplaceUnique(key, emplace_second, STL_MOVE(key)).first->second; }
+
+	T& at(key_type const& key) {
+		auto iter = find(key);
+		THROW_RANGE_ERROR_IF(iter == end(), "UnorderedMap::at(): key is not exists");
+		return iter->second;
+	}
+
+	T const& at(key_type const& key) const {
+		auto iter = find(key);
+		THROW_RANGE_ERROR_IF(iter == end(), "UnorderedMap::at(): key is not exists");
+		return iter->second;
+	}
+
+	//modifiers
+	void clear() noexcept
+	{ rep_.clear(); }
+
+	Res insert(value_type const& x)
+	{ return rep_.insertUnique(x); }
+
+	Res insert(value_type&& x)
+	{ return rep_.insertUnique(STL_MOVE(x)); }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	void insert(II first, II last) {
+		for (; first != last; ++first) {
+			rep_.insertUnique(*first);
+		}
+	}
+
+	template<typename... Args>
+	Res emplace(Args&&... args)
+	{ return rep_.emplaceUnique(STL_FORWARD(Args, args)...); }
+
+	/**
+	 * @brief if key is not exists, insert value constructed from
+	 * key and mapped value constructed from @p args, otherwise do nothing
+	 * @note
+	 * If key is exists, neither node nor mapped value is constructed,
+	 * and @p args are not moved from.
+	 * The mapped value is constructed in place by the piecewise constructor of pair.
+	 */
+	template<typename... Args>
+	Res try_emplace(key_type const& key, Args&&... args)
+	{ return rep_.tryEmplaceUnique(key, emplace_second, key, STL_FORWARD(Args, args)...); }
+
+	// the key is used for lookup before it is moved to the node
+	template<typename... Args>
+	Res try_emplace(key_type&& key, Args&&... args)
+	{ return rep_.tryEmplaceUnique(key, emplace_second, STL_MOVE(key), STL_FORWARD(Args, args)...); }
+
+	/**
+	 * @brief if key is exists, assign @p obj to mapped value,
+	 * otherwise insert it just like try_emplace()
+	 */
+	template<typename M>
+	Res insert_or_assign(key_type const& key, M&& obj) {
+		// obj is only consumed when new node is constructed
+		auto res = rep_.tryEmplaceUnique(key, key, STL_FORWARD(M, obj));
+		if (!res.second) {
+			res.first->second = STL_FORWARD(M, obj);
+		}
+
+		return res;
+	}
+
+	template<typename M>
+	Res insert_or_assign(key_type&& key, M&& obj) {
+		auto res = rep_.tryEmplaceUnique(key, STL_MOVE(key), STL_FORWARD(M, obj));
+		if (!res.second) {
+			res.first->second = STL_FORWARD(M, obj);
+		}
+
+		return res;
+	}
+
+	iterator erase(const_iterator pos)
+	{ return rep_.erase(pos); }
+
+	size_type erase(key_type const& key)
+	{ return rep_.erase(key); }
+
+	// node handle, the node is relinked instead of reallocated
+	node_type extract(const_iterator pos)
+	{ return rep_.extract(pos); }
+
+	node_type extract(key_type const& key)
+	{ return rep_.extract(key); }
+
+	insert_return_type insert(node_type&& nh)
+	{ return rep_.insertUnique(STL_MOVE(nh)); }
+
+	void merge(UnorderedMap& source)
+	{ rep_.mergeUnique(source.rep_); }
+
+	void merge(UnorderedMap&& source)
+	{ rep_.mergeUnique(source.rep_); }
+
+	void swap(UnorderedMap& rhs) noexcept
+	{ rep_.swap(rhs.rep_); }
+
+	// lookup
+	size_type count(key_type const& key) const
+	{ return rep_.count(key); }
+
+	iterator find(key_type const& key)
+	{ return rep_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rep_.find(key); }
+
+	bool contains(key_type const& key) const
+	{ return rep_.contains(key); }
+
+	zstl::pair<iterator, iterator>
+	equal_range(key_type const& key)
+	{ return rep_.equal_range(key); }
+
+	zstl::pair<const_iterator, const_iterator>
+	equal_range(key_type const& key) const
+	{ return rep_.equal_range(key); }
+
+	// search n keys at once, see HashTable::find_batch()
+	void find_batch(key_type const* keys, size_type n, iterator* out)
+	{ rep_.find_batch(keys, n, out); }
+
+	void find_batch(key_type const* keys, size_type n, const_iterator* out) const
+	{ rep_.find_batch(keys, n, out); }
+
+	// heterogeneous lookup, enabled if Hash and KeyEqual are transparent
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	iterator find(KT const& key)
+	{ return rep_.find(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	const_iterator find(KT const& key) const
+	{ return rep_.find(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	size_type count(KT const& key) const
+	{ return rep_.count(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	bool contains(KT const& key) const
+	{ return rep_.contains(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	void find_batch(KT const* keys, size_type n, iterator* out)
+	{ rep_.find_batch(keys, n, out); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	void find_batch(KT const* keys, size_type n, const_iterator* out) const
+	{ rep_.find_batch(keys, n, out); }
+
+	// hash policy
+	size_type bucket_count() const noexcept
+	{ return rep_.tableSize(); }
+
+	double load_factor() const noexcept
+	{ return rep_.load_factor(); }
+
+	void rehash(size_type n)
+	{ rep_.rehash(n); }
+
+	void reserve(size_type n)
+	{ rep_.reserve(n); }
+
+	hasher hash_function() const
+	{ return rep_.hash(); }
+
+	key_equal key_eq() const
+	{ return rep_.equalKey(); }
+
+	// distribution of chains, see HashTable::stats()
+	HashTableStats stats() const
+	{ return rep_.stats(); }
+
+	Rep& rep() noexcept {
+		return rep_;
+	}
+private:
+	Rep rep_;
+};
+
+template<typename K, typename T, typename H, typename E, typename Alloc>
+inline void swap(
+		UnorderedMap<K, T, H, E, Alloc>& lhs,
+		UnorderedMap<K, T, H, E, Alloc>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+/**
+ * @class UnorderedMultiMap
+ * @tparam K key type
+ * @tparam T mapped type
+ * @tparam Hash hash function of key
+ * @tparam KeyEqual predicate that compare two keys whether they are equivalent
+ * @tparam Alloc allocator
+ * @brief map based on chaining HashTable, the key can be duplicate
+ */
+template<typename K, typename T,
+	typename Hash = zstl::hash<K>,
+	typename KeyEqual = zstl::equal_to<K>,
+	typename Alloc = zstl::allocator<zstl::pair<K const, T>>>
+class UnorderedMultiMap {
+public:
+	using Rep = HashTable<zstl::pair<K const, T>, K, Hash,
+		get_first<K const, T>, KeyEqual, Alloc>;
+	using key_type = typename Rep::key_type;
+	using mapped_type = T;
+	using value_type = typename Rep::value_type;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	using allocator_type = typename Rep::allocator_type;
+	using pointer = typename Rep::pointer;
+	using const_pointer = typename Rep::const_pointer;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+	using node_type = typename Rep::node_type;
+
+	UnorderedMultiMap() = default;
+	~UnorderedMultiMap() = default;
+	UnorderedMultiMap(UnorderedMultiMap const& rhs) = default;
+	UnorderedMultiMap& operator=(UnorderedMultiMap const& rhs) = default;
+
+	UnorderedMultiMap(UnorderedMultiMap&& rhs) noexcept = default;
+	UnorderedMultiMap& operator=(UnorderedMultiMap&& rhs) noexcept = default;
+
+	explicit UnorderedMultiMap(size_type bucket_count)
+		: rep_(bucket_count)
+	{ }
+
+	explicit UnorderedMultiMap(RehashPolicy policy)
+		: rep_(policy)
+	{ }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	UnorderedMultiMap(II first, II last)
+	{ insert(first, last); }
+
+	Alloc get_allocator() const noexcept
+	{ return rep_.get_allocator(); }
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rep_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rep_.begin(); }
+
+	iterator end() noexcept
+	{ return rep_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rep_.end(); }
+
+	const_iterator cbegin() const noexcept
+	{ return rep_.cbegin(); }
+
+	const_iterator cend() const noexcept
+	{ return rep_.cend(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rep_.size(); }
+
+	bool empty() const noexcept
+	{ return rep_.empty(); }
+
+	size_type max_size() const noexcept
+	{ return rep_.max_size(); }
+
+	//modifiers
+	void clear() noexcept
+	{ rep_.clear(); }
+
+	iterator insert(value_type const& x)
+	{ return rep_.insertEqual(x); }
+
+	iterator insert(value_type&& x)
+	{ return rep_.insertEqual(STL_MOVE(x)); }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	void insert(II first, II last) {
+		for (; first != last; ++first) {
+			rep_.insertEqual(*first);
+		}
+	}
+
+	template<typename... Args>
+	iterator emplace(Args&&... args)
+	{ return rep_.emplaceEqual(STL_FORWARD(Args, args)...); }
+
+	iterator erase(const_iterator pos)
+	{ return rep_.erase(pos); }
+
+	// remove all elements with the key
+	size_type erase(key_type const& key)
+	{ return rep_.erase(key); }
+
+	// node handle, the node is relinked instead of reallocated
+	node_type extract(const_iterator pos)
+	{ return rep_.extract(pos); }
+
+	node_type extract(key_type const& key)
+	{ return rep_.extract(key); }
+
+	iterator insert(node_type&& nh)
+	{ return rep_.insertEqual(STL_MOVE(nh)); }
+
+	void swap(UnorderedMultiMap& rhs) noexcept
+	{ rep_.swap(rhs.rep_); }
+
+	// lookup
+	// the elements with same key are adjacent,
+	// so count() and equal_range() only walk the group
+	size_type count(key_type const& key) const
+	{ return rep_.count(key); }
+
+	iterator find(key_type const& key)
+	{ return rep_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rep_.find(key); }
+
+	bool contains(key_type const& key) const
+	{ return rep_.contains(key); }
+
+	zstl::pair<iterator, iterator>
+	equal_range(key_type const& key)
+	{ return rep_.equal_range(key); }
+
+	zstl::pair<const_iterator, const_iterator>
+	equal_range(key_type const& key) const
+	{ return rep_.equal_range(key); }
+
+	// hash policy
+	size_type bucket_count() const noexcept
+	{ return rep_.tableSize(); }
+
+	double load_factor() const noexcept
+	{ return rep_.load_factor(); }
+
+	void rehash(size_type n)
+	{ rep_.rehash(n); }
+
+	void reserve(size_type n)
+	{ rep_.reserve(n); }
+
+	hasher hash_function() const
+	{ return rep_.hash(); }
+
+	key_equal key_eq() const
+	{ return rep_.equalKey(); }
+
+	// distribution of chains, see HashTable::stats()
+	HashTableStats stats() const
+	{ return rep_.stats(); }
+
+	Rep& rep() noexcept {
+		return rep_;
+	}
+private:
+	Rep rep_;
+};
+
+template<typename K, typename T, typename H, typename E, typename Alloc>
+inline void swap(
+		UnorderedMultiMap<K, T, H, E, Alloc>& lhs,
+		UnorderedMultiMap<K, T, H, E, Alloc>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+} // namespace zstl
+
+#endif // ZSTL_UNORDERED_MAP_H
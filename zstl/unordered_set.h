@@ -0,0 +1,422 @@
+#ifndef ZSTL_UNORDERED_SET_H
+#define ZSTL_UNORDERED_SET_H
+
+#include "hash_table.h"
+#include "functional.h"
+
+namespace zstl {
+
+/**
+ * @class UnorderedSet
+ * @tparam T key type(also value type)
+ * @tparam Hash hash function of key
+ * @tparam KeyEqual predicate that compare two keys whether they are equivalent
+ * @tparam Alloc allocator
+ * @brief set based on chaining HashTable, the key is unique
+ */
+template<typename T,
+	typename Hash = zstl::hash<T>,
+	typename KeyEqual = zstl::equal_to<T>,
+	typename Alloc = zstl::allocator<T>>
+class UnorderedSet {
+public:
+	using Rep = HashTable<T, T, Hash, identity<T>, KeyEqual, Alloc>;
+	using key_type = typename Rep::key_type;
+	using value_type = typename Rep::value_type;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	using allocator_type = typename Rep::allocator_type;
+	using pointer = typename Rep::pointer;
+	using const_pointer = typename Rep::const_pointer;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+	using node_type = typename Rep::node_type;
+	using insert_return_type = typename Rep::insert_return_type;
+	using Res = zstl::pair<iterator, bool>;
+
+	UnorderedSet() = default;
+	~UnorderedSet() = default;
+	UnorderedSet(UnorderedSet const& rhs) = default;
+	UnorderedSet& operator=(UnorderedSet const& rhs) = default;
+
+	UnorderedSet(UnorderedSet&& rhs) noexcept = default;
+	UnorderedSet& operator=(UnorderedSet&& rhs) noexcept = default;
+
+	explicit UnorderedSet(size_type bucket_count)
+		: rep_(bucket_count)
+	{ }
+
+	explicit UnorderedSet(RehashPolicy policy)
+		: rep_(policy)
+	{ }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	UnorderedSet(II first, II last)
+	{ insert(first, last); }
+
+	Alloc get_allocator() const noexcept
+	{ return rep_.get_allocator(); }
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rep_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rep_.begin(); }
+
+	iterator end() noexcept
+	{ return rep_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rep_.end(); }
+
+	const_iterator cbegin() const noexcept
+	{ return rep_.cbegin(); }
+
+	const_iterator cend() const noexcept
+	{ return rep_.cend(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rep_.size(); }
+
+	bool empty() const noexcept
+	{ return rep_.empty(); }
+
+	size_type max_size() const noexcept
+	{ return rep_.max_size(); }
+
+	//modifiers
+	void clear() noexcept
+	{ rep_.clear(); }
+
+	Res insert(value_type const& x)
+	{ return rep_.insertUnique(x); }
+
+	Res insert(value_type&& x)
+	{ return rep_.insertUnique(STL_MOVE(x)); }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	void insert(II first, II last) {
+		for (; first != last; ++first) {
+			rep_.insertUnique(*first);
+		}
+	}
+
+	template<typename... Args>
+	Res emplace(Args&&... args)
+	{ return rep_.emplaceUnique(STL_FORWARD(Args, args)...); }
+
+	iterator erase(const_iterator pos)
+	{ return rep_.erase(pos); }
+
+	size_type erase(key_type const& key)
+	{ return rep_.erase(key); }
+
+	// node handle, the node is relinked instead of reallocated
+	node_type extract(const_iterator pos)
+	{ return rep_.extract(pos); }
+
+	node_type extract(key_type const& key)
+	{ return rep_.extract(key); }
+
+	insert_return_type insert(node_type&& nh)
+	{ return rep_.insertUnique(STL_MOVE(nh)); }
+
+	void merge(UnorderedSet& source)
+	{ rep_.mergeUnique(source.rep_); }
+
+	void merge(UnorderedSet&& source)
+	{ rep_.mergeUnique(source.rep_); }
+
+	void swap(UnorderedSet& rhs) noexcept
+	{ rep_.swap(rhs.rep_); }
+
+	// lookup
+	size_type count(key_type const& key) const
+	{ return rep_.count(key); }
+
+	iterator find(key_type const& key)
+	{ return rep_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rep_.find(key); }
+
+	bool contains(key_type const& key) const
+	{ return rep_.contains(key); }
+
+	zstl::pair<iterator, iterator>
+	equal_range(key_type const& key)
+	{ return rep_.equal_range(key); }
+
+	zstl::pair<const_iterator, const_iterator>
+	equal_range(key_type const& key) const
+	{ return rep_.equal_range(key); }
+
+	// search n keys at once, see HashTable::find_batch()
+	void find_batch(key_type const* keys, size_type n, iterator* out)
+	{ rep_.find_batch(keys, n, out); }
+
+	void find_batch(key_type const* keys, size_type n, const_iterator* out) const
+	{ rep_.find_batch(keys, n, out); }
+
+	// heterogeneous lookup, enabled if Hash and KeyEqual are transparent
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	iterator find(KT const& key)
+	{ return rep_.find(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	const_iterator find(KT const& key) const
+	{ return rep_.find(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	size_type count(KT const& key) const
+	{ return rep_.count(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	bool contains(KT const& key) const
+	{ return rep_.contains(key); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	void find_batch(KT const* keys, size_type n, iterator* out)
+	{ rep_.find_batch(keys, n, out); }
+
+	template<typename KT, typename = Enable_if_t<
+		Rep::template IsTransparent<KT>::value>>
+	void find_batch(KT const* keys, size_type n, const_iterator* out) const
+	{ rep_.find_batch(keys, n, out); }
+
+	// hash policy
+	size_type bucket_count() const noexcept
+	{ return rep_.tableSize(); }
+
+	double load_factor() const noexcept
+	{ return rep_.load_factor(); }
+
+	void rehash(size_type n)
+	{ rep_.rehash(n); }
+
+	void reserve(size_type n)
+	{ rep_.reserve(n); }
+
+	hasher hash_function() const
+	{ return rep_.hash(); }
+
+	key_equal key_eq() const
+	{ return rep_.equalKey(); }
+
+	// distribution of chains, see HashTable::stats()
+	HashTableStats stats() const
+	{ return rep_.stats(); }
+
+	Rep& rep() noexcept {
+		return rep_;
+	}
+private:
+	Rep rep_;
+};
+
+template<typename T, typename H, typename E, typename Alloc>
+inline void swap(
+		UnorderedSet<T, H, E, Alloc>& lhs,
+		UnorderedSet<T, H, E, Alloc>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+/**
+ * @class UnorderedMultiSet
+ * @tparam T key type(also value type)
+ * @tparam Hash hash function of key
+ * @tparam KeyEqual predicate that compare two keys whether they are equivalent
+ * @tparam Alloc allocator
+ * @brief set based on chaining HashTable, the key can be duplicate
+ */
+template<typename T,
+	typename Hash = zstl::hash<T>,
+	typename KeyEqual = zstl::equal_to<T>,
+	typename Alloc = zstl::allocator<T>>
+class UnorderedMultiSet {
+public:
+	using Rep = HashTable<T, T, Hash, identity<T>, KeyEqual, Alloc>;
+	using key_type = typename Rep::key_type;
+	using value_type = typename Rep::value_type;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	using allocator_type = typename Rep::allocator_type;
+	using pointer = typename Rep::pointer;
+	using const_pointer = typename Rep::const_pointer;
+	using reference = typename Rep::reference;
+	using const_reference = typename Rep::const_reference;
+	using size_type = typename Rep::size_type;
+	using difference_type = typename Rep::difference_type;
+	using iterator = typename Rep::iterator;
+	using const_iterator = typename Rep::const_iterator;
+	using node_type = typename Rep::node_type;
+
+	UnorderedMultiSet() = default;
+	~UnorderedMultiSet() = default;
+	UnorderedMultiSet(UnorderedMultiSet const& rhs) = default;
+	UnorderedMultiSet& operator=(UnorderedMultiSet const& rhs) = default;
+
+	UnorderedMultiSet(UnorderedMultiSet&& rhs) noexcept = default;
+	UnorderedMultiSet& operator=(UnorderedMultiSet&& rhs) noexcept = default;
+
+	explicit UnorderedMultiSet(size_type bucket_count)
+		: rep_(bucket_count)
+	{ }
+
+	explicit UnorderedMultiSet(RehashPolicy policy)
+		: rep_(policy)
+	{ }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	UnorderedMultiSet(II first, II last)
+	{ insert(first, last); }
+
+	Alloc get_allocator() const noexcept
+	{ return rep_.get_allocator(); }
+
+	//iterator interface
+	iterator begin() noexcept
+	{ return rep_.begin(); }
+
+	const_iterator begin() const noexcept
+	{ return rep_.begin(); }
+
+	iterator end() noexcept
+	{ return rep_.end(); }
+
+	const_iterator end() const noexcept
+	{ return rep_.end(); }
+
+	const_iterator cbegin() const noexcept
+	{ return rep_.cbegin(); }
+
+	const_iterator cend() const noexcept
+	{ return rep_.cend(); }
+
+	//capacity
+	size_type size() const noexcept
+	{ return rep_.size(); }
+
+	bool empty() const noexcept
+	{ return rep_.empty(); }
+
+	size_type max_size() const noexcept
+	{ return rep_.max_size(); }
+
+	//modifiers
+	void clear() noexcept
+	{ rep_.clear(); }
+
+	iterator insert(value_type const& x)
+	{ return rep_.insertEqual(x); }
+
+	iterator insert(value_type&& x)
+	{ return rep_.insertEqual(STL_MOVE(x)); }
+
+	template<typename II,
+		typename = Enable_if_t<is_input_iterator<II>::value>>
+	void insert(II first, II last) {
+		for (; first != last; ++first) {
+			rep_.insertEqual(*first);
+		}
+	}
+
+	template<typename... Args>
+	iterator emplace(Args&&... args)
+	{ return rep_.emplaceEqual(STL_FORWARD(Args, args)...); }
+
+	iterator erase(const_iterator pos)
+	{ return rep_.erase(pos); }
+
+	// remove all elements with the key
+	size_type erase(key_type const& key)
+	{ return rep_.erase(key); }
+
+	// node handle, the node is relinked instead of reallocated
+	node_type extract(const_iterator pos)
+	{ return rep_.extract(pos); }
+
+	node_type extract(key_type const& key)
+	{ return rep_.extract(key); }
+
+	iterator insert(node_type&& nh)
+	{ return rep_.insertEqual(STL_MOVE(nh)); }
+
+	void swap(UnorderedMultiSet& rhs) noexcept
+	{ rep_.swap(rhs.rep_); }
+
+	// lookup
+	// the elements with same key are adjacent,
+	// so count() and equal_range() only walk the group
+	size_type count(key_type const& key) const
+	{ return rep_.count(key); }
+
+	iterator find(key_type const& key)
+	{ return rep_.find(key); }
+
+	const_iterator find(key_type const& key) const
+	{ return rep_.find(key); }
+
+	bool contains(key_type const& key) const
+	{ return rep_.contains(key); }
+
+	zstl::pair<iterator, iterator>
+	equal_range(key_type const& key)
+	{ return rep_.equal_range(key); }
+
+	zstl::pair<const_iterator, const_iterator>
+	equal_range(key_type const& key) const
+	{ return rep_.equal_range(key); }
+
+	// hash policy
+	size_type bucket_count() const noexcept
+	{ return rep_.tableSize(); }
+
+	double load_factor() const noexcept
+	{ return rep_.load_factor(); }
+
+	void rehash(size_type n)
+	{ rep_.rehash(n); }
+
+	void reserve(size_type n)
+	{ rep_.reserve(n); }
+
+	hasher hash_function() const
+	{ return rep_.hash(); }
+
+	key_equal key_eq() const
+	{ return rep_.equalKey(); }
+
+	// distribution of chains, see HashTable::stats()
+	HashTableStats stats() const
+	{ return rep_.stats(); }
+
+	Rep& rep() noexcept {
+		return rep_;
+	}
+private:
+	Rep rep_;
+};
+
+template<typename T, typename H, typename E, typename Alloc>
+inline void swap(
+		UnorderedMultiSet<T, H, E, Alloc>& lhs,
+		UnorderedMultiSet<T, H, E, Alloc>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+} // namespace zstl
+
+#endif // ZSTL_UNORDERED_SET_H
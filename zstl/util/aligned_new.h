@@ -0,0 +1,37 @@
+#ifndef ZSTL_UTIL_ALIGNED_NEW_H
+#define ZSTL_UTIL_ALIGNED_NEW_H
+
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+
+namespace zstl {
+
+/**
+ * @class AlignedNew
+ * @brief base of over-aligned class to keep its alignment on heap
+ * @note
+ * Before C++17, operator new only guarantees the alignment of max_align_t,
+ * so the padding of alignas(64) class may not stop false sharing when
+ * it is allocated by new. The derived class is allocated by posix_memalign()
+ * and released by free() instead.
+ */
+template<size_t ALIGN>
+struct AlignedNew {
+    static void* operator new(size_t n) {
+        void* p;
+        if (::posix_memalign(&p, ALIGN, n) != 0) {
+            throw std::bad_alloc();
+        }
+
+        return p;
+    }
+
+    static void operator delete(void* p) noexcept {
+        ::free(p);
+    }
+};
+
+} // namespace zstl
+
+#endif // ZSTL_UTIL_ALIGNED_NEW_H
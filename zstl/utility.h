@@ -7,6 +7,17 @@
 
 namespace zstl{
 
+	/**
+	 * @brief tag to construct pair::second in place from arguments,
+	 * e.g. pair<K const, T>(emplace_second, key, args...)
+	 * is like std::piecewise_construct but don't need tuple
+	 */
+	struct emplace_second_t{
+		explicit emplace_second_t() = default;
+	};
+
+	constexpr emplace_second_t emplace_second{};
+
 	template<typename T1,typename T2>
 	struct pair{
 		T1 first;
@@ -21,6 +32,12 @@ namespace zstl{
 			: first{zstl::move(_first)}
 			, second{zstl::move(_second)}
 		{ }
+
+		template<typename U, typename ...Args>
+		pair(emplace_second_t, U&& _first, Args&&... args)
+			: first(zstl::forward<U>(_first))
+			, second(zstl::forward<Args>(args)...)
+		{ }
 	};
 
 	template<typename T1, typename T2>
@@ -12,6 +12,7 @@
 #include <initializer_list>
 #include <stdexcept>
 #include <climits>
+#include <assert.h>
 
 namespace zstl {
 /**
@@ -155,7 +156,7 @@ public:
 	// dtor:	
 	// deallocate is delegated to base class
 	~Vector()
-	{ destroy(begin(),end()); }
+	{ zstl::destroy(begin(),end()); }
 
 	// copy & move ctor
 	Vector(Vector const& rhs)
@@ -541,7 +542,7 @@ Vector<T,Alloc>::emplace(const_iterator position,Args&&...args)
 			AllocTraits::construct(*this, end(),STL_MOVE(back()));
 			//avoid the intersection of source interval and destination interval
 			//should use copy_backward
-			copy_backward(
+			zstl::copy_backward(
 				MAKE_MOVE_IF_NOEXCEPT_ITERATOR(pos),
 				MAKE_MOVE_IF_NOEXCEPT_ITERATOR(this->last_-1),
 				this->last_);
@@ -609,7 +610,7 @@ Vector<T, Alloc>::insert(const_iterator position, std::initializer_list<U> il)
 template<typename T, typename Alloc>
 inline void
 Vector<T, Alloc>::pop_back() ZSTL_NOEXCEPT {
-	checkSize();
+	assert(!empty());
 	--this->last_;
 	AllocTraits::destroy(*this, this->last_);
 }
@@ -779,8 +780,12 @@ Vector<T, Alloc>::expandAndEmplace(const_iterator pos, Args&&... args) {
 	TRY_END
 	CATCH_ALL_BEGIN
 		AllocTraits::deallocate(*this, new_first, new_capa);
+		RETHROW
 	CATCH_END
 
+	AllocTraits::destroy(*this, begin(), end());
+	AllocTraits::deallocate(*this, this->first_, capacity());
+
 	this->first_ = new_first;
 	this->last_ = this->first_ + old_size + 1;
 	this->capa_ = this->first_ + new_capa;
@@ -799,7 +804,7 @@ Vector<T,Alloc>::eraseAux(iterator first,iterator last)
 		first);
 
 	AllocTraits::destroy(*this, tmp, end());
-
+	this->last_ = tmp;
 
 	return begin() + offset;
 }